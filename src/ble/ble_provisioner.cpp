@@ -212,6 +212,9 @@ void BleProvisioner::handle_write(const uint8_t *data, size_t len) {
   strncpy(c.serverUrl, serverUrl.c_str(), sizeof(c.serverUrl) - 1);  c.serverUrl[sizeof(c.serverUrl) - 1] = '\0';
 
   sInstance_->credPending_ = true;
+  if (sInstance_->credCb_) {
+    sInstance_->credCb_(c, sInstance_->credCbCtx_);
+  }
   DCTRL_LOGI("BLE", "Credentials received ssid=%s passwordLen=%u enterprise=%s token=%s",
              c.ssid,
              static_cast<unsigned>(strlen(c.password)),
@@ -0,0 +1,129 @@
+#include "core/deadline_scheduler.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+namespace core {
+
+namespace {
+
+bool reached(uint32_t nowMs, uint32_t dueMs) {
+  return static_cast<int32_t>(nowMs - dueMs) >= 0;
+}
+
+}  // namespace
+
+void LatenessHistogram::record(uint32_t latenessMs) {
+  uint8_t bucket = 0;
+  while (bucket + 1 < kBuckets && latenessMs >= (1UL << bucket)) {
+    ++bucket;
+  }
+  ++counts[bucket];
+  if (latenessMs > maxMs) {
+    maxMs = latenessMs;
+  }
+}
+
+void LatenessHistogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  maxMs = 0;
+}
+
+uint32_t LatenessHistogram::percentile_ms(uint8_t pct) const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < kBuckets; ++i) total += counts[i];
+  if (total == 0) return 0;
+  // Rank of the percentile sample, rounded up so p99 of 10 samples is the 10th.
+  const uint32_t rank = (total * pct + 99U) / 100U;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i + 1 < kBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank && seen > 0) return 1UL << i;
+  }
+  return maxMs;
+}
+
+DeadlineScheduler::DeadlineScheduler()
+    : deadlines_{}, task_(nullptr), lateness_{}, wakeups_(0), eventWakeups_(0) {}
+
+void DeadlineScheduler::bind_current_task() {
+  task_ = xTaskGetCurrentTaskHandle();
+}
+
+void DeadlineScheduler::set(uint8_t id, uint32_t dueMs) {
+  if (id >= kMaxDeadlines) return;
+  deadlines_[id].dueMs = dueMs;
+  deadlines_[id].armed = true;
+}
+
+void DeadlineScheduler::clear(uint8_t id) {
+  if (id >= kMaxDeadlines) return;
+  deadlines_[id].armed = false;
+}
+
+bool DeadlineScheduler::armed(uint8_t id) const {
+  return id < kMaxDeadlines && deadlines_[id].armed;
+}
+
+bool DeadlineScheduler::fire(uint8_t id, uint32_t nowMs) {
+  if (id >= kMaxDeadlines || !deadlines_[id].armed || !reached(nowMs, deadlines_[id].dueMs)) {
+    return false;
+  }
+  deadlines_[id].armed = false;
+  lateness_.record(nowMs - deadlines_[id].dueMs);
+  return true;
+}
+
+void DeadlineScheduler::advance(uint8_t id, uint32_t periodMs, uint32_t nowMs) {
+  if (id >= kMaxDeadlines || periodMs == 0) return;
+  Deadline &d = deadlines_[id];
+  uint32_t next = d.dueMs + periodMs;
+  if (reached(nowMs, next)) {
+    next += ((nowMs - next) / periodMs + 1U) * periodMs;
+  }
+  d.dueMs = next;
+  d.armed = true;
+}
+
+uint32_t DeadlineScheduler::wait_budget_ms(uint32_t nowMs, uint32_t maxWaitMs) const {
+  uint32_t budget = maxWaitMs;
+  for (const Deadline &d : deadlines_) {
+    if (!d.armed) continue;
+    if (reached(nowMs, d.dueMs)) {
+      return 0;
+    }
+    if (d.dueMs - nowMs < budget) {
+      budget = d.dueMs - nowMs;
+    }
+  }
+  return budget;
+}
+
+void DeadlineScheduler::wait(uint32_t maxWaitMs) {
+  const uint32_t budget = wait_budget_ms(millis(), maxWaitMs);
+  if (budget == 0) {
+    return;
+  }
+  ++wakeups_;
+  if (!task_) {
+    vTaskDelay(pdMS_TO_TICKS(budget));
+    return;
+  }
+  if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(budget)) != 0) {
+    ++eventWakeups_;
+  }
+}
+
+void DeadlineScheduler::wake() {
+  if (task_) {
+    xTaskNotifyGive(task_);
+  }
+}
+
+void DeadlineScheduler::reset_stats() {
+  lateness_.reset();
+  wakeups_ = 0;
+  eventWakeups_ = 0;
+}
+
+}  // namespace core
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdint.h>
+
+namespace core {
+
+// How late deadlines were serviced, in power-of-two millisecond buckets:
+// [0,1) [1,2) [2,4) [4,8) [8,16) [16,32) [32,64) [64,inf).
+struct LatenessHistogram {
+  static constexpr uint8_t kBuckets = 8;
+
+  uint32_t counts[kBuckets];
+  uint32_t maxMs;
+
+  void record(uint32_t latenessMs);
+  void reset();
+  // Upper edge of the bucket holding the pct-th percentile sample, so "2"
+  // means under 2 ms; the open last bucket reports maxMs. 0 when empty.
+  uint32_t percentile_ms(uint8_t pct) const;
+};
+
+// Next-due times for the periodic work of one task. The task sleeps in wait()
+// until the earliest armed deadline, or until another task calls wake() to
+// signal an external event. Deadline ids are small integers chosen by the
+// owner; all times are millis() values and compare wrap-safely.
+class DeadlineScheduler final {
+ public:
+  static constexpr uint8_t kMaxDeadlines = 8;
+
+  DeadlineScheduler();
+
+  // Binds wait()/wake() to the calling task.
+  void bind_current_task();
+
+  void set(uint8_t id, uint32_t dueMs);
+  void clear(uint8_t id);
+  bool armed(uint8_t id) const;
+
+  // True once `id` is due. Disarms it and records how late it was serviced.
+  bool fire(uint8_t id, uint32_t nowMs);
+
+  // Re-arms a fired deadline one period after its previous due time, skipping
+  // periods that were missed entirely, so the cadence does not drift.
+  void advance(uint8_t id, uint32_t periodMs, uint32_t nowMs);
+
+  uint32_t wait_budget_ms(uint32_t nowMs, uint32_t maxWaitMs) const;
+  void wait(uint32_t maxWaitMs);
+
+  // Safe to call from any task (not from an ISR).
+  void wake();
+
+  const LatenessHistogram &lateness() const { return lateness_; }
+  uint32_t wakeups() const { return wakeups_; }
+  uint32_t event_wakeups() const { return eventWakeups_; }
+  void reset_stats();
+
+ private:
+  struct Deadline {
+    uint32_t dueMs;
+    bool armed;
+  };
+
+  Deadline deadlines_[kMaxDeadlines];
+  TaskHandle_t task_;
+  LatenessHistogram lateness_;
+  uint32_t wakeups_;
+  uint32_t eventWakeups_;
+};
+
+}  // namespace core
@@ -7,12 +7,17 @@
 #include <esp_system.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
+#include <time.h>
 #include <type_traits>
 
-#include "parsing/payload_parser.h"
+#include "parsing/binary_payload.h"
+#include "parsing/json_tokenizer.h"
 #include "parsing/provider_parser_router.h"
 #include "core/logging.h"
+#include "core/profiler.h"
 #include "display/badge_renderer.h"
+#include "display/font_tables.h"
 #include "network/wifi_manager.h"
 
 #if __has_include("secrets.h")
@@ -22,6 +27,21 @@
 #warning "Using include/secrets.example.h defaults. Create include/secrets.h for real credentials."
 #endif
 
+#ifndef COMMUTELIVE_RENDER_TASK
+#define COMMUTELIVE_RENDER_TASK 1
+#endif
+
+// Scroll pacing; overridable so timings can be tried in the host simulator.
+#ifndef COMMUTELIVE_SCROLL_STEP_MS
+#define COMMUTELIVE_SCROLL_STEP_MS 65
+#endif
+#ifndef COMMUTELIVE_SCROLL_START_PAUSE_MS
+#define COMMUTELIVE_SCROLL_START_PAUSE_MS 1500
+#endif
+#ifndef COMMUTELIVE_SCROLL_LOOP_PAUSE_MS
+#define COMMUTELIVE_SCROLL_LOOP_PAUSE_MS 2500
+#endif
+
 #ifndef JACK_LEI
 #define JACK_LEI true
 #endif
@@ -32,9 +52,6 @@ DeviceController *DeviceController::activeController_ = nullptr;
 
 namespace {
 
-constexpr uint32_t kHeartbeatEveryMs = 15000;
-constexpr uint32_t kTelemetryEveryMs = 30000;
-constexpr uint32_t kDeviceLogHeartbeatEveryMs = 300000;
 constexpr uint32_t kLowHeapWarningEveryMs = 60000;
 constexpr uint32_t kCrashBreadcrumbPersistEveryMs = 30000;
 constexpr uint32_t kStaleEtaAnimEveryMs = 450;
@@ -43,9 +60,19 @@ constexpr uint32_t kInitialMqttConnectBudgetMs = 2000;
 constexpr uint32_t kBleSuccessNotifyDrainMs = 750;
 constexpr uint32_t kLowHeapWarningThresholdBytes = 32768;
 constexpr uint32_t kMinRenderGapMs = 40;
-constexpr uint32_t kScrollStepMs = 65;       // advance 1px every 65ms (~15px/sec)
-constexpr uint32_t kScrollStartPauseMs = 1500; // pause before first scroll
-constexpr uint32_t kScrollLoopPauseMs = 2500;  // pause at the end before text jumps back
+constexpr uint32_t kScrollStepMs = COMMUTELIVE_SCROLL_STEP_MS;              // advance 1px per step; 65ms is ~15px/sec
+constexpr uint32_t kScrollStartPauseMs = COMMUTELIVE_SCROLL_START_PAUSE_MS;  // pause before first scroll
+constexpr uint32_t kScrollLoopPauseMs = COMMUTELIVE_SCROLL_LOOP_PAUSE_MS;    // pause at the end before text jumps back
+constexpr uint32_t kRenderTaskStackBytes = 8192;
+constexpr UBaseType_t kRenderTaskPriority = 2;
+constexpr BaseType_t kRenderTaskCore = 0;  // Arduino loop() runs on core 1
+// MQTT and HTTP sockets have no readiness callback, so the loop still polls
+// them; everything else wakes it through a deadline or an event.
+constexpr uint32_t kNetworkPollEveryMs = 50;
+constexpr uint32_t kMaxLoopSleepMs = 1000;
+constexpr const char *kNtpServerPrimary = "pool.ntp.org";
+constexpr const char *kNtpServerSecondary = "time.google.com";
+constexpr time_t kMinValidEpochSec = 1700000000;  // below this SNTP has not answered yet
 constexpr int16_t kScrollEtaSafetyGapPx = 4;   // keep scrolled text clear of the ETA column
 constexpr int16_t kScrollGapPx = 16;          // gap between end and restart of text
 constexpr uint8_t kMinDisplayType = 1;
@@ -60,6 +87,16 @@ constexpr uint16_t kTransitCacheSchemaVersion = 1;
 display::BadgeRenderer gBadgeRenderer;
 Preferences gDevicePrefs;
 
+// Control-loop deadlines registered with DeviceController::scheduler_.
+enum LoopDeadline : uint8_t {
+  kDeadlineNetworkPoll,
+  kDeadlineTelemetrySample,
+  kDeadlineTelemetry,
+  kDeadlineBreadcrumbs,
+  kDeadlineEtaCountdown,  // next minute change of a device-side countdown
+  kDeadlineRender,  // only when rendering inline, without the render task
+};
+
 struct PersistedCachedTransitRow {
   uint8_t displayType;
   uint8_t scrollEnabled;
@@ -91,6 +128,16 @@ void copy_str(char *dst, size_t dstLen, const char *src) {
 bool strings_equal(const char *lhs, const char *rhs);
 void clear_row(TransitRowModel &row);
 
+// Largest destination the scroll renderer can see: every char at the 2x advance.
+static_assert((kMaxDestinationLen - 1) * 12 <= display::ScrollStrip::kMaxWidthPx,
+              "Scroll strip must hold the widest destination line");
+
+int16_t scroll_clip_width(const TransitRowGeometry &geom) {
+  return geom.effectiveDestinationWidth > kScrollEtaSafetyGapPx
+      ? static_cast<int16_t>(geom.effectiveDestinationWidth - kScrollEtaSafetyGapPx)
+      : geom.effectiveDestinationWidth;
+}
+
 const char *ble_provision_failure_reason(int wifiStatus, int disconnectReason) {
   switch (disconnectReason) {
     case WIFI_REASON_NO_AP_FOUND:
@@ -207,82 +254,6 @@ void copy_cached_row(CachedTransitRow &dst, const PersistedCachedTransitRow &src
 }
 
 
-bool has_json_field(const String &json, const char *field) {
-  return extract_json_string_field(json, field).length() > 0;
-}
-
-void normalize_eta(const String &input, char *out, size_t outLen) {
-  String eta = input;
-  eta.trim();
-  eta.toUpperCase();
-
-  if (eta.length() == 0 || eta == "--") {
-    copy_str(out, outLen, "--");
-    return;
-  }
-  if (eta == "NOW" || eta == "DUE") {
-    copy_str(out, outLen, "0m");
-    return;
-  }
-
-  // Preserve multi-arrival strings like "DUE/3M/8M" generated from nextArrivals.
-  if (eta.indexOf('/') >= 0) {
-    String normalized = "";
-    int start = 0;
-    while (start <= eta.length()) {
-      int sep = eta.indexOf('/', start);
-      String token;
-      if (sep < 0) {
-        token = eta.substring(start);
-      } else {
-        token = eta.substring(start, sep);
-      }
-      token.trim();
-      if (token == "NOW" || token == "DUE") token = "0m";
-
-      if (token.length() > 0 && token != "--") {
-        if (normalized.length() > 0) normalized += "/";
-        normalized += token;
-      }
-
-      if (sep < 0) break;
-      start = sep + 1;
-    }
-
-    if (normalized.length() == 0) {
-      copy_str(out, outLen, "--");
-      return;
-    }
-    copy_str(out, outLen, normalized.c_str());
-    return;
-  }
-
-  int minutes = 0;
-  bool foundDigit = false;
-  for (int i = 0; i < eta.length(); ++i) {
-    const char c = eta[i];
-    if (c >= '0' && c <= '9') {
-      foundDigit = true;
-      minutes = (minutes * 10) + (c - '0');
-    } else if (foundDigit) {
-      break;
-    }
-  }
-
-  if (foundDigit) {
-    if (minutes <= 1) {
-      copy_str(out, outLen, "DUE");
-    } else {
-      char tmp[12];
-      snprintf(tmp, sizeof(tmp), "%dm", minutes);
-      copy_str(out, outLen, tmp);
-    }
-    return;
-  }
-
-  copy_str(out, outLen, input.c_str());
-}
-
 void set_default_rows(RenderModel &model) {
   model.displayType = kMinDisplayType;
   model.activeRows = 1;
@@ -313,13 +284,17 @@ uint8_t clamp_display_type(int value) {
   return static_cast<uint8_t>(value);
 }
 
-uint8_t parse_brightness_percent(const String &message, uint8_t fallbackPercent) {
-  const int raw = extract_json_int_field(message, "brightness", static_cast<int>(fallbackPercent));
+uint8_t clamp_brightness_percent(int raw) {
   if (raw < 1) return 1;
   if (raw > 100) return 100;
   return static_cast<uint8_t>(raw);
 }
 
+uint8_t parse_brightness_percent(const parsing::JsonIndex &json, uint8_t fallbackPercent) {
+  return clamp_brightness_percent(
+      json.to_int(json.find(json.root(), "brightness"), static_cast<int>(fallbackPercent)));
+}
+
 uint8_t brightness_percent_to_panel(uint8_t percent) {
   const uint32_t numerator = static_cast<uint32_t>(percent) * static_cast<uint32_t>(percent) * 255U;
   const uint16_t scaled = static_cast<uint16_t>((numerator + 5000U) / 10000U);
@@ -408,16 +383,32 @@ bool render_models_equal_for_display(const RenderModel &lhs, const RenderModel &
   return true;
 }
 
+uint8_t render_mode_rank(DeviceController::RenderMode mode) {
+  switch (mode) {
+    case DeviceController::RenderMode::kFull:
+      return 4;
+    case DeviceController::RenderMode::kMinimal:
+      return 3;
+    case DeviceController::RenderMode::kEtaOnly:
+      return 2;
+    case DeviceController::RenderMode::kScrollOnly:
+      return 1;
+    case DeviceController::RenderMode::kNone:
+    default:
+      return 0;
+  }
+}
+
 DeviceController::RenderMode classify_render_mode(const RenderModel &current,
                                                   const RenderModel &next,
-                                                  bool doubleBuffered,
+                                                  bool fullFramesOnly,
                                                   uint8_t &etaDirtyRows) {
   etaDirtyRows = 0;
   if (render_models_equal_for_display(current, next)) {
     return DeviceController::RenderMode::kNone;
   }
 
-  if (doubleBuffered ||
+  if (fullFramesOnly ||
       current.uiState != UiState::kTransit ||
       next.uiState != UiState::kTransit ||
       !current.hasData ||
@@ -431,9 +422,11 @@ DeviceController::RenderMode classify_render_mode(const RenderModel &current,
     return DeviceController::RenderMode::kFull;
   }
 
+  // Row content changes within the same transit layout are repainted from a
+  // DrawList diff rather than a full clear.
   for (uint8_t i = 0; i < current.activeRows; ++i) {
     if (!row_layout_fields_equal(current.rows[i], next.rows[i])) {
-      return DeviceController::RenderMode::kFull;
+      return DeviceController::RenderMode::kMinimal;
     }
     if (!row_eta_fields_equal(current.rows[i], next.rows[i])) {
       etaDirtyRows |= static_cast<uint8_t>(1U << i);
@@ -442,13 +435,46 @@ DeviceController::RenderMode classify_render_mode(const RenderModel &current,
 
   for (uint8_t i = current.activeRows; i < kMaxTransitRows; ++i) {
     if (!rows_equal(current.rows[i], next.rows[i])) {
-      return DeviceController::RenderMode::kFull;
+      return DeviceController::RenderMode::kMinimal;
     }
   }
 
   return etaDirtyRows == 0 ? DeviceController::RenderMode::kNone : DeviceController::RenderMode::kEtaOnly;
 }
 
+// Recomputes the ETAs of rows with arrival times; returns the rows touched.
+uint8_t apply_countdown_rows(const RowArrivals *arrivals,
+                             const WallClock &clock,
+                             uint32_t nowMs,
+                             TransitRowModel *rows,
+                             uint8_t rowCount) {
+  if (!clock.valid()) {
+    return 0;
+  }
+  const uint64_t nowEpochMs = clock.epoch_ms(nowMs);
+  uint8_t touched = 0;
+  for (uint8_t i = 0; i < rowCount && i < kMaxTransitRows; ++i) {
+    if (arrivals[i].enabled) {
+      apply_countdown(arrivals[i], nowEpochMs, rows[i]);
+      touched |= static_cast<uint8_t>(1U << i);
+    }
+  }
+  return touched;
+}
+
+void mark_text_off_list(display::DirtyRegion &region, int16_t x, int16_t y, const char *text, uint8_t size) {
+  DrawCommand cmd{};
+  cmd.type = DrawCommandType::kText;
+  cmd.x = x;
+  cmd.y = y;
+  cmd.size = size;
+  cmd.text = text;
+  display::DirtyRect r{};
+  if (draw_command_bounds(cmd, r)) {
+    region.add(r.x, r.y, r.w, r.h);
+  }
+}
+
 void json_escape(const char *src, char *dst, size_t dstLen) {
   if (dstLen == 0) {
     return;
@@ -567,7 +593,26 @@ DeviceController::DeviceController(const Dependencies &deps)
     : deps_(deps),
       runtimeConfig_{},
       renderModel_{},
+      renderRequest_{},
+      publishedRequest_{},
+      publishedSnapshotSeq_(0),
+      adoptedSnapshotSeq_(0),
+      renderHandoff_(),
+      renderTask_(nullptr),
+      frameModel_{},
+      appliedBrightness_(0),
+      renderLateness_{},
+      renderCounts_{},
+      renderStatsHandoff_(),
+      renderStatsRequested_(false),
+      telemetryAwaitingStats_(false),
+      telemetry_(),
+      scheduler_(),
       drawList_{},
+      presentedDrawList_{},
+      presentedDrawListValid_(false),
+      offListRegion_(),
+      drawListDiff_{},
       server_(80),
       bleProvisioningInFlight_(false),
       bleProvisioningStartedAtMs_(0),
@@ -575,9 +620,8 @@ DeviceController::DeviceController(const Dependencies &deps)
       bleScanPending_(false),
       bootCount_(0),
       lastBreadcrumbPersistAtMs_(0),
-      lastHeartbeatAtMs_(0),
+      lastTelemetrySampleAtMs_(0),
       lastTelemetryAtMs_(0),
-      lastDeviceLogHeartbeatAtMs_(0),
       lastLowMemoryWarningAtMs_(0),
       lastRenderAtMs_(0),
       lastStaleEtaAnimAtMs_(0),
@@ -593,11 +637,14 @@ DeviceController::DeviceController(const Dependencies &deps)
       pendingWifiConnectedLog_(false),
       pendingWifiDisconnectLog_(false),
       pendingMqttDisconnectLog_(false),
-      pendingReconnectLogs_(false),
       pendingRenderMode_(RenderMode::kFull),
       etaDirtyRowMask_(0),
       scrollState_{},
-      cachedTransitAssignment_{} {
+      cachedTransitAssignment_{},
+      wallClock_(),
+      sntpStarted_(false),
+      rowArrivals_{},
+      commandJson_() {
   memset(&renderModel_, 0, sizeof(renderModel_));
   memset(scrollState_, 0, sizeof(scrollState_));
   clear_cached_assignment(cachedTransitAssignment_);
@@ -685,6 +732,15 @@ bool DeviceController::begin() {
 
   deps_.networkManager->set_state_callback(&DeviceController::on_network_state_change, this);
   deps_.mqttClient->set_command_callback(&DeviceController::on_mqtt_command, this);
+  telemetry_.start_window(millis());
+  if (pendingCrashReport_) {
+    // Queued before the first connect; the log ring never evicts it.
+    publish_device_log("error",
+                       "crash_reboot",
+                       "Device restarted after crash",
+                       pendingCrashReportMetadata_[0] ? pendingCrashReportMetadata_ : "{}");
+    pendingCrashReport_ = false;
+  }
   activeController_ = this;
   setup_http_routes();
   // Always start BLE so the user can re-provision even if stale credentials exist.
@@ -698,10 +754,17 @@ bool DeviceController::begin() {
   bleProvisioningStartedAtMs_ = 0;
   bleShutdownAtMs_ = 0;
   bleScanPending_ = false;
+  scheduler_.bind_current_task();
   bleProvisioner_.set_scan_callback([](void *ctx) {
     // Do NOT run the scan here — this runs in the NimBLE host task (tiny stack).
     // Set a flag and run from tick() on the main Arduino task instead.
-    static_cast<DeviceController *>(ctx)->bleScanPending_ = true;
+    DeviceController *self = static_cast<DeviceController *>(ctx);
+    self->bleScanPending_ = true;
+    self->scheduler_.wake();
+  }, this);
+  bleProvisioner_.set_credentials_callback([](const ble::BleCredentials &, void *ctx) {
+    // Credentials are picked up by tick(); just cut the loop's sleep short.
+    static_cast<DeviceController *>(ctx)->scheduler_.wake();
   }, this);
   deps_.networkManager->begin(runtimeConfig_.network);
   mqttUiGraceUntilMs_ = millis() + kMqttUiGraceMs;
@@ -725,16 +788,29 @@ bool DeviceController::begin() {
 
   deps_.layoutEngine->set_viewport(deps_.displayEngine->geometry().totalWidth,
                                    deps_.displayEngine->geometry().totalHeight);
+  offListRegion_.set_bounds(static_cast<int16_t>(deps_.displayEngine->geometry().totalWidth),
+                            static_cast<int16_t>(deps_.displayEngine->geometry().totalHeight));
+
+  appliedBrightness_ = runtimeConfig_.display.brightness;
 
   update_ui_state();
   persist_runtime_breadcrumbs(millis(), true);
-  schedule_full_render();
-  render_frame(millis());
+  request_render(RenderMode::kFull);
+  publish_render_snapshot();
+  tick_render(millis());
+#if COMMUTELIVE_RENDER_TASK
+  if (!start_render_task()) {
+    DCTRL_LOGW("DISPLAY", "Render task unavailable; rendering from the control loop");
+  }
+#endif
   DCTRL_LOGI("CORE", "Device controller begin complete deviceId=%s", runtimeConfig_.deviceId);
   return true;
 }
 
 void DeviceController::tick(uint32_t nowMs) {
+  // Sockets are polled on every wake-up; firing only records loop lateness.
+  scheduler_.fire(kDeadlineNetworkPoll, nowMs);
+
   if (bleScanPending_) {
     bleScanPending_ = false;
     wifi_manager::scan_and_emit([](const char *json, void *ctx2) {
@@ -790,8 +866,14 @@ void DeviceController::tick(uint32_t nowMs) {
       deps_.networkManager->set_credentials(creds.ssid, creds.password, creds.username, false);
     }
   }
-  deps_.networkManager->tick(nowMs);
-  deps_.mqttClient->tick(nowMs);
+  {
+    DCTRL_PROFILE_SCOPE(kNetworkTick);
+    deps_.networkManager->tick(nowMs);
+  }
+  {
+    DCTRL_PROFILE_SCOPE(kMqttTick);
+    deps_.mqttClient->tick(nowMs);
+  }
   maybe_stop_ble_after_success(nowMs);
   const bool mqttConnected = deps_.mqttClient->connected();
 
@@ -802,76 +884,54 @@ void DeviceController::tick(uint32_t nowMs) {
     mqttUiGraceUntilMs_ = nowMs + kMqttUiGraceMs;
   }
 
-  server_.handleClient();
+  {
+    DCTRL_PROFILE_SCOPE(kHttpServer);
+    server_.handleClient();
+  }
   update_ui_state();
 
   if (mqttConnected && !lastMqttConnected_) {
-    // Publish only the critical "online" log on the reconnect tick.
-    // Remaining logs are deferred to subsequent ticks so mqtt_.loop()
-    // runs between publishes and the broker isn't flooded immediately.
+    if (pendingMqttDisconnectLog_) {
+      telemetry_.count_mqtt_reconnect();
+    }
+    // The publish queue paces these out by priority and byte budget, so the
+    // whole reconnect backlog can be queued at once.
     publish_device_log("info", "mqtt_connected", "MQTT connected");
-    pendingReconnectLogs_ = true;
-  }
-  if (mqttConnected && pendingReconnectLogs_) {
-    // Drain one deferred log per tick to avoid publish storms.
     if (pendingWifiConnectedLog_) {
       publish_device_log("info", "wifi_connected", "WiFi connected");
       pendingWifiConnectedLog_ = false;
-    } else if (pendingMqttDisconnectLog_) {
+    }
+    if (pendingMqttDisconnectLog_) {
       char metadata[128];
       snprintf(metadata, sizeof(metadata),
                "{\"disconnect_duration_ms\":%lu}",
                static_cast<unsigned long>(nowMs - lastMqttDisconnectAtMs_));
       publish_device_log("warn", "mqtt_disconnected", "MQTT connection recovered after disconnect", metadata);
       pendingMqttDisconnectLog_ = false;
-    } else if (!bootLogPublished_ && pendingCrashReport_) {
-      publish_device_log("error",
-                         "crash_reboot",
-                         "Device restarted after crash",
-                         pendingCrashReportMetadata_[0] ? pendingCrashReportMetadata_ : "{}");
-      pendingCrashReport_ = false;
-    } else if (!bootLogPublished_) {
+    }
+    if (!bootLogPublished_) {
       publish_device_log("info", "boot", "Device boot completed");
       bootLogPublished_ = true;
-    } else {
-      pendingReconnectLogs_ = false;
     }
   }
   lastMqttConnected_ = mqttConnected;
 
-  if (mqttConnected) {
-    if (nowMs - lastHeartbeatAtMs_ >= kHeartbeatEveryMs) {
-      lastHeartbeatAtMs_ = nowMs;
-
-      char payload[128];
-      snprintf(payload, sizeof(payload),
-               "{\"deviceId\":\"%s\",\"uptimeMs\":%lu,\"freeHeap\":%lu}",
-               runtimeConfig_.deviceId,
-               static_cast<unsigned long>(nowMs),
-               static_cast<unsigned long>(ESP.getFreeHeap()));
-      if (!deps_.mqttClient->publish_heartbeat(payload)) {
-        publish_device_log("error", "mqtt_publish_failed", "Failed to publish heartbeat", "{\"topic\":\"heartbeat\"}");
-      }
-    }
-
-    if (nowMs - lastTelemetryAtMs_ >= kTelemetryEveryMs) {
-      lastTelemetryAtMs_ = nowMs;
-      char payload[160];
-      snprintf(payload, sizeof(payload),
-               "{\"freeHeap\":%lu,\"maxAlloc\":%lu,\"wifiRssi\":%d}",
-               static_cast<unsigned long>(ESP.getFreeHeap()),
-               static_cast<unsigned long>(ESP.getMaxAllocHeap()),
-               WiFi.RSSI());
-      if (!deps_.mqttClient->publish_telemetry(payload)) {
-        publish_device_log("error", "mqtt_publish_failed", "Failed to publish telemetry", "{\"topic\":\"telemetry\"}");
-      }
-    }
+  if (scheduler_.fire(kDeadlineTelemetrySample, nowMs)) {
+    lastTelemetrySampleAtMs_ = nowMs;
+    telemetry_.sample(ESP.getFreeHeap(),
+                      ESP.getMaxAllocHeap(),
+                      deps_.networkManager->is_connected() ? static_cast<int8_t>(WiFi.RSSI()) : 0);
+  }
 
-    if (nowMs - lastDeviceLogHeartbeatAtMs_ >= kDeviceLogHeartbeatEveryMs) {
-      lastDeviceLogHeartbeatAtMs_ = nowMs;
-      publish_device_log("info", "heartbeat", "Device heartbeat");
-    }
+  if (scheduler_.fire(kDeadlineTelemetry, nowMs)) {
+    // The render side hands over its counters on its next tick; the frame is
+    // published once they arrive.
+    lastTelemetryAtMs_ = nowMs;
+    telemetryAwaitingStats_ = true;
+    renderStatsRequested_.store(true, std::memory_order_release);
+  }
 
+  if (mqttConnected) {
     const uint32_t freeHeap = ESP.getFreeHeap();
     if (freeHeap <= kLowHeapWarningThresholdBytes &&
         nowMs - lastLowMemoryWarningAtMs_ >= kLowHeapWarningEveryMs) {
@@ -880,11 +940,56 @@ void DeviceController::tick(uint32_t nowMs) {
     }
   }
 
-  persist_runtime_breadcrumbs(nowMs);
+  if (scheduler_.fire(kDeadlineBreadcrumbs, nowMs)) {
+    persist_runtime_breadcrumbs(nowMs);
+  }
 
-  sync_stale_eta_animation(nowMs);
-  tick_scroll(nowMs);
-  render_frame(nowMs);
+  if (scheduler_.fire(kDeadlineEtaCountdown, nowMs)) {
+    tick_eta_countdown(nowMs);
+  }
+
+  publish_render_snapshot();
+  if (!renderTask_) {
+    if (!scheduler_.armed(kDeadlineRender)) {
+      scheduler_.set(kDeadlineRender, nowMs);
+    }
+    if (scheduler_.fire(kDeadlineRender, nowMs)) {
+      tick_render(nowMs);
+      scheduler_.advance(kDeadlineRender, kScrollStepMs, nowMs);
+    }
+  }
+  if (telemetryAwaitingStats_ && renderStatsHandoff_.take()) {
+    // Queued even while offline; the publish queue keeps the newest frames.
+    telemetryAwaitingStats_ = false;
+    publish_telemetry_frame(nowMs, renderStatsHandoff_.read_slot());
+  }
+
+  arm_deadlines(nowMs);
+}
+
+void DeviceController::wait_for_next_deadline() {
+  scheduler_.wait(kMaxLoopSleepMs);
+}
+
+void DeviceController::arm_periodic(uint8_t id, uint32_t lastAtMs, uint32_t periodMs, uint32_t nowMs) {
+  if (scheduler_.armed(id)) return;
+  const uint32_t dueMs = lastAtMs + periodMs;
+  scheduler_.set(id, static_cast<int32_t>(dueMs - nowMs) > 0 ? dueMs : nowMs);
+}
+
+void DeviceController::arm_deadlines(uint32_t nowMs) {
+  scheduler_.set(kDeadlineNetworkPoll, nowMs + kNetworkPollEveryMs);
+  arm_periodic(kDeadlineBreadcrumbs, lastBreadcrumbPersistAtMs_, kCrashBreadcrumbPersistEveryMs, nowMs);
+  arm_periodic(kDeadlineTelemetrySample, lastTelemetrySampleAtMs_, TelemetryAggregator::kSampleEveryMs, nowMs);
+  arm_periodic(kDeadlineTelemetry, lastTelemetryAtMs_, telemetry_.interval_ms(), nowMs);
+
+  if (!scheduler_.armed(kDeadlineEtaCountdown) && renderModel_.hasData && wallClock_.valid()) {
+    const uint32_t untilChangeMs =
+        next_countdown_change_ms(rowArrivals_, renderModel_.activeRows, wallClock_.epoch_ms(nowMs));
+    if (untilChangeMs > 0) {
+      scheduler_.set(kDeadlineEtaCountdown, nowMs + untilChangeMs);
+    }
+  }
 }
 
 void DeviceController::on_network_state_change(NetworkState state, void *ctx) {
@@ -932,8 +1037,14 @@ void DeviceController::handle_network_state(NetworkState state) {
              core::logging::bool_str(deps_.networkManager->setup_mode_active()));
   if (state == NetworkState::kConnected) {
     mqttUiGraceUntilMs_ = millis() + kMqttUiGraceMs;
+    if (!sntpStarted_) {
+      // UTC only: countdowns compare Unix times and never format local time.
+      configTime(0, 0, kNtpServerPrimary, kNtpServerSecondary);
+      sntpStarted_ = true;
+    }
     pendingWifiConnectedLog_ = true;
     if (pendingWifiDisconnectLog_) {
+      telemetry_.count_wifi_reconnect();
       char metadata[160];
       snprintf(metadata, sizeof(metadata),
                "{\"disconnect_duration_ms\":%lu}",
@@ -1132,6 +1243,7 @@ bool DeviceController::call_provision_api(const char *serverUrl, const char *dev
 }
 
 void DeviceController::handle_command(const char *topic, const uint8_t *payload, size_t len) {
+  DCTRL_PROFILE_SCOPE(kHandleCommand);
   if (!payload || len == 0 || len > kMaxPayloadLen) {
     DCTRL_LOGW("MQTT", "Ignoring incoming command topic=%s payloadLen=%u maxPayloadLen=%u",
                core::logging::safe_str(topic),
@@ -1140,103 +1252,123 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
     return;
   }
 
-  char messageBuf[kMaxPayloadLen + 1];
-  memcpy(messageBuf, payload, len);
-  messageBuf[len] = '\0';
-  const String message(messageBuf);
-  const uint8_t brightnessPercent = parse_brightness_percent(message, kBrightnessFallbackPercent);
-  const uint8_t panelBrightness = brightness_percent_to_panel(brightnessPercent);
   DCTRL_LOGI("MQTT", "Incoming command topic=%s len=%u", core::logging::safe_str(topic), static_cast<unsigned>(len));
-  DCTRL_LOGI("MQTT", "Incoming payload=%s", message.c_str());
+  const bool binaryPatch = parsing::is_binary_patch(payload, len);
+  const bool binary = binaryPatch || parsing::is_binary_payload(payload, len);
+  if (binary) {
+    DCTRL_LOGI("MQTT", "Incoming binary payload version=%u", static_cast<unsigned>(payload[0]));
+  } else {
+    DCTRL_LOGI("MQTT", "Incoming payload=%.*s", static_cast<int>(len), reinterpret_cast<const char *>(payload));
+  }
+
+  if (binaryPatch) {
+    handle_patch_command(payload, len, commandJson_);
+    return;
+  }
+
+  // Index JSON payloads in place; every field lookup below reads this index.
+  // Binary payloads carry only transit data and are decoded straight from the bytes.
+  parsing::JsonIndex &json = commandJson_;
+  parsing::BinaryPayloadHeader binaryHeader{};
+  const bool wellFormed = binary ? parsing::read_binary_header(payload, len, binaryHeader)
+                                 : json.parse(payload, len) && json.token(json.root()).type == parsing::JsonType::kObject;
+  if (!wellFormed) {
+    DCTRL_LOGW("MQTT", "Ignoring malformed command topic=%s len=%u",
+               core::logging::safe_str(topic),
+               static_cast<unsigned>(len));
+    return;
+  }
 
-  String cmdType = extract_json_string_field(message, "type");
+  const uint8_t brightnessPercent =
+      binary ? clamp_brightness_percent(binaryHeader.hasBrightness ? binaryHeader.brightness : kBrightnessFallbackPercent)
+             : parse_brightness_percent(json, kBrightnessFallbackPercent);
+  const uint8_t panelBrightness = brightness_percent_to_panel(brightnessPercent);
+
+  char cmdType[32];
+  cmdType[0] = '\0';
+  if (!binary) {
+    json.copy_string(json.find(json.root(), "type"), cmdType, sizeof(cmdType));
+  }
   DCTRL_LOGI("MQTT", "Parsed command type=%s brightness=%u%% panel=%u",
-             cmdType.length() ? cmdType.c_str() : "(data)",
+             cmdType[0] ? cmdType : "(data)",
              static_cast<unsigned>(brightnessPercent),
              static_cast<unsigned>(panelBrightness));
-  if (cmdType == "ota_update") {
-    String url = extract_json_string_field(message, "url");
-    if (url.length() > 0) {
-      DCTRL_LOGI("OTA", "Received OTA update request url=%s", url.c_str());
-      perform_ota_update(url);
+  if (strcmp(cmdType, "ota_update") == 0) {
+    // Sized for the whole command so no URL the broker can deliver is cut short.
+    char url[kMaxPayloadLen + 1];
+    if (json.copy_string(json.find(json.root(), "url"), url, sizeof(url)) > 0) {
+      DCTRL_LOGI("OTA", "Received OTA update request url=%s", url);
+      perform_ota_update(String(url));
     }
     return;
   }
 
-  if (cmdType == "factory_reset") {
+  if (strcmp(cmdType, "factory_reset") == 0) {
     DCTRL_LOGW("CMD", "Factory reset requested; clearing credentials and restarting");
     deps_.mqttClient->disconnect(true);
     clear_cached_transit_assignment();
     wifi_manager::clear_credentials();
+    core::logging::flush();
     delay(500);
     ESP.restart();
     return;
   }
 
-  if (cmdType == "disconnect_wifi" || cmdType == "unpair") {
-    handle_disconnect_wifi_command(message);
+  if (strcmp(cmdType, "disconnect_wifi") == 0 || strcmp(cmdType, "unpair") == 0) {
+    handle_disconnect_wifi_command(json);
     return;
   }
 
-  if (cmdType == "display_blank") {
-    handle_display_blank_command(message, brightnessPercent, panelBrightness);
+  if (strcmp(cmdType, "display_blank") == 0) {
+    handle_display_blank_command(json, brightnessPercent, panelBrightness);
     return;
   }
 
-  parsing::ProviderPayload parsed{};
-  if (!parsing::parse_transit_payload(message, parsed) || !parsed.hasRow1) {
-    DCTRL_LOGW("MQTT", "Ignoring payload because parser returned no row data");
+  if (strcmp(cmdType, "patch") == 0) {
+    handle_patch_command(payload, len, json);
+    return;
+  }
+
+  if (strcmp(cmdType, "telemetry_interval") == 0) {
+    handle_telemetry_interval_command(json);
+    return;
+  }
+
+  if (strcmp(cmdType, "profile") == 0) {
+    handle_profile_command(json);
     return;
   }
 
   RenderModel nextModel = renderModel_;
+  uint8_t parsedRows = 0;
+  if (!parsing::parse_transit_payload(payload, len, json, nextModel.rows, kMaxVisibleTransitRows, parsedRows)) {
+    DCTRL_LOGW("MQTT", "Ignoring payload because parser returned no row data");
+    return;
+  }
+
+  nextModel.activeRows = parsedRows;
+  for (uint8_t i = parsedRows; i < kMaxTransitRows; ++i) {
+    clear_row(nextModel.rows[i]);
+  }
+
+  // Rows that carry arrival times count down on the device; their server ETAs
+  // are only used until the wall clock is known.
+  RowArrivals nextArrivals[kMaxTransitRows] = {};
+  uint32_t serverTimeSec = 0;
+  parsing::parse_transit_arrivals(payload, len, json, nextArrivals, parsedRows, serverTimeSec);
+  if (serverTimeSec != 0) {
+    wallClock_.sync(WallClock::Source::kServer, static_cast<uint64_t>(serverTimeSec) * 1000, millis());
+  }
+  sync_wall_clock(millis());
+  apply_countdown_rows(nextArrivals, wallClock_, millis(), nextModel.rows, parsedRows);
+
   CachedTransitAssignment nextCachedAssignment{};
   clear_cached_assignment(nextCachedAssignment);
-
-  // Row 0
-  copy_str(nextModel.rows[0].destination, sizeof(nextModel.rows[0].destination),
-           parsed.row1.label.length() ? parsed.row1.label.c_str() : "--");
-  normalize_eta(parsed.row1.eta, nextModel.rows[0].eta, sizeof(nextModel.rows[0].eta));
-  copy_str(nextModel.rows[0].etaExtra, sizeof(nextModel.rows[0].etaExtra),
-           parsed.row1EtaExtra.length() ? parsed.row1EtaExtra.c_str() : "");
-  nextModel.rows[0].displayType = nextModel.rows[0].etaExtra[0] != '\0' ? 4 : 1;
-  nextModel.rows[0].scrollEnabled = parsed.row1.scrollEnabled;
-  nextModel.rows[0].delayed = parsed.row1.delayed;
-  nextModel.rows[0].badgeShape = parsed.row1.badgeShape;
-  nextModel.rows[0].badgeColor = parsed.row1.badgeColor;
-  memcpy(nextModel.rows[0].badgeText, parsed.row1.badgeText, sizeof(nextModel.rows[0].badgeText));
-  copy_str(nextCachedAssignment.rows[0].destination, sizeof(nextCachedAssignment.rows[0].destination),
-           nextModel.rows[0].destination);
-  nextCachedAssignment.rows[0].scrollEnabled = nextModel.rows[0].scrollEnabled;
-
-  if (parsed.hasRow2) {
-    // Row 1
-    copy_str(nextModel.rows[1].destination, sizeof(nextModel.rows[1].destination),
-             parsed.row2.label.length() ? parsed.row2.label.c_str() : "--");
-    normalize_eta(parsed.row2.eta, nextModel.rows[1].eta, sizeof(nextModel.rows[1].eta));
-    copy_str(nextModel.rows[1].etaExtra, sizeof(nextModel.rows[1].etaExtra),
-             parsed.row2EtaExtra.length() ? parsed.row2EtaExtra.c_str() : "");
-    nextModel.rows[1].displayType = nextModel.rows[1].etaExtra[0] != '\0' ? 4 : 1;
-    nextModel.rows[1].scrollEnabled = parsed.row2.scrollEnabled;
-    nextModel.rows[1].delayed = parsed.row2.delayed;
-    nextModel.rows[1].badgeShape = parsed.row2.badgeShape;
-    nextModel.rows[1].badgeColor = parsed.row2.badgeColor;
-    memcpy(nextModel.rows[1].badgeText, parsed.row2.badgeText, sizeof(nextModel.rows[1].badgeText));
-    copy_str(nextCachedAssignment.rows[1].destination, sizeof(nextCachedAssignment.rows[1].destination),
-             nextModel.rows[1].destination);
-    nextCachedAssignment.rows[1].scrollEnabled = nextModel.rows[1].scrollEnabled;
-
-    nextModel.activeRows = 2;
-    nextCachedAssignment.activeRows = 2;
-    for (uint8_t i = 2; i < kMaxTransitRows; ++i) {
-      clear_row(nextModel.rows[i]);
-    }
-  } else {
-    nextModel.activeRows = 1;
-    nextCachedAssignment.activeRows = 1;
-    for (uint8_t i = 1; i < kMaxTransitRows; ++i) {
-      clear_row(nextModel.rows[i]);
-    }
+  nextCachedAssignment.activeRows = parsedRows;
+  for (uint8_t i = 0; i < parsedRows; ++i) {
+    copy_str(nextCachedAssignment.rows[i].destination, sizeof(nextCachedAssignment.rows[i].destination),
+             nextModel.rows[i].destination);
+    nextCachedAssignment.rows[i].scrollEnabled = nextModel.rows[i].scrollEnabled;
   }
 
   sanitize_cached_assignment(nextCachedAssignment);
@@ -1251,7 +1383,7 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
 
   uint8_t etaDirtyRows = 0;
   const RenderMode nextRenderMode =
-      classify_render_mode(renderModel_, nextModel, runtimeConfig_.display.doubleBuffered, etaDirtyRows);
+      classify_render_mode(renderModel_, nextModel, !deps_.displayEngine->partial_present(), etaDirtyRows);
 
   // Reset scroll state when destination text or per-row scroll setting changes
   bool anyScrollReset = false;
@@ -1259,7 +1391,7 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
   for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
     if (renderModel_.rows[i].scrollEnabled != nextModel.rows[i].scrollEnabled ||
         strcmp(renderModel_.rows[i].destination, nextModel.rows[i].destination) != 0) {
-      reset_scroll_state(i);
+      request_scroll_reset(i);
       anyScrollReset = true;
       // Track if scroll is being turned off so we can force a full redraw to clear
       // any frozen mid-scroll position. When turning ON, the scroll renderer handles
@@ -1271,18 +1403,19 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
   }
 
   renderModel_ = nextModel;
+  memcpy(rowArrivals_, nextArrivals, sizeof(rowArrivals_));
+  scheduler_.clear(kDeadlineEtaCountdown);
   hasFreshPayload_ = true;
 
   if (anyScrollReset && scrollTurnedOff) {
-    schedule_full_render();
+    request_render(RenderMode::kFull);
   }
 
   runtimeConfig_.display.brightness = panelBrightness;
-  deps_.displayEngine->set_brightness(panelBrightness);
 
   switch (nextRenderMode) {
     case RenderMode::kNone:
-      schedule_no_render();
+      request_render(RenderMode::kNone);
       if (core::logging::is_dev_build()) {
         DCTRL_LOGI("MQTT", "Applied payload without render change activeRows=%u displayType=%u brightness=%u%% panel=%u",
                    static_cast<unsigned>(renderModel_.activeRows),
@@ -1292,7 +1425,7 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
       }
       break;
     case RenderMode::kEtaOnly:
-      schedule_eta_render(etaDirtyRows);
+      request_render(RenderMode::kEtaOnly, etaDirtyRows);
       if (core::logging::is_dev_build()) {
         DCTRL_LOGI("MQTT",
                    "Applied payload with ETA-only render rowsMask=0x%02x activeRows=%u displayType=%u brightness=%u%% panel=%u",
@@ -1303,9 +1436,19 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
                    static_cast<unsigned>(panelBrightness));
       }
       break;
+    case RenderMode::kMinimal:
+      request_render(RenderMode::kMinimal);
+      if (core::logging::is_dev_build()) {
+        DCTRL_LOGI("MQTT", "Applied payload with minimal render activeRows=%u displayType=%u brightness=%u%% panel=%u",
+                   static_cast<unsigned>(renderModel_.activeRows),
+                   static_cast<unsigned>(renderModel_.displayType),
+                   static_cast<unsigned>(brightnessPercent),
+                   static_cast<unsigned>(panelBrightness));
+      }
+      break;
     case RenderMode::kFull:
     default:
-      schedule_full_render();
+      request_render(RenderMode::kFull);
       if (core::logging::is_dev_build()) {
         DCTRL_LOGI("MQTT", "Applied payload with full render activeRows=%u displayType=%u brightness=%u%% panel=%u",
                    static_cast<unsigned>(renderModel_.activeRows),
@@ -1334,13 +1477,15 @@ void DeviceController::handle_command(const char *topic, const uint8_t *payload,
   publish_display_state();
 }
 
-void DeviceController::handle_display_blank_command(const String &message,
+void DeviceController::handle_display_blank_command(const parsing::JsonIndex &json,
                                                     uint8_t brightnessPercent,
                                                     uint8_t panelBrightness) {
-  const String reason = extract_json_string_field(message, "reason");
+  char reason[48];
+  json.copy_string(json.find(json.root(), "reason"), reason, sizeof(reason));
 
   clear_cached_transit_assignment();
   hasFreshPayload_ = false;
+  memset(rowArrivals_, 0, sizeof(rowArrivals_));
   renderModel_.hasData = false;
   renderModel_.uiState = UiState::kBlank;
   renderModel_.displayType = kMinDisplayType;
@@ -1350,39 +1495,211 @@ void DeviceController::handle_display_blank_command(const String &message,
   copy_str(renderModel_.statusDetail, sizeof(renderModel_.statusDetail), "");
   for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
     clear_row(renderModel_.rows[i]);
-    reset_scroll_state(i);
+    request_scroll_reset(i);
   }
 
   runtimeConfig_.display.brightness = panelBrightness;
-  deps_.displayEngine->set_brightness(panelBrightness);
 
-  schedule_full_render();
+  request_render(RenderMode::kFull);
   DCTRL_LOGI("MQTT",
              "Applied display blank reason=%s brightness=%u%% panel=%u",
-             reason.length() ? reason.c_str() : "(none)",
+             reason[0] ? reason : "(none)",
              static_cast<unsigned>(brightnessPercent),
              static_cast<unsigned>(panelBrightness));
   publish_display_state();
 }
 
-void DeviceController::handle_disconnect_wifi_command(const String &message) {
-  const String cmdType = extract_json_string_field(message, "type");
-  const String reason = extract_json_string_field(message, "reason");
-  bool clearCredentials = extract_json_bool_field(message, "clearCredentials", false);
-  bool restartProvisioning = extract_json_bool_field(message, "restartProvisioning", false);
-  const bool isUnpairRequest = cmdType == "unpair" || reason == "unpair" || reason == "unpaired";
+void DeviceController::handle_telemetry_interval_command(const parsing::JsonIndex &json) {
+  const int seconds = json.to_int(json.find(json.root(), "seconds"), 0);
+  if (seconds <= 0 || !telemetry_.set_interval_ms(static_cast<uint32_t>(seconds) * 1000U)) {
+    DCTRL_LOGW("MQTT", "Ignoring telemetry interval seconds=%d allowed=%lu..%lu",
+               seconds,
+               static_cast<unsigned long>(TelemetryAggregator::kMinIntervalMs / 1000U),
+               static_cast<unsigned long>(TelemetryAggregator::kMaxIntervalMs / 1000U));
+    return;
+  }
+  // Re-armed from the last frame with the new period on this tick.
+  scheduler_.clear(kDeadlineTelemetry);
+  DCTRL_LOGI("MQTT", "Telemetry interval set to %ds", seconds);
+}
+
+// {"type":"profile"} publishes the hot-path timing summary on the event
+// topic; "reset":true clears it as it is read so the next request covers a
+// fresh window.
+void DeviceController::handle_profile_command(const parsing::JsonIndex &json) {
+  const bool reset = json.to_bool(json.find(json.root(), "reset"), false);
+  char summary[1024];
+  const size_t len = profiler::format_summary(summary, sizeof(summary), reset);
+  if (len == 0) {
+    DCTRL_LOGW("MQTT", "Profile summary did not fit in %u bytes", static_cast<unsigned>(sizeof(summary)));
+  } else if (!deps_.mqttClient->publish_event(summary)) {
+    DCTRL_LOGW("MQTT", "Profile summary was not queued len=%u", static_cast<unsigned>(len));
+  }
+}
+
+void DeviceController::publish_telemetry_frame(uint32_t nowMs, const RenderStats &render) {
+  const PublishQueue &queue = deps_.mqttClient->publish_queue();
+  const LatenessHistogram &loopLate = scheduler_.lateness();
+  TelemetryCounters counters{};
+  counters.uptimeMs = nowMs;
+  counters.frames = render.frames.frames;
+  counters.dirtyPixels = render.frames.dirtyPixels;
+  counters.copiedPixels = render.frames.copiedPixels;
+  counters.skippedRows = render.frames.skippedRows;
+  memcpy(counters.renders, render.renders, sizeof(counters.renders));
+  counters.geomHits = render.geomHits;
+  counters.geomMisses = render.geomMisses;
+  counters.loopWakes = scheduler_.wakeups();
+  counters.eventWakes = scheduler_.event_wakeups();
+  const uint8_t kPercentiles[3] = {50, 90, 99};
+  for (uint8_t i = 0; i < 3; ++i) {
+    counters.loopLateMs[i] = loopLate.percentile_ms(kPercentiles[i]);
+    counters.renderLateMs[i] = render.lateness.percentile_ms(kPercentiles[i]);
+  }
+  counters.loopLateMs[3] = loopLate.maxMs;
+  counters.renderLateMs[3] = render.lateness.maxMs;
+  counters.pubPending = queue.pending();
+  counters.pubDropped = queue.dropped();
+  counters.pubCoalesced = queue.coalesced();
+
+  char payload[512];
+  const size_t len = telemetry_.take_frame(counters, nowMs, payload, sizeof(payload));
+  scheduler_.reset_stats();
+  if (len == 0) {
+    DCTRL_LOGE("MQTT", "Telemetry frame exceeded buffer");
+    return;
+  }
+  if (!deps_.mqttClient->publish_telemetry(payload)) {
+    DCTRL_LOGW("MQTT", "Telemetry frame dropped by publish queue");
+  }
+}
+
+// Patches carry only ETA changes for rows already on screen, so they are
+// applied in place and the touched rows go straight to an ETA-only render
+// without re-parsing or re-classifying the whole model.
+void DeviceController::handle_patch_command(const uint8_t *payload, size_t len, const parsing::JsonIndex &json) {
+  if (!renderModel_.hasData || renderModel_.uiState != UiState::kTransit) {
+    DCTRL_LOGW("MQTT", "Ignoring patch because no transit rows are on screen");
+    return;
+  }
+
+  TransitRowModel rows[kMaxTransitRows];
+  memcpy(rows, renderModel_.rows, sizeof(rows));
+  uint8_t patchedRows = 0;
+  if (!parsing::apply_transit_patch(payload, len, json, rows, renderModel_.activeRows, patchedRows)) {
+    DCTRL_LOGW("MQTT", "Ignoring malformed patch len=%u activeRows=%u",
+               static_cast<unsigned>(len),
+               static_cast<unsigned>(renderModel_.activeRows));
+    return;
+  }
+
+  // Patched rows follow the server again rather than a device-side countdown.
+  for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
+    if ((patchedRows & static_cast<uint8_t>(1U << i)) != 0) {
+      rowArrivals_[i].enabled = false;
+    }
+  }
+
+  renderModel_.updatedAtMs = millis();
+  hasFreshPayload_ = true;
+  if (!commit_eta_rows(rows, patchedRows)) {
+    return;
+  }
+  if (core::logging::is_dev_build()) {
+    DCTRL_LOGI("MQTT", "Applied patch patchedMask=0x%02x activeRows=%u",
+               static_cast<unsigned>(patchedRows),
+               static_cast<unsigned>(renderModel_.activeRows));
+  }
+  publish_display_state();
+}
+
+// Copies the ETA fields of the rows in rowMask into renderModel_ and requests
+// the narrowest render covering them. Adding or dropping extra ETAs flips a
+// row between the normal and stacked layouts, which needs a layout repaint
+// rather than ETA-only. Returns false if nothing visible changed.
+bool DeviceController::commit_eta_rows(const TransitRowModel *rows, uint8_t rowMask) {
+  uint8_t etaDirtyRows = 0;
+  bool layoutChanged = false;
+  for (uint8_t i = 0; i < renderModel_.activeRows; ++i) {
+    if ((rowMask & static_cast<uint8_t>(1U << i)) == 0) {
+      continue;
+    }
+    if (!row_layout_fields_equal(renderModel_.rows[i], rows[i])) {
+      layoutChanged = true;
+    } else if (!row_eta_fields_equal(renderModel_.rows[i], rows[i])) {
+      etaDirtyRows |= static_cast<uint8_t>(1U << i);
+    } else {
+      continue;
+    }
+    renderModel_.rows[i] = rows[i];
+  }
+
+  if (!layoutChanged && etaDirtyRows == 0) {
+    request_render(RenderMode::kNone);
+    return false;
+  }
+  if (!deps_.displayEngine->partial_present()) {
+    request_render(RenderMode::kFull);
+  } else if (layoutChanged) {
+    request_render(RenderMode::kMinimal);
+  } else {
+    request_render(RenderMode::kEtaOnly, etaDirtyRows);
+  }
+  return true;
+}
+
+void DeviceController::sync_wall_clock(uint32_t nowMs) {
+  if (!sntpStarted_) {
+    return;
+  }
+  struct timeval tv;
+  if (gettimeofday(&tv, nullptr) == 0 && tv.tv_sec >= kMinValidEpochSec) {
+    wallClock_.sync(WallClock::Source::kSntp,
+                    static_cast<uint64_t>(tv.tv_sec) * 1000 + static_cast<uint64_t>(tv.tv_usec / 1000),
+                    nowMs);
+  }
+}
+
+// Fired when the soonest countdown minute rolls over; arm_deadlines() then
+// re-arms for the next one.
+void DeviceController::tick_eta_countdown(uint32_t nowMs) {
+  if (!renderModel_.hasData) {
+    return;
+  }
+  sync_wall_clock(nowMs);
+  TransitRowModel rows[kMaxTransitRows];
+  memcpy(rows, renderModel_.rows, sizeof(rows));
+  const uint8_t counted = apply_countdown_rows(rowArrivals_, wallClock_, nowMs, rows, renderModel_.activeRows);
+  if (counted != 0 && commit_eta_rows(rows, counted) && core::logging::is_dev_build()) {
+    DCTRL_LOGI("CORE", "Applied device-side ETA countdown rowsMask=0x%02x row1=%s row2=%s",
+               static_cast<unsigned>(counted),
+               renderModel_.rows[0].eta,
+               renderModel_.rows[1].eta);
+  }
+}
+
+void DeviceController::handle_disconnect_wifi_command(const parsing::JsonIndex &json) {
+  const int root = json.root();
+  char reason[48];
+  json.copy_string(json.find(root, "reason"), reason, sizeof(reason));
+  const int clearField = json.find(root, "clearCredentials");
+  const int restartField = json.find(root, "restartProvisioning");
+  bool clearCredentials = json.to_bool(clearField, false);
+  bool restartProvisioning = json.to_bool(restartField, false);
+  const bool isUnpairRequest = json.equals(json.find(root, "type"), "unpair") || strcmp(reason, "unpair") == 0 ||
+                               strcmp(reason, "unpaired") == 0;
 
   if (isUnpairRequest) {
-    if (!has_json_field(message, "clearCredentials")) {
+    if (clearField == parsing::JsonIndex::kNone) {
       clearCredentials = true;
     }
-    if (!has_json_field(message, "restartProvisioning")) {
+    if (restartField == parsing::JsonIndex::kNone) {
       restartProvisioning = true;
     }
   }
 
   Serial.printf("[CMD] Disconnect WiFi requested reason=%s clearCredentials=%s restartProvisioning=%s\n",
-                reason.length() ? reason.c_str() : "(none)",
+                reason[0] ? reason : "(none)",
                 clearCredentials ? "true" : "false",
                 restartProvisioning ? "true" : "false");
 
@@ -1407,7 +1724,7 @@ void DeviceController::handle_disconnect_wifi_command(const String &message) {
   renderModel_.hasData = false;
   set_default_rows(renderModel_);
   update_ui_state();
-  schedule_full_render();
+  request_render(RenderMode::kFull);
 }
 
 void DeviceController::setup_http_routes() {
@@ -1477,14 +1794,159 @@ void DeviceController::http_status_handler() {
   activeController_->server_.send(200, "application/json", response);
 }
 
+void DeviceController::request_render(RenderMode mode, uint8_t etaRows) {
+  renderRequest_.pending = true;
+  if (render_mode_rank(mode) > render_mode_rank(renderRequest_.mode)) {
+    renderRequest_.mode = mode;
+  }
+  renderRequest_.etaRows = static_cast<uint8_t>(renderRequest_.etaRows | etaRows);
+}
+
+void DeviceController::request_scroll_reset(uint8_t rowIndex) {
+  if (rowIndex >= kMaxTransitRows) return;
+  renderRequest_.pending = true;
+  renderRequest_.scrollResetRows = static_cast<uint8_t>(renderRequest_.scrollResetRows | (1U << rowIndex));
+}
+
+// Hands the control-side model to the render side. Requests the render side
+// has not adopted yet are carried forward, because a newer snapshot replaces
+// an untaken one wholesale.
+void DeviceController::publish_render_snapshot() {
+  if (!renderRequest_.pending) {
+    return;
+  }
+  if (adoptedSnapshotSeq_.load(std::memory_order_acquire) == publishedSnapshotSeq_) {
+    publishedRequest_ = {};
+  }
+  publishedRequest_.pending = true;
+  if (render_mode_rank(renderRequest_.mode) > render_mode_rank(publishedRequest_.mode)) {
+    publishedRequest_.mode = renderRequest_.mode;
+  }
+  publishedRequest_.etaRows = static_cast<uint8_t>(publishedRequest_.etaRows | renderRequest_.etaRows);
+  publishedRequest_.scrollResetRows =
+      static_cast<uint8_t>(publishedRequest_.scrollResetRows | renderRequest_.scrollResetRows);
+  renderRequest_ = {};
+
+  RenderSnapshot &snapshot = renderHandoff_.write_slot();
+  snapshot.seq = ++publishedSnapshotSeq_;
+  snapshot.model = renderModel_;
+  snapshot.request = publishedRequest_;
+  snapshot.brightness = runtimeConfig_.display.brightness;
+  renderHandoff_.publish();
+}
+
+void DeviceController::adopt_render_snapshot(const RenderSnapshot &snapshot, uint32_t nowMs) {
+  frameModel_ = snapshot.model;
+  for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
+    if ((snapshot.request.scrollResetRows & static_cast<uint8_t>(1U << i)) != 0) {
+      reset_scroll_state(i);
+    }
+  }
+
+  if (snapshot.brightness != appliedBrightness_) {
+    appliedBrightness_ = snapshot.brightness;
+    deps_.displayEngine->set_brightness(appliedBrightness_);
+  }
+
+  switch (snapshot.request.mode) {
+    case RenderMode::kFull:
+      schedule_full_render();
+      break;
+    case RenderMode::kMinimal:
+      schedule_minimal_render();
+      break;
+    case RenderMode::kEtaOnly:
+      schedule_eta_render(snapshot.request.etaRows);
+      break;
+    case RenderMode::kNone:
+    default:
+      schedule_no_render();
+      break;
+  }
+
+  // The control-side model carries real ETAs; put the placeholder dots back.
+  if (frameModel_.uiState == UiState::kStaleTransit) {
+    sync_stale_eta_animation(nowMs, true);
+  }
+  adoptedSnapshotSeq_.store(snapshot.seq, std::memory_order_release);
+}
+
+void DeviceController::tick_render(uint32_t nowMs) {
+  if (renderHandoff_.take()) {
+    adopt_render_snapshot(renderHandoff_.read_slot(), nowMs);
+  }
+  sync_stale_eta_animation(nowMs);
+  tick_scroll(nowMs);
+  render_frame(nowMs);
+  if (renderStatsRequested_.exchange(false, std::memory_order_acq_rel)) {
+    hand_over_render_stats();
+  }
+}
+
+// Render side: copies out the counters the telemetry frame reports and starts
+// a new window for them.
+void DeviceController::hand_over_render_stats() {
+  RenderStats &stats = renderStatsHandoff_.write_slot();
+  stats.frames = deps_.displayEngine->frame_stats();
+  memcpy(stats.renders, renderCounts_, sizeof(stats.renders));
+  stats.geomHits = deps_.layoutEngine->geometry_cache_hits();
+  stats.geomMisses = deps_.layoutEngine->geometry_cache_misses();
+  stats.lateness = renderLateness_;
+  renderStatsHandoff_.publish();
+
+  deps_.displayEngine->reset_frame_stats();
+  deps_.layoutEngine->reset_geometry_cache_stats();
+  renderLateness_.reset();
+  memset(renderCounts_, 0, sizeof(renderCounts_));
+}
+
+bool DeviceController::start_render_task() {
+  const BaseType_t created = xTaskCreatePinnedToCore(&DeviceController::render_task_entry,
+                                                     "render",
+                                                     kRenderTaskStackBytes,
+                                                     this,
+                                                     kRenderTaskPriority,
+                                                     &renderTask_,
+                                                     kRenderTaskCore);
+  if (created != pdPASS) {
+    renderTask_ = nullptr;
+    return false;
+  }
+  DCTRL_LOGI("DISPLAY", "Render task started core=%d periodMs=%lu",
+             static_cast<int>(kRenderTaskCore),
+             static_cast<unsigned long>(kScrollStepMs));
+  return true;
+}
+
+// Runs the render pipeline on a fixed cadence so scrolling keeps moving while
+// the control loop is blocked in network or flash work.
+void DeviceController::render_task_entry(void *ctx) {
+  DeviceController *self = static_cast<DeviceController *>(ctx);
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    self->tick_render(millis());
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kScrollStepMs));
+    self->renderLateness_.record(static_cast<uint32_t>(xTaskGetTickCount() - lastWake) * portTICK_PERIOD_MS);
+  }
+}
+
 void DeviceController::schedule_full_render() {
   renderDirty_ = true;
   pendingRenderMode_ = RenderMode::kFull;
   etaDirtyRowMask_ = 0;
 }
 
+void DeviceController::schedule_minimal_render() {
+  if (pendingRenderMode_ == RenderMode::kFull) {
+    return;
+  }
+  renderDirty_ = true;
+  pendingRenderMode_ = RenderMode::kMinimal;
+  etaDirtyRowMask_ = 0;
+}
+
 void DeviceController::schedule_eta_render(uint8_t rowMask) {
-  if (rowMask == 0 || pendingRenderMode_ == RenderMode::kFull) {
+  if (rowMask == 0 || pendingRenderMode_ == RenderMode::kFull || pendingRenderMode_ == RenderMode::kMinimal) {
     return;
   }
   renderDirty_ = true;
@@ -1494,7 +1956,8 @@ void DeviceController::schedule_eta_render(uint8_t rowMask) {
 
 void DeviceController::schedule_scroll_render() {
   // Only upgrade to scroll render if no higher-priority render is pending
-  if (pendingRenderMode_ == RenderMode::kFull || pendingRenderMode_ == RenderMode::kEtaOnly) {
+  if (pendingRenderMode_ == RenderMode::kFull || pendingRenderMode_ == RenderMode::kMinimal ||
+      pendingRenderMode_ == RenderMode::kEtaOnly) {
     return;
   }
   renderDirty_ = true;
@@ -1509,10 +1972,37 @@ void DeviceController::reset_scroll_state(uint8_t rowIndex) {
   scrollState_[rowIndex].pauseUntilMs = 0;
   scrollState_[rowIndex].resetPending = false;
   scrollState_[rowIndex].active = false;
+  scrollStrips_[rowIndex].invalidate();
+}
+
+// The destination width depends on the ETA's length, so the blit window is
+// refreshed from the current geometry whenever the row is laid out again.
+// Returns false when the row has to be redrawn in full instead.
+bool DeviceController::update_scroll_window(uint8_t rowIndex, const TransitRowGeometry &geom) {
+  if (rowIndex >= kMaxTransitRows) return true;
+  RowScrollState &s = scrollState_[rowIndex];
+  s.clipX = geom.destinationX;
+  s.clipY = geom.destinationY;
+  s.budgetWidth = scroll_clip_width(geom);
+  if (s.textPixelWidth == 0) return true;  // not measured yet; tick_scroll() decides
+
+  if ((s.textPixelWidth > s.budgetWidth) != s.active) {
+    // The row switches between static and scrolling: redraw it and let the
+    // next tick measure it against the new window.
+    reset_scroll_state(rowIndex);
+    schedule_full_render();
+    return false;
+  }
+  const int16_t minOffset = static_cast<int16_t>(s.budgetWidth - s.textPixelWidth);
+  if (s.active && s.offset < minOffset) {
+    s.offset = minOffset;
+  }
+  return true;
 }
 
 void DeviceController::tick_scroll(uint32_t nowMs) {
-  if (renderModel_.uiState != UiState::kTransit) return;
+  DCTRL_PROFILE_SCOPE(kTickScroll);
+  if (frameModel_.uiState != UiState::kTransit) return;
 
   bool anyActive = false;
   bool scrollActivationChanged = false;
@@ -1521,29 +2011,33 @@ void DeviceController::tick_scroll(uint32_t nowMs) {
   int8_t masterRowIndex = -1;
   int16_t maxOverflowPx = -1;
 
-  for (uint8_t i = 0; i < renderModel_.activeRows; ++i) {
-    if (!renderModel_.rows[i].scrollEnabled) continue;
+  for (uint8_t i = 0; i < frameModel_.activeRows; ++i) {
+    if (!frameModel_.rows[i].scrollEnabled) continue;
     RowScrollState &s = scrollState_[i];
 
     // Measure text width on first tick for this row
     if (s.textPixelWidth == 0) {
       TransitRowGeometry geom{};
-      if (!deps_.layoutEngine->compute_transit_row_geometry(renderModel_, i, geom)) continue;
-      const char *text = renderModel_.rows[i].destination;
-      // Measure width using the same spacing as the scroll renderer:
-      // charW (6px) per non-space, spaceW (charW-2 = 4px) per space.
-      const int16_t charW = static_cast<int16_t>(6 * geom.destinationFont);
+      if (!deps_.layoutEngine->compute_transit_row_geometry(frameModel_, i, geom)) continue;
+      const char *text = frameModel_.rows[i].destination;
+      // Same spacing as the scroll strip: font advance per glyph, spaceW
+      // (advance - 2) per space, ending at the last glyph's inked edge.
+      const int16_t charW = display::font_advance('0', geom.destinationFont);
       const int16_t spaceW = static_cast<int16_t>(charW > 2 ? charW - 2 : 1);
-      int16_t measuredW = 0;
-      for (const char *p = text; *p; ++p) {
-        measuredW = static_cast<int16_t>(measuredW + (*p == ' ' ? spaceW : charW));
-      }
+      const int16_t measuredW = display::font_line_width(text, geom.destinationFont, spaceW);
+      update_scroll_window(i, geom);
       s.textPixelWidth = measuredW;
-      s.budgetWidth = geom.effectiveDestinationWidth > kScrollEtaSafetyGapPx
-          ? static_cast<int16_t>(geom.effectiveDestinationWidth - kScrollEtaSafetyGapPx)
-          : geom.effectiveDestinationWidth;
       // Only activate scroll if text overflows
       s.active = s.textPixelWidth > s.budgetWidth;
+      // Rasterize the whole line once; scroll steps only blit a window of it.
+      if (s.active &&
+          !deps_.displayEngine->render_scroll_strip(text, geom.destinationFont, charW, spaceW, scrollStrips_[i])) {
+        DCTRL_LOGW("DISPLAY", "Scroll strip unavailable row=%u width=%d font=%u; leaving row static",
+                   static_cast<unsigned>(i),
+                   static_cast<int>(measuredW),
+                   static_cast<unsigned>(geom.destinationFont));
+        s.active = false;
+      }
       if (s.active) {
         scrollActivationChanged = true;
         s.pauseUntilMs = nowMs + kScrollStartPauseMs;
@@ -1680,10 +2174,7 @@ void DeviceController::update_ui_state() {
   if (previousState != renderModel_.uiState ||
       strcmp(prevStatus, renderModel_.statusLine) != 0 ||
       strcmp(prevDetail, renderModel_.statusDetail) != 0) {
-    if (renderModel_.uiState == UiState::kStaleTransit) {
-      sync_stale_eta_animation(millis(), true);
-    }
-    schedule_full_render();
+    request_render(RenderMode::kFull);
     DCTRL_LOGI("UI",
                "UI state changed %s -> %s status='%s' detail='%s' wifiUp=%s mqttUp=%s hasData=%s networkState=%s",
                ui_state_name(previousState),
@@ -1698,7 +2189,7 @@ void DeviceController::update_ui_state() {
 }
 
 void DeviceController::sync_stale_eta_animation(uint32_t nowMs, bool force) {
-  if (renderModel_.uiState != UiState::kStaleTransit || !renderModel_.hasData || renderModel_.activeRows == 0) {
+  if (frameModel_.uiState != UiState::kStaleTransit || !frameModel_.hasData || frameModel_.activeRows == 0) {
     return;
   }
 
@@ -1721,20 +2212,20 @@ void DeviceController::sync_stale_eta_animation(uint32_t nowMs, bool force) {
   dots[3] = '\0';
 
   bool changed = false;
-  for (uint8_t i = 0; i < renderModel_.activeRows && i < kMaxTransitRows; ++i) {
-    if (!strings_equal(renderModel_.rows[i].eta, dots)) {
-      copy_str(renderModel_.rows[i].eta, sizeof(renderModel_.rows[i].eta), dots);
+  for (uint8_t i = 0; i < frameModel_.activeRows && i < kMaxTransitRows; ++i) {
+    if (!strings_equal(frameModel_.rows[i].eta, dots)) {
+      copy_str(frameModel_.rows[i].eta, sizeof(frameModel_.rows[i].eta), dots);
       changed = true;
     }
-    if (renderModel_.rows[i].etaExtra[0] != '\0') {
-      copy_str(renderModel_.rows[i].etaExtra, sizeof(renderModel_.rows[i].etaExtra), "");
+    if (frameModel_.rows[i].etaExtra[0] != '\0') {
+      copy_str(frameModel_.rows[i].etaExtra, sizeof(frameModel_.rows[i].etaExtra), "");
       changed = true;
     }
   }
 
   lastStaleEtaAnimAtMs_ = nowMs;
   if (changed) {
-    schedule_eta_render(static_cast<uint8_t>((1U << renderModel_.activeRows) - 1U));
+    schedule_eta_render(static_cast<uint8_t>((1U << frameModel_.activeRows) - 1U));
   }
 }
 
@@ -1786,7 +2277,7 @@ void DeviceController::apply_cached_transit_assignment() {
 
   for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
     clear_row(renderModel_.rows[i]);
-    reset_scroll_state(i);
+    request_scroll_reset(i);
   }
 
   renderModel_.hasData = true;
@@ -1858,31 +2349,40 @@ void DeviceController::clear_cached_transit_assignment() {
 }
 
 void DeviceController::render_eta_updates() {
-  if (!is_stale_eta_animation_render(renderModel_, etaDirtyRowMask_)) {
+  DCTRL_PROFILE_SCOPE(kRenderEta);
+  if (!is_stale_eta_animation_render(frameModel_, etaDirtyRowMask_)) {
     DCTRL_LOGI("DISPLAY", "Rendering ETA-only update rowsMask=0x%02x activeRows=%u displayType=%u",
                static_cast<unsigned>(etaDirtyRowMask_),
-               static_cast<unsigned>(renderModel_.activeRows),
-               static_cast<unsigned>(renderModel_.displayType));
+               static_cast<unsigned>(frameModel_.activeRows),
+               static_cast<unsigned>(frameModel_.displayType));
   }
 
   char etaText[kMaxEtaLen];
   char etaExtraText[kMaxDestinationLen];
-  for (uint8_t i = 0; i < renderModel_.activeRows && i < kMaxTransitRows; ++i) {
+  for (uint8_t i = 0; i < frameModel_.activeRows && i < kMaxTransitRows; ++i) {
     if ((etaDirtyRowMask_ & static_cast<uint8_t>(1U << i)) == 0) {
       continue;
     }
 
     TransitRowGeometry geometry{};
-    if (!deps_.layoutEngine->compute_transit_row_geometry(renderModel_, i, geometry)) {
+    if (!deps_.layoutEngine->compute_transit_row_geometry(frameModel_, i, geometry)) {
       DCTRL_LOGW("DISPLAY", "Falling back to full redraw because ETA geometry lookup failed row=%u",
                  static_cast<unsigned>(i));
       schedule_full_render();
       return;
     }
 
-    const TransitRowModel &row = renderModel_.rows[i];
+    // ETA width feeds the row layout, so keep the scroll window in step with it.
+    if (!update_scroll_window(i, geometry)) {
+      return;
+    }
+
+    const TransitRowModel &row = frameModel_.rows[i];
+    offListRegion_.add(geometry.etaClearX, geometry.etaClearY, geometry.etaClearW, geometry.etaClearH);
     deps_.displayEngine->fill_rect(geometry.etaClearX, geometry.etaClearY, geometry.etaClearW, geometry.etaClearH, kColorBlack);
     if (geometry.hasEtaExtra) {
+      offListRegion_.add(geometry.etaExtraClearX, geometry.etaExtraClearY, geometry.etaExtraClearW,
+                         geometry.etaExtraClearH);
       deps_.displayEngine->fill_rect(geometry.etaExtraClearX,
                                      geometry.etaExtraClearY,
                                      geometry.etaExtraClearW,
@@ -1891,20 +2391,23 @@ void DeviceController::render_eta_updates() {
     }
 
     trim_text_for_chars(row.eta[0] ? row.eta : "--", 3, etaText, sizeof(etaText));
+    mark_text_off_list(offListRegion_, geometry.etaTextX, geometry.etaTextY, etaText, geometry.etaFont);
     deps_.displayEngine->draw_text(geometry.etaTextX,
                                    geometry.etaTextY,
                                    etaText,
-                                   LayoutEngine::eta_color_for_row(row, renderModel_.uiState),
+                                   LayoutEngine::eta_color_for_row(row, frameModel_.uiState),
                                    geometry.etaFont,
                                    kColorBlack);
 
     if (geometry.hasEtaExtra) {
       if (row.etaExtra[0] != '\0' && geometry.etaExtraCharLimit > 0) {
         trim_text_for_chars(row.etaExtra, geometry.etaExtraCharLimit, etaExtraText, sizeof(etaExtraText));
+        mark_text_off_list(offListRegion_, geometry.etaExtraTextX, geometry.etaExtraTextY, etaExtraText,
+                           geometry.etaExtraFont);
         deps_.displayEngine->draw_text(geometry.etaExtraTextX,
                                        geometry.etaExtraTextY,
                                        etaExtraText,
-                                       LayoutEngine::eta_color_for_row(row, renderModel_.uiState),
+                                       LayoutEngine::eta_color_for_row(row, frameModel_.uiState),
                                        geometry.etaExtraFont,
                                        kColorBlack);
       }
@@ -1919,73 +2422,23 @@ void DeviceController::render_eta_updates() {
 }
 
 void DeviceController::render_scroll_updates() {
-  for (uint8_t i = 0; i < renderModel_.activeRows && i < kMaxTransitRows; ++i) {
+  DCTRL_PROFILE_SCOPE(kRenderScroll);
+  for (uint8_t i = 0; i < frameModel_.activeRows && i < kMaxTransitRows; ++i) {
     const RowScrollState &s = scrollState_[i];
     if (!s.active) continue;
 
-    TransitRowGeometry geom{};
-    if (!deps_.layoutEngine->compute_transit_row_geometry(renderModel_, i, geom)) {
+    display::ScrollStrip &strip = scrollStrips_[i];
+    if (!strip.valid()) {
       schedule_full_render();
       return;
     }
 
-    const TransitRowModel &row = renderModel_.rows[i];
-    const char *text = row.destination[0] ? row.destination : "-";
-
-    // Draw characters one-by-one with black background, clipped to destination zone.
-    // Each character slot is filled (char or black) in a single pass — no separate
-    // fill_rect clear step — to avoid the brief all-black frame that causes flicker.
-    const int16_t charW = static_cast<int16_t>(6 * geom.destinationFont);
-    const int16_t charH = static_cast<int16_t>(8 * geom.destinationFont);
-    const int16_t spaceW = static_cast<int16_t>(charW > 2 ? charW - 2 : 1);
-    const int16_t clipLeft = geom.destinationX;
-    const int16_t clipWidth = geom.effectiveDestinationWidth > kScrollEtaSafetyGapPx
-        ? static_cast<int16_t>(geom.effectiveDestinationWidth - kScrollEtaSafetyGapPx)
-        : geom.effectiveDestinationWidth;
-    const int16_t clipRight = static_cast<int16_t>(geom.destinationX + clipWidth);
-
-    // Scan for the first visible character to determine how much leading black to fill.
-    // This clears ghost pixels when a character has just scrolled past clipLeft.
-    int16_t cx = static_cast<int16_t>(geom.destinationX + s.offset);
-    {
-      int16_t scanCx = cx;
-      int16_t firstVisibleX = clipRight;
-      for (const char *p = text; *p && scanCx < clipRight; ++p) {
-        const int16_t adv = (*p == ' ') ? spaceW : charW;
-        if (*p != ' ' && scanCx >= clipLeft) { firstVisibleX = scanCx; break; }
-        scanCx = static_cast<int16_t>(scanCx + adv);
-      }
-      if (firstVisibleX > clipLeft) {
-        deps_.displayEngine->fill_rect(clipLeft, geom.destinationY,
-                                       static_cast<int16_t>(firstVisibleX - clipLeft), charH, kColorBlack);
-      }
-    }
-
-    char buf[2] = {0, 0};
-    for (const char *p = text; *p; ++p) {
-      if (*p == ' ') {
-        const int16_t gapX = cx < clipLeft ? clipLeft : cx;
-        const int16_t gapEnd = static_cast<int16_t>(cx + spaceW);
-        if (gapX < clipRight && gapEnd > clipLeft) {
-          const int16_t gapW = static_cast<int16_t>((gapEnd < clipRight ? gapEnd : clipRight) - gapX);
-          if (gapW > 0) deps_.displayEngine->fill_rect(gapX, geom.destinationY, gapW, charH, kColorBlack);
-        }
-        cx = static_cast<int16_t>(cx + spaceW);
-        continue;
-      }
-      if (cx < clipLeft) { cx = static_cast<int16_t>(cx + charW); continue; }
-      if (cx >= clipRight) break;
-      buf[0] = *p;
-      deps_.displayEngine->draw_text(cx, geom.destinationY, buf, 0xFFFF, geom.destinationFont, kColorBlack);
-      cx = static_cast<int16_t>(cx + charW);
-    }
-
-    // Fill any trailing gap (after last text char) with black.
-    if (cx < clipRight) {
-      deps_.displayEngine->fill_rect(cx < clipLeft ? clipLeft : cx, geom.destinationY,
-                                     static_cast<int16_t>(clipRight - (cx < clipLeft ? clipLeft : cx)),
-                                     charH, kColorBlack);
-    }
+    // Copy the visible window of the pre-rendered line. Every pixel in the
+    // window is written exactly once (lit or black), so there is no separate
+    // clear step and no flicker.
+    strip.blit(*deps_.displayEngine, s.clipX, s.clipY, s.budgetWidth, static_cast<int16_t>(-s.offset), 0xFFFF,
+               kColorBlack);
+    offListRegion_.add(s.clipX, s.clipY, s.budgetWidth, strip.height());
   }
 
   draw_dev_border();
@@ -2014,12 +2467,6 @@ bool DeviceController::publish_device_log(const char *status,
                                           const char *eventType,
                                           const char *message,
                                           const char *metadataJson) {
-  if (!deps_.mqttClient->connected()) {
-    DCTRL_LOGW("MQTT", "Skipping device log publish because MQTT is offline eventType=%s",
-               core::logging::safe_str(eventType));
-    return false;
-  }
-
   char safeMessage[160];
   char safeStatus[16];
   char safeEventType[64];
@@ -2058,11 +2505,11 @@ bool DeviceController::publish_device_log(const char *status,
   }
 
   if (!deps_.mqttClient->publish_log(payload)) {
-    DCTRL_LOGE("MQTT", "Failed to publish device log eventType=%s", core::logging::safe_str(eventType));
+    DCTRL_LOGE("MQTT", "Failed to queue device log eventType=%s", core::logging::safe_str(eventType));
     return false;
   }
 
-  DCTRL_LOGI("MQTT", "Published device log eventType=%s status=%s message=%s",
+  DCTRL_LOGI("MQTT", "Queued device log eventType=%s status=%s message=%s",
              core::logging::safe_str(eventType),
              core::logging::safe_str(status),
              core::logging::safe_str(message));
@@ -2075,6 +2522,7 @@ void DeviceController::persist_runtime_breadcrumbs(uint32_t nowMs, bool force) {
   }
 
   if (!gDevicePrefs.begin("device", false)) {
+    lastBreadcrumbPersistAtMs_ = nowMs;  // retry next period rather than every wake-up
     return;
   }
 
@@ -2102,76 +2550,151 @@ void DeviceController::render_frame(uint32_t nowMs) {
   }
 
   if (pendingRenderMode_ == RenderMode::kEtaOnly) {
+    ++renderCounts_[2];
     render_eta_updates();
     return;
   }
 
   if (pendingRenderMode_ == RenderMode::kScrollOnly) {
+    ++renderCounts_[3];
     render_scroll_updates();
     return;
   }
 
   if (core::logging::is_dev_build()) {
     DCTRL_LOGI("DISPLAY", "Rendering frame uiState=%s activeRows=%u displayType=%u status='%s'",
-               ui_state_name(renderModel_.uiState),
-               static_cast<unsigned>(renderModel_.activeRows),
-               static_cast<unsigned>(renderModel_.displayType),
-               renderModel_.statusLine);
+               ui_state_name(frameModel_.uiState),
+               static_cast<unsigned>(frameModel_.activeRows),
+               static_cast<unsigned>(frameModel_.displayType),
+               frameModel_.statusLine);
   }
-  deps_.layoutEngine->build_transit_layout(renderModel_, drawList_);
+  {
+    DCTRL_PROFILE_SCOPE(kBuildLayout);
+    deps_.layoutEngine->build_transit_layout(frameModel_, drawList_);
+  }
+  if (pendingRenderMode_ == RenderMode::kMinimal && render_minimal_frame()) {
+    ++renderCounts_[1];
+    return;
+  }
+  ++renderCounts_[0];
+  DCTRL_PROFILE_SCOPE(kRenderFull);
   for (size_t i = 0; i < drawList_.count; ++i) {
+    execute_draw_command(drawList_.commands[i]);
+  }
+  presentedDrawList_.copy_from(drawList_);
+  presentedDrawListValid_ = true;
+  offListRegion_.clear();
+
+  draw_dev_border();
+  deps_.displayEngine->present();
+  renderDirty_ = false;
+  pendingRenderMode_ = RenderMode::kNone;
+  etaDirtyRowMask_ = 0;
+}
+
+// Replays only the part of drawList_ that differs from what the panel shows.
+// Returns false when a full replay is needed instead.
+bool DeviceController::render_minimal_frame() {
+  DCTRL_PROFILE_SCOPE(kRenderMinimal);
+  const int16_t width = static_cast<int16_t>(deps_.displayEngine->geometry().totalWidth);
+  const int16_t height = static_cast<int16_t>(deps_.displayEngine->geometry().totalHeight);
+  // Pixels no command covers are only reset by the background fill.
+  const bool startsWithBackground = drawList_.count > 0 &&
+                                    drawList_.commands[0].type == DrawCommandType::kFillRect &&
+                                    drawList_.commands[0].x <= 0 && drawList_.commands[0].y <= 0 &&
+                                    drawList_.commands[0].x + drawList_.commands[0].w >= width &&
+                                    drawList_.commands[0].y + drawList_.commands[0].h >= height;
+  if (!presentedDrawListValid_ || !startsWithBackground) {
+    return false;
+  }
+
+  diff_draw_lists(presentedDrawList_, drawList_, offListRegion_, width, height, drawListDiff_);
+  const uint32_t panelArea = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+  if (drawListDiff_.region.area() * 4U >= panelArea * 3U) {
+    return false;
+  }
+
+  for (size_t i = 0; i < drawList_.count; ++i) {
+    if (!drawListDiff_.replay[i]) {
+      continue;
+    }
     const DrawCommand &cmd = drawList_.commands[i];
-    switch (cmd.type) {
-      case DrawCommandType::kFillRect:
-        deps_.displayEngine->fill_rect(cmd.x, cmd.y, cmd.w, cmd.h, cmd.color);
-        break;
-      case DrawCommandType::kText:
-        deps_.displayEngine->draw_text(cmd.x, cmd.y, cmd.text, cmd.color, cmd.size, cmd.bg);
-        break;
-      case DrawCommandType::kBadge:
-        gBadgeRenderer.draw_badge(*deps_.displayEngine, cmd.x, cmd.y, cmd.w, cmd.text, cmd.color);
-        break;
-      case DrawCommandType::kRectBadge:
-        gBadgeRenderer.draw_rect_badge(*deps_.displayEngine,
-                                       cmd.x,
-                                       cmd.y,
-                                       cmd.w,
-                                       cmd.h,
-                                       cmd.text,
-                                       cmd.color,
-                                       static_cast<display::RoundedBadgeStyle>(cmd.size));
-        break;
-      case DrawCommandType::kMonoBitmap:
-        if (!cmd.bitmap || cmd.w <= 0 || cmd.h <= 0) {
-          break;
-        }
-        for (int16_t y = 0; y < cmd.h; ++y) {
-          for (int16_t x = 0; x < cmd.w; ++x) {
-            const uint8_t pixel = cmd.bitmap[static_cast<size_t>(y) * static_cast<size_t>(cmd.w) + static_cast<size_t>(x)];
-            deps_.displayEngine->draw_pixel(static_cast<int16_t>(cmd.x + x),
-                                            static_cast<int16_t>(cmd.y + y),
-                                            pixel ? cmd.color : cmd.bg);
-          }
-        }
-        break;
-      default:
-        break;
+    if (cmd.type != DrawCommandType::kFillRect) {
+      execute_draw_command(cmd);
+      continue;
+    }
+    for (uint8_t r = 0; r < drawListDiff_.region.count(); ++r) {
+      const display::DirtyRect &clip = drawListDiff_.region.rect(r);
+      const int16_t x0 = cmd.x > clip.x ? cmd.x : clip.x;
+      const int16_t y0 = cmd.y > clip.y ? cmd.y : clip.y;
+      const int16_t x1 = static_cast<int16_t>(cmd.x + cmd.w < clip.x + clip.w ? cmd.x + cmd.w : clip.x + clip.w);
+      const int16_t y1 = static_cast<int16_t>(cmd.y + cmd.h < clip.y + clip.h ? cmd.y + cmd.h : clip.y + clip.h);
+      if (x1 > x0 && y1 > y0) {
+        deps_.displayEngine->fill_rect(x0, y0, static_cast<int16_t>(x1 - x0), static_cast<int16_t>(y1 - y0),
+                                       cmd.color);
+      }
     }
   }
 
+  if (core::logging::is_dev_build()) {
+    DCTRL_LOGI("DISPLAY", "Minimal repaint commands=%u changed=%u replayed=%u rects=%u area=%lu",
+               static_cast<unsigned>(drawList_.count),
+               static_cast<unsigned>(drawListDiff_.changedCount),
+               static_cast<unsigned>(drawListDiff_.replayCount),
+               static_cast<unsigned>(drawListDiff_.region.count()),
+               static_cast<unsigned long>(drawListDiff_.region.area()));
+  }
+
+  presentedDrawList_.copy_from(drawList_);
+  offListRegion_.clear();
   draw_dev_border();
   deps_.displayEngine->present();
   renderDirty_ = false;
   pendingRenderMode_ = RenderMode::kNone;
   etaDirtyRowMask_ = 0;
+  return true;
 }
 
-void DeviceController::publish_display_state() {
-  if (!deps_.mqttClient->connected()) {
-    DCTRL_LOGW("MQTT", "Skipping display state publish because MQTT is offline");
-    return;
+void DeviceController::execute_draw_command(const DrawCommand &cmd) {
+  switch (cmd.type) {
+    case DrawCommandType::kFillRect:
+      deps_.displayEngine->fill_rect(cmd.x, cmd.y, cmd.w, cmd.h, cmd.color);
+      break;
+    case DrawCommandType::kText:
+      deps_.displayEngine->draw_text(cmd.x, cmd.y, cmd.text, cmd.color, cmd.size, cmd.bg);
+      break;
+    case DrawCommandType::kBadge:
+      gBadgeRenderer.draw_badge(*deps_.displayEngine, cmd.x, cmd.y, cmd.w, cmd.text, cmd.color);
+      break;
+    case DrawCommandType::kRectBadge:
+      gBadgeRenderer.draw_rect_badge(*deps_.displayEngine,
+                                     cmd.x,
+                                     cmd.y,
+                                     cmd.w,
+                                     cmd.h,
+                                     cmd.text,
+                                     cmd.color,
+                                     static_cast<display::RoundedBadgeStyle>(cmd.size));
+      break;
+    case DrawCommandType::kMonoBitmap:
+      if (!cmd.bitmap || cmd.w <= 0 || cmd.h <= 0) {
+        break;
+      }
+      for (int16_t y = 0; y < cmd.h; ++y) {
+        for (int16_t x = 0; x < cmd.w; ++x) {
+          const uint8_t pixel = cmd.bitmap[static_cast<size_t>(y) * static_cast<size_t>(cmd.w) + static_cast<size_t>(x)];
+          deps_.displayEngine->draw_pixel(static_cast<int16_t>(cmd.x + x),
+                                          static_cast<int16_t>(cmd.y + y),
+                                          pixel ? cmd.color : cmd.bg);
+        }
+      }
+      break;
+    default:
+      break;
   }
+}
 
+void DeviceController::publish_display_state() {
   char r1Badge[8];
   char r1Label[128];
   char r1Eta[32];
@@ -2266,6 +2789,7 @@ bool DeviceController::perform_ota_update(const String& url) {
   }
   DCTRL_LOGI("OTA", "OTA update written=%u bytes; restarting", static_cast<unsigned>(written));
   http.end();
+  core::logging::flush();
   delay(200);
   ESP.restart();
   return true;
@@ -4,13 +4,25 @@
 #include <HTTPClient.h>
 #include <Update.h>
 #include <WebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
 
 #include "ble/ble_provisioner.h"
 #include "core/config_store.h"
+#include "core/deadline_scheduler.h"
 #include "core/display_engine.h"
+#include "core/draw_list_diff.h"
+#include "core/eta_countdown.h"
 #include "core/layout_engine.h"
 #include "core/mqtt_client.h"
 #include "core/network_manager.h"
+#include "core/render_handoff.h"
+#include "core/telemetry_aggregator.h"
+#include "core/wall_clock.h"
+#include "display/scroll_strip.h"
+#include "parsing/json_tokenizer.h"
 namespace core {
 
 struct CachedTransitRow {
@@ -40,27 +52,79 @@ class DeviceController final {
     kFull,
     kEtaOnly,
     kScrollOnly,
+    kMinimal,  // rebuild the DrawList but repaint only commands that changed
   };
 
   struct RowScrollState {
     int16_t offset;         // current pixel scroll offset (0 = no scroll, negative = scrolled left)
     int16_t textPixelWidth; // measured pixel width of destination text
     int16_t budgetWidth;    // available pixel width for destination text
+    int16_t clipX;          // left edge of the destination window the strip is blitted into
+    int16_t clipY;          // top edge of the destination window
     uint32_t pauseUntilMs; // don't advance offset until this time
     bool resetPending;      // true when we've reached the end and are pausing before jumping back
     bool active;            // true when text overflows and scrolling is enabled
   };
 
+  // Render work requested by the control side since the last snapshot the
+  // render side adopted. Requests merge: the strongest mode wins, masks OR.
+  struct RenderRequest {
+    bool pending;
+    RenderMode mode;
+    uint8_t etaRows;
+    uint8_t scrollResetRows;
+  };
+
+  struct RenderSnapshot {
+    uint32_t seq;
+    RenderModel model;
+    RenderRequest request;
+    uint8_t brightness;
+  };
+
+  // Counters the render side accumulates between telemetry frames. Handed to
+  // the control side on request and reset by the render side, so it stays
+  // their only writer.
+  struct RenderStats {
+    FrameStats frames;
+    uint32_t renders[4];  // full, minimal, ETA-only, scroll-only
+    uint32_t geomHits;
+    uint32_t geomMisses;
+    LatenessHistogram lateness;
+  };
+
   explicit DeviceController(const Dependencies &deps);
 
   bool begin();
   void tick(uint32_t nowMs);
+  // Sleeps the calling (loop) task until the next armed deadline or an
+  // external event such as a BLE write.
+  void wait_for_next_deadline();
 
  private:
   Dependencies deps_;
   DeviceRuntimeConfig runtimeConfig_;
-  RenderModel renderModel_;
+  RenderModel renderModel_;  // control side; the render side draws frameModel_
+  RenderRequest renderRequest_;
+  RenderRequest publishedRequest_;
+  uint32_t publishedSnapshotSeq_;
+  std::atomic<uint32_t> adoptedSnapshotSeq_;
+  RenderHandoff<RenderSnapshot> renderHandoff_;
+  TaskHandle_t renderTask_;
+  RenderModel frameModel_;
+  uint8_t appliedBrightness_;
+  LatenessHistogram renderLateness_;  // render task wake-ups vs. its period
+  uint32_t renderCounts_[4];  // full, minimal, ETA-only, scroll-only; render side
+  RenderHandoff<RenderStats> renderStatsHandoff_;
+  std::atomic<bool> renderStatsRequested_;
+  bool telemetryAwaitingStats_;  // control side; frame goes out once the stats arrive
+  TelemetryAggregator telemetry_;
+  DeadlineScheduler scheduler_;
   DrawList drawList_;
+  DrawList presentedDrawList_;   // last DrawList replayed onto the panel
+  bool presentedDrawListValid_;
+  display::DirtyRegion offListRegion_;  // drawn by ETA/scroll updates since presentedDrawList_
+  DrawListDiff drawListDiff_;
   WebServer server_;
   ble::BleProvisioner bleProvisioner_;
   char pendingProvisionToken_[48];
@@ -71,9 +135,8 @@ class DeviceController final {
   volatile bool bleScanPending_;
   uint32_t bootCount_;
   uint32_t lastBreadcrumbPersistAtMs_;
-  uint32_t lastHeartbeatAtMs_;
+  uint32_t lastTelemetrySampleAtMs_;
   uint32_t lastTelemetryAtMs_;
-  uint32_t lastDeviceLogHeartbeatAtMs_;
   uint32_t lastLowMemoryWarningAtMs_;
   uint32_t lastRenderAtMs_;
   uint32_t lastStaleEtaAnimAtMs_;
@@ -89,11 +152,15 @@ class DeviceController final {
   bool pendingWifiConnectedLog_;
   bool pendingWifiDisconnectLog_;
   bool pendingMqttDisconnectLog_;
-  bool pendingReconnectLogs_;
   RenderMode pendingRenderMode_;
   uint8_t etaDirtyRowMask_;
   RowScrollState scrollState_[kMaxTransitRows];
+  display::ScrollStrip scrollStrips_[kMaxTransitRows];
   CachedTransitAssignment cachedTransitAssignment_;
+  WallClock wallClock_;
+  bool sntpStarted_;
+  RowArrivals rowArrivals_[kMaxTransitRows];  // device-side countdown per row
+  parsing::JsonIndex commandJson_;  // token arena for the command being handled
   char pendingCrashReportMetadata_[256];
   static DeviceController *activeController_;
 
@@ -111,23 +178,46 @@ class DeviceController final {
                                      uint8_t attempt,
                                      uint8_t totalAttempts);
   void handle_command(const char *topic, const uint8_t *payload, size_t len);
-  void handle_display_blank_command(const String &message, uint8_t brightnessPercent, uint8_t panelBrightness);
-  void handle_disconnect_wifi_command(const String &message);
+  void handle_display_blank_command(const parsing::JsonIndex &json,
+                                    uint8_t brightnessPercent,
+                                    uint8_t panelBrightness);
+  void handle_disconnect_wifi_command(const parsing::JsonIndex &json);
+  void handle_patch_command(const uint8_t *payload, size_t len, const parsing::JsonIndex &json);
+  void handle_telemetry_interval_command(const parsing::JsonIndex &json);
+  void handle_profile_command(const parsing::JsonIndex &json);
+  void publish_telemetry_frame(uint32_t nowMs, const RenderStats &render);
+  bool commit_eta_rows(const TransitRowModel *rows, uint8_t rowMask);
+  void sync_wall_clock(uint32_t nowMs);
+  void tick_eta_countdown(uint32_t nowMs);
   bool perform_ota_update(const String& url);
   void setup_http_routes();
   static void http_connect_handler();
   static void http_device_info_handler();
   static void http_heartbeat_handler();
   static void http_status_handler();
+  void request_render(RenderMode mode, uint8_t etaRows = 0);
+  void request_scroll_reset(uint8_t rowIndex);
+  void publish_render_snapshot();
+  void adopt_render_snapshot(const RenderSnapshot &snapshot, uint32_t nowMs);
+  void tick_render(uint32_t nowMs);
+  void hand_over_render_stats();
+  bool start_render_task();
+  static void render_task_entry(void *ctx);
+  void arm_periodic(uint8_t id, uint32_t lastAtMs, uint32_t periodMs, uint32_t nowMs);
+  void arm_deadlines(uint32_t nowMs);
   void schedule_full_render();
+  void schedule_minimal_render();
   void schedule_eta_render(uint8_t rowMask);
   void schedule_scroll_render();
   void schedule_no_render();
   void tick_scroll(uint32_t nowMs);
   void reset_scroll_state(uint8_t rowIndex);
+  bool update_scroll_window(uint8_t rowIndex, const TransitRowGeometry &geom);
   void render_scroll_updates();
   void update_ui_state();
   void render_frame(uint32_t nowMs);
+  bool render_minimal_frame();
+  void execute_draw_command(const DrawCommand &cmd);
   void sync_stale_eta_animation(uint32_t nowMs, bool force = false);
   bool load_cached_transit_assignment();
   void apply_cached_transit_assignment();
@@ -240,6 +240,7 @@ bool maybe_run(DisplayEngine &display,
       } else {
         DCTRL_LOGI("CAL", "Saved display calibration");
         DCTRL_LOGI("CAL", "Restarting to apply mapping cleanly");
+        core::logging::flush();
         delay(200);
         ESP.restart();
       }
@@ -1,10 +1,19 @@
 #include "core/display_engine.h"
 
+#include <string.h>
+
 #include <Adafruit_GFX.h>
 #include <Fonts/TomThumb.h>
 #include <ESP32-VirtualMatrixPanel-I2S-DMA.h>
 
 #include "core/logging.h"
+#include "display/font_tables.h"
+
+// Fills, hlines and glyph spans go straight to the matrix's span writers
+// when the VirtualMatrixPanel transform could be learned (see ChainTransform).
+#ifndef COMMUTELIVE_DIRECT_SPANS
+#define COMMUTELIVE_DIRECT_SPANS 1
+#endif
 
 namespace core {
 
@@ -12,6 +21,7 @@ namespace {
 constexpr uint8_t kTextSizeTiny = 0;
 constexpr uint8_t kTextSizeTinyPlus = 255;
 constexpr uint8_t kCanvasRotationQuarterTurns = 2;
+constexpr uint8_t kSpanBatch = 8;
 
 const char *shift_driver_name(uint8_t value) {
   switch (value) {
@@ -91,55 +101,111 @@ constexpr int8_t kLatPin = 47;
 constexpr int8_t kOePin = 14;
 constexpr int8_t kClkPin = 2;
 
-bool in_bounds(const DisplayConfig &cfg, int16_t x, int16_t y) {
-  DisplayGeometry geom{};
-  if (!compute_geometry(cfg, geom)) {
-    return false;
+// Conservative box around a text run. Tiny text is positioned by baseline and
+// classic text by its top-left cell corner.
+void text_box(int16_t x, int16_t y, const char *text, uint8_t size, int16_t &bx, int16_t &by, int16_t &bw,
+              int16_t &bh) {
+  const int16_t len = static_cast<int16_t>(strlen(text));
+  if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
+    bx = x;
+    by = static_cast<int16_t>(y - 6);
+    bw = static_cast<int16_t>(len * 4 + 2);
+    bh = 8;
+    return;
   }
-  return x >= 0 && y >= 0 && x < static_cast<int16_t>(geom.totalWidth) &&
-         y < static_cast<int16_t>(geom.totalHeight);
+  bx = x;
+  by = y;
+  bw = static_cast<int16_t>(len * 6 * size);
+  bh = static_cast<int16_t>(8 * size);
 }
 
-}  // namespace
-
-PhysicalPoint LinearPanelMapper::map(const DisplayConfig &cfg, int16_t x, int16_t y) const {
-  if (!in_bounds(cfg, x, y)) {
-    return {false, 0, 0, 0};
-  }
-  const uint16_t panelCol = static_cast<uint16_t>(x) / cfg.panelWidth;
-  const uint16_t panelRow = static_cast<uint16_t>(y) / cfg.panelHeight;
-  const uint16_t panelIndex = panelRow * cfg.panelCols + panelCol;
-  return {
-      true,
-      panelIndex,
-      static_cast<uint16_t>(x - panelCol * cfg.panelWidth),
-      static_cast<uint16_t>(y - panelRow * cfg.panelHeight),
-  };
-}
+// Adafruit_GFX target that records lit glyph pixels into a scroll strip.
+class ScrollStripCanvas final : public Adafruit_GFX {
+ public:
+  explicit ScrollStripCanvas(display::ScrollStrip &strip)
+      : Adafruit_GFX(strip.width(), strip.height()), strip_(strip) {}
 
-PhysicalPoint SerpentinePanelMapper::map(const DisplayConfig &cfg, int16_t x, int16_t y) const {
-  if (!in_bounds(cfg, x, y)) {
-    return {false, 0, 0, 0};
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (color != 0) {
+      strip_.set_pixel(x, y);
+    }
   }
 
-  const uint16_t panelRow = static_cast<uint16_t>(y) / cfg.panelHeight;
-  const uint16_t logicalPanelCol = static_cast<uint16_t>(x) / cfg.panelWidth;
+ private:
+  display::ScrollStrip &strip_;
+};
+
+// Adafruit_GFX target that records one glyph cell: foreground pixels as 1,
+// background pixels as 2. Used to copy the built-in font into the atlas.
+class GlyphCaptureCanvas final : public Adafruit_GFX {
+ public:
+  static constexpr int16_t kCellW = 6;
+  static constexpr int16_t kCellH = 8;
 
-  uint16_t physicalPanelCol = logicalPanelCol;
-  if ((panelRow & 1U) == 1U) {
-    physicalPanelCol = static_cast<uint16_t>((cfg.panelCols - 1) - logicalPanelCol);
+  GlyphCaptureCanvas() : Adafruit_GFX(kCellW, kCellH), cells_{} {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= kCellW || y >= kCellH) {
+      return;
+    }
+    cells_[y * kCellW + x] = static_cast<uint8_t>(color);
   }
 
-  const uint16_t panelIndex = panelRow * cfg.panelCols + physicalPanelCol;
+  void reset() { memset(cells_, display::GlyphAtlas::kCellEmpty, sizeof(cells_)); }
+  const uint8_t *cells() const { return cells_; }
+
+ private:
+  uint8_t cells_[kCellW * kCellH];
+};
+
+// The panel driver, plus a probe mode in which drawPixel() records where
+// VirtualMatrixPanel sent the point instead of drawing it. That lets begin()
+// learn the chain and rotation transform from the library itself.
+class ProbedMatrixPanel final : public MatrixPanel_I2S_DMA {
+ public:
+  explicit ProbedMatrixPanel(const HUB75_I2S_CFG &cfg)
+      : MatrixPanel_I2S_DMA(cfg), probing_(false), hit_(false), x_(0), y_(0) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (!probing_) {
+      MatrixPanel_I2S_DMA::drawPixel(x, y, color);
+      return;
+    }
+    hit_ = true;
+    x_ = x;
+    y_ = y;
+  }
 
-  return {
-      true,
-      panelIndex,
-      static_cast<uint16_t>(x - logicalPanelCol * cfg.panelWidth),
-      static_cast<uint16_t>(y - panelRow * cfg.panelHeight),
-  };
+  void set_probing(bool probing) { probing_ = probing; }
+
+  bool take(int16_t &x, int16_t &y) {
+    const bool hit = hit_;
+    hit_ = false;
+    x = x_;
+    y = y_;
+    return hit;
+  }
+
+ private:
+  bool probing_;
+  bool hit_;
+  int16_t x_;
+  int16_t y_;
+};
+
+struct ChainProbe {
+  ProbedMatrixPanel *matrix;
+  VirtualMatrixPanel *panel;
+};
+
+bool probe_chain(void *ctx, int16_t x, int16_t y, int16_t &chainX, int16_t &chainY) {
+  ChainProbe *probe = static_cast<ChainProbe *>(ctx);
+  probe->panel->drawPixel(x, y, 0xFFFF);
+  return probe->matrix->take(chainX, chainY);
 }
 
+}  // namespace
+
 DisplayEngine::DisplayEngine()
     : config_{1, 2, 64, 32, 255, false, true, 0, 0, 0, 0, 0, 0, 4, false},
       geometry_{128, 32},
@@ -147,9 +213,19 @@ DisplayEngine::DisplayEngine()
       matrix_(nullptr),
       virtualMatrix_(nullptr),
       canvas_(nullptr),
+      shadow_(nullptr),
+      dirty_(),
+      previousDirty_(),
+      litRows_(),
+      stats_{},
+      glyphAtlas_(),
+      classicFontVerified_(false),
+      tinyFontVerified_(false),
       linearMapper_(),
       serpentineMapper_(),
-      mapper_(&linearMapper_) {}
+      panelMap_(),
+      mapper_(&linearMapper_),
+      chain_() {}
 
 DisplayEngine::~DisplayEngine() { end(); }
 
@@ -168,8 +244,12 @@ bool DisplayEngine::begin(const DisplayConfig &config) {
 
   config_ = config;
   geometry_ = geom;
-  mapper_ = config_.serpentine ? static_cast<const IPanelMapper *>(&serpentineMapper_)
-                               : static_cast<const IPanelMapper *>(&linearMapper_);
+  if (panelMap_.build(config_)) {
+    mapper_ = &panelMap_;
+  } else {
+    mapper_ = config_.serpentine ? static_cast<const IPanelMapper *>(&serpentineMapper_)
+                                 : static_cast<const IPanelMapper *>(&linearMapper_);
+  }
 
   HUB75_I2S_CFG::i2s_pins pins = {
       kR1Pin, kG1Pin, kB1Pin, kR2Pin, kG2Pin, kB2Pin, kAPin,
@@ -186,7 +266,8 @@ bool DisplayEngine::begin(const DisplayConfig &config) {
   mxConfig.clkphase = config_.clkPhase;
   mxConfig.min_refresh_rate = 60;
 
-  matrix_ = new MatrixPanel_I2S_DMA(mxConfig);
+  ProbedMatrixPanel *probedMatrix = new ProbedMatrixPanel(mxConfig);
+  matrix_ = probedMatrix;
   if (!matrix_ || !matrix_->begin()) {
     DCTRL_LOGE("DISPLAY", "Matrix initialization failed chainLength=%u brightness=%u",
                static_cast<unsigned>(chainLength),
@@ -217,16 +298,53 @@ bool DisplayEngine::begin(const DisplayConfig &config) {
     return false;
   }
 
-  canvas_ = virtualMatrix_;
   matrix_->setBrightness8(config_.brightness);
-  canvas_->setRotation(kCanvasRotationQuarterTurns);
+  virtualMatrix_->setRotation(kCanvasRotationQuarterTurns);
+  virtualMatrix_->fillScreen(0);
+
+#if COMMUTELIVE_DIRECT_SPANS
+  // Checks every pixel once; configs whose transform turns rows into columns
+  // (or that the table does not cover) keep drawing through VirtualMatrixPanel.
+  if (mapper_ == &panelMap_) {
+    ChainProbe probe{probedMatrix, virtualMatrix_};
+    probedMatrix->set_probing(true);
+    chain_.learn(panelMap_, &probe_chain, &probe);
+    probedMatrix->set_probing(false);
+  }
+#endif
+
+  // With double buffering the back buffer is two frames stale after a flip.
+  // Drawing into a RAM shadow lets present() bring it up to date by copying
+  // only the regions changed in the last two frames.
+  if (config_.doubleBuffered) {
+    shadow_ = new GFXcanvas16(geometry_.totalWidth, geometry_.totalHeight);
+    if (!shadow_ || !shadow_->getBuffer()) {
+      DCTRL_LOGW("DISPLAY", "Shadow canvas allocation failed %ux%u; presenting full frames",
+                 geometry_.totalWidth,
+                 geometry_.totalHeight);
+      delete shadow_;
+      shadow_ = nullptr;
+    }
+  }
+
+  canvas_ = shadow_ ? static_cast<Adafruit_GFX *>(shadow_) : static_cast<Adafruit_GFX *>(virtualMatrix_);
   canvas_->setTextWrap(false);
   canvas_->setTextSize(1);
   canvas_->fillScreen(0);
 
+  dirty_.set_bounds(static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight));
+  previousDirty_.set_bounds(static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight));
+  // Without a shadow the two DMA buffers diverge, so no row can be assumed dark.
+  litRows_.set_all(!partial_present());
+  stats_ = {};
+
+  if (glyphAtlas_.span_count() == 0) {
+    build_glyph_atlas();
+  }
+
   ready_ = true;
   DCTRL_LOGI("DISPLAY",
-             "Ready total=%ux%u panels=%ux%u brightness=%u serpentine=%s chainMode=%u offsets=(%d,%d) rotation=%u driver=%s line=%s clk=%s lat=%u clkphase=%s",
+             "Ready total=%ux%u panels=%ux%u brightness=%u serpentine=%s chainMode=%u offsets=(%d,%d) rotation=%u directSpans=%s driver=%s line=%s clk=%s lat=%u clkphase=%s",
              geometry_.totalWidth,
              geometry_.totalHeight,
              config_.panelCols,
@@ -237,6 +355,7 @@ bool DisplayEngine::begin(const DisplayConfig &config) {
              static_cast<int>(config_.xOffset),
              static_cast<int>(config_.yOffset),
              static_cast<unsigned>(kCanvasRotationQuarterTurns),
+             core::logging::bool_str(chain_.valid()),
              shift_driver_name(config_.shiftDriver),
              line_driver_name(config_.lineDriver),
              clock_speed_name(config_.clockSpeed),
@@ -247,6 +366,7 @@ bool DisplayEngine::begin(const DisplayConfig &config) {
 
 void DisplayEngine::end() {
   ready_ = false;
+  chain_.reset();
 
   if (virtualMatrix_) {
     delete virtualMatrix_;
@@ -255,6 +375,11 @@ void DisplayEngine::end() {
 
   canvas_ = nullptr;
 
+  if (shadow_) {
+    delete shadow_;
+    shadow_ = nullptr;
+  }
+
   if (matrix_) {
     delete matrix_;
     matrix_ = nullptr;
@@ -267,6 +392,8 @@ const DisplayConfig &DisplayEngine::config() const { return config_; }
 
 const DisplayGeometry &DisplayEngine::geometry() const { return geometry_; }
 
+const IPanelMapper &DisplayEngine::panel_mapper() const { return *mapper_; }
+
 void DisplayEngine::set_brightness(uint8_t brightness) {
   config_.brightness = brightness;
   if (matrix_) {
@@ -285,18 +412,43 @@ void DisplayEngine::clear(uint16_t color) {
   if (!canvas_) {
     return;
   }
-  canvas_->fillScreen(color);
+  if (direct_canvas()) {
+    fill_canvas_rect(0, 0, static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight),
+                     color);
+  } else {
+    canvas_->fillScreen(color);
+  }
+  dirty_.add_all();
+  if (partial_present()) {
+    litRows_.set_all(color != 0);
+  }
 }
 
 LogicalPoint DisplayEngine::with_offset(int16_t x, int16_t y) const {
   return {static_cast<int16_t>(x + config_.xOffset), static_cast<int16_t>(y + config_.yOffset)};
 }
 
+void DisplayEngine::mark_drawn(int16_t x, int16_t y, int16_t w, int16_t h, bool lit) {
+  dirty_.add(x, y, w, h);
+  if (lit) {
+    litRows_.set_range(y, h, true);
+  }
+}
+
 void DisplayEngine::draw_text(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size, uint16_t bg) {
   if (!canvas_ || !text) {
     return;
   }
   const LogicalPoint p = with_offset(x, y);
+  int16_t bx = 0;
+  int16_t by = 0;
+  int16_t bw = 0;
+  int16_t bh = 0;
+  text_box(p.x, p.y, text, size, bx, by, bw, bh);
+  mark_drawn(bx, by, bw, bh, color != 0 || bg != 0);
+  if (draw_atlas_text(p.x, p.y, text, color, size, true, bg)) {
+    return;
+  }
   canvas_->setTextWrap(false);
   if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
     canvas_->setFont(&TomThumb);
@@ -323,6 +475,15 @@ void DisplayEngine::draw_text_transparent(int16_t x, int16_t y, const char *text
     return;
   }
   const LogicalPoint p = with_offset(x, y);
+  int16_t bx = 0;
+  int16_t by = 0;
+  int16_t bw = 0;
+  int16_t bh = 0;
+  text_box(p.x, p.y, text, size, bx, by, bw, bh);
+  mark_drawn(bx, by, bw, bh, color != 0);
+  if (draw_atlas_text(p.x, p.y, text, color, size, false, 0)) {
+    return;
+  }
   canvas_->setTextWrap(false);
   if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
     canvas_->setFont(&TomThumb);
@@ -343,20 +504,190 @@ void DisplayEngine::draw_text_transparent(int16_t x, int16_t y, const char *text
   canvas_->print(text);
 }
 
+void DisplayEngine::build_glyph_atlas() {
+  glyphAtlas_.clear();
+  bool ok = true;
+  // The shared font tables drive measurement and layout estimates; they are
+  // only trusted once every glyph matches what the library actually draws.
+  uint8_t classicMismatches = 0;
+  uint8_t tinyMismatches = 0;
+
+  GlyphCaptureCanvas capture;
+  for (char c = display::GlyphAtlas::kFirstChar; c <= display::GlyphAtlas::kLastChar; ++c) {
+    capture.reset();
+    capture.drawChar(0, 0, static_cast<unsigned char>(c), display::GlyphAtlas::kCellForeground,
+                     display::GlyphAtlas::kCellBackground, 1);
+    const uint8_t slot = display::font_glyph_slot(c);
+    bool same = true;
+    for (uint8_t row = 0; row < GlyphCaptureCanvas::kCellH && same; ++row) {
+      for (uint8_t col = 0; col < GlyphCaptureCanvas::kCellW; ++col) {
+        const bool lit = capture.cells()[row * GlyphCaptureCanvas::kCellW + col] == display::GlyphAtlas::kCellForeground;
+        if (lit != display::classic_glyph_pixel(slot, col, row)) {
+          same = false;
+          break;
+        }
+      }
+    }
+    if (!same) {
+      ++classicMismatches;
+    }
+    ok = glyphAtlas_.add_glyph(display::GlyphSet::kClassic, c, capture.cells(), GlyphCaptureCanvas::kCellW,
+                               GlyphCaptureCanvas::kCellH, 0, 0, GlyphCaptureCanvas::kCellW) && ok;
+  }
+
+  // TomThumb glyphs are read straight from the font's packed bitmap. The
+  // emboldened set is the glyph OR'd with itself shifted one pixel right,
+  // which is exactly what printing the string twice produced.
+  constexpr uint8_t kMaxTinyW = 16;
+  constexpr uint8_t kMaxTinyH = 8;
+  uint8_t cells[(kMaxTinyW + 1) * kMaxTinyH];
+  uint8_t bold[(kMaxTinyW + 1) * kMaxTinyH];
+  for (char c = display::GlyphAtlas::kFirstChar; c <= display::GlyphAtlas::kLastChar; ++c) {
+    const uint8_t code = static_cast<uint8_t>(c);
+    if (code < TomThumb.first || code > TomThumb.last) {
+      continue;
+    }
+    const GFXglyph &glyph = TomThumb.glyph[code - TomThumb.first];
+    if (glyph.width > kMaxTinyW || glyph.height > kMaxTinyH) {
+      ok = false;
+      ++tinyMismatches;
+      continue;
+    }
+
+    const uint8_t w = glyph.width;
+    const uint8_t h = glyph.height;
+    const uint8_t slot = display::font_glyph_slot(c);
+    const display::FontGlyph &table = display::kTinyFontGlyphs[slot];
+    bool same = table.width == w && table.height == h && table.xAdvance == glyph.xAdvance &&
+                table.xOffset == glyph.xOffset && table.yOffset == glyph.yOffset;
+    const uint8_t boldW = w > 0 ? static_cast<uint8_t>(w + 1) : 0;
+    memset(cells, display::GlyphAtlas::kCellEmpty, sizeof(cells));
+    memset(bold, display::GlyphAtlas::kCellEmpty, sizeof(bold));
+    uint16_t bitIndex = 0;
+    for (uint8_t yy = 0; yy < h; ++yy) {
+      for (uint8_t xx = 0; xx < w; ++xx, ++bitIndex) {
+        const uint8_t byte = TomThumb.bitmap[glyph.bitmapOffset + (bitIndex >> 3)];
+        const bool lit = (byte & (0x80U >> (bitIndex & 7))) != 0;
+        if (same && lit != display::tiny_glyph_pixel(slot, xx, yy)) {
+          same = false;
+        }
+        if (!lit) {
+          continue;
+        }
+        cells[yy * w + xx] = display::GlyphAtlas::kCellForeground;
+        bold[yy * boldW + xx] = display::GlyphAtlas::kCellForeground;
+        bold[yy * boldW + xx + 1] = display::GlyphAtlas::kCellForeground;
+      }
+    }
+    if (!same) {
+      ++tinyMismatches;
+    }
+    ok = glyphAtlas_.add_glyph(display::GlyphSet::kTiny, c, cells, w, h, glyph.xOffset, glyph.yOffset,
+                               glyph.xAdvance) && ok;
+    ok = glyphAtlas_.add_glyph(display::GlyphSet::kTinyBold, c, bold, boldW, h, glyph.xOffset, glyph.yOffset,
+                               glyph.xAdvance) && ok;
+  }
+
+  classicFontVerified_ = classicMismatches == 0;
+  tinyFontVerified_ = tinyMismatches == 0 && TomThumb.first == static_cast<uint8_t>(display::kFontFirstChar) &&
+                      TomThumb.last == static_cast<uint8_t>(display::kFontLastChar);
+  if (!classicFontVerified_ || !tinyFontVerified_) {
+    DCTRL_LOGW("DISPLAY", "Font tables differ from Adafruit_GFX classic=%u tiny=%u glyphs; measuring via the library",
+               static_cast<unsigned>(classicMismatches),
+               static_cast<unsigned>(tinyMismatches));
+  }
+
+  if (!ok) {
+    DCTRL_LOGW("DISPLAY", "Glyph atlas incomplete spans=%u; missing glyphs use Adafruit_GFX",
+               static_cast<unsigned>(glyphAtlas_.span_count()));
+    return;
+  }
+  DCTRL_LOGI("DISPLAY", "Glyph atlas ready spans=%u bytes=%u",
+             static_cast<unsigned>(glyphAtlas_.span_count()),
+             static_cast<unsigned>(glyphAtlas_.span_count() * sizeof(display::GlyphSpan)));
+}
+
+bool DisplayEngine::draw_atlas_text(int16_t x,
+                                    int16_t y,
+                                    const char *text,
+                                    uint16_t color,
+                                    uint8_t size,
+                                    bool opaque,
+                                    uint16_t bg) {
+  display::GlyphSet set = display::GlyphSet::kClassic;
+  uint8_t scale = size;
+  if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
+    // Adafruit_GFX never paints a background behind custom-font glyphs.
+    set = size == kTextSizeTinyPlus ? display::GlyphSet::kTinyBold : display::GlyphSet::kTiny;
+    scale = 1;
+    opaque = false;
+  }
+  if (opaque && bg == color) {
+    opaque = false;
+  }
+
+  if (direct_canvas()) {
+    return glyphAtlas_.draw(set, x, y, text, scale, opaque,
+                            [this, color, bg](int16_t sx, int16_t sy, int16_t w, bool lit) {
+                              write_span(sx, sy, w, lit ? color : bg);
+                            });
+  }
+
+  Adafruit_GFX *canvas = canvas_;
+  canvas->startWrite();
+  const bool drawn = glyphAtlas_.draw(set, x, y, text, scale, opaque,
+                                      [canvas, color, bg](int16_t sx, int16_t sy, int16_t w, bool lit) {
+                                        canvas->writeFastHLine(sx, sy, w, lit ? color : bg);
+                                      });
+  canvas->endWrite();
+  return drawn;
+}
+
 void DisplayEngine::draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
   if (!canvas_) {
     return;
   }
   const LogicalPoint p = with_offset(x, y);
   canvas_->drawRect(p.x, p.y, w, h, color);
+  mark_drawn(p.x, p.y, w, h, color != 0);
 }
 
 void DisplayEngine::fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-  if (!canvas_) {
+  if (!canvas_ || w <= 0 || h <= 0) {
     return;
   }
   const LogicalPoint p = with_offset(x, y);
-  canvas_->fillRect(p.x, p.y, w, h, color);
+  if (color != 0) {
+    fill_canvas_rect(p.x, p.y, w, h, color);
+    mark_drawn(p.x, p.y, w, h, true);
+    return;
+  }
+
+  // Black fills (including the full-screen clear every full render starts
+  // with) only need to touch scanlines that may still hold lit pixels.
+  const int16_t height = static_cast<int16_t>(geometry_.totalHeight);
+  const int16_t rowEnd = static_cast<int16_t>(p.y + h) < height ? static_cast<int16_t>(p.y + h) : height;
+  int16_t runStart = -1;
+  for (int16_t row = p.y < 0 ? 0 : p.y; row <= rowEnd; ++row) {
+    if (row < rowEnd && litRows_.test(row)) {
+      if (runStart < 0) {
+        runStart = row;
+      }
+      continue;
+    }
+    if (runStart >= 0) {
+      fill_canvas_rect(p.x, runStart, w, static_cast<int16_t>(row - runStart), 0);
+      dirty_.add(p.x, runStart, w, static_cast<int16_t>(row - runStart));
+      runStart = -1;
+    }
+    if (row < rowEnd) {
+      ++stats_.skippedRows;
+    }
+  }
+
+  if (partial_present() && p.x <= 0 && p.x + w >= static_cast<int16_t>(geometry_.totalWidth)) {
+    litRows_.set_range(p.y, h, false);
+  }
 }
 
 void DisplayEngine::draw_pixel(int16_t x, int16_t y, uint16_t color) {
@@ -365,6 +696,7 @@ void DisplayEngine::draw_pixel(int16_t x, int16_t y, uint16_t color) {
   }
   const LogicalPoint p = with_offset(x, y);
   canvas_->drawPixel(p.x, p.y, color);
+  mark_drawn(p.x, p.y, 1, 1, color != 0);
 }
 
 void DisplayEngine::draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) {
@@ -372,7 +704,27 @@ void DisplayEngine::draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color)
     return;
   }
   const LogicalPoint p = with_offset(x, y);
-  canvas_->drawFastHLine(p.x, p.y, w, color);
+  if (direct_canvas()) {
+    write_span(p.x, p.y, w, color);
+  } else {
+    canvas_->drawFastHLine(p.x, p.y, w, color);
+  }
+  mark_drawn(p.x, p.y, w, 1, color != 0);
+}
+
+void DisplayEngine::draw_bitmap(int16_t x,
+                                int16_t y,
+                                const uint8_t *bits,
+                                int16_t w,
+                                int16_t h,
+                                uint16_t fg,
+                                uint16_t bg) {
+  if (!canvas_ || !bits || w <= 0 || h <= 0) {
+    return;
+  }
+  const LogicalPoint p = with_offset(x, y);
+  canvas_->drawBitmap(p.x, p.y, bits, w, h, fg, bg);
+  mark_drawn(p.x, p.y, w, h, fg != 0 || bg != 0);
 }
 
 display::TextMetrics DisplayEngine::measure_text(const char *text, uint8_t size) {
@@ -381,6 +733,11 @@ display::TextMetrics DisplayEngine::measure_text(const char *text, uint8_t size)
     return tm;
   }
 
+  const bool tiny = size == kTextSizeTiny || size == kTextSizeTinyPlus;
+  if (tiny ? tinyFontVerified_ : classicFontVerified_) {
+    return display::font_measure_text(text, size);
+  }
+
   if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
     canvas_->setFont(&TomThumb);
     canvas_->setTextSize(1);
@@ -406,14 +763,144 @@ display::TextMetrics DisplayEngine::measure_text(const char *text, uint8_t size)
   return tm;
 }
 
+bool DisplayEngine::render_scroll_strip(const char *text,
+                                        uint8_t size,
+                                        int16_t charAdvance,
+                                        int16_t spaceAdvance,
+                                        display::ScrollStrip &out) {
+  out.invalidate();
+  if (!text || size == kTextSizeTiny || size == kTextSizeTinyPlus || charAdvance <= 0 || spaceAdvance <= 0) {
+    return false;
+  }
+
+  int32_t width = 0;
+  for (const char *p = text; *p; ++p) {
+    width += (*p == ' ') ? spaceAdvance : charAdvance;
+  }
+  if (width > display::ScrollStrip::kMaxWidthPx ||
+      !out.reset(static_cast<int16_t>(width), static_cast<int16_t>(8 * size))) {
+    return false;
+  }
+
+  // Same glyphs and advances the per-character scroll renderer used, drawn
+  // transparently so only lit pixels reach the strip.
+  ScrollStripCanvas strip(out);
+  int16_t cx = 0;
+  char glyph[2] = {0, 0};
+  for (const char *p = text; *p; ++p) {
+    if (*p == ' ') {
+      cx = static_cast<int16_t>(cx + spaceAdvance);
+      continue;
+    }
+    glyph[0] = *p;
+    const bool drawn = glyphAtlas_.draw(display::GlyphSet::kClassic, cx, 0, glyph, size, false,
+                                        [&out](int16_t sx, int16_t sy, int16_t w, bool) {
+                                          for (int16_t i = 0; i < w; ++i) {
+                                            out.set_pixel(static_cast<int16_t>(sx + i), sy);
+                                          }
+                                        });
+    if (!drawn) {
+      strip.drawChar(cx, 0, static_cast<unsigned char>(*p), 1, 1, size);
+    }
+    cx = static_cast<int16_t>(cx + charAdvance);
+  }
+  return true;
+}
+
 bool DisplayEngine::present() {
   if (!ready_ || !matrix_) {
     return false;
   }
+
+  const uint32_t dirtyArea = dirty_.area();
+  ++stats_.frames;
+  stats_.dirtyPixels += dirtyArea;
+  stats_.lastDirtyPixels = dirtyArea;
+
+  if (shadow_) {
+    // The back buffer last received the frame before the previous one, so it
+    // needs both frames' changes to catch up with the shadow.
+    display::DirtyRegion pending = dirty_;
+    pending.add_region(previousDirty_);
+    for (uint8_t i = 0; i < pending.count(); ++i) {
+      copy_to_matrix(pending.rect(i));
+    }
+    stats_.copiedPixels += pending.area();
+    previousDirty_ = dirty_;
+  }
+  dirty_.clear();
+
   matrix_->flipDMABuffer();
   return true;
 }
 
+bool DisplayEngine::partial_present() const { return !config_.doubleBuffered || shadow_ != nullptr; }
+
+const FrameStats &DisplayEngine::frame_stats() const { return stats_; }
+
+void DisplayEngine::reset_frame_stats() { stats_ = {}; }
+
+void DisplayEngine::copy_to_matrix(const display::DirtyRect &rect) {
+  const uint16_t *pixels = shadow_->getBuffer();
+  const size_t stride = geometry_.totalWidth;
+  if (chain_.valid()) {
+    // Runs of one color (mostly background) become single chain spans.
+    for (int16_t row = rect.y; row < rect.y + rect.h; ++row) {
+      const uint16_t *line = &pixels[static_cast<size_t>(row) * stride];
+      int16_t runStart = rect.x;
+      for (int16_t x = static_cast<int16_t>(rect.x + 1); x <= rect.x + rect.w; ++x) {
+        if (x < rect.x + rect.w && line[x] == line[runStart]) {
+          continue;
+        }
+        write_span(runStart, row, static_cast<int16_t>(x - runStart), line[runStart]);
+        runStart = x;
+      }
+    }
+    return;
+  }
+  for (int16_t row = rect.y; row < rect.y + rect.h; ++row) {
+    virtualMatrix_->drawRGBBitmap(rect.x, row, &pixels[static_cast<size_t>(row) * stride + static_cast<size_t>(rect.x)],
+                                  rect.w, 1);
+  }
+}
+
+// Drawing straight to the chain only applies when there is no shadow canvas;
+// with one, draws stay in RAM and copy_to_matrix() uses the chain instead.
+bool DisplayEngine::direct_canvas() const { return chain_.valid() && canvas_ == virtualMatrix_; }
+
+void DisplayEngine::fill_canvas_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!direct_canvas()) {
+    canvas_->fillRect(x, y, w, h, color);
+    return;
+  }
+  const int16_t rowEnd = static_cast<int16_t>(y + h);
+  for (int16_t row = y < 0 ? 0 : y; row < rowEnd && row < static_cast<int16_t>(geometry_.totalHeight); ++row) {
+    write_span(x, row, w, color);
+  }
+}
+
+// One matrix hline per panel the span crosses instead of one transformed
+// drawPixel per pixel; the driver's hline writes the DMA bit planes directly.
+void DisplayEngine::write_span(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  PhysicalSpan spans[kSpanBatch];
+  while (w > 0) {
+    const uint8_t count = panelMap_.map_span(x, y, w, spans, kSpanBatch);
+    if (count == 0) {
+      return;
+    }
+    int16_t consumed = x < 0 ? static_cast<int16_t>(-x) : 0;
+    for (uint8_t i = 0; i < count; ++i) {
+      int16_t chainX = 0;
+      int16_t chainY = 0;
+      chain_.place(spans[i], chainX, chainY);
+      matrix_->drawFastHLine(chainX, chainY, static_cast<int16_t>(spans[i].length), color);
+      consumed = static_cast<int16_t>(consumed + spans[i].length);
+    }
+    x = static_cast<int16_t>(x + consumed);
+    w = static_cast<int16_t>(w - consumed);
+  }
+}
+
 uint16_t DisplayEngine::color565(uint8_t r, uint8_t g, uint8_t b) const {
   if (!matrix_) {
     return 0;
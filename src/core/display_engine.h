@@ -4,10 +4,15 @@
 #include <ESP32-HUB75-MatrixPanel-I2S-DMA.h>
 
 #include "core/models.h"
+#include "core/panel_mapper.h"
+#include "display/dirty_region.h"
 #include "display/display_engine.h"
+#include "display/glyph_atlas.h"
+#include "display/scroll_strip.h"
 
 class VirtualMatrixPanel;
 class Adafruit_GFX;
+class GFXcanvas16;
 
 namespace core {
 
@@ -16,27 +21,13 @@ struct LogicalPoint {
   int16_t y;
 };
 
-struct PhysicalPoint {
-  bool valid;
-  uint16_t panelIndex;
-  uint16_t localX;
-  uint16_t localY;
-};
-
-class IPanelMapper {
- public:
-  virtual ~IPanelMapper() = default;
-  virtual PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const = 0;
-};
-
-class LinearPanelMapper final : public IPanelMapper {
- public:
-  PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const override;
-};
-
-class SerpentinePanelMapper final : public IPanelMapper {
- public:
-  PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const override;
+// Per-frame drawing cost, accumulated across present() calls until reset.
+struct FrameStats {
+  uint32_t frames;
+  uint32_t dirtyPixels;      // area touched by draw calls
+  uint32_t copiedPixels;     // area pushed from the shadow canvas to the DMA buffer
+  uint32_t skippedRows;      // black-fill scanlines skipped because they were already dark
+  uint32_t lastDirtyPixels;  // dirty area of the most recent frame
 };
 
 class DisplayEngine final : public display::DisplayEngine {
@@ -50,6 +41,8 @@ class DisplayEngine final : public display::DisplayEngine {
   bool is_ready() const;
   const DisplayConfig &config() const;
   const DisplayGeometry &geometry() const;
+  // Table-backed when the canvas fits PanelMapTable, arithmetic otherwise.
+  const IPanelMapper &panel_mapper() const;
 
   void set_brightness(uint8_t brightness);
   void set_offsets(int8_t xOffset, int8_t yOffset);
@@ -61,13 +54,31 @@ class DisplayEngine final : public display::DisplayEngine {
   void fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
   void draw_pixel(int16_t x, int16_t y, uint16_t color) override;
   void draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void draw_bitmap(int16_t x, int16_t y, const uint8_t *bits, int16_t w, int16_t h, uint16_t fg, uint16_t bg) override;
   display::TextMetrics measure_text(const char *text, uint8_t size) override;
+  bool render_scroll_strip(const char *text,
+                           uint8_t size,
+                           int16_t charAdvance,
+                           int16_t spaceAdvance,
+                           display::ScrollStrip &out);
   bool present();
+  // False when double buffering is on but no shadow canvas could be allocated;
+  // every frame must then be drawn in full.
+  bool partial_present() const;
+  const FrameStats &frame_stats() const;
+  void reset_frame_stats();
 
   uint16_t color565(uint8_t r, uint8_t g, uint8_t b) const;
 
  private:
   LogicalPoint with_offset(int16_t x, int16_t y) const;
+  void mark_drawn(int16_t x, int16_t y, int16_t w, int16_t h, bool lit);
+  void copy_to_matrix(const display::DirtyRect &rect);
+  bool direct_canvas() const;
+  void fill_canvas_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void write_span(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void build_glyph_atlas();
+  bool draw_atlas_text(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size, bool opaque, uint16_t bg);
 
   DisplayConfig config_;
   DisplayGeometry geometry_;
@@ -76,10 +87,22 @@ class DisplayEngine final : public display::DisplayEngine {
   MatrixPanel_I2S_DMA *matrix_;
   VirtualMatrixPanel *virtualMatrix_;
   Adafruit_GFX *canvas_;
+  GFXcanvas16 *shadow_;
+
+  display::DirtyRegion dirty_;
+  display::DirtyRegion previousDirty_;
+  display::ScanlineMask litRows_;
+  FrameStats stats_;
+  display::GlyphAtlas glyphAtlas_;
+  bool classicFontVerified_;
+  bool tinyFontVerified_;
 
   LinearPanelMapper linearMapper_;
   SerpentinePanelMapper serpentineMapper_;
+  PanelMapTable panelMap_;
   const IPanelMapper *mapper_;
+  // Valid when spans can bypass VirtualMatrixPanel and go straight to the chain.
+  ChainTransform chain_;
 };
 
 }  // namespace core
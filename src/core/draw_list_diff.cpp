@@ -0,0 +1,119 @@
+#include "core/draw_list_diff.h"
+
+#include <string.h>
+
+#include "display/font_tables.h"
+
+namespace core {
+
+namespace {
+
+bool overlaps(const display::DirtyRect &a, const display::DirtyRect &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+bool overlaps_region(const display::DirtyRegion &region, const display::DirtyRect &r) {
+  for (uint8_t i = 0; i < region.count(); ++i) {
+    if (overlaps(region.rect(i), r)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void add_command(display::DirtyRegion &region, const DrawCommand &cmd) {
+  display::DirtyRect r{};
+  if (draw_command_bounds(cmd, r)) {
+    region.add(r.x, r.y, r.w, r.h);
+  }
+}
+
+}  // namespace
+
+bool draw_commands_equal(const DrawCommand &lhs, const DrawCommand &rhs) {
+  if (lhs.type != rhs.type || lhs.x != rhs.x || lhs.y != rhs.y || lhs.w != rhs.w || lhs.h != rhs.h ||
+      lhs.color != rhs.color || lhs.bg != rhs.bg || lhs.size != rhs.size || lhs.bitmap != rhs.bitmap) {
+    return false;
+  }
+  if (!lhs.text || !rhs.text) {
+    return lhs.text == rhs.text;
+  }
+  return strcmp(lhs.text, rhs.text) == 0;
+}
+
+bool draw_command_bounds(const DrawCommand &cmd, display::DirtyRect &out) {
+  switch (cmd.type) {
+    case DrawCommandType::kFillRect:
+    case DrawCommandType::kRectBadge:
+    case DrawCommandType::kMonoBitmap:
+      out = {cmd.x, cmd.y, cmd.w, cmd.h};
+      break;
+    case DrawCommandType::kBadge: {
+      // BadgeRenderer enforces a 5 px minimum and centers on size / 2.
+      const int16_t size = static_cast<int16_t>((cmd.w < 5 ? 5 : cmd.w) + 1);
+      out = {cmd.x, cmd.y, size, size};
+      break;
+    }
+    case DrawCommandType::kText: {
+      if (!cmd.text || cmd.text[0] == '\0') {
+        return false;
+      }
+      const display::TextMetrics tm = display::font_measure_text(cmd.text, cmd.size);
+      out = {static_cast<int16_t>(cmd.x + tm.xOffset), static_cast<int16_t>(cmd.y + tm.yOffset), tm.width,
+             tm.height};
+      break;
+    }
+    default:
+      return false;
+  }
+  return out.w > 0 && out.h > 0;
+}
+
+void diff_draw_lists(const DrawList &previous,
+                     const DrawList &next,
+                     const display::DirtyRegion &seed,
+                     int16_t width,
+                     int16_t height,
+                     DrawListDiff &out) {
+  out.region.set_bounds(width, height);
+  out.region.add_region(seed);
+  out.replayCount = 0;
+  out.changedCount = 0;
+  memset(out.replay, 0, sizeof(out.replay));
+
+  const size_t common = previous.count < next.count ? previous.count : next.count;
+  for (size_t i = 0; i < common; ++i) {
+    if (!draw_commands_equal(previous.commands[i], next.commands[i])) {
+      add_command(out.region, previous.commands[i]);
+      add_command(out.region, next.commands[i]);
+      ++out.changedCount;
+    }
+  }
+  for (size_t i = common; i < previous.count; ++i) {
+    add_command(out.region, previous.commands[i]);
+    ++out.changedCount;
+  }
+  for (size_t i = common; i < next.count; ++i) {
+    add_command(out.region, next.commands[i]);
+    ++out.changedCount;
+  }
+
+  bool grew = true;
+  while (grew) {
+    grew = false;
+    for (size_t i = 0; i < next.count; ++i) {
+      display::DirtyRect r{};
+      if (out.replay[i] || !draw_command_bounds(next.commands[i], r) || !overlaps_region(out.region, r)) {
+        continue;
+      }
+      out.replay[i] = true;
+      ++out.replayCount;
+      if (next.commands[i].type != DrawCommandType::kFillRect) {
+        out.region.add(r.x, r.y, r.w, r.h);
+        grew = true;
+      }
+    }
+  }
+}
+
+}  // namespace core
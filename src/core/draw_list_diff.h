@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/layout_engine.h"
+#include "display/dirty_region.h"
+
+namespace core {
+
+bool draw_commands_equal(const DrawCommand &lhs, const DrawCommand &rhs);
+
+// Conservative pixel box a command can touch. Returns false for commands that
+// draw nothing.
+bool draw_command_bounds(const DrawCommand &cmd, display::DirtyRect &out);
+
+// Result of comparing the last presented DrawList with a newly built one.
+// Replaying the marked commands of `next`, with fills clipped to `region`,
+// turns a panel showing `previous` into one showing `next`.
+struct DrawListDiff {
+  display::DirtyRegion region;
+  bool replay[DrawList::kMaxCommands];
+  size_t replayCount;
+  size_t changedCount;
+};
+
+// Commands are matched by index. Every command whose content differs
+// contributes its old and new bounds; `seed` adds areas drawn outside the
+// list since `previous` was presented. Any non-fill command overlapping the
+// region is replayed and its bounds folded back in until nothing changes, so
+// replaying it cannot disturb pixels outside the region.
+void diff_draw_lists(const DrawList &previous,
+                     const DrawList &next,
+                     const display::DirtyRegion &seed,
+                     int16_t width,
+                     int16_t height,
+                     DrawListDiff &out);
+
+}  // namespace core
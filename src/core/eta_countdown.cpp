@@ -0,0 +1,90 @@
+#include "core/eta_countdown.h"
+
+#include <stdio.h>
+
+namespace core {
+
+namespace {
+
+constexpr int64_t kMinuteMs = 60000;
+
+// Writes "<n><unit>" and returns the length.
+size_t format_minutes(uint32_t minutes, char unit, char *out, size_t outLen) {
+  char digits[10];
+  size_t n = 0;
+  do {
+    digits[n++] = static_cast<char>('0' + minutes % 10);
+    minutes /= 10;
+  } while (minutes > 0 && n < sizeof(digits));
+
+  size_t used = 0;
+  while (n > 0 && used + 2 < outLen) out[used++] = digits[--n];
+  out[used++] = unit;
+  out[used] = '\0';
+  return used;
+}
+
+int64_t remaining_ms(uint32_t arrivalSec, uint64_t nowEpochMs) {
+  return static_cast<int64_t>(arrivalSec) * 1000 - static_cast<int64_t>(nowEpochMs);
+}
+
+uint32_t minutes_until(int64_t remainingMs) {
+  return remainingMs <= 0 ? 0 : static_cast<uint32_t>((remainingMs + kMinuteMs - 1) / kMinuteMs);
+}
+
+bool departed(int64_t remainingMs) {
+  return remainingMs + static_cast<int64_t>(kArrivalGraceMs) <= 0;
+}
+
+}  // namespace
+
+void apply_countdown(const RowArrivals &arrivals, uint64_t nowEpochMs, TransitRowModel &row) {
+  row.eta[0] = '\0';
+  row.etaExtra[0] = '\0';
+  size_t used = 0;
+  uint8_t shown = 0;
+  for (uint8_t i = 0; i < arrivals.count && i < kMaxRowArrivals && shown < kMaxRowArrivals; ++i) {
+    const int64_t remaining = remaining_ms(arrivals.epochs[i], nowEpochMs);
+    if (departed(remaining)) continue;
+    const uint32_t minutes = minutes_until(remaining);
+
+    if (shown++ == 0) {
+      if (minutes <= 1) {
+        snprintf(row.eta, sizeof(row.eta), "DUE");
+      } else {
+        format_minutes(minutes, 'm', row.eta, sizeof(row.eta));
+      }
+      continue;
+    }
+    char text[12];
+    format_minutes(minutes, 'M', text, sizeof(text));
+    if (used > 0 && used + 1 < sizeof(row.etaExtra)) row.etaExtra[used++] = ' ';
+    for (const char *c = text; *c && used + 1 < sizeof(row.etaExtra); ++c) row.etaExtra[used++] = *c;
+    row.etaExtra[used] = '\0';
+  }
+
+  if (shown == 0) {
+    snprintf(row.eta, sizeof(row.eta), "--");
+  }
+  row.displayType = used > 0 ? 4 : 1;
+}
+
+uint32_t next_countdown_change_ms(const RowArrivals *arrivals, uint8_t rowCount, uint64_t nowEpochMs) {
+  int64_t next = 0;
+  for (uint8_t r = 0; arrivals && r < rowCount; ++r) {
+    if (!arrivals[r].enabled) continue;
+    for (uint8_t i = 0; i < arrivals[r].count && i < kMaxRowArrivals; ++i) {
+      const int64_t remaining = remaining_ms(arrivals[r].epochs[i], nowEpochMs);
+      if (departed(remaining)) continue;
+      // The minute count drops each time remaining crosses a whole minute;
+      // once it reaches zero the next change is the arrival leaving.
+      const int64_t change = remaining > 0
+                                 ? remaining - static_cast<int64_t>(minutes_until(remaining) - 1) * kMinuteMs
+                                 : remaining + static_cast<int64_t>(kArrivalGraceMs);
+      if (next == 0 || change < next) next = change;
+    }
+  }
+  return static_cast<uint32_t>(next);
+}
+
+}  // namespace core
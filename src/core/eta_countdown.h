@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "core/models.h"
+
+namespace core {
+
+constexpr uint8_t kMaxRowArrivals = 8;
+// An arrival stays on screen as DUE this long past its scheduled time.
+constexpr uint32_t kArrivalGraceMs = 60000;
+
+// Absolute arrival times for one row, in Unix seconds, soonest first. Rows
+// whose payload carried no arrivals[] are not enabled and keep server ETAs.
+struct RowArrivals {
+  bool enabled;
+  uint8_t count;
+  uint32_t epochs[kMaxRowArrivals];
+};
+
+// Writes row.eta, etaExtra and displayType as of nowEpochMs: the same text a
+// v2 etas[] list holding the rounded-up minutes would produce.
+void apply_countdown(const RowArrivals &arrivals, uint64_t nowEpochMs, TransitRowModel &row);
+
+// Milliseconds until apply_countdown() can next give a different result for
+// any enabled row, or 0 if none ever will.
+uint32_t next_countdown_change_ms(const RowArrivals *arrivals, uint8_t rowCount, uint64_t nowEpochMs);
+
+}  // namespace core
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "display/badge_renderer.h"
+#include "display/font_tables.h"
 
 namespace core {
 
@@ -138,13 +139,7 @@ int16_t estimate_compact_line_width(const char *text, uint8_t normalizedDisplayT
     return 0;
   }
 
-  const int16_t charW = compact_line_char_width(fontSize);
-  const int16_t spaceW = compact_line_space_advance(normalizedDisplayType, fontSize);
-  int16_t width = 0;
-  for (size_t i = 0; text[i] != '\0'; ++i) {
-    width = static_cast<int16_t>(width + (text[i] == ' ' ? spaceW : charW));
-  }
-  return width;
+  return display::font_line_width(text, fontSize, compact_line_space_advance(normalizedDisplayType, fontSize));
 }
 
 const char *primary_destination_line(const TransitRowModel &row, uint8_t /*normalizedDisplayType*/) {
@@ -220,7 +215,24 @@ const char *DrawList::copy_text(const char *text) {
   return dst;
 }
 
-LayoutEngine::LayoutEngine() : width_(128), height_(32) {}
+void DrawList::copy_from(const DrawList &other) {
+  if (&other == this) {
+    return;
+  }
+  memcpy(commands, other.commands, other.count * sizeof(DrawCommand));
+  memcpy(textPool, other.textPool, other.textUsed);
+  count = other.count;
+  textUsed = other.textUsed;
+  for (size_t i = 0; i < count; ++i) {
+    const char *text = commands[i].text;
+    if (text >= other.textPool && text < other.textPool + kTextPoolSize) {
+      commands[i].text = textPool + (text - other.textPool);
+    }
+  }
+}
+
+LayoutEngine::LayoutEngine()
+    : width_(128), height_(32), geometryCache_{}, geometryCacheHits_(0), geometryCacheMisses_(0) {}
 
 uint16_t LayoutEngine::eta_color_for_row(const TransitRowModel &row, UiState uiState) {
   return transit_service_color(row, uiState);
@@ -229,6 +241,18 @@ uint16_t LayoutEngine::eta_color_for_row(const TransitRowModel &row, UiState uiS
 void LayoutEngine::set_viewport(uint16_t width, uint16_t height) {
   width_ = width;
   height_ = height;
+  invalidate_geometry_cache();
+}
+
+void LayoutEngine::invalidate_geometry_cache() {
+  for (uint8_t i = 0; i < kMaxTransitRows; ++i) {
+    geometryCache_[i].valid = false;
+  }
+}
+
+void LayoutEngine::reset_geometry_cache_stats() {
+  geometryCacheHits_ = 0;
+  geometryCacheMisses_ = 0;
 }
 
 const char *LayoutEngine::trim_for_width(const char *src, uint8_t charLimit, DrawList &out) {
@@ -246,9 +270,55 @@ const char *LayoutEngine::trim_for_width(const char *src, uint8_t charLimit, Dra
   return out.copy_text(buf);
 }
 
+void LayoutEngine::make_geometry_key(const RenderModel &model, uint8_t rowIndex, GeometryKey &key) const {
+  memset(&key, 0, sizeof(key));
+  const TransitRowModel &row = model.rows[rowIndex];
+  key.width = width_;
+  key.height = height_;
+  key.modelDisplayType = model.displayType;
+  key.activeRows = model.activeRows;
+  key.rowDisplayType = row.displayType;
+  key.badgeShape = row.badgeShape;
+  memcpy(key.badgeText, row.badgeText, sizeof(key.badgeText));
+  key.etaLen = static_cast<uint8_t>(strnlen(row.eta, kMaxEtaLen - 1));
+  if (model.activeRows == 1 && normalize_display_type(row.displayType) <= 2) {
+    strncpy(key.destination, row.destination, sizeof(key.destination) - 1);
+  }
+}
+
 bool LayoutEngine::compute_transit_row_geometry(const RenderModel &model,
                                                 uint8_t rowIndex,
                                                 TransitRowGeometry &out) const {
+  const bool transitView =
+      model.hasData && (model.uiState == UiState::kTransit || model.uiState == UiState::kStaleTransit);
+  if (!transitView || rowIndex >= kMaxTransitRows) {
+    memset(&out, 0, sizeof(out));
+    return false;
+  }
+
+  GeometryKey key;
+  make_geometry_key(model, rowIndex, key);
+  GeometryCacheEntry &entry = geometryCache_[rowIndex];
+  if (entry.valid && memcmp(&entry.key, &key, sizeof(key)) == 0) {
+    ++geometryCacheHits_;
+    out = entry.geometry;
+    return true;
+  }
+
+  ++geometryCacheMisses_;
+  if (!compute_transit_row_geometry_uncached(model, rowIndex, out)) {
+    entry.valid = false;
+    return false;
+  }
+  memcpy(&entry.key, &key, sizeof(key));
+  entry.geometry = out;
+  entry.valid = true;
+  return true;
+}
+
+bool LayoutEngine::compute_transit_row_geometry_uncached(const RenderModel &model,
+                                                         uint8_t rowIndex,
+                                                         TransitRowGeometry &out) const {
   memset(&out, 0, sizeof(out));
 
   const bool transitView =
@@ -53,6 +53,8 @@ struct DrawList {
   }
 
   const char *copy_text(const char *text);
+  // Deep copy; text held in other's pool is re-pointed into this one.
+  void copy_from(const DrawList &other);
 };
 
 struct TransitRowGeometry {
@@ -91,15 +93,48 @@ class LayoutEngine final {
 
   void set_viewport(uint16_t width, uint16_t height);
   void build_transit_layout(const RenderModel &model, DrawList &out);
+  // Memoized per row: recomputed only when a layout-relevant input changes.
   bool compute_transit_row_geometry(const RenderModel &model, uint8_t rowIndex, TransitRowGeometry &out) const;
 
+  void invalidate_geometry_cache();
+  uint32_t geometry_cache_hits() const { return geometryCacheHits_; }
+  uint32_t geometry_cache_misses() const { return geometryCacheMisses_; }
+  void reset_geometry_cache_stats();
+
  private:
+  // Every input compute_transit_row_geometry() reads. Zero-filled before use
+  // so the whole struct can be compared with memcmp.
+  struct GeometryKey {
+    uint16_t width;
+    uint16_t height;
+    uint8_t modelDisplayType;
+    uint8_t activeRows;
+    uint8_t rowDisplayType;
+    uint8_t badgeShape;
+    char badgeText[5];
+    uint8_t etaLen;
+    char destination[kMaxDestinationLen];  // only set when the centered single-row layout measures it
+  };
+
+  struct GeometryCacheEntry {
+    bool valid;
+    GeometryKey key;
+    TransitRowGeometry geometry;
+  };
+
   uint16_t width_;
   uint16_t height_;
   VerticalLayoutEngine verticalLayout_;
   display::LayoutEngine rowLayout_;
+  mutable GeometryCacheEntry geometryCache_[kMaxTransitRows];
+  mutable uint32_t geometryCacheHits_;
+  mutable uint32_t geometryCacheMisses_;
 
   const char *trim_for_width(const char *src, uint8_t charLimit, DrawList &out);
+  void make_geometry_key(const RenderModel &model, uint8_t rowIndex, GeometryKey &key) const;
+  bool compute_transit_row_geometry_uncached(const RenderModel &model,
+                                             uint8_t rowIndex,
+                                             TransitRowGeometry &out) const;
 };
 
 }  // namespace core
@@ -0,0 +1,436 @@
+#include "core/log_ring.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace core {
+
+namespace {
+
+constexpr size_t kLenOffset = 0;
+constexpr size_t kMsOffset = 2;
+constexpr size_t kLevelOffset = 6;
+constexpr size_t kTagOffset = 7;
+constexpr size_t kFmtOffset = 8;
+constexpr size_t kHeaderLen = kFmtOffset + sizeof(const char *);
+constexpr size_t kMaxSpecLen = 24;
+
+// What one printf conversion consumes, after any '*' width/precision ints.
+enum class ArgKind : uint8_t {
+  kNone,  // "%%", or a conversion this ring does not support
+  kInt,
+  kLong,
+  kLongLong,
+  kUInt,
+  kULong,
+  kULongLong,
+  kSize,
+  kPtrDiff,
+  kIntMax,
+  kUIntMax,
+  kDouble,
+  kLongDouble,
+  kString,
+  kPointer,
+};
+
+struct Spec {
+  size_t len;           // '%' through the conversion character
+  uint8_t stars;        // '*' width/precision ints consumed before the value
+  bool starPrecision;   // the last star is the precision
+  int precision;        // literal precision, or -1
+  ArgKind kind;
+};
+
+Spec parse_spec(const char *p) {
+  Spec spec{1, 0, false, -1, ArgKind::kNone};
+  const char *at = p + 1;
+  while (*at && strchr("-+ #0", *at)) ++at;
+  if (*at == '*') {
+    ++spec.stars;
+    ++at;
+  } else {
+    while (*at >= '0' && *at <= '9') ++at;
+  }
+  if (*at == '.') {
+    ++at;
+    if (*at == '*') {
+      ++spec.stars;
+      spec.starPrecision = true;
+      ++at;
+    } else {
+      spec.precision = 0;
+      while (*at >= '0' && *at <= '9') spec.precision = spec.precision * 10 + (*at++ - '0');
+    }
+  }
+
+  char length[3] = {};
+  for (uint8_t i = 0; i < 2 && *at && strchr("hljztL", *at); ++i) length[i] = *at++;
+  const bool isLong = strcmp(length, "l") == 0;
+  const bool isLongLong = strcmp(length, "ll") == 0;
+  const char conversion = *at;
+  spec.len = conversion ? static_cast<size_t>(at - p) + 1 : static_cast<size_t>(at - p);
+
+  switch (conversion) {
+    case 'd':
+    case 'i':
+      spec.kind = isLongLong       ? ArgKind::kLongLong
+                  : isLong         ? ArgKind::kLong
+                  : length[0] == 'z' ? ArgKind::kSize
+                  : length[0] == 't' ? ArgKind::kPtrDiff
+                  : length[0] == 'j' ? ArgKind::kIntMax
+                                   : ArgKind::kInt;
+      break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+      spec.kind = isLongLong       ? ArgKind::kULongLong
+                  : isLong         ? ArgKind::kULong
+                  : length[0] == 'z' ? ArgKind::kSize
+                  : length[0] == 't' ? ArgKind::kPtrDiff
+                  : length[0] == 'j' ? ArgKind::kUIntMax
+                                   : ArgKind::kUInt;
+      break;
+    case 'c':
+      spec.kind = ArgKind::kInt;
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      spec.kind = length[0] == 'L' ? ArgKind::kLongDouble : ArgKind::kDouble;
+      break;
+    case 's':
+      spec.kind = ArgKind::kString;
+      break;
+    case 'p':
+      spec.kind = ArgKind::kPointer;
+      break;
+    default:
+      break;
+  }
+  return spec;
+}
+
+class Packer {
+ public:
+  Packer(uint8_t *out, size_t cap) : out_(out), cap_(cap), len_(0), full_(false) {}
+
+  template <typename T>
+  void put(T value) {
+    if (full_ || cap_ - len_ < sizeof(T)) {
+      full_ = true;
+      return;
+    }
+    memcpy(out_ + len_, &value, sizeof(T));
+    len_ += sizeof(T);
+  }
+
+  // [u16 n][n bytes][NUL], cut short to whatever room is left.
+  void put_string(const char *text, int precision) {
+    if (!text) text = "(null)";
+    if (full_ || cap_ - len_ < sizeof(uint16_t) + 1) {
+      full_ = true;
+      return;
+    }
+    size_t limit = cap_ - len_ - sizeof(uint16_t) - 1;
+    if (precision >= 0 && static_cast<size_t>(precision) < limit) limit = static_cast<size_t>(precision);
+    const uint16_t n = static_cast<uint16_t>(strnlen(text, limit));
+    put(n);
+    memcpy(out_ + len_, text, n);
+    out_[len_ + n] = '\0';
+    len_ += n + 1U;
+  }
+
+  size_t len() const { return len_; }
+
+ private:
+  uint8_t *out_;
+  size_t cap_;
+  size_t len_;
+  bool full_;
+};
+
+class Unpacker {
+ public:
+  Unpacker(const uint8_t *in, size_t len) : in_(in), len_(len), at_(0) {}
+
+  template <typename T>
+  bool get(T &value) {
+    if (len_ - at_ < sizeof(T)) return false;
+    memcpy(&value, in_ + at_, sizeof(T));
+    at_ += sizeof(T);
+    return true;
+  }
+
+  bool get_string(const char *&text) {
+    uint16_t n = 0;
+    if (!get(n) || len_ - at_ < n + 1U) return false;
+    text = reinterpret_cast<const char *>(in_ + at_);
+    at_ += n + 1U;
+    return true;
+  }
+
+ private:
+  const uint8_t *in_;
+  size_t len_;
+  size_t at_;
+};
+
+template <typename T>
+int format_one(char *out, size_t outLen, const char *spec, const int *stars, uint8_t starCount, T value) {
+  switch (starCount) {
+    case 0:
+      return snprintf(out, outLen, spec, value);
+    case 1:
+      return snprintf(out, outLen, spec, stars[0], value);
+    default:
+      return snprintf(out, outLen, spec, stars[0], stars[1], value);
+  }
+}
+
+template <typename T>
+bool unpack_and_format(Unpacker &in, char *out, size_t outLen, const char *spec, const int *stars, uint8_t starCount,
+                       int &written) {
+  T value{};
+  if (!in.get(value)) return false;
+  written = format_one(out, outLen, spec, stars, starCount, value);
+  return true;
+}
+
+}  // namespace
+
+LogRing::LogRing() : head_(0), used_(0), dropped_(0), droppedReported_(0), tags_{}, tagCount_(0) {}
+
+size_t LogRing::encode(uint32_t ms, uint8_t level, const char *fmt, va_list args, uint8_t *record) {
+  memcpy(record + kMsOffset, &ms, sizeof(ms));
+  record[kLevelOffset] = level;
+  record[kTagOffset] = kUnknownTag;
+  memcpy(record + kFmtOffset, &fmt, sizeof(fmt));
+
+  Packer packer(record + kHeaderLen, kMaxRecordLen - kHeaderLen);
+  for (const char *p = fmt; *p; ++p) {
+    if (*p != '%') continue;
+    const Spec spec = parse_spec(p);
+    int precision = spec.precision;
+    for (uint8_t i = 0; i < spec.stars; ++i) {
+      const int star = va_arg(args, int);
+      packer.put(star);
+      if (spec.starPrecision && i + 1 == spec.stars) precision = star;
+    }
+    switch (spec.kind) {
+      case ArgKind::kInt:
+        packer.put(va_arg(args, int));
+        break;
+      case ArgKind::kLong:
+        packer.put(va_arg(args, long));
+        break;
+      case ArgKind::kLongLong:
+        packer.put(va_arg(args, long long));
+        break;
+      case ArgKind::kUInt:
+        packer.put(va_arg(args, unsigned));
+        break;
+      case ArgKind::kULong:
+        packer.put(va_arg(args, unsigned long));
+        break;
+      case ArgKind::kULongLong:
+        packer.put(va_arg(args, unsigned long long));
+        break;
+      case ArgKind::kSize:
+        packer.put(va_arg(args, size_t));
+        break;
+      case ArgKind::kPtrDiff:
+        packer.put(va_arg(args, ptrdiff_t));
+        break;
+      case ArgKind::kIntMax:
+        packer.put(va_arg(args, intmax_t));
+        break;
+      case ArgKind::kUIntMax:
+        packer.put(va_arg(args, uintmax_t));
+        break;
+      case ArgKind::kDouble:
+        packer.put(va_arg(args, double));
+        break;
+      case ArgKind::kLongDouble:
+        packer.put(va_arg(args, long double));
+        break;
+      case ArgKind::kString:
+        packer.put_string(va_arg(args, const char *), precision);
+        break;
+      case ArgKind::kPointer:
+        packer.put(va_arg(args, void *));
+        break;
+      case ArgKind::kNone:
+        break;
+    }
+    p += spec.len - 1;
+  }
+
+  const uint16_t len = static_cast<uint16_t>(kHeaderLen + packer.len());
+  memcpy(record + kLenOffset, &len, sizeof(len));
+  return len;
+}
+
+bool LogRing::push(uint8_t *record, size_t len, const char *tag) {
+  if (len < kHeaderLen || len > kMaxRecordLen || kCapacity - used_ < len) {
+    ++dropped_;
+    return false;
+  }
+  record[kTagOffset] = tag_id(tag);
+  write_bytes((head_ + used_) % kCapacity, record, len);
+  used_ += len;
+  return true;
+}
+
+size_t LogRing::pop(uint8_t *record) {
+  if (used_ == 0) return 0;
+  uint16_t len = 0;
+  read_bytes(head_, &len, sizeof(len));
+  read_bytes(head_, record, len);
+  head_ = (head_ + len) % kCapacity;
+  used_ -= len;
+  return len;
+}
+
+void LogRing::format(const uint8_t *record, size_t len, Entry &entry, char *out, size_t outLen) const {
+  const char *fmt = nullptr;
+  memcpy(&entry.ms, record + kMsOffset, sizeof(entry.ms));
+  entry.level = record[kLevelOffset];
+  entry.tag = tag_name(record[kTagOffset]);
+  memcpy(&fmt, record + kFmtOffset, sizeof(fmt));
+  if (outLen == 0) return;
+  out[0] = '\0';
+
+  Unpacker in(record + kHeaderLen, len - kHeaderLen);
+  size_t used = 0;
+  for (const char *p = fmt; *p && used + 1 < outLen;) {
+    if (*p != '%') {
+      out[used++] = *p++;
+      continue;
+    }
+    const Spec spec = parse_spec(p);
+    if (spec.kind == ArgKind::kNone && spec.stars == 0) {
+      if (p[1] == '%') {
+        out[used++] = '%';
+        p += 2;
+      } else {
+        out[used++] = *p++;
+      }
+      continue;
+    }
+
+    int stars[2] = {};
+    bool ok = spec.len < kMaxSpecLen;
+    for (uint8_t i = 0; ok && i < spec.stars; ++i) ok = in.get(stars[i]);
+    char specText[kMaxSpecLen];
+    if (ok) {
+      memcpy(specText, p, spec.len);
+      specText[spec.len] = '\0';
+    }
+
+    int written = 0;
+    char *dst = out + used;
+    const size_t room = outLen - used;
+    switch (ok ? spec.kind : ArgKind::kNone) {
+      case ArgKind::kInt:
+        ok = unpack_and_format<int>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kLong:
+        ok = unpack_and_format<long>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kLongLong:
+        ok = unpack_and_format<long long>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kUInt:
+        ok = unpack_and_format<unsigned>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kULong:
+        ok = unpack_and_format<unsigned long>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kULongLong:
+        ok = unpack_and_format<unsigned long long>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kSize:
+        ok = unpack_and_format<size_t>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kPtrDiff:
+        ok = unpack_and_format<ptrdiff_t>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kIntMax:
+        ok = unpack_and_format<intmax_t>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kUIntMax:
+        ok = unpack_and_format<uintmax_t>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kDouble:
+        ok = unpack_and_format<double>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kLongDouble:
+        ok = unpack_and_format<long double>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kString: {
+        const char *text = nullptr;
+        ok = in.get_string(text);
+        if (ok) written = format_one(dst, room, specText, stars, spec.stars, text);
+        break;
+      }
+      case ArgKind::kPointer:
+        ok = unpack_and_format<void *>(in, dst, room, specText, stars, spec.stars, written);
+        break;
+      case ArgKind::kNone:
+        ok = false;
+        break;
+    }
+    // Arguments cut off at encode time end the message here.
+    if (!ok || written < 0) break;
+    used += static_cast<size_t>(written) < room ? static_cast<size_t>(written) : room - 1;
+    p += spec.len;
+  }
+  out[used] = '\0';
+}
+
+uint32_t LogRing::take_dropped() {
+  const uint32_t fresh = dropped_ - droppedReported_;
+  droppedReported_ = dropped_;
+  return fresh;
+}
+
+uint8_t LogRing::tag_id(const char *tag) {
+  for (uint8_t i = 0; i < tagCount_; ++i) {
+    if (tags_[i] == tag) return i;
+  }
+  // The same tag literal can live at different addresses in different files.
+  for (uint8_t i = 0; i < tagCount_; ++i) {
+    if (strcmp(tags_[i], tag) == 0) return i;
+  }
+  if (tagCount_ == kMaxTags) return kUnknownTag;
+  tags_[tagCount_] = tag;
+  return tagCount_++;
+}
+
+const char *LogRing::tag_name(uint8_t id) const {
+  return id < tagCount_ ? tags_[id] : "?";
+}
+
+void LogRing::write_bytes(size_t at, const void *src, size_t len) {
+  const uint8_t *from = static_cast<const uint8_t *>(src);
+  const size_t firstPart = len < kCapacity - at ? len : kCapacity - at;
+  memcpy(bytes_ + at, from, firstPart);
+  memcpy(bytes_, from + firstPart, len - firstPart);
+}
+
+void LogRing::read_bytes(size_t at, void *dst, size_t len) const {
+  uint8_t *to = static_cast<uint8_t *>(dst);
+  const size_t firstPart = len < kCapacity - at ? len : kCapacity - at;
+  memcpy(to, bytes_ + at, firstPart);
+  memcpy(to + firstPart, bytes_, len - firstPart);
+}
+
+}  // namespace core
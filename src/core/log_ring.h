@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+// Deferred printf: log lines are stored as binary records and only formatted
+// when drained, so the caller never waits on the serial port.
+//
+// Record: [u16 len][u32 ms][u8 level][u8 tag id][fmt pointer][packed args].
+// The format pointer doubles as the format id; it must point at a string
+// literal (or anything else that outlives the record). Arguments are packed
+// by walking the format with the caller's va_list, so the stored bytes are
+// exactly what the printf conversions consumed. %s arguments are copied,
+// honouring any precision, and truncated when the record would exceed
+// kMaxRecordLen.
+//
+// encode() and format() touch no ring state and run outside any lock; the
+// caller serializes push() and pop().
+class LogRing final {
+ public:
+  static constexpr size_t kCapacity = 8192;
+  static constexpr size_t kMaxRecordLen = 320;
+  static constexpr uint8_t kMaxTags = 32;
+  static constexpr uint8_t kUnknownTag = 0xFF;
+
+  struct Entry {
+    uint32_t ms;
+    uint8_t level;
+    const char *tag;
+  };
+
+  LogRing();
+
+  // Builds a record in record[kMaxRecordLen]. Returns its length.
+  static size_t encode(uint32_t ms, uint8_t level, const char *fmt, va_list args, uint8_t *record);
+
+  // Interns tag into the record and appends it. False (and the line counted
+  // as dropped) when the ring has no room.
+  bool push(uint8_t *record, size_t len, const char *tag);
+
+  // Moves the oldest record into record[kMaxRecordLen]. Returns its length,
+  // or 0 when empty.
+  size_t pop(uint8_t *record);
+
+  // Formats a popped record's message into out, always NUL-terminated.
+  void format(const uint8_t *record, size_t len, Entry &entry, char *out, size_t outLen) const;
+
+  bool empty() const { return used_ == 0; }
+  size_t used() const { return used_; }
+  uint32_t dropped() const { return dropped_; }
+  // Dropped-line count since the last call, for the drainer to report.
+  uint32_t take_dropped();
+
+ private:
+  uint8_t tag_id(const char *tag);
+  const char *tag_name(uint8_t id) const;
+  void write_bytes(size_t at, const void *src, size_t len);
+  void read_bytes(size_t at, void *dst, size_t len) const;
+
+  uint8_t bytes_[kCapacity];
+  size_t head_;
+  size_t used_;
+  uint32_t dropped_;
+  uint32_t droppedReported_;
+  const char *tags_[kMaxTags];
+  uint8_t tagCount_;
+};
+
+}  // namespace core
@@ -0,0 +1,100 @@
+#include "core/logging.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+
+#include "core/log_ring.h"
+
+namespace core::logging {
+
+namespace {
+
+constexpr uint32_t kDrainTaskStackBytes = 4096;
+constexpr uint32_t kDrainIdleMs = 10;
+constexpr size_t kMaxLineLen = 512;
+
+const char *const kLevelNames[] = {"DBG", "INF", "WRN", "ERR"};
+
+LogRing gRing;
+portMUX_TYPE gRingLock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t gDrainTask = nullptr;
+
+// Prints one queued line. False when the ring was empty.
+bool drain_one() {
+  uint8_t record[LogRing::kMaxRecordLen];
+  portENTER_CRITICAL(&gRingLock);
+  const size_t len = gRing.pop(record);
+  const uint32_t dropped = gRing.take_dropped();
+  portEXIT_CRITICAL(&gRingLock);
+
+  if (dropped > 0) {
+    Serial.printf(DCTRL_LOG_PREFIX "[%010lu][WRN][LOG] %lu lines dropped; log ring full\n",
+                  static_cast<unsigned long>(millis()),
+                  static_cast<unsigned long>(dropped));
+  }
+  if (len == 0) return false;
+
+  LogRing::Entry entry{};
+  char line[kMaxLineLen];
+  gRing.format(record, len, entry, line, sizeof(line));
+  Serial.printf(DCTRL_LOG_PREFIX "[%010lu][%s][%s] %s\n",
+                static_cast<unsigned long>(entry.ms),
+                entry.level <= kLevelError ? kLevelNames[entry.level] : "???",
+                entry.tag,
+                line);
+  return true;
+}
+
+void drain_task_entry(void *) {
+  for (;;) {
+    while (drain_one()) {
+    }
+    vTaskDelay(pdMS_TO_TICKS(kDrainIdleMs));
+  }
+}
+
+}  // namespace
+
+void write(uint8_t level, const char *tag, const char *fmt, ...) {
+  uint8_t record[LogRing::kMaxRecordLen];
+  va_list args;
+  va_start(args, fmt);
+  const size_t len = LogRing::encode(millis(), level, fmt, args, record);
+  va_end(args);
+
+  portENTER_CRITICAL(&gRingLock);
+  gRing.push(record, len, tag);
+  portEXIT_CRITICAL(&gRingLock);
+}
+
+bool start_drain_task() {
+  if (gDrainTask) return true;
+  const BaseType_t created = xTaskCreatePinnedToCore(&drain_task_entry,
+                                                     "log",
+                                                     kDrainTaskStackBytes,
+                                                     nullptr,
+                                                     tskIDLE_PRIORITY,
+                                                     &gDrainTask,
+                                                     tskNO_AFFINITY);
+  if (created != pdPASS) {
+    gDrainTask = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void flush() {
+  while (drain_one()) {
+  }
+  Serial.flush();
+}
+
+uint32_t dropped_lines() {
+  portENTER_CRITICAL(&gRingLock);
+  const uint32_t dropped = gRing.dropped();
+  portEXIT_CRITICAL(&gRingLock);
+  return dropped;
+}
+
+}  // namespace core::logging
@@ -1,12 +1,39 @@
 #pragma once
 
+#include <stdint.h>
 #include <string.h>
 
 #include <Arduino.h>
 #include <WiFi.h>
 
+// Lines below this level compile to nothing: 0 debug, 1 info, 2 warn, 3 error.
+#ifndef DCTRL_LOG_LEVEL
+#define DCTRL_LOG_LEVEL 0
+#endif
+
 namespace core::logging {
 
+enum : uint8_t {
+  kLevelDebug,
+  kLevelInfo,
+  kLevelWarn,
+  kLevelError,
+};
+
+// Queues one line in the binary log ring and returns without touching the
+// serial port. fmt must be a string literal; the line is formatted later by
+// the drain task.
+void write(uint8_t level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+// Starts the idle-priority task that prints queued lines. Until it runs,
+// lines wait in the ring (or are dropped once it is full).
+bool start_drain_task();
+
+// Prints everything queued from the calling task; call before a restart.
+void flush();
+
+uint32_t dropped_lines();
+
 inline const char *bool_str(bool value) {
   return value ? "true" : "false";
 }
@@ -51,14 +78,30 @@ inline const char *wifi_status_name(int status) {
 }  // namespace core::logging
 
 #define DCTRL_LOG_PREFIX "[DCTRL]"
-#define DCTRL_LOG(level, tag, fmt, ...)                                                               \
-  Serial.printf(DCTRL_LOG_PREFIX "[%010lu][%s][%s] " fmt "\n",                                       \
-                static_cast<unsigned long>(millis()),                                                 \
-                level,                                                                                \
-                tag,                                                                                  \
-                ##__VA_ARGS__)
-
-#define DCTRL_LOGD(tag, fmt, ...) DCTRL_LOG("DBG", tag, fmt, ##__VA_ARGS__)
-#define DCTRL_LOGI(tag, fmt, ...) DCTRL_LOG("INF", tag, fmt, ##__VA_ARGS__)
-#define DCTRL_LOGW(tag, fmt, ...) DCTRL_LOG("WRN", tag, fmt, ##__VA_ARGS__)
-#define DCTRL_LOGE(tag, fmt, ...) DCTRL_LOG("ERR", tag, fmt, ##__VA_ARGS__)
+#define DCTRL_LOG(level, tag, fmt, ...) ::core::logging::write(level, tag, fmt, ##__VA_ARGS__)
+// Keeps arguments type-checked and "used" while generating no code.
+#define DCTRL_LOG_DISCARD(tag, fmt, ...)              \
+  do {                                                \
+    if (false) DCTRL_LOG(0, tag, fmt, ##__VA_ARGS__); \
+  } while (0)
+
+#if DCTRL_LOG_LEVEL <= 0
+#define DCTRL_LOGD(tag, fmt, ...) DCTRL_LOG(::core::logging::kLevelDebug, tag, fmt, ##__VA_ARGS__)
+#else
+#define DCTRL_LOGD(tag, fmt, ...) DCTRL_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#endif
+#if DCTRL_LOG_LEVEL <= 1
+#define DCTRL_LOGI(tag, fmt, ...) DCTRL_LOG(::core::logging::kLevelInfo, tag, fmt, ##__VA_ARGS__)
+#else
+#define DCTRL_LOGI(tag, fmt, ...) DCTRL_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#endif
+#if DCTRL_LOG_LEVEL <= 2
+#define DCTRL_LOGW(tag, fmt, ...) DCTRL_LOG(::core::logging::kLevelWarn, tag, fmt, ##__VA_ARGS__)
+#else
+#define DCTRL_LOGW(tag, fmt, ...) DCTRL_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#endif
+#if DCTRL_LOG_LEVEL <= 3
+#define DCTRL_LOGE(tag, fmt, ...) DCTRL_LOG(::core::logging::kLevelError, tag, fmt, ##__VA_ARGS__)
+#else
+#define DCTRL_LOGE(tag, fmt, ...) DCTRL_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#endif
@@ -1,7 +1,6 @@
 #include "core/mqtt_client.h"
 
 #include <WiFi.h>
-#include <lwip/sockets.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -16,15 +15,24 @@
 
 namespace core {
 
-MqttClient *MqttClient::activeInstance_ = nullptr;
-
 namespace {
 constexpr uint32_t kRetryBaseMs = 1000;
 constexpr uint32_t kRetryMaxMs = 60000;
 constexpr uint32_t kRetryJitterMs = 750;
 constexpr int kUnknownWifiStatus = 999;
-constexpr int kUnknownMqttState = 999;
 constexpr size_t kMqttPublishHeaderReserve = 7;
+constexpr uint16_t kKeepAliveSec = 60;
+constexpr uint32_t kDnsTimeoutMs = 5000;
+constexpr uint32_t kTcpConnectTimeoutMs = 5000;
+constexpr uint32_t kConnackTimeoutMs = 5000;
+constexpr uint32_t kSubackTimeoutMs = 5000;
+// Payload bytes handed to the socket per tick while draining the queue, so a
+// reconnect backlog goes out over several ticks instead of in one burst.
+constexpr size_t kDrainBytesPerTick = 1024;
+
+static_assert(mqtt::Connection::kRxBufferLen >= kMaxMqttPacketLen, "inbound commands must fit the rx buffer");
+static_assert(mqtt::Connection::kTxBufferLen >= kMaxMqttPacketLen, "outbound packets must fit the tx buffer");
+static_assert(PublishQueue::kMaxPayloadLen >= kMaxPayloadLen, "queued payloads must hold a full device log");
 
 uint32_t bounded_backoff(uint8_t attempt) {
   uint32_t waitMs = kRetryBaseMs;
@@ -43,36 +51,41 @@ uint32_t bounded_backoff(uint8_t attempt) {
   return waitMs + jitter;
 }
 
-const char *mqtt_state_name(int state) {
-  switch (state) {
-    case MQTT_CONNECTION_TIMEOUT:
-      return "MQTT_CONNECTION_TIMEOUT";
-    case MQTT_CONNECTION_LOST:
-      return "MQTT_CONNECTION_LOST";
-    case MQTT_CONNECT_FAILED:
-      return "MQTT_CONNECT_FAILED";
-    case MQTT_DISCONNECTED:
-      return "MQTT_DISCONNECTED";
-    case MQTT_CONNECTED:
-      return "MQTT_CONNECTED";
-    case MQTT_CONNECT_BAD_PROTOCOL:
-      return "MQTT_CONNECT_BAD_PROTOCOL";
-    case MQTT_CONNECT_BAD_CLIENT_ID:
-      return "MQTT_CONNECT_BAD_CLIENT_ID";
-    case MQTT_CONNECT_UNAVAILABLE:
-      return "MQTT_CONNECT_UNAVAILABLE";
-    case MQTT_CONNECT_BAD_CREDENTIALS:
-      return "MQTT_CONNECT_BAD_CREDENTIALS";
-    case MQTT_CONNECT_UNAUTHORIZED:
-      return "MQTT_CONNECT_UNAUTHORIZED";
+const char *connack_code_name(int code) {
+  switch (code) {
+    case 1:
+      return "BAD_PROTOCOL";
+    case 2:
+      return "BAD_CLIENT_ID";
+    case 3:
+      return "UNAVAILABLE";
+    case 4:
+      return "BAD_CREDENTIALS";
+    case 5:
+      return "UNAUTHORIZED";
+    default:
+      return "-";
+  }
+}
+
+const char *publish_label(PublishKind kind) {
+  switch (kind) {
+    case PublishKind::kPresence:
+      return "presence";
+    case PublishKind::kState:
+      return "state";
+    case PublishKind::kEvent:
+      return "event";
+    case PublishKind::kLog:
+      return "logs";
     default:
-      return "MQTT_UNKNOWN";
+      return "telemetry";
   }
 }
 
 bool is_verbose_publish_label(const char *label) {
   const char *safeLabel = core::logging::safe_str(label);
-  return strcmp(safeLabel, "state") == 0 || strcmp(safeLabel, "heartbeat") == 0;
+  return strcmp(safeLabel, "state") == 0;
 }
 
 }  // namespace
@@ -80,36 +93,27 @@ bool is_verbose_publish_label(const char *label) {
 MqttClient::MqttClient()
     : config_{},
       topics_{},
-      wifiClient_(),
-      mqtt_(wifiClient_),
-      connected_(false),
+      connection_(),
       nextRetryAtMs_(0),
+      attemptStartedAtMs_(0),
       retryCount_(0),
       lastWifiStatus_(kUnknownWifiStatus),
-      lastMqttState_(kUnknownMqttState),
-      lastTransportConnected_(false),
+      lastState_(mqtt::Connection::State::kIdle),
       commandCallback_(nullptr),
       commandCtx_(nullptr) {}
 
 bool MqttClient::begin(const MqttConfig &config, const MqttTopics &topics) {
+  connection_.drop();
   config_ = config;
   topics_ = topics;
-  connected_ = false;
   nextRetryAtMs_ = 0;
   retryCount_ = 0;
   lastWifiStatus_ = kUnknownWifiStatus;
-  lastMqttState_ = kUnknownMqttState;
-  lastTransportConnected_ = false;
+  lastState_ = mqtt::Connection::State::kIdle;
 
-  mqtt_.setServer(config_.host, config_.port);
-  const bool bufferOk = mqtt_.setBufferSize(kMaxMqttPacketLen);
-  mqtt_.setKeepAlive(60);
-  mqtt_.setSocketTimeout(5);
-
-  activeInstance_ = this;
-  mqtt_.setCallback(&MqttClient::global_on_message);
+  connection_.set_message_callback(&MqttClient::on_connection_message, this);
   DCTRL_LOGI("MQTT",
-             "Configured broker host=%s port=%u clientId=%s auth=%s stateTopic=%s commandTopic=%s packetBuffer=%u payloadLimit=%u bufferOk=%s",
+             "Configured broker host=%s port=%u clientId=%s auth=%s stateTopic=%s commandTopic=%s packetBuffer=%u payloadLimit=%u",
              core::logging::safe_str(config_.host),
              static_cast<unsigned>(config_.port),
              core::logging::safe_str(config_.clientId),
@@ -117,43 +121,18 @@ bool MqttClient::begin(const MqttConfig &config, const MqttTopics &topics) {
              topics_.state,
              topics_.command,
              static_cast<unsigned>(kMaxMqttPacketLen),
-             static_cast<unsigned>(kMaxPayloadLen),
-             core::logging::bool_str(bufferOk));
+             static_cast<unsigned>(kMaxPayloadLen));
   return true;
 }
 
 void MqttClient::tick(uint32_t nowMs) {
-  ensure_connected(nowMs);
-  if (connected_) {
-    const bool loopOk = mqtt_.loop();
-    const bool transportConnected = mqtt_.connected();
-    const int mqttState = mqtt_.state();
-    if (mqttState != lastMqttState_) {
-      DCTRL_LOGI("MQTT", "Loop state update transport=%s rc=%d (%s)",
-                 core::logging::bool_str(transportConnected),
-                 mqttState,
-                 mqtt_state_name(mqttState));
-      lastMqttState_ = mqttState;
-    }
-    if (lastTransportConnected_ && !transportConnected) {
-      DCTRL_LOGW("MQTT",
-                 "Connection dropped during loop wifi=%s rc=%d (%s) ip=%s rssi=%d",
-                 core::logging::wifi_status_name(WiFi.status()),
-                 mqttState,
-                 mqtt_state_name(mqttState),
-                 WiFi.localIP().toString().c_str(),
-                 WiFi.RSSI());
-      connected_ = false;
-    }
-    lastTransportConnected_ = transportConnected;
-    if (!loopOk && !transportConnected) {
-      connected_ = false;
-    }
+  if (ensure_connected(nowMs) && !queue_.empty()) {
+    queue_.drain(&MqttClient::send_queued, this, kDrainBytesPerTick);
   }
 }
 
 bool MqttClient::connected() {
-  return connected_ && mqtt_.connected();
+  return connection_.connected();
 }
 
 bool MqttClient::ensure_connected(uint32_t nowMs) {
@@ -166,58 +145,33 @@ bool MqttClient::ensure_connected(uint32_t nowMs) {
   }
 
   if (wifiStatus != WL_CONNECTED) {
-    if (connected_ || lastTransportConnected_) {
-      DCTRL_LOGW("MQTT", "Skipping broker connect because WiFi is %s (%d)",
+    if (!connection_.idle()) {
+      DCTRL_LOGW("MQTT", "Dropping broker session (%s) because WiFi is %s (%d)",
+                 mqtt::Connection::state_name(connection_.state()),
                  core::logging::wifi_status_name(wifiStatus),
                  wifiStatus);
+      connection_.drop();
     }
-    connected_ = false;
-    lastTransportConnected_ = false;
+    lastState_ = mqtt::Connection::State::kIdle;
     return false;
   }
 
-  const bool transportConnected = mqtt_.connected();
-  const int mqttState = mqtt_.state();
-  if (mqttState != lastMqttState_) {
-    DCTRL_LOGI("MQTT", "Broker rc=%d (%s) transport=%s",
-               mqttState,
-               mqtt_state_name(mqttState),
-               core::logging::bool_str(transportConnected));
-    lastMqttState_ = mqttState;
-  }
-
-  if (transportConnected) {
-    if (!connected_ || !lastTransportConnected_) {
-      DCTRL_LOGI("MQTT", "Broker session active host=%s port=%u clientId=%s ip=%s rssi=%d",
-                 core::logging::safe_str(config_.host),
-                 static_cast<unsigned>(config_.port),
-                 core::logging::safe_str(config_.clientId),
-                 WiFi.localIP().toString().c_str(),
-                 WiFi.RSSI());
-    }
-    connected_ = true;
-    lastTransportConnected_ = true;
-    retryCount_ = 0;
-    return true;
-  }
-
-  if (connected_ || lastTransportConnected_) {
-    DCTRL_LOGW("MQTT", "Transport disconnected while WiFi still up rc=%d (%s) ip=%s rssi=%d",
-               mqttState,
-               mqtt_state_name(mqttState),
-               WiFi.localIP().toString().c_str(),
-               WiFi.RSSI());
-  }
-  connected_ = false;
-  lastTransportConnected_ = false;
-  if (nowMs < nextRetryAtMs_) {
-    return false;
+  // Each step below is non-blocking; a connect attempt advances one phase
+  // per call instead of holding the loop until the broker answers.
+  bool started = false;
+  if (connection_.idle() && static_cast<int32_t>(nowMs - nextRetryAtMs_) >= 0) {
+    started = start_connect(nowMs);
   }
+  connection_.tick(nowMs);
+  log_transition(nowMs, started);
+  return connection_.connected();
+}
 
+bool MqttClient::start_connect(uint32_t nowMs) {
   const bool hasUser = config_.username[0] != '\0';
   const bool hasPass = config_.password[0] != '\0';
   DCTRL_LOGI("MQTT",
-             "Attempting broker connect host=%s port=%u clientId=%s authUser=%s authPass=%s attempt=%u ip=%s rssi=%d nextRetryAt=%lu",
+             "Attempting broker connect host=%s port=%u clientId=%s authUser=%s authPass=%s attempt=%u ip=%s rssi=%d",
              core::logging::safe_str(config_.host),
              static_cast<unsigned>(config_.port),
              core::logging::safe_str(config_.clientId),
@@ -225,80 +179,113 @@ bool MqttClient::ensure_connected(uint32_t nowMs) {
              core::logging::bool_str(hasPass),
              static_cast<unsigned>(retryCount_ + 1),
              WiFi.localIP().toString().c_str(),
-             WiFi.RSSI(),
-             static_cast<unsigned long>(nextRetryAtMs_));
+             WiFi.RSSI());
 
-  bool ok = false;
-  if (hasUser && hasPass) {
-    ok = mqtt_.connect(config_.clientId, config_.username, config_.password, topics_.presence, 0, true, "offline");
-  } else {
-    ok = mqtt_.connect(config_.clientId, topics_.presence, 0, true, "offline");
+  mqtt::Connection::Options options = mqtt::Connection::default_options();
+  options.host = config_.host;
+  options.port = config_.port;
+  options.connect.clientId = config_.clientId;
+  options.connect.username = hasUser && hasPass ? config_.username : nullptr;
+  options.connect.password = hasUser && hasPass ? config_.password : nullptr;
+  options.connect.willTopic = topics_.presence;
+  options.connect.willMessage = "offline";
+  options.connect.willRetain = true;
+  options.connect.keepAliveSec = kKeepAliveSec;
+  options.subscribeTopic = topics_.command;
+  options.birthTopic = topics_.presence;
+  options.birthPayload = "online";
+  options.birthRetain = true;
+  options.dnsTimeoutMs = kDnsTimeoutMs;
+  options.connectTimeoutMs = kTcpConnectTimeoutMs;
+  options.connackTimeoutMs = kConnackTimeoutMs;
+  options.subackTimeoutMs = kSubackTimeoutMs;
+
+  attemptStartedAtMs_ = nowMs;
+  if (!connection_.start(options, nowMs)) {
+    DCTRL_LOGE("MQTT", "Broker connect rejected host=%s port=%u",
+               core::logging::safe_str(config_.host),
+               static_cast<unsigned>(config_.port));
+    nextRetryAtMs_ = nowMs + bounded_backoff(retryCount_++);
+    return false;
   }
+  return true;
+}
 
-  if (ok) {
-    // Socket exists now — enable TCP keepalive to detect silent NAT deaths.
-    int keepAlive = 1;
-    wifiClient_.setSocketOption(SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(keepAlive));
-    int keepIdle = 60;
-    int keepIntvl = 15;
-    int keepCnt = 4;
-    wifiClient_.setOption(TCP_KEEPIDLE, &keepIdle);
-    wifiClient_.setOption(TCP_KEEPINTVL, &keepIntvl);
-    wifiClient_.setOption(TCP_KEEPCNT, &keepCnt);
-
-    connected_ = true;
-    retryCount_ = 0;
-    nextRetryAtMs_ = nowMs;
-    lastTransportConnected_ = true;
-    lastMqttState_ = mqtt_.state();
-    DCTRL_LOGI("MQTT", "Broker connect succeeded rc=%d (%s) commandTopic=%s presenceTopic=%s",
-               lastMqttState_,
-               mqtt_state_name(lastMqttState_),
+// startedNow is true when this tick began an attempt. Such an attempt can
+// fail before the state is ever seen leaving idle (a refused literal address,
+// a DNS answer that arrived before the tick), and still has to back off.
+void MqttClient::log_transition(uint32_t nowMs, bool startedNow) {
+  using State = mqtt::Connection::State;
+  const State state = connection_.state();
+  const bool failedOnStart =
+      startedNow && state == State::kIdle && connection_.error() != mqtt::Connection::Error::kNone;
+  if (state == lastState_ && !failedOnStart) {
+    return;
+  }
+  const State previous = lastState_;
+  lastState_ = state;
+
+  if (state == State::kConnected) {
+    DCTRL_LOGI("MQTT", "Broker session active host=%s port=%u clientId=%s commandTopic=%s presenceTopic=%s setupMs=%lu ip=%s rssi=%d",
+               core::logging::safe_str(config_.host),
+               static_cast<unsigned>(config_.port),
+               core::logging::safe_str(config_.clientId),
                topics_.command,
-               topics_.presence);
-
-    if (!mqtt_.subscribe(topics_.command)) {
-      DCTRL_LOGE("MQTT", "Subscribe failed topic=%s", topics_.command);
-    } else {
-      DCTRL_LOGI("MQTT", "Subscribed topic=%s", topics_.command);
-    }
+               topics_.presence,
+               static_cast<unsigned long>(nowMs - attemptStartedAtMs_),
+               WiFi.localIP().toString().c_str(),
+               WiFi.RSSI());
+    retryCount_ = 0;
+    return;
+  }
 
-    if (!publish_presence("online", true)) {
-      DCTRL_LOGE("MQTT", "Failed to publish initial online presence topic=%s", topics_.presence);
-    }
-    return true;
+  if (state != State::kIdle) {
+    DCTRL_LOGI("MQTT", "Connect phase %s -> %s",
+               mqtt::Connection::state_name(previous),
+               mqtt::Connection::state_name(state));
+    return;
   }
 
+  const mqtt::Connection::Error error = connection_.error();
+  const int detail = connection_.error_detail();
   const uint32_t waitMs = bounded_backoff(retryCount_);
   retryCount_++;
   nextRetryAtMs_ = nowMs + waitMs;
-  lastMqttState_ = mqtt_.state();
-  DCTRL_LOGW("MQTT", "Broker connect failed rc=%d (%s) retryInMs=%lu wifi=%s ip=%s rssi=%d",
-             lastMqttState_,
-             mqtt_state_name(lastMqttState_),
-             static_cast<unsigned long>(waitMs),
-             core::logging::wifi_status_name(WiFi.status()),
-             WiFi.localIP().toString().c_str(),
-             WiFi.RSSI());
-  return false;
+  if (previous == State::kConnected) {
+    DCTRL_LOGW("MQTT", "Connection dropped error=%s detail=%d retryInMs=%lu wifi=%s ip=%s rssi=%d",
+               mqtt::Connection::error_name(error),
+               detail,
+               static_cast<unsigned long>(waitMs),
+               core::logging::wifi_status_name(WiFi.status()),
+               WiFi.localIP().toString().c_str(),
+               WiFi.RSSI());
+  } else {
+    DCTRL_LOGW("MQTT", "Broker connect failed phase=%s error=%s detail=%d (%s) retryInMs=%lu wifi=%s ip=%s rssi=%d",
+               failedOnStart ? "start" : mqtt::Connection::state_name(previous),
+               mqtt::Connection::error_name(error),
+               detail,
+               error == mqtt::Connection::Error::kConnackRefused ? connack_code_name(detail) : "-",
+               static_cast<unsigned long>(waitMs),
+               core::logging::wifi_status_name(WiFi.status()),
+               WiFi.localIP().toString().c_str(),
+               WiFi.RSSI());
+  }
 }
 
 void MqttClient::disconnect(bool publishOffline) {
-  DCTRL_LOGI("MQTT", "Disconnect requested publishOffline=%s connected=%s rc=%d (%s)",
+  DCTRL_LOGI("MQTT", "Disconnect requested publishOffline=%s state=%s",
              core::logging::bool_str(publishOffline),
-             core::logging::bool_str(mqtt_.connected()),
-             mqtt_.state(),
-             mqtt_state_name(mqtt_.state()));
-  if (mqtt_.connected()) {
+             mqtt::Connection::state_name(connection_.state()));
+  if (connection_.connected()) {
     if (publishOffline) {
       publish_with_trace(topics_.presence, "offline", true, "presence");
     }
-    mqtt_.disconnect();
+    connection_.disconnect();
     DCTRL_LOGI("MQTT", "Broker session closed");
+  } else {
+    connection_.drop();
   }
-  connected_ = false;
-  lastTransportConnected_ = false;
-  lastMqttState_ = mqtt_.state();
+  lastState_ = mqtt::Connection::State::kIdle;
 }
 
 void MqttClient::set_command_callback(CommandCallback callback, void *ctx) {
@@ -307,27 +294,59 @@ void MqttClient::set_command_callback(CommandCallback callback, void *ctx) {
 }
 
 bool MqttClient::publish_state(const char *payload, bool retained) {
-  return publish_with_trace(topics_.state, payload, retained, "state");
+  return enqueue(PublishKind::kState, payload, retained);
 }
 
 bool MqttClient::publish_presence(const char *payload, bool retained) {
-  return publish_with_trace(topics_.presence, payload, retained, "presence");
-}
-
-bool MqttClient::publish_heartbeat(const char *payload) {
-  return publish_with_trace(topics_.heartbeat, payload, false, "heartbeat");
+  return enqueue(PublishKind::kPresence, payload, retained);
 }
 
 bool MqttClient::publish_event(const char *payload) {
-  return publish_with_trace(topics_.event, payload, false, "event");
+  return enqueue(PublishKind::kEvent, payload, false);
 }
 
 bool MqttClient::publish_telemetry(const char *payload) {
-  return publish_with_trace(topics_.telemetry, payload, false, "telemetry");
+  return enqueue(PublishKind::kTelemetry, payload, false);
 }
 
 bool MqttClient::publish_log(const char *payload) {
-  return publish_with_trace(topics_.logs, payload, false, "logs");
+  return enqueue(PublishKind::kLog, payload, false);
+}
+
+bool MqttClient::enqueue(PublishKind kind, const char *payload, bool retained) {
+  const char *safePayload = payload ? payload : "";
+  if (queue_.push(kind, safePayload, strlen(safePayload), retained)) {
+    return true;
+  }
+  DCTRL_LOGW("MQTT", "Publish queue refused %s payloadLen=%u pending=%u dropped=%lu",
+             publish_label(kind),
+             static_cast<unsigned>(strlen(safePayload)),
+             static_cast<unsigned>(queue_.pending()),
+             static_cast<unsigned long>(queue_.dropped()));
+  return false;
+}
+
+bool MqttClient::send_queued(const PublishQueue::Message &message, void *ctx) {
+  MqttClient *self = static_cast<MqttClient *>(ctx);
+  return self->publish_with_trace(self->topic_for(message.kind),
+                                  message.payload,
+                                  message.retained,
+                                  publish_label(message.kind));
+}
+
+const char *MqttClient::topic_for(PublishKind kind) const {
+  switch (kind) {
+    case PublishKind::kPresence:
+      return topics_.presence;
+    case PublishKind::kState:
+      return topics_.state;
+    case PublishKind::kEvent:
+      return topics_.event;
+    case PublishKind::kLog:
+      return topics_.logs;
+    default:
+      return topics_.telemetry;
+  }
 }
 
 bool MqttClient::build_default_topics(const char *deviceId, MqttTopics &outTopics) {
@@ -338,36 +357,32 @@ bool MqttClient::build_default_topics(const char *deviceId, MqttTopics &outTopic
   const int s = snprintf(outTopics.state, sizeof(outTopics.state), "device/%s/state", deviceId);
   const int p = snprintf(outTopics.presence, sizeof(outTopics.presence), "device/%s/presence", deviceId);
   const int c = snprintf(outTopics.command, sizeof(outTopics.command), "device/%s/commands", deviceId);
-  const int h = snprintf(outTopics.heartbeat, sizeof(outTopics.heartbeat), "device/%s/heartbeat", deviceId);
   const int e = snprintf(outTopics.event, sizeof(outTopics.event), "device/%s/event", deviceId);
   const int t = snprintf(outTopics.telemetry, sizeof(outTopics.telemetry), "device/%s/telemetry", deviceId);
   const int l = snprintf(outTopics.logs, sizeof(outTopics.logs), "device/%s/logs", deviceId);
 
-  return s > 0 && p > 0 && c > 0 && h > 0 && e > 0 && t > 0 && l > 0 &&
+  return s > 0 && p > 0 && c > 0 && e > 0 && t > 0 && l > 0 &&
          s < static_cast<int>(sizeof(outTopics.state)) &&
          p < static_cast<int>(sizeof(outTopics.presence)) &&
          c < static_cast<int>(sizeof(outTopics.command)) &&
-         h < static_cast<int>(sizeof(outTopics.heartbeat)) &&
          e < static_cast<int>(sizeof(outTopics.event)) &&
          t < static_cast<int>(sizeof(outTopics.telemetry)) &&
          l < static_cast<int>(sizeof(outTopics.logs));
 }
 
-void MqttClient::global_on_message(char *topic, uint8_t *payload, unsigned int len) {
-  if (!activeInstance_) {
-    return;
-  }
-  activeInstance_->on_message(topic, payload, len);
+void MqttClient::on_connection_message(const char *topic, const uint8_t *payload, size_t len, void *ctx) {
+  static_cast<MqttClient *>(ctx)->on_message(topic, payload, len);
 }
 
-void MqttClient::on_message(char *topic, uint8_t *payload, unsigned int len) {
+void MqttClient::on_message(const char *topic, const uint8_t *payload, size_t len) {
   if (!commandCallback_) {
     DCTRL_LOGW("MQTT", "Dropping incoming topic=%s len=%u because no command callback is registered",
                core::logging::safe_str(topic),
-               len);
+               static_cast<unsigned>(len));
     return;
   }
-  DCTRL_LOGI("MQTT", "Dispatching incoming topic=%s len=%u", core::logging::safe_str(topic), len);
+  DCTRL_LOGI("MQTT", "Dispatching incoming topic=%s len=%u", core::logging::safe_str(topic),
+             static_cast<unsigned>(len));
   commandCallback_(topic, payload, len, commandCtx_);
 }
 
@@ -397,7 +412,7 @@ bool MqttClient::publish_with_trace(const char *topic, const char *payload, bool
     return false;
   }
 
-  const bool ok = mqtt_.publish(safeTopic, safePayload, retained);
+  const bool ok = connection_.publish(safeTopic, reinterpret_cast<const uint8_t *>(safePayload), payloadLen, retained);
   if (ok) {
     if (!is_verbose_publish_label(label) || core::logging::is_dev_build()) {
       DCTRL_LOGI("MQTT", "Published %s topic=%s retained=%s payload=%s",
@@ -407,13 +422,13 @@ bool MqttClient::publish_with_trace(const char *topic, const char *payload, bool
                  safePayload);
     }
   } else {
-    DCTRL_LOGE("MQTT", "Publish failed %s topic=%s retained=%s payload=%s rc=%d (%s)",
+    DCTRL_LOGE("MQTT", "Publish failed %s topic=%s retained=%s payload=%s state=%s error=%s",
                core::logging::safe_str(label),
                safeTopic,
                core::logging::bool_str(retained),
                safePayload,
-               mqtt_.state(),
-               mqtt_state_name(mqtt_.state()));
+               mqtt::Connection::state_name(connection_.state()),
+               mqtt::Connection::error_name(connection_.error()));
   }
   return ok;
 }
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <PubSubClient.h>
-#include <WiFiClient.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#include "core/publish_queue.h"
+#include "network/mqtt_connection.h"
+
 namespace core {
 
 constexpr size_t kMaxTopicLen = 96;
@@ -23,7 +24,6 @@ struct MqttTopics {
   char state[kMaxTopicLen];
   char presence[kMaxTopicLen];
   char command[kMaxTopicLen];
-  char heartbeat[kMaxTopicLen];
   char event[kMaxTopicLen];
   char telemetry[kMaxTopicLen];
   char logs[kMaxTopicLen];
@@ -42,36 +42,41 @@ class MqttClient final {
   void disconnect(bool publishOffline = true);
   void set_command_callback(CommandCallback callback, void *ctx);
 
+  // Publishes are queued (see PublishQueue) and drained by tick() while the
+  // broker is connected; false means the queue refused the message.
   bool publish_state(const char *payload, bool retained);
   bool publish_presence(const char *payload, bool retained);
-  bool publish_heartbeat(const char *payload);
   bool publish_event(const char *payload);
   bool publish_telemetry(const char *payload);
   bool publish_log(const char *payload);
 
+  const PublishQueue &publish_queue() const { return queue_; }
+
   static bool build_default_topics(const char *deviceId, MqttTopics &outTopics);
 
  private:
-  static void global_on_message(char *topic, uint8_t *payload, unsigned int len);
-  void on_message(char *topic, uint8_t *payload, unsigned int len);
+  static void on_connection_message(const char *topic, const uint8_t *payload, size_t len, void *ctx);
+  void on_message(const char *topic, const uint8_t *payload, size_t len);
+  bool start_connect(uint32_t nowMs);
+  void log_transition(uint32_t nowMs, bool startedNow);
+  bool enqueue(PublishKind kind, const char *payload, bool retained);
+  static bool send_queued(const PublishQueue::Message &message, void *ctx);
+  const char *topic_for(PublishKind kind) const;
   bool publish_with_trace(const char *topic, const char *payload, bool retained, const char *label);
 
   MqttConfig config_;
   MqttTopics topics_;
-  WiFiClient wifiClient_;
-  PubSubClient mqtt_;
+  mqtt::Connection connection_;
+  PublishQueue queue_;
 
-  bool connected_;
   uint32_t nextRetryAtMs_;
+  uint32_t attemptStartedAtMs_;
   uint8_t retryCount_;
   int lastWifiStatus_;
-  int lastMqttState_;
-  bool lastTransportConnected_;
+  mqtt::Connection::State lastState_;
 
   CommandCallback commandCallback_;
   void *commandCtx_;
-
-  static MqttClient *activeInstance_;
 };
 
 }  // namespace core
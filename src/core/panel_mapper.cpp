@@ -0,0 +1,223 @@
+#include "core/panel_mapper.h"
+
+namespace core {
+
+namespace {
+
+bool in_bounds(const DisplayConfig &cfg, int16_t x, int16_t y) {
+  DisplayGeometry geom{};
+  if (!compute_geometry(cfg, geom)) {
+    return false;
+  }
+  return x >= 0 && y >= 0 && x < static_cast<int16_t>(geom.totalWidth) &&
+         y < static_cast<int16_t>(geom.totalHeight);
+}
+
+}  // namespace
+
+PhysicalPoint LinearPanelMapper::map(const DisplayConfig &cfg, int16_t x, int16_t y) const {
+  if (!in_bounds(cfg, x, y)) {
+    return {false, 0, 0, 0};
+  }
+  const uint16_t panelCol = static_cast<uint16_t>(x) / cfg.panelWidth;
+  const uint16_t panelRow = static_cast<uint16_t>(y) / cfg.panelHeight;
+  const uint16_t panelIndex = panelRow * cfg.panelCols + panelCol;
+  return {
+      true,
+      panelIndex,
+      static_cast<uint16_t>(x - panelCol * cfg.panelWidth),
+      static_cast<uint16_t>(y - panelRow * cfg.panelHeight),
+  };
+}
+
+PhysicalPoint SerpentinePanelMapper::map(const DisplayConfig &cfg, int16_t x, int16_t y) const {
+  if (!in_bounds(cfg, x, y)) {
+    return {false, 0, 0, 0};
+  }
+
+  const uint16_t panelRow = static_cast<uint16_t>(y) / cfg.panelHeight;
+  const uint16_t logicalPanelCol = static_cast<uint16_t>(x) / cfg.panelWidth;
+
+  uint16_t physicalPanelCol = logicalPanelCol;
+  if ((panelRow & 1U) == 1U) {
+    physicalPanelCol = static_cast<uint16_t>((cfg.panelCols - 1) - logicalPanelCol);
+  }
+
+  const uint16_t panelIndex = panelRow * cfg.panelCols + physicalPanelCol;
+
+  return {
+      true,
+      panelIndex,
+      static_cast<uint16_t>(x - logicalPanelCol * cfg.panelWidth),
+      static_cast<uint16_t>(y - panelRow * cfg.panelHeight),
+  };
+}
+
+PanelMapTable::PanelMapTable()
+    : valid_(false),
+      width_(0),
+      height_(0),
+      panelWidth_(0),
+      lastPanelCol_(0),
+      colPanel_{},
+      colLocal_{},
+      rowBase_{},
+      rowLocal_{},
+      rowMirrored_{} {}
+
+bool PanelMapTable::build(const DisplayConfig &cfg) {
+  reset();
+  DisplayGeometry geom{};
+  if (!compute_geometry(cfg, geom) || geom.totalWidth > kMaxColumns || geom.totalHeight > kMaxRows ||
+      cfg.panelWidth > 256 || cfg.panelHeight > 256) {
+    return false;
+  }
+
+  // Filled by stepping through panels, so building costs no divides either.
+  uint16_t x = 0;
+  for (uint8_t panelCol = 0; panelCol < cfg.panelCols; ++panelCol) {
+    for (uint16_t localX = 0; localX < cfg.panelWidth; ++localX, ++x) {
+      colPanel_[x] = panelCol;
+      colLocal_[x] = static_cast<uint8_t>(localX);
+    }
+  }
+  uint16_t y = 0;
+  for (uint8_t panelRow = 0; panelRow < cfg.panelRows; ++panelRow) {
+    for (uint16_t localY = 0; localY < cfg.panelHeight; ++localY, ++y) {
+      rowBase_[y] = static_cast<uint16_t>(panelRow * cfg.panelCols);
+      rowLocal_[y] = static_cast<uint8_t>(localY);
+      rowMirrored_[y] = cfg.serpentine && (panelRow & 1U) == 1U ? 1 : 0;
+    }
+  }
+
+  width_ = geom.totalWidth;
+  height_ = geom.totalHeight;
+  panelWidth_ = cfg.panelWidth;
+  lastPanelCol_ = static_cast<uint8_t>(cfg.panelCols - 1);
+  valid_ = true;
+  return true;
+}
+
+void PanelMapTable::reset() {
+  valid_ = false;
+  width_ = 0;
+  height_ = 0;
+}
+
+bool PanelMapTable::valid() const { return valid_; }
+
+uint16_t PanelMapTable::width() const { return width_; }
+
+uint16_t PanelMapTable::height() const { return height_; }
+
+PhysicalPoint PanelMapTable::map(const DisplayConfig &, int16_t x, int16_t y) const { return map(x, y); }
+
+PhysicalPoint PanelMapTable::map(int16_t x, int16_t y) const {
+  // Negative coordinates wrap to large unsigned values and fail the same test.
+  const uint16_t ux = static_cast<uint16_t>(x);
+  const uint16_t uy = static_cast<uint16_t>(y);
+  if (ux >= width_ || uy >= height_) {
+    return {false, 0, 0, 0};
+  }
+  return {true, panel_index(ux, uy), colLocal_[ux], rowLocal_[uy]};
+}
+
+uint8_t PanelMapTable::map_span(int16_t x, int16_t y, int16_t w, PhysicalSpan *out, uint8_t maxSpans) const {
+  if (!out || maxSpans == 0 || w <= 0 || y < 0 || static_cast<uint16_t>(y) >= height_) {
+    return 0;
+  }
+  int32_t x0 = x < 0 ? 0 : x;
+  const int32_t x1 = static_cast<int32_t>(x) + w > width_ ? width_ : static_cast<int32_t>(x) + w;
+  const uint16_t uy = static_cast<uint16_t>(y);
+
+  uint8_t count = 0;
+  while (x0 < x1 && count < maxSpans) {
+    const uint16_t ux = static_cast<uint16_t>(x0);
+    const uint16_t toPanelEdge = static_cast<uint16_t>(panelWidth_ - colLocal_[ux]);
+    const uint16_t length = x1 - x0 < toPanelEdge ? static_cast<uint16_t>(x1 - x0) : toPanelEdge;
+    out[count++] = {panel_index(ux, uy), colLocal_[ux], rowLocal_[uy], length};
+    x0 += length;
+  }
+  return count;
+}
+
+uint16_t PanelMapTable::panel_index(uint16_t x, uint16_t y) const {
+  const uint8_t panelCol = rowMirrored_[y] ? static_cast<uint8_t>(lastPanelCol_ - colPanel_[x]) : colPanel_[x];
+  return static_cast<uint16_t>(rowBase_[y] + panelCol);
+}
+
+ChainTransform::ChainTransform() : valid_(false), placements_{} {}
+
+bool ChainTransform::learn(const PanelMapTable &map, Probe probe, void *ctx) {
+  reset();
+  if (!map.valid() || !probe) {
+    return false;
+  }
+  const int16_t width = static_cast<int16_t>(map.width());
+  const int16_t height = static_cast<int16_t>(map.height());
+  bool seen[kMaxPanels] = {};
+
+  // Each panel's origin and steps come from its local (0, 0), (1, 0) and
+  // (0, 1), which raster order reaches in that order.
+  for (int16_t y = 0; y < height; ++y) {
+    for (int16_t x = 0; x < width; ++x) {
+      const PhysicalPoint p = map.map(x, y);
+      if (p.panelIndex >= kMaxPanels) {
+        return false;
+      }
+      if (p.localX + p.localY > 1) {
+        continue;
+      }
+      int16_t chainX = 0;
+      int16_t chainY = 0;
+      if (!probe(ctx, x, y, chainX, chainY)) {
+        return false;
+      }
+      Placement &placement = placements_[p.panelIndex];
+      if (p.localX == 0 && p.localY == 0) {
+        placement = {chainX, chainY, 1, 1};
+        seen[p.panelIndex] = true;
+      } else if (!seen[p.panelIndex]) {
+        return false;
+      } else if (p.localX == 1) {
+        if (chainY != placement.originY || (chainX - placement.originX != 1 && chainX - placement.originX != -1)) {
+          return false;
+        }
+        placement.stepX = static_cast<int8_t>(chainX - placement.originX);
+      } else {
+        if (chainX != placement.originX || (chainY - placement.originY != 1 && chainY - placement.originY != -1)) {
+          return false;
+        }
+        placement.stepY = static_cast<int8_t>(chainY - placement.originY);
+      }
+    }
+  }
+
+  for (int16_t y = 0; y < height; ++y) {
+    for (int16_t x = 0; x < width; ++x) {
+      const PhysicalPoint p = map.map(x, y);
+      const Placement &placement = placements_[p.panelIndex];
+      int16_t chainX = 0;
+      int16_t chainY = 0;
+      if (!probe(ctx, x, y, chainX, chainY) || chainX != placement.originX + placement.stepX * p.localX ||
+          chainY != placement.originY + placement.stepY * p.localY) {
+        return false;
+      }
+    }
+  }
+  valid_ = true;
+  return true;
+}
+
+void ChainTransform::reset() { valid_ = false; }
+
+bool ChainTransform::valid() const { return valid_; }
+
+void ChainTransform::place(const PhysicalSpan &span, int16_t &chainX, int16_t &chainY) const {
+  const Placement &placement = placements_[span.panelIndex];
+  const int16_t first = static_cast<int16_t>(placement.originX + placement.stepX * span.localX);
+  chainX = placement.stepX > 0 ? first : static_cast<int16_t>(first - (span.length - 1));
+  chainY = static_cast<int16_t>(placement.originY + placement.stepY * span.localY);
+}
+
+}  // namespace core
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "core/models.h"
+
+namespace core {
+
+struct PhysicalPoint {
+  bool valid;
+  uint16_t panelIndex;
+  uint16_t localX;
+  uint16_t localY;
+};
+
+// Part of one logical scanline that lands on a single panel.
+struct PhysicalSpan {
+  uint16_t panelIndex;
+  uint16_t localX;
+  uint16_t localY;
+  uint16_t length;
+};
+
+class IPanelMapper {
+ public:
+  virtual ~IPanelMapper() = default;
+  virtual PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const = 0;
+};
+
+class LinearPanelMapper final : public IPanelMapper {
+ public:
+  PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const override;
+};
+
+class SerpentinePanelMapper final : public IPanelMapper {
+ public:
+  PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const override;
+};
+
+// Logical-to-physical lookup built once per display config: one entry per
+// canvas column and one per canvas row, so a point maps with two table reads
+// and an add instead of a geometry check and two divides. Gives the same
+// answers as the linear or serpentine mapper the config selects. Canvases
+// larger than the tables (or panels wider or taller than 256) are not cached;
+// build() then returns false and callers keep the arithmetic mapper.
+class PanelMapTable final : public IPanelMapper {
+ public:
+  static constexpr uint16_t kMaxColumns = 1024;  // 8 panels of 128
+  static constexpr uint16_t kMaxRows = 256;      // 4 panels of 64
+
+  PanelMapTable();
+
+  bool build(const DisplayConfig &cfg);
+  void reset();
+  bool valid() const;
+  uint16_t width() const;
+  uint16_t height() const;
+
+  // Answers for the config passed to build(); cfg is not consulted.
+  PhysicalPoint map(const DisplayConfig &cfg, int16_t x, int16_t y) const override;
+  PhysicalPoint map(int16_t x, int16_t y) const;
+
+  // Clips [x, x + w) on row y to the canvas and splits it at panel edges,
+  // left to right. Returns the number of spans written (at most maxSpans).
+  uint8_t map_span(int16_t x, int16_t y, int16_t w, PhysicalSpan *out, uint8_t maxSpans) const;
+
+ private:
+  uint16_t panel_index(uint16_t x, uint16_t y) const;
+
+  bool valid_;
+  uint16_t width_;
+  uint16_t height_;
+  uint16_t panelWidth_;
+  uint8_t lastPanelCol_;
+  uint8_t colPanel_[kMaxColumns];   // logical panel column
+  uint8_t colLocal_[kMaxColumns];   // x within the panel
+  uint16_t rowBase_[kMaxRows];      // panelRow * panelCols
+  uint8_t rowLocal_[kMaxRows];      // y within the panel
+  uint8_t rowMirrored_[kMaxRows];   // serpentine odd panel rows run right to left
+};
+
+// Where each panel of a PanelMapTable lands in the HUB75 chain buffer, so a
+// logical span can be written to the chain as one physical span. Learned once
+// by probing the driver's own pixel transform (chain order and rotation)
+// rather than re-deriving it; only transforms that keep every panel row a
+// chain row with unit steps are accepted, and every pixel is checked.
+class ChainTransform final {
+ public:
+  static constexpr uint8_t kMaxPanels = 32;
+  // Where the driver sends logical (x, y); false when it drops the point.
+  using Probe = bool (*)(void *ctx, int16_t x, int16_t y, int16_t &chainX, int16_t &chainY);
+
+  ChainTransform();
+
+  bool learn(const PanelMapTable &map, Probe probe, void *ctx);
+  void reset();
+  bool valid() const;
+
+  // Leftmost chain x and the chain row of a span from PanelMapTable::map_span().
+  void place(const PhysicalSpan &span, int16_t &chainX, int16_t &chainY) const;
+
+ private:
+  struct Placement {
+    int16_t originX;  // chain position of the panel's local (0, 0)
+    int16_t originY;
+    int8_t stepX;     // +1 or -1 per local x
+    int8_t stepY;     // +1 or -1 per local y
+  };
+
+  bool valid_;
+  Placement placements_[kMaxPanels];
+};
+
+}  // namespace core
@@ -0,0 +1,139 @@
+#include "core/profiler.h"
+
+#include <freertos/FreeRTOS.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace core::profiler {
+
+namespace {
+
+constexpr const char *kSectionNames[] = {
+    "network_tick",
+    "mqtt_tick",
+    "http_server",
+    "handle_command",
+    "tick_scroll",
+    "build_layout",
+    "render_full",
+    "render_minimal",
+    "render_eta",
+    "render_scroll",
+};
+static_assert(sizeof(kSectionNames) / sizeof(kSectionNames[0]) == static_cast<size_t>(ProfileSection::kCount),
+              "every profile section needs a name");
+
+#if COMMUTELIVE_PROFILER
+ProfileStats gStats[static_cast<size_t>(ProfileSection::kCount)];
+portMUX_TYPE gStatsLock = portMUX_INITIALIZER_UNLOCKED;
+uint32_t gTicksPerUs = 0;
+
+uint32_t ticks_per_us() {
+  if (gTicksPerUs == 0) {
+#if defined(ARDUINO)
+    gTicksPerUs = ESP.getCpuFreqMHz();
+#else
+    gTicksPerUs = 1000;
+#endif
+  }
+  return gTicksPerUs;
+}
+
+uint8_t bucket_for(uint32_t us) {
+  if (us == 0) return 0;
+  const uint8_t bits = static_cast<uint8_t>(32 - __builtin_clz(us));
+  return bits < kProfileBuckets ? bits : kProfileBuckets - 1;
+}
+
+// Upper bound of the bucket holding the pct-th percentile sample.
+uint32_t percentile_us(const ProfileStats &stats, uint8_t pct) {
+  if (stats.count == 0) return 0;
+  const uint64_t target = (static_cast<uint64_t>(stats.count) * pct + 99U) / 100U;
+  uint64_t seen = 0;
+  for (uint8_t i = 0; i < kProfileBuckets; ++i) {
+    seen += stats.buckets[i];
+    if (seen >= target) {
+      return i + 1 < kProfileBuckets ? (1UL << i) : stats.maxUs;
+    }
+  }
+  return stats.maxUs;
+}
+#endif
+
+}  // namespace
+
+const char *section_name(ProfileSection section) {
+  const size_t index = static_cast<size_t>(section);
+  return index < static_cast<size_t>(ProfileSection::kCount) ? kSectionNames[index] : "unknown";
+}
+
+#if COMMUTELIVE_PROFILER
+void record(ProfileSection section, uint32_t ticks) {
+  const uint32_t us = ticks / ticks_per_us();
+  const uint8_t bucket = bucket_for(us);
+  portENTER_CRITICAL(&gStatsLock);
+  ProfileStats &stats = gStats[static_cast<size_t>(section)];
+  ++stats.count;
+  stats.totalUs += us;
+  if (us > stats.maxUs) stats.maxUs = us;
+  ++stats.buckets[bucket];
+  portEXIT_CRITICAL(&gStatsLock);
+}
+
+ProfileStats stats(ProfileSection section) {
+  portENTER_CRITICAL(&gStatsLock);
+  const ProfileStats copy = gStats[static_cast<size_t>(section)];
+  portEXIT_CRITICAL(&gStatsLock);
+  return copy;
+}
+
+void reset() {
+  portENTER_CRITICAL(&gStatsLock);
+  memset(gStats, 0, sizeof(gStats));
+  portEXIT_CRITICAL(&gStatsLock);
+}
+
+size_t format_summary(char *out, size_t outLen, bool clear) {
+  ProfileStats snapshot[static_cast<size_t>(ProfileSection::kCount)];
+  portENTER_CRITICAL(&gStatsLock);
+  memcpy(snapshot, gStats, sizeof(snapshot));
+  if (clear) memset(gStats, 0, sizeof(gStats));
+  portEXIT_CRITICAL(&gStatsLock);
+
+  int written = snprintf(out, outLen, "{\"type\":\"profile\",\"enabled\":true,\"mhz\":%lu,\"us\":{",
+                         static_cast<unsigned long>(ticks_per_us()));
+  if (written <= 0 || static_cast<size_t>(written) >= outLen) return 0;
+  size_t used = static_cast<size_t>(written);
+
+  bool first = true;
+  for (size_t i = 0; i < static_cast<size_t>(ProfileSection::kCount); ++i) {
+    const ProfileStats &stats = snapshot[i];
+    if (stats.count == 0) continue;
+    written = snprintf(out + used, outLen - used, "%s\"%s\":[%lu,%lu,%lu,%lu,%lu]",
+                       first ? "" : ",",
+                       kSectionNames[i],
+                       static_cast<unsigned long>(stats.count),
+                       static_cast<unsigned long>(stats.totalUs / stats.count),
+                       static_cast<unsigned long>(percentile_us(stats, 50)),
+                       static_cast<unsigned long>(percentile_us(stats, 99)),
+                       static_cast<unsigned long>(stats.maxUs));
+    if (written <= 0 || static_cast<size_t>(written) >= outLen - used) return 0;
+    used += static_cast<size_t>(written);
+    first = false;
+  }
+
+  written = snprintf(out + used, outLen - used, "}}");
+  if (written <= 0 || static_cast<size_t>(written) >= outLen - used) return 0;
+  return used + static_cast<size_t>(written);
+}
+#else
+void reset() {}
+
+size_t format_summary(char *out, size_t outLen, bool) {
+  const int written = snprintf(out, outLen, "{\"type\":\"profile\",\"enabled\":false}");
+  if (written <= 0 || static_cast<size_t>(written) >= outLen) return 0;
+  return static_cast<size_t>(written);
+}
+#endif
+
+}  // namespace core::profiler
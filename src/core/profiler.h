@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef COMMUTELIVE_PROFILER
+#define COMMUTELIVE_PROFILER 0
+#endif
+
+#if COMMUTELIVE_PROFILER
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace core {
+
+// Hot-path sections timed by DCTRL_PROFILE_SCOPE. The loop task and the
+// render task record into them while {"type":"profile"} reads and clears them
+// from the loop, so every access takes a short spinlock. Nested sections
+// count in both: mqtt_tick includes handle_command, which runs from its
+// callback.
+enum class ProfileSection : uint8_t {
+  kNetworkTick,
+  kMqttTick,
+  kHttpServer,
+  kHandleCommand,
+  kTickScroll,
+  kBuildLayout,
+  kRenderFull,
+  kRenderMinimal,
+  kRenderEta,
+  kRenderScroll,
+  kCount,
+};
+
+// Bucket 0 is under 1us; bucket i covers [2^(i-1), 2^i) us; the last is open.
+constexpr uint8_t kProfileBuckets = 16;
+
+struct ProfileStats {
+  uint32_t count;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t buckets[kProfileBuckets];
+};
+
+namespace profiler {
+
+constexpr bool kEnabled = COMMUTELIVE_PROFILER != 0;
+
+const char *section_name(ProfileSection section);
+
+#if COMMUTELIVE_PROFILER
+// Raw cycle counter on the device, nanoseconds on the host. Only differences
+// are used, so wrapping is harmless for sections shorter than ~17s.
+inline uint32_t now_ticks() {
+#if defined(ARDUINO)
+  return ESP.getCycleCount();
+#else
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+void record(ProfileSection section, uint32_t ticks);
+// A consistent copy of one section.
+ProfileStats stats(ProfileSection section);
+#endif
+
+// Clears every section; a no-op when compiled out.
+void reset();
+
+// Formats the summary published in answer to {"type":"profile"}:
+//   {"type":"profile","enabled":true,"mhz":N,
+//    "us":{"<section>":[count,avg,p50,p99,max],...}}
+// Sections never entered are left out; percentiles are bucket upper bounds.
+// With clear set, every section is cleared in the same step the summary is
+// copied, so no sample falls between the two. Returns the length, or 0 if out
+// was too small.
+size_t format_summary(char *out, size_t outLen, bool clear = false);
+
+}  // namespace profiler
+
+#if COMMUTELIVE_PROFILER
+class ProfileScope final {
+ public:
+  explicit ProfileScope(ProfileSection section) : section_(section), startTicks_(profiler::now_ticks()) {}
+  ~ProfileScope() { profiler::record(section_, profiler::now_ticks() - startTicks_); }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+ private:
+  ProfileSection section_;
+  uint32_t startTicks_;
+};
+#endif
+
+}  // namespace core
+
+// Times the rest of the enclosing block, e.g. DCTRL_PROFILE_SCOPE(kMqttTick).
+// Expands to nothing unless built with -DCOMMUTELIVE_PROFILER=1.
+#if COMMUTELIVE_PROFILER
+#define DCTRL_PROFILE_CONCAT_INNER(a, b) a##b
+#define DCTRL_PROFILE_CONCAT(a, b) DCTRL_PROFILE_CONCAT_INNER(a, b)
+#define DCTRL_PROFILE_SCOPE(section) \
+  ::core::ProfileScope DCTRL_PROFILE_CONCAT(profileScope_, __LINE__)(::core::ProfileSection::section)
+#else
+#define DCTRL_PROFILE_SCOPE(section) \
+  do {                               \
+  } while (0)
+#endif
@@ -0,0 +1,169 @@
+#include "core/publish_queue.h"
+
+#include <string.h>
+
+namespace core {
+
+namespace {
+
+constexpr size_t kRecordHeaderLen = 3;
+constexpr uint8_t kSlotCount = 2;
+
+}  // namespace
+
+PublishQueue::PublishQueue() : slots_{}, rings_{}, pending_(0), dropped_(0), coalesced_(0) {
+  rings_[0].bytes = eventBytes_;
+  rings_[0].cap = kEventRingBytes;
+  rings_[1].bytes = logBytes_;
+  rings_[1].cap = kLogRingBytes;
+  rings_[2].bytes = telemetryBytes_;
+  rings_[2].cap = kTelemetryRingBytes;
+  scratch_[0] = '\0';
+}
+
+bool PublishQueue::is_coalesced(PublishKind kind) {
+  return static_cast<uint8_t>(kind) < kSlotCount;
+}
+
+PublishQueue::Ring *PublishQueue::ring_for(PublishKind kind) {
+  const uint8_t index = static_cast<uint8_t>(kind);
+  if (index < kSlotCount || kind >= PublishKind::kCount) return nullptr;
+  return &rings_[index - kSlotCount];
+}
+
+bool PublishQueue::push(PublishKind kind, const char *payload, size_t len, bool retained) {
+  if (!payload || kind >= PublishKind::kCount || len > kMaxPayloadLen) {
+    ++dropped_;
+    return false;
+  }
+
+  if (is_coalesced(kind)) {
+    Slot &slot = slots_[static_cast<uint8_t>(kind)];
+    if (len >= kSlotPayloadLen) {
+      ++dropped_;
+      return false;
+    }
+    if (slot.full) {
+      ++coalesced_;
+    } else {
+      ++pending_;
+    }
+    memcpy(slot.payload, payload, len);
+    slot.payload[len] = '\0';
+    slot.len = static_cast<uint16_t>(len);
+    slot.retained = retained;
+    slot.full = true;
+    return true;
+  }
+
+  Ring &ring = *ring_for(kind);
+  return ring_push(ring, payload, len, retained, kind != PublishKind::kLog);
+}
+
+size_t PublishQueue::drain(SendFn send, void *ctx, size_t budgetBytes) {
+  size_t sent = 0;
+  bool first = true;
+  for (uint8_t k = 0; k < static_cast<uint8_t>(PublishKind::kCount); ++k) {
+    const PublishKind kind = static_cast<PublishKind>(k);
+    while (first || sent < budgetBytes) {
+      Message message{kind, false, nullptr, 0};
+      Ring *ring = nullptr;
+      if (is_coalesced(kind)) {
+        const Slot &slot = slots_[k];
+        if (!slot.full) break;
+        message.retained = slot.retained;
+        message.payload = slot.payload;
+        message.len = slot.len;
+      } else {
+        ring = ring_for(kind);
+        if (!ring_front(*ring, message.retained, message.len)) break;
+        ring_read(*ring, kRecordHeaderLen, scratch_, message.len);
+        scratch_[message.len] = '\0';
+        message.payload = scratch_;
+      }
+
+      if (!send(message, ctx)) return sent;
+      sent += message.len;
+      first = false;
+      if (ring) {
+        ring_pop(*ring);
+      } else {
+        slots_[k].full = false;
+        --pending_;
+      }
+    }
+    if (!first && sent >= budgetBytes) break;
+  }
+  return sent;
+}
+
+void PublishQueue::clear() {
+  for (Slot &slot : slots_) slot.full = false;
+  for (Ring &ring : rings_) {
+    ring.head = 0;
+    ring.used = 0;
+    ring.count = 0;
+  }
+  pending_ = 0;
+}
+
+bool PublishQueue::ring_push(Ring &ring, const char *payload, size_t len, bool retained, bool evictOldest) {
+  const size_t need = kRecordHeaderLen + len;
+  if (need > ring.cap) {
+    ++dropped_;
+    return false;
+  }
+  while (ring.cap - ring.used < need) {
+    if (!evictOldest) {
+      ++dropped_;
+      return false;
+    }
+    ring_pop(ring);
+    ++dropped_;
+  }
+
+  const uint8_t header[kRecordHeaderLen] = {
+      static_cast<uint8_t>(retained ? 1 : 0),
+      static_cast<uint8_t>(len),
+      static_cast<uint8_t>(len >> 8),
+  };
+  size_t at = (ring.head + ring.used) % ring.cap;
+  for (size_t i = 0; i < need; ++i) {
+    ring.bytes[at] = i < kRecordHeaderLen ? header[i] : static_cast<uint8_t>(payload[i - kRecordHeaderLen]);
+    at = at + 1 == ring.cap ? 0 : at + 1;
+  }
+  ring.used += need;
+  ++ring.count;
+  ++pending_;
+  return true;
+}
+
+bool PublishQueue::ring_front(const Ring &ring, bool &retained, size_t &len) {
+  if (ring.count == 0) return false;
+  uint8_t header[kRecordHeaderLen];
+  ring_read(ring, 0, header, sizeof(header));
+  retained = header[0] != 0;
+  len = static_cast<size_t>(header[1] | (header[2] << 8));
+  return true;
+}
+
+void PublishQueue::ring_pop(Ring &ring) {
+  bool retained = false;
+  size_t len = 0;
+  if (!ring_front(ring, retained, len)) return;
+  const size_t recordLen = kRecordHeaderLen + len;
+  ring.head = (ring.head + recordLen) % ring.cap;
+  ring.used -= recordLen;
+  --ring.count;
+  --pending_;
+}
+
+void PublishQueue::ring_read(const Ring &ring, size_t offset, void *out, size_t len) const {
+  uint8_t *dst = static_cast<uint8_t *>(out);
+  const size_t start = (ring.head + offset) % ring.cap;
+  const size_t firstPart = len < ring.cap - start ? len : ring.cap - start;
+  memcpy(dst, ring.bytes + start, firstPart);
+  memcpy(dst + firstPart, ring.bytes, len - firstPart);
+}
+
+}  // namespace core
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+// What a queued message is; the MQTT client maps each kind to its topic.
+// Declared in drain order, highest priority first.
+enum class PublishKind : uint8_t {
+  kPresence,
+  kState,
+  kEvent,
+  kLog,
+  kTelemetry,
+  kCount,
+};
+
+// Outbound MQTT messages, held in RAM while the broker is unreachable and
+// drained by priority once it is back.
+//
+// Presence and display state only matter in their latest form, so each has
+// one slot that a newer message overwrites. Events, logs and
+// telemetry are kept in order in per-kind byte rings. A full telemetry or
+// event ring evicts its oldest message; a full log ring refuses the new one,
+// so the crash report queued at boot is never pushed out by later chatter.
+class PublishQueue final {
+ public:
+  static constexpr size_t kMaxPayloadLen = 1450;
+  static constexpr size_t kSlotPayloadLen = 512;
+  static constexpr size_t kLogRingBytes = 6144;
+  static constexpr size_t kTelemetryRingBytes = 1536;
+  static constexpr size_t kEventRingBytes = 1024;
+
+  struct Message {
+    PublishKind kind;
+    bool retained;
+    const char *payload;
+    size_t len;
+  };
+
+  // Sends one message; false leaves it queued for the next drain.
+  using SendFn = bool (*)(const Message &message, void *ctx);
+
+  PublishQueue();
+
+  // False when the message was refused (too large, or its log ring is full).
+  bool push(PublishKind kind, const char *payload, size_t len, bool retained);
+
+  // Sends messages in PublishKind order until one fails or budgetBytes of
+  // payload have gone out. The first message is always attempted, so one
+  // larger than the budget still drains. Returns payload bytes sent.
+  size_t drain(SendFn send, void *ctx, size_t budgetBytes);
+
+  void clear();
+
+  bool empty() const { return pending_ == 0; }
+  uint16_t pending() const { return pending_; }
+  uint32_t dropped() const { return dropped_; }
+  uint32_t coalesced() const { return coalesced_; }
+
+ private:
+  struct Slot {
+    bool full;
+    bool retained;
+    uint16_t len;
+    char payload[kSlotPayloadLen];
+  };
+
+  // Records are [u8 retained][u16 len][payload], wrapping at the end.
+  struct Ring {
+    uint8_t *bytes;
+    size_t cap;
+    size_t head;
+    size_t used;
+    uint16_t count;
+  };
+
+  static bool is_coalesced(PublishKind kind);
+  Ring *ring_for(PublishKind kind);
+  bool ring_push(Ring &ring, const char *payload, size_t len, bool retained, bool evictOldest);
+  bool ring_front(const Ring &ring, bool &retained, size_t &len);
+  void ring_pop(Ring &ring);
+  void ring_read(const Ring &ring, size_t offset, void *out, size_t len) const;
+
+  Slot slots_[2];  // presence, state
+  Ring rings_[3];  // event, log, telemetry
+  uint8_t logBytes_[kLogRingBytes];
+  uint8_t telemetryBytes_[kTelemetryRingBytes];
+  uint8_t eventBytes_[kEventRingBytes];
+  char scratch_[kMaxPayloadLen + 1];  // ring payloads are copied out here to send
+  uint16_t pending_;
+  uint32_t dropped_;
+  uint32_t coalesced_;
+};
+
+}  // namespace core
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace core {
+
+// Lock-free single-producer/single-consumer triple buffer. The producer fills
+// write_slot() and publishes it; the consumer takes the newest published slot
+// and reads it at leisure. Neither side ever waits on the other: the producer
+// owns one slot, the consumer one, and the third is swapped between them with
+// a single atomic exchange. Snapshots published before the consumer takes one
+// are superseded, so T must describe complete state, not deltas.
+template <typename T>
+class RenderHandoff final {
+ public:
+  RenderHandoff() : slots_{}, writeIndex_(0), middle_(1), readIndex_(2) {}
+
+  T &write_slot() { return slots_[writeIndex_]; }
+
+  void publish() {
+    const uint8_t previous = middle_.exchange(static_cast<uint8_t>(writeIndex_ | kFreshBit), std::memory_order_acq_rel);
+    writeIndex_ = static_cast<uint8_t>(previous & kIndexMask);
+  }
+
+  // Returns true when a newer snapshot than the last taken one is available;
+  // it is then readable through read_slot() until the next take().
+  bool take() {
+    if ((middle_.load(std::memory_order_acquire) & kFreshBit) == 0) {
+      return false;
+    }
+    const uint8_t previous = middle_.exchange(readIndex_, std::memory_order_acq_rel);
+    readIndex_ = static_cast<uint8_t>(previous & kIndexMask);
+    return true;
+  }
+
+  const T &read_slot() const { return slots_[readIndex_]; }
+
+ private:
+  static constexpr uint8_t kIndexMask = 0x03;
+  static constexpr uint8_t kFreshBit = 0x04;
+
+  T slots_[3];
+  uint8_t writeIndex_;             // producer only
+  std::atomic<uint8_t> middle_;   // hand-off slot index plus kFreshBit
+  uint8_t readIndex_;              // consumer only
+};
+
+}  // namespace core
@@ -0,0 +1,107 @@
+#include "core/telemetry_aggregator.h"
+
+#include <stdio.h>
+
+namespace core {
+
+TelemetryAggregator::TelemetryAggregator()
+    : intervalMs_(kDefaultIntervalMs),
+      sequence_(0),
+      windowStartedAtMs_(0),
+      samples_(0),
+      heapMin_(0),
+      heapMax_(0),
+      maxAllocMin_(0),
+      rssiSamples_(0),
+      rssiMin_(0),
+      rssiSum_(0),
+      wifiReconnects_(0),
+      mqttReconnects_(0) {}
+
+bool TelemetryAggregator::set_interval_ms(uint32_t intervalMs) {
+  if (intervalMs < kMinIntervalMs || intervalMs > kMaxIntervalMs) {
+    return false;
+  }
+  intervalMs_ = intervalMs;
+  return true;
+}
+
+void TelemetryAggregator::start_window(uint32_t nowMs) {
+  windowStartedAtMs_ = nowMs;
+  samples_ = 0;
+  heapMin_ = 0;
+  heapMax_ = 0;
+  maxAllocMin_ = 0;
+  rssiSamples_ = 0;
+  rssiMin_ = 0;
+  rssiSum_ = 0;
+  wifiReconnects_ = 0;
+  mqttReconnects_ = 0;
+}
+
+void TelemetryAggregator::sample(uint32_t freeHeap, uint32_t maxAllocHeap, int8_t rssi) {
+  if (samples_ == 0 || freeHeap < heapMin_) heapMin_ = freeHeap;
+  if (samples_ == 0 || freeHeap > heapMax_) heapMax_ = freeHeap;
+  if (samples_ == 0 || maxAllocHeap < maxAllocMin_) maxAllocMin_ = maxAllocHeap;
+  if (samples_ < UINT16_MAX) ++samples_;
+
+  if (rssi != 0 && rssiSamples_ < UINT16_MAX) {
+    if (rssiSamples_ == 0 || rssi < rssiMin_) rssiMin_ = rssi;
+    rssiSum_ += rssi;
+    ++rssiSamples_;
+  }
+}
+
+size_t TelemetryAggregator::take_frame(const TelemetryCounters &counters, uint32_t nowMs, char *out, size_t outLen) {
+  const int rssiAvg = rssiSamples_ > 0 ? static_cast<int>(rssiSum_ / rssiSamples_) : 0;
+  const uint32_t dirtyPerFrame = counters.frames > 0 ? counters.dirtyPixels / counters.frames : 0;
+  const int written = snprintf(
+      out,
+      outLen,
+      "{\"v\":1,\"seq\":%lu,\"up\":%lu,\"win\":%lu,\"n\":%u,\"heap\":[%lu,%lu],\"maxAlloc\":%lu,"
+      "\"rssi\":[%d,%d],\"frames\":%lu,\"renders\":[%lu,%lu,%lu,%lu],\"dirtyPx\":%lu,\"copiedPx\":%lu,"
+      "\"skippedRows\":%lu,\"geom\":[%lu,%lu],\"wakes\":[%lu,%lu],\"loopLateMs\":[%lu,%lu,%lu,%lu],"
+      "\"renderLateMs\":[%lu,%lu,%lu,%lu],\"reconnects\":[%u,%u],\"pub\":[%u,%lu,%lu]}",
+      static_cast<unsigned long>(sequence_),
+      static_cast<unsigned long>(counters.uptimeMs / 1000U),
+      static_cast<unsigned long>((nowMs - windowStartedAtMs_) / 1000U),
+      static_cast<unsigned>(samples_),
+      static_cast<unsigned long>(heapMin_),
+      static_cast<unsigned long>(heapMax_),
+      static_cast<unsigned long>(maxAllocMin_),
+      static_cast<int>(rssiMin_),
+      rssiAvg,
+      static_cast<unsigned long>(counters.frames),
+      static_cast<unsigned long>(counters.renders[0]),
+      static_cast<unsigned long>(counters.renders[1]),
+      static_cast<unsigned long>(counters.renders[2]),
+      static_cast<unsigned long>(counters.renders[3]),
+      static_cast<unsigned long>(dirtyPerFrame),
+      static_cast<unsigned long>(counters.copiedPixels),
+      static_cast<unsigned long>(counters.skippedRows),
+      static_cast<unsigned long>(counters.geomHits),
+      static_cast<unsigned long>(counters.geomMisses),
+      static_cast<unsigned long>(counters.loopWakes),
+      static_cast<unsigned long>(counters.eventWakes),
+      static_cast<unsigned long>(counters.loopLateMs[0]),
+      static_cast<unsigned long>(counters.loopLateMs[1]),
+      static_cast<unsigned long>(counters.loopLateMs[2]),
+      static_cast<unsigned long>(counters.loopLateMs[3]),
+      static_cast<unsigned long>(counters.renderLateMs[0]),
+      static_cast<unsigned long>(counters.renderLateMs[1]),
+      static_cast<unsigned long>(counters.renderLateMs[2]),
+      static_cast<unsigned long>(counters.renderLateMs[3]),
+      static_cast<unsigned>(wifiReconnects_),
+      static_cast<unsigned>(mqttReconnects_),
+      static_cast<unsigned>(counters.pubPending),
+      static_cast<unsigned long>(counters.pubDropped),
+      static_cast<unsigned long>(counters.pubCoalesced));
+  if (written <= 0 || static_cast<size_t>(written) >= outLen) {
+    return 0;
+  }
+  ++sequence_;
+  start_window(nowMs);
+  return static_cast<size_t>(written);
+}
+
+}  // namespace core
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+// Counters other components keep themselves; read once per frame.
+struct TelemetryCounters {
+  uint32_t uptimeMs;
+  uint32_t frames;
+  uint32_t dirtyPixels;
+  uint32_t copiedPixels;
+  uint32_t skippedRows;
+  uint32_t renders[4];  // full, minimal, ETA-only, scroll-only
+  uint32_t geomHits;
+  uint32_t geomMisses;
+  uint32_t loopWakes;
+  uint32_t eventWakes;
+  uint32_t loopLateMs[4];  // p50, p90, p99, max
+  uint32_t renderLateMs[4];
+  uint16_t pubPending;
+  uint32_t pubDropped;
+  uint32_t pubCoalesced;
+};
+
+// One telemetry frame per interval in place of separate heartbeat,
+// telemetry and heartbeat-log packets. Heap and RSSI are sampled into the
+// current window as min/max/avg; everything else comes from
+// TelemetryCounters when the frame is taken.
+//
+// Frame (all times in seconds unless suffixed):
+//   {"v":1,"seq":N,"up":S,"win":S,"n":samples,"heap":[min,max],"maxAlloc":min,
+//    "rssi":[min,avg],"frames":N,"renders":[full,minimal,eta,scroll],
+//    "dirtyPx":avgPerFrame,"copiedPx":N,"skippedRows":N,"geom":[hits,misses],
+//    "wakes":[loop,event],"loopLateMs":[p50,p90,p99,max],"renderLateMs":[...],
+//    "reconnects":[wifi,mqtt],"pub":[pending,dropped,coalesced]}
+class TelemetryAggregator final {
+ public:
+  static constexpr uint32_t kDefaultIntervalMs = 30000;
+  static constexpr uint32_t kMinIntervalMs = 5000;
+  static constexpr uint32_t kMaxIntervalMs = 3600000;
+  static constexpr uint32_t kSampleEveryMs = 1000;
+
+  TelemetryAggregator();
+
+  // False (and no change) when outside [kMinIntervalMs, kMaxIntervalMs].
+  bool set_interval_ms(uint32_t intervalMs);
+  uint32_t interval_ms() const { return intervalMs_; }
+
+  void start_window(uint32_t nowMs);
+  // rssi 0 means not associated and is left out of the RSSI stats.
+  void sample(uint32_t freeHeap, uint32_t maxAllocHeap, int8_t rssi);
+  void count_wifi_reconnect() { ++wifiReconnects_; }
+  void count_mqtt_reconnect() { ++mqttReconnects_; }
+
+  // Formats the frame for the window ending at nowMs and starts the next
+  // window. Returns the length, or 0 if out was too small.
+  size_t take_frame(const TelemetryCounters &counters, uint32_t nowMs, char *out, size_t outLen);
+
+ private:
+  uint32_t intervalMs_;
+  uint32_t sequence_;
+  uint32_t windowStartedAtMs_;
+  uint16_t samples_;
+  uint32_t heapMin_;
+  uint32_t heapMax_;
+  uint32_t maxAllocMin_;
+  uint16_t rssiSamples_;
+  int8_t rssiMin_;
+  int32_t rssiSum_;
+  uint16_t wifiReconnects_;
+  uint16_t mqttReconnects_;
+};
+
+}  // namespace core
@@ -0,0 +1,20 @@
+#include "core/wall_clock.h"
+
+namespace core {
+
+WallClock::WallClock() : anchorEpochMs_(0), anchorMs_(0), source_(Source::kNone) {}
+
+void WallClock::sync(Source source, uint64_t epochMs, uint32_t nowMs) {
+  if (source == Source::kNone || source < source_) {
+    return;
+  }
+  anchorEpochMs_ = epochMs;
+  anchorMs_ = nowMs;
+  source_ = source;
+}
+
+uint64_t WallClock::epoch_ms(uint32_t nowMs) const {
+  return anchorEpochMs_ + static_cast<uint32_t>(nowMs - anchorMs_);
+}
+
+}  // namespace core
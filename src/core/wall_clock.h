@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace core {
+
+// Unix time in milliseconds, extrapolated from the last sync with millis().
+// SNTP is authoritative; a server time reference from a payload only stands
+// in until SNTP has answered once, and also lets host tools drive the clock.
+class WallClock final {
+ public:
+  enum class Source : uint8_t {
+    kNone,
+    kServer,
+    kSntp,
+  };
+
+  WallClock();
+
+  // Ignored when a more authoritative source has already synced.
+  void sync(Source source, uint64_t epochMs, uint32_t nowMs);
+
+  bool valid() const { return source_ != Source::kNone; }
+  Source source() const { return source_; }
+  uint64_t epoch_ms(uint32_t nowMs) const;
+
+ private:
+  uint64_t anchorEpochMs_;
+  uint32_t anchorMs_;
+  Source source_;
+};
+
+}  // namespace core
@@ -0,0 +1,155 @@
+#include "display/dirty_region.h"
+
+#include <string.h>
+
+namespace display {
+
+namespace {
+
+int16_t min16(int16_t a, int16_t b) { return a < b ? a : b; }
+
+int16_t max16(int16_t a, int16_t b) { return a > b ? a : b; }
+
+DirtyRect bounding_box(const DirtyRect &a, const DirtyRect &b) {
+  const int16_t x0 = min16(a.x, b.x);
+  const int16_t y0 = min16(a.y, b.y);
+  const int16_t x1 = max16(static_cast<int16_t>(a.x + a.w), static_cast<int16_t>(b.x + b.w));
+  const int16_t y1 = max16(static_cast<int16_t>(a.y + a.h), static_cast<int16_t>(b.y + b.h));
+  return {x0, y0, static_cast<int16_t>(x1 - x0), static_cast<int16_t>(y1 - y0)};
+}
+
+// True when the rects overlap or share an edge, i.e. their union is cheap to
+// treat as one box.
+bool touching(const DirtyRect &a, const DirtyRect &b) {
+  return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+uint32_t rect_area(const DirtyRect &r) { return static_cast<uint32_t>(r.w) * static_cast<uint32_t>(r.h); }
+
+}  // namespace
+
+DirtyRegion::DirtyRegion() : rects_{}, count_(0), width_(0), height_(0) {}
+
+void DirtyRegion::set_bounds(int16_t width, int16_t height) {
+  width_ = width;
+  height_ = height;
+  count_ = 0;
+}
+
+void DirtyRegion::clear() { count_ = 0; }
+
+void DirtyRegion::add(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  int32_t x0 = x;
+  int32_t y0 = y;
+  int32_t x1 = static_cast<int32_t>(x) + w;
+  int32_t y1 = static_cast<int32_t>(y) + h;
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 > width_) x1 = width_;
+  if (y1 > height_) y1 = height_;
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+  insert({static_cast<int16_t>(x0), static_cast<int16_t>(y0), static_cast<int16_t>(x1 - x0),
+          static_cast<int16_t>(y1 - y0)});
+}
+
+void DirtyRegion::add_all() {
+  count_ = 0;
+  add(0, 0, width_, height_);
+}
+
+void DirtyRegion::add_region(const DirtyRegion &other) {
+  for (uint8_t i = 0; i < other.count_; ++i) {
+    insert(other.rects_[i]);
+  }
+}
+
+bool DirtyRegion::empty() const { return count_ == 0; }
+
+uint8_t DirtyRegion::count() const { return count_; }
+
+const DirtyRect &DirtyRegion::rect(uint8_t index) const { return rects_[index]; }
+
+uint32_t DirtyRegion::area() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    total += rect_area(rects_[i]);
+  }
+  return total;
+}
+
+void DirtyRegion::insert(DirtyRect r) {
+  // Absorb every rect the new one touches; growing r can make it reach rects
+  // it missed earlier, so rescan after each merge.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (touching(r, rects_[i])) {
+        r = bounding_box(r, rects_[i]);
+        remove_at(i);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (count_ < kMaxRects) {
+    rects_[count_++] = r;
+    return;
+  }
+
+  uint8_t best = 0;
+  uint32_t bestGrowth = UINT32_MAX;
+  for (uint8_t i = 0; i < count_; ++i) {
+    const uint32_t growth = rect_area(bounding_box(r, rects_[i])) - rect_area(rects_[i]);
+    if (growth < bestGrowth) {
+      bestGrowth = growth;
+      best = i;
+    }
+  }
+  const DirtyRect combined = bounding_box(r, rects_[best]);
+  remove_at(best);
+  insert(combined);
+}
+
+void DirtyRegion::remove_at(uint8_t index) {
+  rects_[index] = rects_[count_ - 1];
+  --count_;
+}
+
+ScanlineMask::ScanlineMask() : bits_{} {}
+
+void ScanlineMask::set_all(bool value) { memset(bits_, value ? 0xFF : 0x00, sizeof(bits_)); }
+
+void ScanlineMask::set_range(int16_t y, int16_t h, bool value) {
+  int32_t y0 = y;
+  int32_t y1 = static_cast<int32_t>(y) + h;
+  if (y0 < 0) y0 = 0;
+  if (y1 > kMaxRows) y1 = kMaxRows;
+  for (int32_t row = y0; row < y1; ++row) {
+    const uint32_t bit = 1UL << (row & 31);
+    if (value) {
+      bits_[row >> 5] |= bit;
+    } else {
+      bits_[row >> 5] &= ~bit;
+    }
+  }
+}
+
+bool ScanlineMask::test(int16_t y) const {
+  if (y < 0) {
+    return false;
+  }
+  // Rows past the mask are never tracked, so they must be assumed lit.
+  if (y >= static_cast<int16_t>(kMaxRows)) {
+    return true;
+  }
+  return (bits_[y >> 5] & (1UL << (y & 31))) != 0;
+}
+
+}  // namespace display
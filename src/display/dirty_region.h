@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace display {
+
+struct DirtyRect {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+// Small fixed list of disjoint rectangles touched during one frame. Rects that
+// overlap or abut are merged; when the list is full the pair whose bounding box
+// grows least is merged, so the region only ever over-approximates.
+class DirtyRegion final {
+ public:
+  static constexpr uint8_t kMaxRects = 8;
+
+  DirtyRegion();
+
+  void set_bounds(int16_t width, int16_t height);
+  void clear();
+  void add(int16_t x, int16_t y, int16_t w, int16_t h);
+  void add_all();
+  void add_region(const DirtyRegion &other);
+
+  bool empty() const;
+  uint8_t count() const;
+  const DirtyRect &rect(uint8_t index) const;
+  uint32_t area() const;
+
+ private:
+  void insert(DirtyRect r);
+  void remove_at(uint8_t index);
+
+  DirtyRect rects_[kMaxRects];
+  uint8_t count_;
+  int16_t width_;
+  int16_t height_;
+};
+
+// One bit per scanline, used to remember which rows may hold non-black pixels.
+// Rows beyond kMaxRows always read as set.
+class ScanlineMask final {
+ public:
+  static constexpr uint16_t kMaxRows = 256;
+
+  ScanlineMask();
+
+  void set_all(bool value);
+  void set_range(int16_t y, int16_t h, bool value);
+  bool test(int16_t y) const;
+
+ private:
+  uint32_t bits_[kMaxRows / 32];
+};
+
+}  // namespace display
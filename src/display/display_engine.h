@@ -24,6 +24,9 @@ class DisplayEngine {
   virtual void fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) = 0;
   virtual void draw_pixel(int16_t x, int16_t y, uint16_t color) = 0;
   virtual void draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) = 0;
+  // 1bpp MSB-first bitmap, each row padded to (w + 7) / 8 bytes. Set bits draw
+  // fg, clear bits draw bg.
+  virtual void draw_bitmap(int16_t x, int16_t y, const uint8_t *bits, int16_t w, int16_t h, uint16_t fg, uint16_t bg) = 0;
   virtual TextMetrics measure_text(const char *text, uint8_t size) = 0;
 };
 
@@ -0,0 +1,419 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "display/display_engine.h"
+
+namespace display {
+
+// Font data shared by the firmware and the host tools, so layout estimates,
+// text measurement and the host preview all see the glyphs Adafruit_GFX draws.
+//
+// kClassicFontColumns is the Adafruit GFX built-in 5x7 font (glcdfont.c) for
+// 0x20-0x7E: five column bytes per glyph, bit 0 = top row, drawn in a 6x8 cell.
+// kTinyFontGlyphs / kTinyFontBitmap are TomThumb in GFXfont layout: row-major
+// bits packed MSB-first per glyph, positioned relative to the text baseline.
+// DisplayEngine checks both against the linked library at boot.
+
+struct FontGlyph {
+  uint16_t bitmapOffset;
+  uint8_t width;
+  uint8_t height;
+  uint8_t xAdvance;
+  int8_t xOffset;
+  int8_t yOffset;
+};
+
+constexpr char kFontFirstChar = 0x20;
+constexpr char kFontLastChar = 0x7E;
+constexpr uint8_t kFontGlyphCount = kFontLastChar - kFontFirstChar + 1;
+constexpr uint8_t kNoGlyph = 0xFF;
+constexpr uint8_t kClassicCellW = 6;
+constexpr uint8_t kClassicCellH = 8;
+constexpr uint8_t kClassicInkW = 5;
+
+inline constexpr uint8_t kClassicFontColumns[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // 0x20 space
+    {0x00, 0x00, 0x5F, 0x00, 0x00},  // 0x21 !
+    {0x00, 0x07, 0x00, 0x07, 0x00},  // 0x22 "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14},  // 0x23 #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12},  // 0x24 $
+    {0x23, 0x13, 0x08, 0x64, 0x62},  // 0x25 %
+    {0x36, 0x49, 0x56, 0x20, 0x50},  // 0x26 &
+    {0x00, 0x08, 0x07, 0x03, 0x00},  // 0x27 quotesingle
+    {0x00, 0x1C, 0x22, 0x41, 0x00},  // 0x28 (
+    {0x00, 0x41, 0x22, 0x1C, 0x00},  // 0x29 )
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A},  // 0x2A *
+    {0x08, 0x08, 0x3E, 0x08, 0x08},  // 0x2B +
+    {0x00, 0x80, 0x70, 0x30, 0x00},  // 0x2C ,
+    {0x08, 0x08, 0x08, 0x08, 0x08},  // 0x2D -
+    {0x00, 0x00, 0x60, 0x60, 0x00},  // 0x2E .
+    {0x20, 0x10, 0x08, 0x04, 0x02},  // 0x2F /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E},  // 0x30 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00},  // 0x31 1
+    {0x72, 0x49, 0x49, 0x49, 0x46},  // 0x32 2
+    {0x21, 0x41, 0x49, 0x4D, 0x33},  // 0x33 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10},  // 0x34 4
+    {0x27, 0x45, 0x45, 0x45, 0x39},  // 0x35 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x31},  // 0x36 6
+    {0x41, 0x21, 0x11, 0x09, 0x07},  // 0x37 7
+    {0x36, 0x49, 0x49, 0x49, 0x36},  // 0x38 8
+    {0x46, 0x49, 0x49, 0x29, 0x1E},  // 0x39 9
+    {0x00, 0x00, 0x14, 0x00, 0x00},  // 0x3A :
+    {0x00, 0x40, 0x34, 0x00, 0x00},  // 0x3B ;
+    {0x00, 0x08, 0x14, 0x22, 0x41},  // 0x3C <
+    {0x14, 0x14, 0x14, 0x14, 0x14},  // 0x3D =
+    {0x00, 0x41, 0x22, 0x14, 0x08},  // 0x3E >
+    {0x02, 0x01, 0x59, 0x09, 0x06},  // 0x3F ?
+    {0x3E, 0x41, 0x5D, 0x59, 0x4E},  // 0x40 @
+    {0x7C, 0x12, 0x11, 0x12, 0x7C},  // 0x41 A
+    {0x7F, 0x49, 0x49, 0x49, 0x36},  // 0x42 B
+    {0x3E, 0x41, 0x41, 0x41, 0x22},  // 0x43 C
+    {0x7F, 0x41, 0x41, 0x41, 0x3E},  // 0x44 D
+    {0x7F, 0x49, 0x49, 0x49, 0x41},  // 0x45 E
+    {0x7F, 0x09, 0x09, 0x09, 0x01},  // 0x46 F
+    {0x3E, 0x41, 0x41, 0x51, 0x73},  // 0x47 G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F},  // 0x48 H
+    {0x00, 0x41, 0x7F, 0x41, 0x00},  // 0x49 I
+    {0x20, 0x40, 0x41, 0x3F, 0x01},  // 0x4A J
+    {0x7F, 0x08, 0x14, 0x22, 0x41},  // 0x4B K
+    {0x7F, 0x40, 0x40, 0x40, 0x40},  // 0x4C L
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F},  // 0x4D M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F},  // 0x4E N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E},  // 0x4F O
+    {0x7F, 0x09, 0x09, 0x09, 0x06},  // 0x50 P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E},  // 0x51 Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46},  // 0x52 R
+    {0x26, 0x49, 0x49, 0x49, 0x32},  // 0x53 S
+    {0x03, 0x01, 0x7F, 0x01, 0x03},  // 0x54 T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F},  // 0x55 U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F},  // 0x56 V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F},  // 0x57 W
+    {0x63, 0x14, 0x08, 0x14, 0x63},  // 0x58 X
+    {0x03, 0x04, 0x78, 0x04, 0x03},  // 0x59 Y
+    {0x61, 0x59, 0x49, 0x4D, 0x43},  // 0x5A Z
+    {0x00, 0x7F, 0x41, 0x41, 0x41},  // 0x5B [
+    {0x02, 0x04, 0x08, 0x10, 0x20},  // 0x5C backslash
+    {0x00, 0x41, 0x41, 0x41, 0x7F},  // 0x5D ]
+    {0x04, 0x02, 0x01, 0x02, 0x04},  // 0x5E ^
+    {0x40, 0x40, 0x40, 0x40, 0x40},  // 0x5F _
+    {0x00, 0x03, 0x07, 0x08, 0x00},  // 0x60 `
+    {0x20, 0x54, 0x54, 0x78, 0x40},  // 0x61 a
+    {0x7F, 0x28, 0x44, 0x44, 0x38},  // 0x62 b
+    {0x38, 0x44, 0x44, 0x44, 0x28},  // 0x63 c
+    {0x38, 0x44, 0x44, 0x28, 0x7F},  // 0x64 d
+    {0x38, 0x54, 0x54, 0x54, 0x18},  // 0x65 e
+    {0x00, 0x08, 0x7E, 0x09, 0x02},  // 0x66 f
+    {0x18, 0xA4, 0xA4, 0x9C, 0x78},  // 0x67 g
+    {0x7F, 0x08, 0x04, 0x04, 0x78},  // 0x68 h
+    {0x00, 0x44, 0x7D, 0x40, 0x00},  // 0x69 i
+    {0x20, 0x40, 0x40, 0x3D, 0x00},  // 0x6A j
+    {0x7F, 0x10, 0x28, 0x44, 0x00},  // 0x6B k
+    {0x00, 0x41, 0x7F, 0x40, 0x00},  // 0x6C l
+    {0x7C, 0x04, 0x78, 0x04, 0x78},  // 0x6D m
+    {0x7C, 0x08, 0x04, 0x04, 0x78},  // 0x6E n
+    {0x38, 0x44, 0x44, 0x44, 0x38},  // 0x6F o
+    {0xFC, 0x18, 0x24, 0x24, 0x18},  // 0x70 p
+    {0x18, 0x24, 0x24, 0x18, 0xFC},  // 0x71 q
+    {0x7C, 0x08, 0x04, 0x04, 0x08},  // 0x72 r
+    {0x48, 0x54, 0x54, 0x54, 0x24},  // 0x73 s
+    {0x04, 0x04, 0x3F, 0x44, 0x24},  // 0x74 t
+    {0x3C, 0x40, 0x40, 0x20, 0x7C},  // 0x75 u
+    {0x1C, 0x20, 0x40, 0x20, 0x1C},  // 0x76 v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C},  // 0x77 w
+    {0x44, 0x28, 0x10, 0x28, 0x44},  // 0x78 x
+    {0x4C, 0x90, 0x90, 0x90, 0x7C},  // 0x79 y
+    {0x44, 0x64, 0x54, 0x4C, 0x44},  // 0x7A z
+    {0x00, 0x08, 0x36, 0x41, 0x00},  // 0x7B {
+    {0x00, 0x00, 0x77, 0x00, 0x00},  // 0x7C |
+    {0x00, 0x41, 0x36, 0x08, 0x00},  // 0x7D }
+    {0x02, 0x01, 0x02, 0x04, 0x02},  // 0x7E ~
+};
+
+inline constexpr uint8_t kTinyFontBitmap[] = {
+    0xE8, 0xB4, 0xBE, 0xFA, 0x79, 0x3C, 0x85, 0x42, 0xDB, 0xD6, 0xC0, 0x6A,
+    0x40, 0x95, 0x80, 0xAA, 0x80, 0x5D, 0x00, 0x60, 0xE0, 0x80, 0x25, 0x48,
+    0x76, 0xDC, 0x75, 0x40, 0xC5, 0x4E, 0xC5, 0x1C, 0xB7, 0x92, 0xF3, 0x1C,
+    0x73, 0xDE, 0xE5, 0x48, 0xF7, 0xDE, 0xF7, 0x9C, 0xA0, 0x46, 0x2A, 0x22,
+    0xE3, 0x80, 0x88, 0xA8, 0xE5, 0x04, 0x57, 0xC6, 0x57, 0xDA, 0xD7, 0x5C,
+    0x72, 0x46, 0xD6, 0xDC, 0xF3, 0xCE, 0xF3, 0xC8, 0x73, 0xD6, 0xB7, 0xDA,
+    0xE9, 0x2E, 0x24, 0xD4, 0xB7, 0x5A, 0x92, 0x4E, 0xBF, 0xDA, 0xBF, 0xFA,
+    0x56, 0xD4, 0xD7, 0x48, 0x56, 0xF6, 0xD7, 0xEA, 0x71, 0x1C, 0xE9, 0x24,
+    0xB6, 0xD6, 0xB6, 0xA4, 0xB7, 0xFA, 0xB5, 0x5A, 0xB5, 0x24, 0xE5, 0x4E,
+    0xF2, 0x4E, 0x88, 0x80, 0xE4, 0x9E, 0x54, 0xE0, 0x90, 0xCE, 0xF0, 0x9A,
+    0xDC, 0x72, 0x30, 0x2E, 0xD6, 0x77, 0x30, 0x2B, 0xA4, 0x77, 0x94, 0x9A,
+    0xDA, 0xB8, 0x20, 0x9A, 0x80, 0x97, 0x6A, 0xC9, 0x2E, 0xFF, 0xD0, 0xD6,
+    0xD0, 0x56, 0xA0, 0xD6, 0xE8, 0x76, 0xB2, 0x72, 0x40, 0x79, 0xE0, 0x5D,
+    0x26, 0xB6, 0xB0, 0xB7, 0xA0, 0xBF, 0xF0, 0xA9, 0x50, 0xB5, 0x94, 0xEF,
+    0x70, 0x6A, 0x26, 0xD8, 0xC8, 0xAC, 0x78,
+};
+
+inline constexpr FontGlyph kTinyFontGlyphs[] = {
+    {0, 0, 0, 4, 0, -5},  // 0x20 space
+    {0, 1, 5, 4, 1, -5},  // 0x21 !
+    {1, 3, 2, 4, 0, -5},  // 0x22 "
+    {2, 3, 5, 4, 0, -5},  // 0x23 #
+    {4, 3, 5, 4, 0, -5},  // 0x24 $
+    {6, 3, 5, 4, 0, -5},  // 0x25 %
+    {8, 3, 5, 4, 0, -5},  // 0x26 &
+    {10, 1, 2, 4, 1, -5},  // 0x27 quotesingle
+    {11, 2, 5, 4, 1, -5},  // 0x28 (
+    {13, 2, 5, 4, 0, -5},  // 0x29 )
+    {15, 3, 3, 4, 0, -5},  // 0x2A *
+    {17, 3, 3, 4, 0, -4},  // 0x2B +
+    {19, 2, 2, 4, 0, -1},  // 0x2C ,
+    {20, 3, 1, 4, 0, -3},  // 0x2D -
+    {21, 1, 1, 4, 1, -1},  // 0x2E .
+    {22, 3, 5, 4, 0, -5},  // 0x2F /
+    {24, 3, 5, 4, 0, -5},  // 0x30 0
+    {26, 2, 5, 4, 0, -5},  // 0x31 1
+    {28, 3, 5, 4, 0, -5},  // 0x32 2
+    {30, 3, 5, 4, 0, -5},  // 0x33 3
+    {32, 3, 5, 4, 0, -5},  // 0x34 4
+    {34, 3, 5, 4, 0, -5},  // 0x35 5
+    {36, 3, 5, 4, 0, -5},  // 0x36 6
+    {38, 3, 5, 4, 0, -5},  // 0x37 7
+    {40, 3, 5, 4, 0, -5},  // 0x38 8
+    {42, 3, 5, 4, 0, -5},  // 0x39 9
+    {44, 1, 3, 4, 1, -4},  // 0x3A :
+    {45, 2, 4, 4, 0, -4},  // 0x3B ;
+    {46, 3, 5, 4, 0, -5},  // 0x3C <
+    {48, 3, 3, 4, 0, -4},  // 0x3D =
+    {50, 3, 5, 4, 0, -5},  // 0x3E >
+    {52, 3, 5, 4, 0, -5},  // 0x3F ?
+    {54, 3, 5, 4, 0, -5},  // 0x40 @
+    {56, 3, 5, 4, 0, -5},  // 0x41 A
+    {58, 3, 5, 4, 0, -5},  // 0x42 B
+    {60, 3, 5, 4, 0, -5},  // 0x43 C
+    {62, 3, 5, 4, 0, -5},  // 0x44 D
+    {64, 3, 5, 4, 0, -5},  // 0x45 E
+    {66, 3, 5, 4, 0, -5},  // 0x46 F
+    {68, 3, 5, 4, 0, -5},  // 0x47 G
+    {70, 3, 5, 4, 0, -5},  // 0x48 H
+    {72, 3, 5, 4, 0, -5},  // 0x49 I
+    {74, 3, 5, 4, 0, -5},  // 0x4A J
+    {76, 3, 5, 4, 0, -5},  // 0x4B K
+    {78, 3, 5, 4, 0, -5},  // 0x4C L
+    {80, 3, 5, 4, 0, -5},  // 0x4D M
+    {82, 3, 5, 4, 0, -5},  // 0x4E N
+    {84, 3, 5, 4, 0, -5},  // 0x4F O
+    {86, 3, 5, 4, 0, -5},  // 0x50 P
+    {88, 3, 5, 4, 0, -5},  // 0x51 Q
+    {90, 3, 5, 4, 0, -5},  // 0x52 R
+    {92, 3, 5, 4, 0, -5},  // 0x53 S
+    {94, 3, 5, 4, 0, -5},  // 0x54 T
+    {96, 3, 5, 4, 0, -5},  // 0x55 U
+    {98, 3, 5, 4, 0, -5},  // 0x56 V
+    {100, 3, 5, 4, 0, -5},  // 0x57 W
+    {102, 3, 5, 4, 0, -5},  // 0x58 X
+    {104, 3, 5, 4, 0, -5},  // 0x59 Y
+    {106, 3, 5, 4, 0, -5},  // 0x5A Z
+    {108, 3, 5, 4, 0, -5},  // 0x5B [
+    {110, 3, 3, 4, 0, -4},  // 0x5C backslash
+    {112, 3, 5, 4, 0, -5},  // 0x5D ]
+    {114, 3, 2, 4, 0, -5},  // 0x5E ^
+    {115, 3, 1, 4, 0, -1},  // 0x5F _
+    {116, 2, 2, 4, 0, -5},  // 0x60 `
+    {117, 3, 4, 4, 0, -4},  // 0x61 a
+    {119, 3, 5, 4, 0, -5},  // 0x62 b
+    {121, 3, 4, 4, 0, -4},  // 0x63 c
+    {123, 3, 5, 4, 0, -5},  // 0x64 d
+    {125, 3, 4, 4, 0, -4},  // 0x65 e
+    {127, 3, 5, 4, 0, -5},  // 0x66 f
+    {129, 3, 5, 4, 0, -4},  // 0x67 g
+    {131, 3, 5, 4, 0, -5},  // 0x68 h
+    {133, 1, 5, 4, 1, -5},  // 0x69 i
+    {134, 3, 6, 4, 0, -5},  // 0x6A j
+    {137, 3, 5, 4, 0, -5},  // 0x6B k
+    {139, 3, 5, 4, 0, -5},  // 0x6C l
+    {141, 3, 4, 4, 0, -4},  // 0x6D m
+    {143, 3, 4, 4, 0, -4},  // 0x6E n
+    {145, 3, 4, 4, 0, -4},  // 0x6F o
+    {147, 3, 5, 4, 0, -4},  // 0x70 p
+    {149, 3, 5, 4, 0, -4},  // 0x71 q
+    {151, 3, 4, 4, 0, -4},  // 0x72 r
+    {153, 3, 4, 4, 0, -4},  // 0x73 s
+    {155, 3, 5, 4, 0, -5},  // 0x74 t
+    {157, 3, 4, 4, 0, -4},  // 0x75 u
+    {159, 3, 4, 4, 0, -4},  // 0x76 v
+    {161, 3, 4, 4, 0, -4},  // 0x77 w
+    {163, 3, 4, 4, 0, -4},  // 0x78 x
+    {165, 3, 5, 4, 0, -4},  // 0x79 y
+    {167, 3, 4, 4, 0, -4},  // 0x7A z
+    {169, 3, 5, 4, 0, -5},  // 0x7B {
+    {171, 1, 5, 4, 1, -5},  // 0x7C |
+    {172, 3, 5, 4, 0, -5},  // 0x7D }
+    {174, 3, 2, 4, 0, -5},  // 0x7E ~
+};
+
+static_assert(sizeof(kClassicFontColumns) / sizeof(kClassicFontColumns[0]) == kFontGlyphCount,
+              "classic font must cover 0x20-0x7E");
+static_assert(sizeof(kTinyFontGlyphs) / sizeof(kTinyFontGlyphs[0]) == kFontGlyphCount,
+              "tiny font must cover 0x20-0x7E");
+
+// Code point -> glyph slot, built at compile time. Both fonts cover the same
+// contiguous range, so a direct-mapped 128-entry table is a collision-free
+// (perfect) hash with a single load per lookup.
+struct GlyphSlotTable {
+  uint8_t slot[128];
+};
+
+constexpr GlyphSlotTable make_glyph_slot_table() {
+  GlyphSlotTable table{};
+  for (uint16_t code = 0; code < 128; ++code) {
+    table.slot[code] = (code >= static_cast<uint8_t>(kFontFirstChar) && code <= static_cast<uint8_t>(kFontLastChar))
+                           ? static_cast<uint8_t>(code - kFontFirstChar)
+                           : kNoGlyph;
+  }
+  return table;
+}
+
+inline constexpr GlyphSlotTable kGlyphSlots = make_glyph_slot_table();
+
+// Classic glyphs repacked row-major (bit 7 = leftmost column) at compile time,
+// which is the layout span fills and bitmap blits want.
+struct ClassicRowTable {
+  uint8_t rows[kFontGlyphCount][kClassicCellH];
+};
+
+constexpr ClassicRowTable make_classic_row_table() {
+  ClassicRowTable table{};
+  for (uint8_t glyph = 0; glyph < kFontGlyphCount; ++glyph) {
+    for (uint8_t row = 0; row < kClassicCellH; ++row) {
+      uint8_t bits = 0;
+      for (uint8_t col = 0; col < kClassicInkW; ++col) {
+        if ((kClassicFontColumns[glyph][col] >> row) & 1U) {
+          bits = static_cast<uint8_t>(bits | (0x80U >> col));
+        }
+      }
+      table.rows[glyph][row] = bits;
+    }
+  }
+  return table;
+}
+
+inline constexpr ClassicRowTable kClassicFontRows = make_classic_row_table();
+
+constexpr uint8_t font_glyph_slot(char c) {
+  const uint8_t code = static_cast<uint8_t>(c);
+  return code < 128 ? kGlyphSlots.slot[code] : kNoGlyph;
+}
+
+// Size 0 selects TomThumb, 255 selects TomThumb drawn twice ("tiny plus").
+constexpr bool font_is_tiny(uint8_t size) { return size == 0 || size == 255; }
+
+constexpr bool classic_glyph_pixel(uint8_t slot, uint8_t col, uint8_t row) {
+  return slot < kFontGlyphCount && col < kClassicInkW && row < kClassicCellH &&
+         (kClassicFontRows.rows[slot][row] & (0x80U >> col)) != 0;
+}
+
+constexpr bool tiny_glyph_pixel(uint8_t slot, uint8_t col, uint8_t row) {
+  if (slot >= kFontGlyphCount) {
+    return false;
+  }
+  const FontGlyph &g = kTinyFontGlyphs[slot];
+  if (col >= g.width || row >= g.height) {
+    return false;
+  }
+  const uint16_t bit = static_cast<uint16_t>(row * g.width + col);
+  return (kTinyFontBitmap[g.bitmapOffset + (bit >> 3)] & (0x80U >> (bit & 7))) != 0;
+}
+
+// Cursor advance for one character. Adafruit_GFX skips characters outside a
+// custom font's range without advancing.
+constexpr int16_t font_advance(char c, uint8_t size) {
+  if (font_is_tiny(size)) {
+    const uint8_t slot = font_glyph_slot(c);
+    return slot == kNoGlyph ? 0 : kTinyFontGlyphs[slot].xAdvance;
+  }
+  return static_cast<int16_t>(kClassicCellW * size);
+}
+
+// One past the rightmost column a character can light, relative to its origin.
+constexpr int16_t font_ink_right(char c, uint8_t size) {
+  if (font_is_tiny(size)) {
+    const uint8_t slot = font_glyph_slot(c);
+    if (slot == kNoGlyph) {
+      return 0;
+    }
+    const FontGlyph &g = kTinyFontGlyphs[slot];
+    return static_cast<int16_t>(g.xOffset + g.width + (size == 255 && g.width > 0 ? 1 : 0));
+  }
+  return static_cast<int16_t>(kClassicInkW * size);
+}
+
+// Width of a line laid out one glyph at a time with a custom space advance:
+// full advances for every character but the last, whose inked width is used
+// so the blank spacing column after the final glyph is not counted.
+constexpr int16_t font_line_width(const char *text, uint8_t size, int16_t spaceAdvance) {
+  if (!text || text[0] == '\0') {
+    return 0;
+  }
+  int16_t width = 0;
+  size_t i = 0;
+  for (; text[i + 1] != '\0'; ++i) {
+    width = static_cast<int16_t>(width + (text[i] == ' ' ? spaceAdvance : font_advance(text[i], size)));
+  }
+  return static_cast<int16_t>(width + (text[i] == ' ' ? spaceAdvance : font_ink_right(text[i], size)));
+}
+
+// Same result as Adafruit_GFX::getTextBounds() at (0, 0) for a single line,
+// including the extra column DisplayEngine adds for tiny-plus text.
+constexpr TextMetrics font_measure_text(const char *text, uint8_t size) {
+  TextMetrics tm{0, 0, 0, 0};
+  if (!text) {
+    return tm;
+  }
+
+  int16_t minX = INT16_MAX;
+  int16_t minY = INT16_MAX;
+  int16_t maxX = -1;
+  int16_t maxY = -1;
+  int16_t cursorX = 0;
+  const bool tiny = font_is_tiny(size);
+  for (const char *p = text; *p; ++p) {
+    if (*p == '\n' || *p == '\r') {
+      continue;
+    }
+    if (tiny) {
+      const uint8_t slot = font_glyph_slot(*p);
+      if (slot == kNoGlyph) {
+        continue;
+      }
+      const FontGlyph &g = kTinyFontGlyphs[slot];
+      const int16_t x1 = static_cast<int16_t>(cursorX + g.xOffset);
+      const int16_t y1 = g.yOffset;
+      const int16_t x2 = static_cast<int16_t>(x1 + g.width - 1);
+      const int16_t y2 = static_cast<int16_t>(y1 + g.height - 1);
+      minX = x1 < minX ? x1 : minX;
+      minY = y1 < minY ? y1 : minY;
+      maxX = x2 > maxX ? x2 : maxX;
+      maxY = y2 > maxY ? y2 : maxY;
+      cursorX = static_cast<int16_t>(cursorX + g.xAdvance);
+    } else {
+      const int16_t x2 = static_cast<int16_t>(cursorX + kClassicCellW * size - 1);
+      const int16_t y2 = static_cast<int16_t>(kClassicCellH * size - 1);
+      minX = cursorX < minX ? cursorX : minX;
+      minY = 0 < minY ? 0 : minY;
+      maxX = x2 > maxX ? x2 : maxX;
+      maxY = y2 > maxY ? y2 : maxY;
+      cursorX = static_cast<int16_t>(cursorX + kClassicCellW * size);
+    }
+  }
+
+  if (maxX >= minX) {
+    tm.xOffset = minX;
+    tm.width = static_cast<int16_t>(maxX - minX + 1);
+  }
+  if (maxY >= minY) {
+    tm.yOffset = minY;
+    tm.height = static_cast<int16_t>(maxY - minY + 1);
+  }
+  if (size == 255) {
+    tm.width = static_cast<int16_t>(tm.width + 1);
+  }
+  return tm;
+}
+
+}  // namespace display
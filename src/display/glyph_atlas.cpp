@@ -0,0 +1,83 @@
+#include "display/glyph_atlas.h"
+
+namespace display {
+
+GlyphAtlas::GlyphAtlas() : glyphs_{}, spans_{}, spanCount_(0) {}
+
+void GlyphAtlas::clear() {
+  for (uint8_t set = 0; set < static_cast<uint8_t>(GlyphSet::kCount); ++set) {
+    for (uint16_t i = 0; i < kGlyphsPerSet; ++i) {
+      glyphs_[set][i] = {};
+    }
+  }
+  spanCount_ = 0;
+}
+
+bool GlyphAtlas::add_glyph(GlyphSet set,
+                           char c,
+                           const uint8_t *cells,
+                           uint8_t w,
+                           uint8_t h,
+                           int8_t offsetX,
+                           int8_t offsetY,
+                           uint8_t advance) {
+  if (set >= GlyphSet::kCount || c < kFirstChar || c > kLastChar || (w > 0 && h > 0 && !cells)) {
+    return false;
+  }
+
+  const uint16_t first = spanCount_;
+  for (uint8_t row = 0; row < h; ++row) {
+    const uint8_t *line = &cells[static_cast<uint16_t>(row) * w];
+    uint8_t col = 0;
+    while (col < w) {
+      const uint8_t value = line[col];
+      uint8_t end = static_cast<uint8_t>(col + 1);
+      while (end < w && line[end] == value) {
+        ++end;
+      }
+      if (value != kCellEmpty) {
+        if (spanCount_ >= kMaxSpans || spanCount_ - first >= UINT8_MAX) {
+          spanCount_ = first;
+          return false;
+        }
+        spans_[spanCount_++] = {static_cast<int8_t>(offsetX + col), static_cast<int8_t>(offsetY + row),
+                                static_cast<uint8_t>(end - col), static_cast<uint8_t>(value == kCellForeground)};
+      }
+      col = end;
+    }
+  }
+
+  Glyph &g = glyphs_[static_cast<uint8_t>(set)][c - kFirstChar];
+  g.firstSpan = first;
+  g.spanCount = static_cast<uint8_t>(spanCount_ - first);
+  g.advance = advance;
+  g.present = true;
+  return true;
+}
+
+bool GlyphAtlas::has(GlyphSet set, char c) const {
+  if (set >= GlyphSet::kCount || c < kFirstChar || c > kLastChar) {
+    return false;
+  }
+  return glyphs_[static_cast<uint8_t>(set)][c - kFirstChar].present;
+}
+
+bool GlyphAtlas::supports(GlyphSet set, const char *text) const {
+  if (!text) {
+    return false;
+  }
+  for (const char *p = text; *p; ++p) {
+    if (!has(set, *p)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint8_t GlyphAtlas::advance(GlyphSet set, char c) const {
+  return has(set, c) ? glyphs_[static_cast<uint8_t>(set)][c - kFirstChar].advance : 0;
+}
+
+uint16_t GlyphAtlas::span_count() const { return spanCount_; }
+
+}  // namespace display
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace display {
+
+enum class GlyphSet : uint8_t {
+  kClassic,    // Adafruit GFX built-in 5x7 font, 6x8 cell, drawn at any integer scale
+  kTiny,       // TomThumb, positioned by baseline
+  kTinyBold,   // TomThumb overdrawn one pixel to the right ("tiny plus")
+  kCount,
+};
+
+struct GlyphSpan {
+  int8_t dx;  // offset from the draw origin, in unscaled pixels
+  int8_t dy;
+  uint8_t len;
+  uint8_t lit;  // 1 = foreground, 0 = background (only drawn for opaque text)
+};
+
+// Pre-rasterized glyphs stored as horizontal spans, so drawing a character is a
+// handful of span fills instead of a per-pixel walk through the font bitmap.
+// The atlas is filled once at boot from whatever font source the platform has.
+class GlyphAtlas final {
+ public:
+  static constexpr char kFirstChar = 0x20;
+  static constexpr char kLastChar = 0x7E;
+  static constexpr uint16_t kGlyphsPerSet = kLastChar - kFirstChar + 1;
+  static constexpr uint16_t kMaxSpans = 4608;
+
+  // Values for the `cells` grid passed to add_glyph().
+  static constexpr uint8_t kCellEmpty = 0;
+  static constexpr uint8_t kCellForeground = 1;
+  static constexpr uint8_t kCellBackground = 2;
+
+  GlyphAtlas();
+
+  void clear();
+
+  // Adds one glyph from a w x h grid of kCell* values. Cell (0, 0) is drawn at
+  // (offsetX, offsetY) relative to the draw origin. Returns false when the
+  // character is out of range or the span pool is full.
+  bool add_glyph(GlyphSet set,
+                 char c,
+                 const uint8_t *cells,
+                 uint8_t w,
+                 uint8_t h,
+                 int8_t offsetX,
+                 int8_t offsetY,
+                 uint8_t advance);
+
+  bool has(GlyphSet set, char c) const;
+  bool supports(GlyphSet set, const char *text) const;
+  uint8_t advance(GlyphSet set, char c) const;
+  uint16_t span_count() const;
+
+  // Calls fill(x, y, w, lit) for every span row of `text`, scaled by `scale`.
+  // Background spans are skipped unless `opaque` is set. Returns false without
+  // drawing anything if some character is not in the atlas.
+  template <typename SpanFn>
+  bool draw(GlyphSet set, int16_t x, int16_t y, const char *text, uint8_t scale, bool opaque, SpanFn &&fill) const {
+    if (scale == 0 || !supports(set, text)) {
+      return false;
+    }
+    const Glyph *glyphs = glyphs_[static_cast<uint8_t>(set)];
+    int16_t cx = x;
+    for (const char *p = text; *p; ++p) {
+      const Glyph &g = glyphs[*p - kFirstChar];
+      for (uint16_t i = 0; i < g.spanCount; ++i) {
+        const GlyphSpan &s = spans_[g.firstSpan + i];
+        if (!s.lit && !opaque) {
+          continue;
+        }
+        const int16_t sx = static_cast<int16_t>(cx + s.dx * scale);
+        const int16_t sy = static_cast<int16_t>(y + s.dy * scale);
+        for (uint8_t k = 0; k < scale; ++k) {
+          fill(sx, static_cast<int16_t>(sy + k), static_cast<int16_t>(s.len * scale), s.lit != 0);
+        }
+      }
+      cx = static_cast<int16_t>(cx + g.advance * scale);
+    }
+    return true;
+  }
+
+ private:
+  struct Glyph {
+    uint16_t firstSpan;
+    uint8_t spanCount;
+    uint8_t advance;
+    bool present;
+  };
+
+  Glyph glyphs_[static_cast<uint8_t>(GlyphSet::kCount)][kGlyphsPerSet];
+  GlyphSpan spans_[kMaxSpans];
+  uint16_t spanCount_;
+};
+
+}  // namespace display
@@ -0,0 +1,90 @@
+#include "display/scroll_strip.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace display {
+
+ScrollStrip::ScrollStrip() : bits_{}, window_{}, width_(0), height_(0) {}
+
+bool ScrollStrip::reset(int16_t width, int16_t height) {
+  if (width <= 0 || height <= 0 || width > kMaxWidthPx || height > kMaxHeightPx) {
+    invalidate();
+    return false;
+  }
+  width_ = width;
+  height_ = height;
+  memset(bits_, 0, static_cast<size_t>(kStrideBytes) * static_cast<size_t>(height_));
+  return true;
+}
+
+void ScrollStrip::invalidate() {
+  width_ = 0;
+  height_ = 0;
+}
+
+bool ScrollStrip::valid() const { return width_ > 0 && height_ > 0; }
+
+int16_t ScrollStrip::width() const { return width_; }
+
+int16_t ScrollStrip::height() const { return height_; }
+
+void ScrollStrip::set_pixel(int16_t x, int16_t y) {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return;
+  }
+  bits_[static_cast<size_t>(y) * kStrideBytes + static_cast<size_t>(x >> 3)] |=
+      static_cast<uint8_t>(0x80U >> (x & 7));
+}
+
+bool ScrollStrip::pixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return false;
+  }
+  return (bits_[static_cast<size_t>(y) * kStrideBytes + static_cast<size_t>(x >> 3)] & (0x80U >> (x & 7))) != 0;
+}
+
+uint8_t ScrollStrip::source_byte(const uint8_t *line, int32_t byteIndex) const {
+  // Bits past width_ are never set, so whole bytes outside the stride read as bg.
+  if (byteIndex < 0 || byteIndex >= kStrideBytes) {
+    return 0;
+  }
+  return line[byteIndex];
+}
+
+void ScrollStrip::blit(DisplayEngine &display,
+                       int16_t x,
+                       int16_t y,
+                       int16_t w,
+                       int16_t srcX,
+                       uint16_t fg,
+                       uint16_t bg) {
+  if (!valid() || w <= 0 || srcX < 0) {
+    return;
+  }
+  if (w > kMaxWidthPx) {
+    w = kMaxWidthPx;
+  }
+
+  // Realign the window to a byte boundary so it can go out as one packed
+  // bitmap: each destination byte is two neighbouring source bytes shifted.
+  const size_t windowStride = static_cast<size_t>((w + 7) / 8);
+  const int32_t firstByte = srcX >> 3;
+  const uint8_t shift = static_cast<uint8_t>(srcX & 7);
+  for (int16_t row = 0; row < height_; ++row) {
+    const uint8_t *line = &bits_[static_cast<size_t>(row) * kStrideBytes];
+    uint8_t *out = &window_[static_cast<size_t>(row) * windowStride];
+    for (size_t i = 0; i < windowStride; ++i) {
+      const int32_t src = firstByte + static_cast<int32_t>(i);
+      if (shift == 0) {
+        out[i] = source_byte(line, src);
+      } else {
+        out[i] = static_cast<uint8_t>((source_byte(line, src) << shift) | (source_byte(line, src + 1) >> (8 - shift)));
+      }
+    }
+  }
+
+  display.draw_bitmap(x, y, window_, w, height_, fg, bg);
+}
+
+}  // namespace display
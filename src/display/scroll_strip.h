@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "display/display_engine.h"
+
+namespace display {
+
+// Off-screen 1bpp copy of one scrolling text line. The line is rasterized once
+// when it changes; each scroll step then copies a clipped window of it to the
+// display instead of re-drawing every visible glyph.
+class ScrollStrip final {
+ public:
+  static constexpr int16_t kMaxWidthPx = 768;
+  static constexpr int16_t kMaxHeightPx = 16;
+  static constexpr uint16_t kStrideBytes = kMaxWidthPx / 8;
+
+  ScrollStrip();
+
+  // Clears the strip to `width` x `height` unlit pixels. Returns false (and
+  // leaves the strip invalid) when the size does not fit the fixed storage.
+  bool reset(int16_t width, int16_t height);
+  void invalidate();
+
+  bool valid() const;
+  int16_t width() const;
+  int16_t height() const;
+
+  void set_pixel(int16_t x, int16_t y);
+  bool pixel(int16_t x, int16_t y) const;
+
+  // Draws strip columns [srcX, srcX + w) at (x, y) with a single bitmap call.
+  // Columns past the end of the strip are drawn as bg, so the window is always
+  // fully repainted and no separate clear pass is needed.
+  void blit(DisplayEngine &display, int16_t x, int16_t y, int16_t w, int16_t srcX, uint16_t fg, uint16_t bg);
+
+ private:
+  uint8_t source_byte(const uint8_t *line, int32_t byteIndex) const;
+
+  uint8_t bits_[kStrideBytes * kMaxHeightPx];
+  uint8_t window_[kStrideBytes * kMaxHeightPx];
+  int16_t width_;
+  int16_t height_;
+};
+
+}  // namespace display
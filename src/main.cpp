@@ -55,6 +55,7 @@ core::DeviceController gController(gDeps);
 void setup() {
   Serial.begin(115200);
   delay(200);
+  core::logging::start_drain_task();
   randomSeed(esp_random());
   DCTRL_LOGI("BOOT", "Serial ready baud=115200 freeHeap=%lu sdk=%s",
              static_cast<unsigned long>(ESP.getFreeHeap()),
@@ -121,5 +122,5 @@ void setup() {
 
 void loop() {
   gController.tick(millis());
-  delay(50);
+  gController.wait_for_next_deadline();
 }
@@ -0,0 +1,215 @@
+#include "network/mqtt_codec.h"
+
+#include <string.h>
+
+namespace mqtt {
+
+namespace {
+
+constexpr uint8_t kProtocolLevel311 = 4;
+constexpr uint8_t kConnectFlagCleanSession = 0x02;
+constexpr uint8_t kConnectFlagWill = 0x04;
+constexpr uint8_t kConnectFlagWillRetain = 0x20;
+constexpr uint8_t kConnectFlagPassword = 0x40;
+constexpr uint8_t kConnectFlagUsername = 0x80;
+constexpr size_t kMaxRemainingLength = 268435455;
+
+bool has_text(const char *s) {
+  return s && s[0] != '\0';
+}
+
+size_t text_len(const char *s) {
+  return s ? strlen(s) : 0;
+}
+
+// Sequential writer that latches a failure instead of overrunning out.
+class Writer {
+ public:
+  Writer(uint8_t *out, size_t cap) : out_(out), cap_(cap), len_(0), ok_(out != nullptr) {}
+
+  void u8(uint8_t v) {
+    if (!ok_ || len_ >= cap_) {
+      ok_ = false;
+      return;
+    }
+    out_[len_++] = v;
+  }
+
+  void u16(uint16_t v) {
+    u8(static_cast<uint8_t>(v >> 8));
+    u8(static_cast<uint8_t>(v));
+  }
+
+  void bytes(const void *data, size_t n) {
+    if (!ok_ || n > cap_ - len_) {
+      ok_ = false;
+      return;
+    }
+    if (n > 0) memcpy(out_ + len_, data, n);
+    len_ += n;
+  }
+
+  void str(const char *s) {
+    const size_t n = text_len(s);
+    if (n > 0xFFFF) {
+      ok_ = false;
+      return;
+    }
+    u16(static_cast<uint16_t>(n));
+    bytes(s, n);
+  }
+
+  void fixed_header(uint8_t header, size_t remaining) {
+    if (remaining > kMaxRemainingLength) {
+      ok_ = false;
+      return;
+    }
+    u8(header);
+    do {
+      uint8_t digit = static_cast<uint8_t>(remaining % 128);
+      remaining /= 128;
+      if (remaining > 0) digit |= 0x80;
+      u8(digit);
+    } while (remaining > 0);
+  }
+
+  size_t finish() const { return ok_ ? len_ : 0; }
+
+ private:
+  uint8_t *out_;
+  size_t cap_;
+  size_t len_;
+  bool ok_;
+};
+
+uint16_t read_u16(const uint8_t *p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+}  // namespace
+
+size_t encode_connect(const ConnectOptions &options, uint8_t *out, size_t cap) {
+  const bool will = has_text(options.willTopic);
+  const bool user = has_text(options.username);
+  const bool pass = user && has_text(options.password);
+
+  size_t remaining = 10 + 2 + text_len(options.clientId);
+  if (will) remaining += 2 + text_len(options.willTopic) + 2 + text_len(options.willMessage);
+  if (user) remaining += 2 + text_len(options.username);
+  if (pass) remaining += 2 + text_len(options.password);
+
+  uint8_t flags = kConnectFlagCleanSession;
+  if (will) flags |= kConnectFlagWill | (options.willRetain ? kConnectFlagWillRetain : 0);
+  if (user) flags |= kConnectFlagUsername;
+  if (pass) flags |= kConnectFlagPassword;
+
+  Writer w(out, cap);
+  w.fixed_header(kConnect << 4, remaining);
+  w.str("MQTT");
+  w.u8(kProtocolLevel311);
+  w.u8(flags);
+  w.u16(options.keepAliveSec);
+  w.str(options.clientId);
+  if (will) {
+    w.str(options.willTopic);
+    w.str(options.willMessage);
+  }
+  if (user) w.str(options.username);
+  if (pass) w.str(options.password);
+  return w.finish();
+}
+
+size_t encode_subscribe(uint16_t packetId, const char *topic, uint8_t qos, uint8_t *out, size_t cap) {
+  if (!has_text(topic) || packetId == 0) return 0;
+  Writer w(out, cap);
+  w.fixed_header((kSubscribe << 4) | 0x02, 2 + 2 + text_len(topic) + 1);
+  w.u16(packetId);
+  w.str(topic);
+  w.u8(qos & 0x03);
+  return w.finish();
+}
+
+size_t encode_publish(const char *topic, const uint8_t *payload, size_t len, bool retained, uint8_t *out, size_t cap) {
+  if (!has_text(topic) || (len > 0 && !payload)) return 0;
+  Writer w(out, cap);
+  w.fixed_header(static_cast<uint8_t>((kPublish << 4) | (retained ? 0x01 : 0x00)), 2 + text_len(topic) + len);
+  w.str(topic);
+  w.bytes(payload, len);
+  return w.finish();
+}
+
+size_t encode_puback(uint16_t packetId, uint8_t *out, size_t cap) {
+  Writer w(out, cap);
+  w.fixed_header(kPuback << 4, 2);
+  w.u16(packetId);
+  return w.finish();
+}
+
+size_t encode_empty(PacketType type, uint8_t *out, size_t cap) {
+  Writer w(out, cap);
+  w.fixed_header(static_cast<uint8_t>(type << 4), 0);
+  return w.finish();
+}
+
+DecodeStatus next_packet(const uint8_t *data, size_t len, Packet &out, size_t &packetLen) {
+  packetLen = 0;
+  if (len < 2) return DecodeStatus::kIncomplete;
+
+  size_t remaining = 0;
+  size_t multiplier = 1;
+  size_t pos = 1;
+  while (true) {
+    if (pos >= len) return DecodeStatus::kIncomplete;
+    if (pos > 4) return DecodeStatus::kMalformed;
+    const uint8_t digit = data[pos++];
+    remaining += (digit & 0x7F) * multiplier;
+    multiplier *= 128;
+    if ((digit & 0x80) == 0) break;
+  }
+
+  packetLen = pos + remaining;
+  if (len < packetLen) return DecodeStatus::kIncomplete;
+  out.header = data[0];
+  out.body = data + pos;
+  out.bodyLen = remaining;
+  return DecodeStatus::kComplete;
+}
+
+bool parse_connack(const Packet &packet, uint8_t &returnCode) {
+  if (packet.type() != kConnack || packet.bodyLen != 2) return false;
+  returnCode = packet.body[1];
+  return true;
+}
+
+bool parse_suback(const Packet &packet, uint16_t &packetId, uint8_t &grantedQos) {
+  if (packet.type() != kSuback || packet.bodyLen < 3) return false;
+  packetId = read_u16(packet.body);
+  grantedQos = packet.body[2];
+  return true;
+}
+
+bool parse_publish(const Packet &packet,
+                   const char *&topic,
+                   size_t &topicLen,
+                   const uint8_t *&payload,
+                   size_t &payloadLen,
+                   uint16_t &packetId) {
+  if (packet.type() != kPublish || packet.bodyLen < 2) return false;
+  const uint8_t qos = (packet.header >> 1) & 0x03;
+  topicLen = read_u16(packet.body);
+  size_t pos = 2 + topicLen;
+  if (qos == 3 || pos > packet.bodyLen) return false;
+  topic = reinterpret_cast<const char *>(packet.body + 2);
+
+  packetId = 0;
+  if (qos > 0) {
+    if (pos + 2 > packet.bodyLen) return false;
+    packetId = read_u16(packet.body + pos);
+    pos += 2;
+  }
+  payload = packet.body + pos;
+  payloadLen = packet.bodyLen - pos;
+  return true;
+}
+
+}  // namespace mqtt
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mqtt {
+
+// MQTT 3.1.1 packet encoding and decoding over caller-owned buffers. Only
+// what the device uses: CONNECT with a will, QoS 0 PUBLISH out, QoS 0/1
+// PUBLISH in, one-topic SUBSCRIBE, keepalive pings and DISCONNECT.
+
+enum PacketType : uint8_t {
+  kConnect = 1,
+  kConnack = 2,
+  kPublish = 3,
+  kPuback = 4,
+  kSubscribe = 8,
+  kSuback = 9,
+  kPingreq = 12,
+  kPingresp = 13,
+  kDisconnect = 14,
+};
+
+// CONNACK return codes 1..5; 0 is accepted.
+constexpr uint8_t kConnackAccepted = 0;
+constexpr uint8_t kSubackFailure = 0x80;
+
+struct ConnectOptions {
+  const char *clientId;
+  const char *username;  // empty or null: no credentials
+  const char *password;
+  const char *willTopic;  // empty or null: no will
+  const char *willMessage;
+  bool willRetain;
+  uint16_t keepAliveSec;
+};
+
+// Encoders return the packet length, or 0 when it does not fit in cap.
+size_t encode_connect(const ConnectOptions &options, uint8_t *out, size_t cap);
+size_t encode_subscribe(uint16_t packetId, const char *topic, uint8_t qos, uint8_t *out, size_t cap);
+size_t encode_publish(const char *topic, const uint8_t *payload, size_t len, bool retained, uint8_t *out, size_t cap);
+size_t encode_puback(uint16_t packetId, uint8_t *out, size_t cap);
+// PINGREQ, PINGRESP and DISCONNECT, which have no variable header.
+size_t encode_empty(PacketType type, uint8_t *out, size_t cap);
+
+struct Packet {
+  uint8_t header;  // packet type in the high nibble, flags in the low one
+  const uint8_t *body;
+  size_t bodyLen;
+
+  PacketType type() const { return static_cast<PacketType>(header >> 4); }
+};
+
+enum class DecodeStatus : uint8_t {
+  kIncomplete,
+  kComplete,
+  kMalformed,
+};
+
+// Frames the packet at the start of data. packetLen is the whole packet's
+// size once the fixed header is complete, even while the body is not, so
+// callers can skip packets too large for their buffer.
+DecodeStatus next_packet(const uint8_t *data, size_t len, Packet &out, size_t &packetLen);
+
+bool parse_connack(const Packet &packet, uint8_t &returnCode);
+bool parse_suback(const Packet &packet, uint16_t &packetId, uint8_t &grantedQos);
+// topic is not NUL-terminated; packetId is 0 for QoS 0.
+bool parse_publish(const Packet &packet,
+                   const char *&topic,
+                   size_t &topicLen,
+                   const uint8_t *&payload,
+                   size_t &payloadLen,
+                   uint16_t &packetId);
+
+}  // namespace mqtt
@@ -0,0 +1,567 @@
+#include "network/mqtt_connection.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#if defined(ARDUINO)
+#include <lwip/dns.h>
+#include <lwip/inet.h>
+#include <lwip/sockets.h>
+#include <lwip/tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#endif
+
+namespace mqtt {
+
+namespace {
+
+enum DnsStatus : uint8_t {
+  kDnsIdle,
+  kDnsPending,
+  kDnsDone,
+  kDnsFailed,
+};
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Broker silence allowed past the keepalive interval before the session is
+// declared dead; the broker itself waits 1.5x before dropping us.
+constexpr uint32_t kKeepaliveGraceNum = 3;
+constexpr uint32_t kKeepaliveGraceDen = 2;
+
+bool has_text(const char *s) {
+  return s && s[0] != '\0';
+}
+
+bool would_block(int err) {
+  return err == EAGAIN || err == EWOULDBLOCK || err == EINPROGRESS;
+}
+
+uint32_t monotonic_us() {
+  using namespace std::chrono;
+  return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+#if defined(ARDUINO)
+// dns_gethostbyname() must run on the lwIP thread; results land in lookup
+// and the state machine picks them up on its next tick.
+void dns_found(const char *name, const ip_addr_t *addr, void *arg) {
+  auto *lookup = static_cast<Connection::DnsLookup *>(arg);
+  // A late answer for a host we no longer want is dropped.
+  if (lookup->status.load() != kDnsPending || !name || strcmp(name, lookup->host) != 0) return;
+  if (addr && IP_IS_V4(addr)) {
+    lookup->address = ip4_addr_get_u32(ip_2_ip4(addr));
+    lookup->status.store(kDnsDone);
+  } else {
+    lookup->status.store(kDnsFailed);
+  }
+}
+
+void dns_start(void *arg) {
+  auto *lookup = static_cast<Connection::DnsLookup *>(arg);
+  ip_addr_t addr;
+  const err_t err = dns_gethostbyname(lookup->host, &addr, &dns_found, lookup);
+  if (err == ERR_OK) {
+    dns_found(lookup->host, &addr, lookup);
+  } else if (err != ERR_INPROGRESS) {
+    lookup->status.store(kDnsFailed);
+  }
+}
+
+void begin_lookup(Connection::DnsLookup &lookup) {
+  if (tcpip_callback(&dns_start, &lookup) != ERR_OK) {
+    lookup.status.store(kDnsFailed);
+  }
+}
+#else
+// Host builds resolve synchronously; the tools only use literal addresses.
+void begin_lookup(Connection::DnsLookup &lookup) {
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *result = nullptr;
+  if (getaddrinfo(lookup.host, nullptr, &hints, &result) != 0 || !result) {
+    lookup.status.store(kDnsFailed);
+    return;
+  }
+  lookup.address = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(result);
+  lookup.status.store(kDnsDone);
+}
+#endif
+
+}  // namespace
+
+Connection::Connection()
+    : options_(default_options()),
+      state_(State::kIdle),
+      error_(Error::kNone),
+      errorDetail_(0),
+      socket_(-1),
+      phaseStartedAtMs_(0),
+      lastTxAtMs_(0),
+      lastRxAtMs_(0),
+      lastTickAtMs_(0),
+      pingOutstanding_(false),
+      nextPacketId_(1),
+      subscribePacketId_(0),
+      generation_(0),
+      maxTickUs_(0),
+      discardRemaining_(0),
+      dns_{},
+      messageCallback_(nullptr),
+      messageCtx_(nullptr),
+      rxLen_(0),
+      txLen_(0) {}
+
+Connection::~Connection() {
+  drop();
+}
+
+Connection::Options Connection::default_options() {
+  Options options{};
+  options.connect.keepAliveSec = 60;
+  options.dnsTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.connectTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.connackTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.subackTimeoutMs = kDefaultPhaseTimeoutMs;
+  return options;
+}
+
+bool Connection::start(const Options &options, uint32_t nowMs) {
+  if (state_ != State::kIdle || !has_text(options.host) || options.port == 0 ||
+      strlen(options.host) >= sizeof(dns_.host)) {
+    return false;
+  }
+  options_ = options;
+  error_ = Error::kNone;
+  errorDetail_ = 0;
+  rxLen_ = 0;
+  txLen_ = 0;
+  discardRemaining_ = 0;
+  pingOutstanding_ = false;
+
+  in_addr literal{};
+  if (inet_pton(AF_INET, options_.host, &literal) == 1) {
+    if (open_socket(literal.s_addr)) enter(State::kConnecting, nowMs);
+    return true;
+  }
+
+  strncpy(dns_.host, options_.host, sizeof(dns_.host) - 1);
+  dns_.host[sizeof(dns_.host) - 1] = '\0';
+  dns_.address = 0;
+  dns_.status.store(kDnsPending);
+  enter(State::kResolving, nowMs);
+  begin_lookup(dns_);
+  return true;
+}
+
+void Connection::tick(uint32_t nowMs) {
+  const uint32_t startedUs = monotonic_us();
+  lastTickAtMs_ = nowMs;
+  switch (state_) {
+    case State::kIdle:
+      break;
+    case State::kResolving:
+      tick_resolving(nowMs);
+      break;
+    case State::kConnecting:
+      tick_connecting(nowMs);
+      break;
+    case State::kAwaitConnack:
+    case State::kAwaitSuback:
+    case State::kConnected:
+      if (!flush(nowMs) || !receive(nowMs)) break;
+      if (state_ == State::kAwaitConnack && phase_expired(nowMs, options_.connackTimeoutMs)) {
+        fail(Error::kConnackTimeout, 0);
+      } else if (state_ == State::kAwaitSuback && phase_expired(nowMs, options_.subackTimeoutMs)) {
+        fail(Error::kSubackTimeout, 0);
+      } else if (state_ == State::kConnected) {
+        check_keepalive(nowMs);
+        flush(nowMs);
+      }
+      break;
+  }
+  const uint32_t elapsedUs = monotonic_us() - startedUs;
+  if (elapsedUs > maxTickUs_) maxTickUs_ = elapsedUs;
+}
+
+void Connection::disconnect() {
+  if (state_ == State::kConnected) {
+    uint8_t packet[2];
+    const size_t len = encode_empty(kDisconnect, packet, sizeof(packet));
+    if (queue(packet, len)) flush(lastTickAtMs_);
+  }
+  drop();
+}
+
+void Connection::drop() {
+  if (socket_ >= 0) {
+    ::close(socket_);
+    socket_ = -1;
+  }
+  dns_.status.store(kDnsIdle);
+  state_ = State::kIdle;
+  rxLen_ = 0;
+  txLen_ = 0;
+  ++generation_;
+}
+
+bool Connection::publish(const char *topic, const uint8_t *payload, size_t len, bool retained) {
+  if (state_ != State::kConnected) return false;
+  const size_t packetLen = encode_publish(topic, payload, len, retained, tx_ + txLen_, kTxBufferLen - txLen_);
+  if (packetLen == 0) return false;
+  txLen_ += packetLen;
+  return flush(lastTickAtMs_);
+}
+
+void Connection::set_message_callback(MessageCallback callback, void *ctx) {
+  messageCallback_ = callback;
+  messageCtx_ = ctx;
+}
+
+const char *Connection::state_name(State state) {
+  switch (state) {
+    case State::kIdle:
+      return "idle";
+    case State::kResolving:
+      return "resolving";
+    case State::kConnecting:
+      return "connecting";
+    case State::kAwaitConnack:
+      return "await_connack";
+    case State::kAwaitSuback:
+      return "await_suback";
+    case State::kConnected:
+      return "connected";
+  }
+  return "unknown";
+}
+
+const char *Connection::error_name(Error error) {
+  switch (error) {
+    case Error::kNone:
+      return "none";
+    case Error::kDnsFailed:
+      return "dns_failed";
+    case Error::kDnsTimeout:
+      return "dns_timeout";
+    case Error::kSocketFailed:
+      return "socket_failed";
+    case Error::kConnectFailed:
+      return "connect_failed";
+    case Error::kConnectTimeout:
+      return "connect_timeout";
+    case Error::kConnackTimeout:
+      return "connack_timeout";
+    case Error::kConnackRefused:
+      return "connack_refused";
+    case Error::kSubackTimeout:
+      return "suback_timeout";
+    case Error::kSubscribeRefused:
+      return "subscribe_refused";
+    case Error::kProtocol:
+      return "protocol_error";
+    case Error::kConnectionLost:
+      return "connection_lost";
+    case Error::kKeepaliveTimeout:
+      return "keepalive_timeout";
+    case Error::kBufferFull:
+      return "buffer_full";
+  }
+  return "unknown";
+}
+
+void Connection::enter(State state, uint32_t nowMs) {
+  state_ = state;
+  phaseStartedAtMs_ = nowMs;
+}
+
+void Connection::fail(Error error, int detail) {
+  drop();
+  error_ = error;
+  errorDetail_ = detail;
+}
+
+bool Connection::phase_expired(uint32_t nowMs, uint32_t timeoutMs) const {
+  return nowMs - phaseStartedAtMs_ >= timeoutMs;
+}
+
+void Connection::tick_resolving(uint32_t nowMs) {
+  const uint8_t status = dns_.status.load();
+  if (status == kDnsDone) {
+    dns_.status.store(kDnsIdle);
+    if (open_socket(dns_.address)) enter(State::kConnecting, nowMs);
+  } else if (status == kDnsFailed) {
+    fail(Error::kDnsFailed, 0);
+  } else if (phase_expired(nowMs, options_.dnsTimeoutMs)) {
+    fail(Error::kDnsTimeout, 0);
+  }
+}
+
+bool Connection::open_socket(uint32_t address) {
+  socket_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (socket_ < 0) {
+    fail(Error::kSocketFailed, errno);
+    return false;
+  }
+  const int flags = fcntl(socket_, F_GETFL, 0);
+  if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
+    fail(Error::kSocketFailed, errno);
+    return false;
+  }
+
+  // Detects silent NAT deaths well before the MQTT keepalive would.
+  const int keepAlive = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(keepAlive));
+#ifdef TCP_KEEPIDLE
+  const int keepIdle = 60;
+  const int keepIntvl = 15;
+  const int keepCnt = 4;
+  setsockopt(socket_, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(keepIdle));
+  setsockopt(socket_, IPPROTO_TCP, TCP_KEEPINTVL, &keepIntvl, sizeof(keepIntvl));
+  setsockopt(socket_, IPPROTO_TCP, TCP_KEEPCNT, &keepCnt, sizeof(keepCnt));
+#endif
+  const int noDelay = 1;
+  setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(options_.port);
+  addr.sin_addr.s_addr = address;
+  if (::connect(socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 && !would_block(errno)) {
+    fail(Error::kConnectFailed, errno);
+    return false;
+  }
+  return true;
+}
+
+void Connection::tick_connecting(uint32_t nowMs) {
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(socket_, &writable);
+  timeval zero{};
+  const int ready = ::select(socket_ + 1, nullptr, &writable, nullptr, &zero);
+  if (ready < 0) {
+    fail(Error::kConnectFailed, errno);
+    return;
+  }
+  if (ready == 0) {
+    if (phase_expired(nowMs, options_.connectTimeoutMs)) fail(Error::kConnectTimeout, 0);
+    return;
+  }
+
+  int soError = 0;
+  socklen_t soLen = sizeof(soError);
+  if (getsockopt(socket_, SOL_SOCKET, SO_ERROR, &soError, &soLen) < 0) soError = errno;
+  if (soError != 0) {
+    fail(Error::kConnectFailed, soError);
+    return;
+  }
+
+  enter(State::kAwaitConnack, nowMs);
+  lastRxAtMs_ = nowMs;
+  lastTickAtMs_ = nowMs;
+  if (queue_connect()) flush(nowMs);
+}
+
+bool Connection::queue(const uint8_t *data, size_t len) {
+  if (len == 0 || len > kTxBufferLen - txLen_) {
+    fail(Error::kBufferFull, static_cast<int>(len));
+    return false;
+  }
+  memcpy(tx_ + txLen_, data, len);
+  txLen_ += len;
+  return true;
+}
+
+bool Connection::queue_connect() {
+  const size_t len = encode_connect(options_.connect, tx_ + txLen_, kTxBufferLen - txLen_);
+  if (len == 0) {
+    fail(Error::kBufferFull, 0);
+    return false;
+  }
+  txLen_ += len;
+  return true;
+}
+
+bool Connection::queue_subscribe_or_birth(uint32_t nowMs) {
+  if (state_ == State::kAwaitConnack && has_text(options_.subscribeTopic)) {
+    subscribePacketId_ = nextPacketId_++;
+    if (nextPacketId_ == 0) nextPacketId_ = 1;
+    const size_t len =
+        encode_subscribe(subscribePacketId_, options_.subscribeTopic, 0, tx_ + txLen_, kTxBufferLen - txLen_);
+    if (len == 0) {
+      fail(Error::kBufferFull, 0);
+      return false;
+    }
+    txLen_ += len;
+    enter(State::kAwaitSuback, nowMs);
+    return true;
+  }
+
+  enter(State::kConnected, nowMs);
+  if (has_text(options_.birthTopic)) {
+    const char *payload = options_.birthPayload ? options_.birthPayload : "";
+    if (!publish(options_.birthTopic, reinterpret_cast<const uint8_t *>(payload), strlen(payload),
+                 options_.birthRetain)) {
+      if (state_ == State::kConnected) fail(Error::kBufferFull, 0);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Connection::flush(uint32_t nowMs) {
+  size_t sent = 0;
+  while (sent < txLen_) {
+    const ssize_t n = ::send(socket_, tx_ + sent, txLen_ - sent, kSendFlags);
+    if (n > 0) {
+      sent += static_cast<size_t>(n);
+      lastTxAtMs_ = nowMs;
+      continue;
+    }
+    if (n < 0 && would_block(errno)) break;
+    fail(Error::kConnectionLost, n < 0 ? errno : 0);
+    return false;
+  }
+  if (sent > 0) {
+    memmove(tx_, tx_ + sent, txLen_ - sent);
+    txLen_ -= sent;
+  }
+  return true;
+}
+
+bool Connection::receive(uint32_t nowMs) {
+  // One read per tick keeps the time bounded; the rest waits for next one.
+  const ssize_t n = ::recv(socket_, rx_ + rxLen_, kRxBufferLen - rxLen_, 0);
+  if (n == 0 || (n < 0 && !would_block(errno))) {
+    fail(Error::kConnectionLost, n < 0 ? errno : 0);
+    return false;
+  }
+  if (n < 0) return true;
+  lastRxAtMs_ = nowMs;
+  rxLen_ += static_cast<size_t>(n);
+
+  if (discardRemaining_ > 0) {
+    const size_t dropped = discardRemaining_ < rxLen_ ? discardRemaining_ : rxLen_;
+    memmove(rx_, rx_ + dropped, rxLen_ - dropped);
+    rxLen_ -= dropped;
+    discardRemaining_ -= dropped;
+  }
+
+  const uint32_t generation = generation_;
+  size_t consumed = 0;
+  while (consumed < rxLen_) {
+    Packet packet{};
+    size_t packetLen = 0;
+    const DecodeStatus status = next_packet(rx_ + consumed, rxLen_ - consumed, packet, packetLen);
+    if (status == DecodeStatus::kMalformed) {
+      fail(Error::kProtocol, 0);
+      return false;
+    }
+    if (status == DecodeStatus::kIncomplete) {
+      if (packetLen > kRxBufferLen) {
+        // Never fits: drop what we have and skip the rest as it arrives.
+        discardRemaining_ = packetLen - (rxLen_ - consumed);
+        consumed = rxLen_;
+      }
+      break;
+    }
+    consumed += packetLen;
+    handle_packet(packet, nowMs);
+    // The callback may have closed or restarted the session.
+    if (generation != generation_ || state_ == State::kIdle) return false;
+  }
+  if (consumed > 0) {
+    memmove(rx_, rx_ + consumed, rxLen_ - consumed);
+    rxLen_ -= consumed;
+  }
+  return true;
+}
+
+void Connection::handle_packet(const Packet &packet, uint32_t nowMs) {
+  if (state_ == State::kAwaitConnack) {
+    uint8_t returnCode = 0;
+    if (!parse_connack(packet, returnCode)) {
+      fail(Error::kProtocol, packet.type());
+    } else if (returnCode != kConnackAccepted) {
+      fail(Error::kConnackRefused, returnCode);
+    } else {
+      queue_subscribe_or_birth(nowMs);
+    }
+    return;
+  }
+
+  switch (packet.type()) {
+    case kSuback: {
+      uint16_t packetId = 0;
+      uint8_t granted = 0;
+      if (state_ != State::kAwaitSuback || !parse_suback(packet, packetId, granted) ||
+          packetId != subscribePacketId_) {
+        fail(Error::kProtocol, packet.type());
+      } else if (granted == kSubackFailure) {
+        fail(Error::kSubscribeRefused, granted);
+      } else {
+        queue_subscribe_or_birth(nowMs);
+      }
+      break;
+    }
+    case kPublish: {
+      const char *topic = nullptr;
+      size_t topicLen = 0;
+      const uint8_t *payload = nullptr;
+      size_t payloadLen = 0;
+      uint16_t packetId = 0;
+      if (!parse_publish(packet, topic, topicLen, payload, payloadLen, packetId) || topicLen >= kMaxTopicLen) {
+        fail(Error::kProtocol, packet.type());
+        break;
+      }
+      if (packetId != 0) {
+        uint8_t ack[4];
+        if (!queue(ack, encode_puback(packetId, ack, sizeof(ack)))) break;
+      }
+      memcpy(topic_, topic, topicLen);
+      topic_[topicLen] = '\0';
+      if (messageCallback_) messageCallback_(topic_, payload, payloadLen, messageCtx_);
+      break;
+    }
+    case kPingresp:
+      pingOutstanding_ = false;
+      break;
+    default:
+      fail(Error::kProtocol, packet.type());
+      break;
+  }
+}
+
+void Connection::check_keepalive(uint32_t nowMs) {
+  const uint32_t keepAliveMs = static_cast<uint32_t>(options_.connect.keepAliveSec) * 1000U;
+  if (keepAliveMs == 0) return;
+  if (nowMs - lastRxAtMs_ >= keepAliveMs * kKeepaliveGraceNum / kKeepaliveGraceDen) {
+    fail(Error::kKeepaliveTimeout, 0);
+    return;
+  }
+  const bool txIdle = nowMs - lastTxAtMs_ >= keepAliveMs;
+  const bool rxIdle = nowMs - lastRxAtMs_ >= keepAliveMs;
+  if (txIdle || (rxIdle && !pingOutstanding_)) {
+    uint8_t ping[2];
+    if (queue(ping, encode_empty(kPingreq, ping, sizeof(ping)))) pingOutstanding_ = true;
+  }
+}
+
+}  // namespace mqtt
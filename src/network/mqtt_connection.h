@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "network/mqtt_codec.h"
+
+namespace mqtt {
+
+// One broker session driven by tick(). Every step uses non-blocking sockets,
+// so a tick never waits on the network:
+//
+//   kResolving     DNS lookup (literal addresses skip it)
+//   kConnecting    TCP connect in flight
+//   kAwaitConnack  CONNECT queued, waiting for CONNACK
+//   kAwaitSuback   SUBSCRIBE queued, waiting for SUBACK
+//   kConnected     birth message queued; keepalive pings from here on
+//
+// Each phase has its own timeout. Any failure closes the socket and returns
+// to kIdle with error() set; retry policy belongs to the caller.
+class Connection final {
+ public:
+  enum class State : uint8_t {
+    kIdle,
+    kResolving,
+    kConnecting,
+    kAwaitConnack,
+    kAwaitSuback,
+    kConnected,
+  };
+
+  enum class Error : uint8_t {
+    kNone,
+    kDnsFailed,
+    kDnsTimeout,
+    kSocketFailed,
+    kConnectFailed,
+    kConnectTimeout,
+    kConnackTimeout,
+    kConnackRefused,
+    kSubackTimeout,
+    kSubscribeRefused,
+    kProtocol,
+    kConnectionLost,
+    kKeepaliveTimeout,
+    kBufferFull,
+  };
+
+  // Strings are not copied; they must outlive the attempt.
+  struct Options {
+    const char *host;
+    uint16_t port;
+    ConnectOptions connect;
+    const char *subscribeTopic;  // empty or null: skip SUBSCRIBE
+    const char *birthTopic;      // empty or null: no birth message
+    const char *birthPayload;
+    bool birthRetain;
+    uint32_t dnsTimeoutMs;
+    uint32_t connectTimeoutMs;
+    uint32_t connackTimeoutMs;
+    uint32_t subackTimeoutMs;
+  };
+
+  using MessageCallback = void (*)(const char *topic, const uint8_t *payload, size_t len, void *ctx);
+
+  static constexpr size_t kRxBufferLen = 1600;
+  static constexpr size_t kTxBufferLen = 2048;
+  static constexpr size_t kMaxTopicLen = 128;
+  static constexpr uint32_t kDefaultPhaseTimeoutMs = 5000;
+
+  // Filled in on the lwIP thread on the device, so status is atomic.
+  struct DnsLookup {
+    std::atomic<uint8_t> status;
+    uint32_t address;  // IPv4, network byte order
+    char host[64];
+  };
+
+  Connection();
+  ~Connection();
+
+  static Options default_options();
+
+  // Starts an attempt; false if one is already running or options are bad.
+  bool start(const Options &options, uint32_t nowMs);
+  void tick(uint32_t nowMs);
+  // Queues DISCONNECT, makes one flush attempt and closes the socket.
+  void disconnect();
+  // Drops the socket without telling the broker, so the will is published.
+  void drop();
+
+  // QoS 0; queued and flushed as the socket accepts it.
+  bool publish(const char *topic, const uint8_t *payload, size_t len, bool retained);
+
+  void set_message_callback(MessageCallback callback, void *ctx);
+
+  State state() const { return state_; }
+  Error error() const { return error_; }
+  bool connected() const { return state_ == State::kConnected; }
+  bool idle() const { return state_ == State::kIdle; }
+  // errno of the failing socket call, or the CONNACK return code.
+  int error_detail() const { return errorDetail_; }
+  // Longest single tick() so far, for checking the non-blocking claim.
+  uint32_t max_tick_us() const { return maxTickUs_; }
+
+  static const char *state_name(State state);
+  static const char *error_name(Error error);
+
+ private:
+  void enter(State state, uint32_t nowMs);
+  void fail(Error error, int detail);
+  void tick_resolving(uint32_t nowMs);
+  void tick_connecting(uint32_t nowMs);
+  bool open_socket(uint32_t address);
+  bool queue(const uint8_t *data, size_t len);
+  bool queue_connect();
+  bool queue_subscribe_or_birth(uint32_t nowMs);
+  bool flush(uint32_t nowMs);
+  bool receive(uint32_t nowMs);
+  void handle_packet(const Packet &packet, uint32_t nowMs);
+  void check_keepalive(uint32_t nowMs);
+  bool phase_expired(uint32_t nowMs, uint32_t timeoutMs) const;
+
+  Options options_;
+  State state_;
+  Error error_;
+  int errorDetail_;
+  int socket_;
+  uint32_t phaseStartedAtMs_;
+  uint32_t lastTxAtMs_;
+  uint32_t lastRxAtMs_;
+  uint32_t lastTickAtMs_;  // publish() runs between ticks and stamps with this
+  bool pingOutstanding_;
+  uint16_t nextPacketId_;
+  uint16_t subscribePacketId_;
+  uint32_t generation_;  // bumped by drop(), so callbacks can end a tick
+  uint32_t maxTickUs_;
+  size_t discardRemaining_;  // bytes left of an inbound packet too big for rx_
+  DnsLookup dns_;
+
+  MessageCallback messageCallback_;
+  void *messageCtx_;
+
+  uint8_t rx_[kRxBufferLen];
+  size_t rxLen_;
+  uint8_t tx_[kTxBufferLen];
+  size_t txLen_;
+  char topic_[kMaxTopicLen];
+};
+
+}  // namespace mqtt
@@ -0,0 +1,204 @@
+#include "parsing/binary_payload.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "parsing/generic_payload_parser.h"
+
+namespace parsing {
+
+namespace {
+
+// Bounds-checked reader over one payload; any overrun latches ok_ to false.
+class ByteReader {
+ public:
+  ByteReader(const uint8_t *data, size_t len) : data_(data), len_(len), pos_(0), ok_(data != nullptr) {}
+
+  uint8_t u8() {
+    if (!ok_ || pos_ >= len_) {
+      ok_ = false;
+      return 0;
+    }
+    return data_[pos_++];
+  }
+
+  uint16_t u16() {
+    const uint8_t lo = u8();
+    const uint8_t hi = u8();
+    return static_cast<uint16_t>(lo | (hi << 8));
+  }
+
+  // Copies a u8-length-prefixed string, truncated to fit out.
+  void str(char *out, size_t outLen) {
+    const uint8_t n = u8();
+    if (!ok_ || n > len_ - pos_) {
+      ok_ = false;
+      out[0] = '\0';
+      return;
+    }
+    const size_t kept = n < outLen ? n : outLen - 1;
+    memcpy(out, data_ + pos_, kept);
+    out[kept] = '\0';
+    pos_ += n;
+  }
+
+  void seek(size_t pos) {
+    if (pos > len_) {
+      ok_ = false;
+      return;
+    }
+    pos_ = pos;
+  }
+
+  size_t pos() const { return pos_; }
+  bool ok() const { return ok_; }
+
+ private:
+  const uint8_t *data_;
+  size_t len_;
+  size_t pos_;
+  bool ok_;
+};
+
+// Same text v2 would carry for this code, so normalization matches it.
+// `out` holds at least 5 bytes; minutes get `unit` as their suffix.
+void eta_code_text(uint8_t code, char unit, char *out) {
+  if (code == kEtaNone) {
+    memcpy(out, "--", 3);
+  } else if (code == kEtaDue) {
+    memcpy(out, "DUE", 4);
+  } else {
+    char *p = out;
+    if (code >= 100) *p++ = static_cast<char>('0' + code / 100);
+    if (code >= 10) *p++ = static_cast<char>('0' + (code / 10) % 10);
+    *p++ = static_cast<char>('0' + code % 10);
+    *p++ = unit;
+    *p = '\0';
+  }
+}
+
+// u8 etaCount then the codes; fills eta, etaExtra and displayType.
+void decode_etas(ByteReader &in, core::TransitRowModel &row) {
+  const uint8_t etaCount = in.u8();
+  char text[8];
+  eta_code_text(etaCount > 0 ? in.u8() : kEtaNone, 'm', text);
+  normalize_eta(text, row.eta, sizeof(row.eta));
+
+  // Up to seven more ETAs, space-separated, as v2 joins etas[1..7].
+  size_t used = 0;
+  for (uint8_t i = 1; i < etaCount; ++i) {
+    const uint8_t code = in.u8();
+    if (i >= 8) continue;
+    eta_code_text(code, 'M', text);
+    if (i > 1 && used + 1 < sizeof(row.etaExtra)) row.etaExtra[used++] = ' ';
+    for (const char *c = text; *c && used + 1 < sizeof(row.etaExtra); ++c) row.etaExtra[used++] = *c;
+  }
+  row.etaExtra[used] = '\0';
+  row.displayType = used > 0 ? 4 : 1;
+}
+
+bool decode_row(ByteReader &in, core::TransitRowModel &row) {
+  const uint8_t rowLen = in.u8();
+  const size_t rowEnd = in.pos() + rowLen;
+
+  const uint8_t flags = in.u8();
+  row.badgeShape = (flags & kBinaryRowCircleBadge) ? core::kBadgeShapeCircle : core::kBadgeShapePill;
+  row.scrollEnabled = (flags & kBinaryRowScrolling) != 0;
+  row.delayed = (flags & kBinaryRowDelayed) != 0;
+  row.badgeColor = in.u16();
+  in.str(row.badgeText, sizeof(row.badgeText));
+  in.str(row.destination, sizeof(row.destination));
+  if (row.destination[0] == '\0') {
+    snprintf(row.destination, sizeof(row.destination), "--");
+  }
+
+  decode_etas(in, row);
+
+  if (!in.ok() || in.pos() > rowEnd) {
+    return false;
+  }
+  in.seek(rowEnd);
+  return in.ok();
+}
+
+}  // namespace
+
+bool is_binary_payload(const uint8_t *payload, size_t len) {
+  return payload && len > 0 && payload[0] == kBinaryPayloadV3;
+}
+
+bool is_binary_patch(const uint8_t *payload, size_t len) {
+  return payload && len > 0 && payload[0] == kBinaryPatchV3;
+}
+
+bool read_binary_header(const uint8_t *payload, size_t len, BinaryPayloadHeader &out) {
+  out = {};
+  ByteReader in(payload, len);
+  out.version = in.u8();
+  if (out.version != kBinaryPayloadV3) {
+    return false;
+  }
+  const uint8_t flags = in.u8();
+  out.hasBrightness = (flags & kBinaryFlagBrightness) != 0;
+  if (out.hasBrightness) {
+    out.brightness = in.u8();
+  }
+  out.rowCount = in.u8();
+  out.rowsOffset = in.pos();
+  return in.ok();
+}
+
+bool decode_binary_rows(const uint8_t *payload,
+                        size_t len,
+                        const BinaryPayloadHeader &header,
+                        core::TransitRowModel *rows,
+                        uint8_t maxRows,
+                        uint8_t &rowCount) {
+  rowCount = 0;
+  if (!rows || header.version != kBinaryPayloadV3) {
+    return false;
+  }
+  ByteReader in(payload, len);
+  in.seek(header.rowsOffset);
+  for (uint8_t i = 0; i < header.rowCount && rowCount < maxRows; ++i) {
+    if (!decode_row(in, rows[rowCount])) {
+      return false;
+    }
+    ++rowCount;
+  }
+  return rowCount > 0;
+}
+
+bool decode_binary_patch(const uint8_t *payload,
+                         size_t len,
+                         core::TransitRowModel *rows,
+                         uint8_t activeRows,
+                         uint8_t &patchedMask) {
+  patchedMask = 0;
+  if (!rows || !is_binary_patch(payload, len)) {
+    return false;
+  }
+  ByteReader in(payload, len);
+  in.u8();
+  const uint8_t entryCount = in.u8();
+  for (uint8_t i = 0; i < entryCount; ++i) {
+    const uint8_t entryLen = in.u8();
+    const size_t entryEnd = in.pos() + entryLen;
+    const uint8_t rowIndex = in.u8();
+    const uint8_t flags = in.u8();
+    if (!in.ok() || rowIndex >= activeRows) {
+      return false;
+    }
+    core::TransitRowModel &row = rows[rowIndex];
+    row.delayed = (flags & kBinaryRowDelayed) != 0;
+    decode_etas(in, row);
+    if (!in.ok() || in.pos() > entryEnd) {
+      return false;
+    }
+    in.seek(entryEnd);
+    patchedMask = static_cast<uint8_t>(patchedMask | (1U << rowIndex));
+  }
+  return in.ok() && patchedMask != 0;
+}
+
+}  // namespace parsing
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/models.h"
+
+namespace parsing {
+
+// Compact binary transit payload. JSON payloads always start with '{' (or
+// whitespace), so the leading version byte tells the formats apart. All
+// multi-byte fields are little-endian.
+//
+//   u8  version          kBinaryPayloadV3
+//   u8  flags            bit0: brightness present
+//   u8  brightness       percent, only when flags bit0 is set
+//   u8  rowCount
+//   rowCount x row:
+//     u8  rowLen         bytes that follow for this row
+//     u8  rowFlags       bit0: circle badge, bit1: scrolling, bit2: delayed
+//     u16 badgeColor     RGB565
+//     u8  badgeTextLen, badgeText bytes (at most 4 kept)
+//     u8  labelLen, label bytes
+//     u8  etaCount, etaCount x u8 ETA code (minutes, kEtaDue or kEtaNone)
+//     ...                fields added by later versions; skipped via rowLen
+//
+// The first ETA becomes the row's primary ETA and up to seven more are joined
+// into etaExtra, rendered exactly as the equivalent v2 JSON would be.
+//
+// A patch replaces the ETA fields of rows already on screen, leaving labels,
+// badges and layout alone:
+//
+//   u8  version          kBinaryPatchV3
+//   u8  entryCount
+//   entryCount x entry:
+//     u8  entryLen       bytes that follow for this entry
+//     u8  row            index into the rows of the last full update
+//     u8  rowFlags       bit2: delayed; other bits ignored
+//     u8  etaCount, etaCount x u8 ETA code
+constexpr uint8_t kBinaryPayloadV3 = 0x03;
+constexpr uint8_t kBinaryPatchV3 = 0x04;
+constexpr uint8_t kBinaryFlagBrightness = 0x01;
+constexpr uint8_t kBinaryRowCircleBadge = 0x01;
+constexpr uint8_t kBinaryRowScrolling = 0x02;
+constexpr uint8_t kBinaryRowDelayed = 0x04;
+constexpr uint8_t kEtaMaxMinutes = 253;
+constexpr uint8_t kEtaDue = 0xFE;   // the server said "Due"/"Now"
+constexpr uint8_t kEtaNone = 0xFF;  // no prediction, shown as "--"
+
+struct BinaryPayloadHeader {
+  uint8_t version;
+  bool hasBrightness;
+  uint8_t brightness;
+  uint8_t rowCount;
+  size_t rowsOffset;
+};
+
+bool is_binary_payload(const uint8_t *payload, size_t len);
+bool is_binary_patch(const uint8_t *payload, size_t len);
+bool read_binary_header(const uint8_t *payload, size_t len, BinaryPayloadHeader &out);
+
+// Decodes up to maxRows rows. Returns false for a truncated or inconsistent
+// payload; rows may then be partially written.
+bool decode_binary_rows(const uint8_t *payload,
+                        size_t len,
+                        const BinaryPayloadHeader &header,
+                        core::TransitRowModel *rows,
+                        uint8_t maxRows,
+                        uint8_t &rowCount);
+
+// Applies a patch to the first activeRows rows in place, setting a bit in
+// patchedMask per patched row. Returns false for a truncated patch or one
+// naming a row past activeRows; rows may then be partially written.
+bool decode_binary_patch(const uint8_t *payload,
+                         size_t len,
+                         core::TransitRowModel *rows,
+                         uint8_t activeRows,
+                         uint8_t &patchedMask);
+
+}  // namespace parsing
@@ -1,10 +1,10 @@
 #include "parsing/generic_payload_parser.h"
 
 #include <ctype.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-#include "parsing/payload_parser.h"
+#include <strings.h>
 
 namespace parsing {
 
@@ -27,137 +27,254 @@ uint16_t hex_color_to_rgb565(const char *hex) {
   return static_cast<uint16_t>(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
 }
 
-// Extract a nested JSON object by key. Returns the raw "{...}" substring or "".
-String extract_json_object_field(const String &json, const char *key) {
-  String needle = "\"";
-  needle += key;
-  needle += "\"";
-  const int keyPos = json.indexOf(needle);
-  if (keyPos < 0) return "";
-
-  const int colonPos = json.indexOf(':', keyPos + needle.length());
-  if (colonPos < 0) return "";
-
-  int objStart = colonPos + 1;
-  while (objStart < (int)json.length() && json[objStart] == ' ') objStart++;
-  if (objStart >= (int)json.length() || json[objStart] != '{') return "";
-
-  int depth = 0;
-  for (int i = objStart; i < (int)json.length(); ++i) {
-    const char c = json[i];
-    if (c == '{') depth++;
-    else if (c == '}') {
-      depth--;
-      if (depth == 0) return json.substring(objStart, i + 1);
-    }
-  }
-  return "";
+void copy_text(char *dst, size_t dstLen, const char *src) {
+  if (!dst || dstLen == 0) return;
+  size_t n = 0;
+  for (; src && src[n] && n + 1 < dstLen; ++n) dst[n] = src[n];
+  dst[n] = '\0';
 }
 
-// Get the JSON object at lines[index]. Returns true on success.
-bool extract_line_at(const String &json, int index, String &out) {
-  const String needle = "\"lines\"";
-  const int arrKeyPos = json.indexOf(needle);
-  if (arrKeyPos < 0) return false;
+// Appends src at *used, keeping dst NUL-terminated and truncating on overflow.
+void append_text(char *dst, size_t dstLen, size_t &used, const char *src) {
+  while (*src && used + 1 < dstLen) dst[used++] = *src++;
+  dst[used] = '\0';
+}
 
-  const int colonPos = json.indexOf(':', arrKeyPos + needle.length());
-  if (colonPos < 0) return false;
+// Trimmed, upper-cased copy of [begin, end).
+void upper_trimmed(const char *begin, const char *end, char *out, size_t outLen) {
+  while (begin < end && isspace(static_cast<unsigned char>(*begin))) ++begin;
+  while (end > begin && isspace(static_cast<unsigned char>(end[-1]))) --end;
+  size_t n = 0;
+  for (; begin < end && n + 1 < outLen; ++begin) out[n++] = static_cast<char>(toupper(static_cast<unsigned char>(*begin)));
+  out[n] = '\0';
+}
 
-  const int arrStart = json.indexOf('[', colonPos);
-  if (arrStart < 0) return false;
+// Unsigned integer primitive, such as a Unix time; 0 if the token is not one.
+uint32_t to_uint32(const JsonIndex &json, int index) {
+  char text[16];
+  if (index == JsonIndex::kNone || json.token(index).type != JsonType::kPrimitive ||
+      json.copy_string(index, text, sizeof(text)) == 0 || text[0] < '0' || text[0] > '9') {
+    return 0;
+  }
+  return static_cast<uint32_t>(strtoul(text, nullptr, 10));
+}
 
-  int depth = 0;
-  int itemStart = -1;
-  int itemIndex = -1;
+bool is_now(const char *eta) {
+  return strcmp(eta, "NOW") == 0 || strcmp(eta, "DUE") == 0;
+}
 
-  for (int i = arrStart; i < (int)json.length(); ++i) {
-    const char c = json[i];
-    if (c == '[' || c == '{') {
-      if (c == '{' && depth == 1) {
-        itemIndex++;
-        itemStart = i;
-      }
-      depth++;
-    } else if (c == ']' || c == '}') {
-      depth--;
-      if (c == '}' && depth == 1 && itemIndex == index) {
-        out = json.substring(itemStart, i + 1);
-        return true;
-      }
+// etas[0] is the primary ETA; etas[1..7] are joined into etaExtra with
+// spaces and upper-case minute suffixes. A missing array reads as "--".
+void parse_etas_into_row(const JsonIndex &json, int etas, core::TransitRowModel &row) {
+  const uint16_t etaCount = etas == JsonIndex::kNone ? 0 : json.token(etas).size;
+  char eta[32];
+  if (etaCount > 0 && json.token(etas + 1).type == JsonType::kString) {
+    json.copy_string(etas + 1, eta, sizeof(eta));
+  } else {
+    copy_text(eta, sizeof(eta), "--");
+  }
+  normalize_eta(eta, row.eta, sizeof(row.eta));
+
+  size_t used = 0;
+  row.etaExtra[0] = '\0';
+  int item = etaCount > 0 ? json.token(etas + 1).next : JsonIndex::kNone;
+  for (uint16_t i = 1; i < etaCount && i < 8; ++i, item = json.token(item).next) {
+    if (json.token(item).type != JsonType::kString) break;
+    json.copy_string(item, eta, sizeof(eta));
+    for (char *c = eta; *c; ++c) {
+      if (*c == 'm') *c = 'M';
     }
+    if (i > 1) append_text(row.etaExtra, sizeof(row.etaExtra), used, " ");
+    append_text(row.etaExtra, sizeof(row.etaExtra), used, eta);
   }
-  return false;
+  row.displayType = row.etaExtra[0] != '\0' ? 4 : 1;
 }
 
-void parse_line_into_row(const String &lineJson, ProviderRow &row) {
-  row.label = extract_json_string_field(lineJson, "label");
+void parse_line_into_row(const JsonIndex &json, int line, core::TransitRowModel &row) {
+  if (json.copy_string(json.find(line, "label"), row.destination, sizeof(row.destination)) == 0) {
+    copy_text(row.destination, sizeof(row.destination), "--");
+  }
 
   // badge
-  const String badgeJson = extract_json_object_field(lineJson, "badge");
-  if (badgeJson.length() > 0) {
-    const String shape = extract_json_string_field(badgeJson, "shape");
-    const String color = extract_json_string_field(badgeJson, "color");
-    const String text  = extract_json_string_field(badgeJson, "text");
-
-    row.badgeShape = (shape == "circle") ? 0 : 1;
-    row.badgeColor = hex_color_to_rgb565(color.c_str());
-    const size_t textLen = min((size_t)text.length(), (size_t)4);
-    memcpy(row.badgeText, text.c_str(), textLen);
-    row.badgeText[textLen] = '\0';
+  row.badgeShape = core::kBadgeShapePill;
+  row.badgeColor = 0x8410;
+  row.badgeText[0] = '\0';
+  const int badge = json.find(line, "badge", JsonType::kObject);
+  if (badge != JsonIndex::kNone) {
+    char color[12];
+    json.copy_string(json.find(badge, "color"), color, sizeof(color));
+    row.badgeShape = json.equals(json.find(badge, "shape"), "circle") ? core::kBadgeShapeCircle
+                                                                       : core::kBadgeShapePill;
+    row.badgeColor = hex_color_to_rgb565(color);
+    json.copy_string(json.find(badge, "text"), row.badgeText, sizeof(row.badgeText));
   }
 
   // status
-  String status = extract_json_string_field(lineJson, "status");
-  status.toLowerCase();
-  row.delayed = (status == "delayed");
+  char status[16];
+  json.copy_string(json.find(line, "status"), status, sizeof(status));
+  row.delayed = strcasecmp(status, "delayed") == 0;
 
   // scrolling
-  row.scrollEnabled = extract_json_bool_field(lineJson, "scrolling", false);
+  row.scrollEnabled = json.to_bool(json.find(line, "scrolling"), false);
 
-  // primary ETA = etas[0]
-  String etas[1];
-  const int etaCount = extract_json_string_array_field(lineJson, "etas", etas, 1);
-  row.eta = (etaCount > 0) ? etas[0] : "--";
+  parse_etas_into_row(json, json.find(line, "etas", JsonType::kArray), row);
 }
 
-// Build etaExtra string from etas[1..n], comma-separated.
-String build_eta_extra(const String &lineJson) {
-  String etas[8];
-  const int count = extract_json_string_array_field(lineJson, "etas", etas, 8);
-  if (count <= 1) return "";
-  String extra = "";
-  for (int i = 1; i < count; ++i) {
-    if (i > 1) extra += " ";
-    etas[i].replace("m", "M");
-    etas[i].replace("M", "M");
-    extra += etas[i];
-  }
-  return extra;
-}
+// One patch object: "row" picks the row; "etas" replaces all of its ETAs,
+// "eta" only the primary one, and "status" the delayed flag.
+bool apply_patch_entry(const JsonIndex &json,
+                       int entry,
+                       core::TransitRowModel *rows,
+                       uint8_t activeRows,
+                       uint8_t &patchedMask) {
+  const int rowIndex = json.to_int(json.find(entry, "row", JsonType::kPrimitive), -1);
+  if (rowIndex < 0 || rowIndex >= activeRows) return false;
+  core::TransitRowModel &row = rows[rowIndex];
+
+  bool touched = false;
+  const int etas = json.find(entry, "etas", JsonType::kArray);
+  const int eta = json.find(entry, "eta", JsonType::kString);
+  if (etas != JsonIndex::kNone) {
+    parse_etas_into_row(json, etas, row);
+    touched = true;
+  } else if (eta != JsonIndex::kNone) {
+    char text[32];
+    json.copy_string(eta, text, sizeof(text));
+    normalize_eta(text, row.eta, sizeof(row.eta));
+    touched = true;
+  }
 
+  const int status = json.find(entry, "status", JsonType::kString);
+  if (status != JsonIndex::kNone) {
+    char text[16];
+    json.copy_string(status, text, sizeof(text));
+    row.delayed = strcasecmp(text, "delayed") == 0;
+    touched = true;
+  }
+
+  if (touched) patchedMask = static_cast<uint8_t>(patchedMask | (1U << rowIndex));
+  return touched;
+}
 
 }  // namespace
 
-bool parse_generic_v2_payload(const String &message, ProviderPayload &out) {
-  out = {};
+void normalize_eta(const char *input, char *out, size_t outLen) {
+  char eta[32];
+  upper_trimmed(input, input + strlen(input), eta, sizeof(eta));
 
-  String line0Json, line1Json;
-  const bool hasLine0 = extract_line_at(message, 0, line0Json);
-  const bool hasLine1 = extract_line_at(message, 1, line1Json);
+  if (eta[0] == '\0' || strcmp(eta, "--") == 0) {
+    copy_text(out, outLen, "--");
+    return;
+  }
+  if (is_now(eta)) {
+    copy_text(out, outLen, "0m");
+    return;
+  }
 
-  if (!hasLine0) return false;
+  if (strchr(eta, '/')) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (const char *part = eta; part; ) {
+      const char *sep = strchr(part, '/');
+      char token[sizeof(eta)];
+      upper_trimmed(part, sep ? sep : part + strlen(part), token, sizeof(token));
+      if (is_now(token)) copy_text(token, sizeof(token), "0m");
+      if (token[0] != '\0' && strcmp(token, "--") != 0) {
+        if (used > 0) append_text(out, outLen, used, "/");
+        append_text(out, outLen, used, token);
+      }
+      part = sep ? sep + 1 : nullptr;
+    }
+    if (used == 0) copy_text(out, outLen, "--");
+    return;
+  }
 
-  out.hasRow1 = true;
-  parse_line_into_row(line0Json, out.row1);
-  out.row1EtaExtra = build_eta_extra(line0Json);
+  int minutes = 0;
+  bool foundDigit = false;
+  for (const char *c = eta; *c; ++c) {
+    if (*c >= '0' && *c <= '9') {
+      foundDigit = true;
+      minutes = (minutes * 10) + (*c - '0');
+    } else if (foundDigit) {
+      break;
+    }
+  }
 
-  if (hasLine1) {
-    out.hasRow2 = true;
-    parse_line_into_row(line1Json, out.row2);
-    out.row2EtaExtra = build_eta_extra(line1Json);
+  if (foundDigit) {
+    if (minutes <= 1) {
+      copy_text(out, outLen, "DUE");
+    } else {
+      snprintf(out, outLen, "%dm", minutes);
+    }
+    return;
   }
 
-  return true;
+  copy_text(out, outLen, input);
+}
+
+bool parse_generic_v2_rows(const JsonIndex &json, core::TransitRowModel *rows, uint8_t maxRows, uint8_t &rowCount) {
+  rowCount = 0;
+  if (!rows) return false;
+
+  const int lines = json.find(json.root(), "lines", JsonType::kArray);
+  for (uint16_t i = 0; i < maxRows; ++i) {
+    const int line = json.element(lines, i);
+    if (line == JsonIndex::kNone || json.token(line).type != JsonType::kObject) break;
+    parse_line_into_row(json, line, rows[rowCount++]);
+  }
+  return rowCount > 0;
+}
+
+bool apply_generic_v2_patch(const JsonIndex &json,
+                            core::TransitRowModel *rows,
+                            uint8_t activeRows,
+                            uint8_t &patchedMask) {
+  patchedMask = 0;
+  if (!rows) return false;
+
+  const int root = json.root();
+  const int patches = json.find(root, "patches", JsonType::kArray);
+  if (patches == JsonIndex::kNone) {
+    return apply_patch_entry(json, root, rows, activeRows, patchedMask);
+  }
+  const uint16_t count = json.token(patches).size;
+  int entry = patches + 1;
+  for (uint16_t i = 0; i < count; ++i, entry = json.token(entry).next) {
+    if (json.token(entry).type != JsonType::kObject ||
+        !apply_patch_entry(json, entry, rows, activeRows, patchedMask)) {
+      return false;
+    }
+  }
+  return patchedMask != 0;
+}
+
+bool parse_generic_v2_arrivals(const JsonIndex &json,
+                               core::RowArrivals *arrivals,
+                               uint8_t maxRows,
+                               uint32_t &serverTimeSec) {
+  const int root = json.root();
+  serverTimeSec = to_uint32(json, json.find(root, "serverTime", JsonType::kPrimitive));
+  if (!arrivals) return false;
+
+  bool any = false;
+  const int lines = json.find(root, "lines", JsonType::kArray);
+  for (uint8_t i = 0; i < maxRows; ++i) {
+    core::RowArrivals &row = arrivals[i];
+    row.enabled = false;
+    row.count = 0;
+    const int times = json.find(json.element(lines, i), "arrivals", JsonType::kArray);
+    if (times == JsonIndex::kNone) continue;
+
+    row.enabled = true;
+    any = true;
+    const uint16_t count = json.token(times).size;
+    int item = times + 1;
+    for (uint16_t t = 0; t < count && row.count < core::kMaxRowArrivals; ++t, item = json.token(item).next) {
+      const uint32_t epoch = to_uint32(json, item);
+      if (epoch != 0) row.epochs[row.count++] = epoch;
+    }
+  }
+  return any;
 }
 
 }  // namespace parsing
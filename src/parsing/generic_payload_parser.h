@@ -1,15 +1,47 @@
 #pragma once
 
-#include <Arduino.h>
+#include "core/eta_countdown.h"
+#include "parsing/json_tokenizer.h"
 #include "parsing/provider_parser_router.h"
 
 namespace parsing {
 
+// Server ETA to display form: "--" when empty, "0m" for NOW/DUE, "DUE" for
+// a minute or less, otherwise "<n>m". Multi-arrival "DUE/3M/8M" strings keep
+// their parts, minus empty ones. Text without digits passes through as sent.
+void normalize_eta(const char *input, char *out, size_t outLen);
+
 /**
  * Parses a v2 server payload (contains "v":2 field).
- * Extracts pre-computed badge info and ETAs directly — no city-specific logic.
- * Returns true if at least one row was successfully parsed.
+ * Writes up to maxRows entries of lines[] straight into rows, with ETAs
+ * normalized for display and badge info taken as sent — no city-specific
+ * logic and no heap allocation. Returns true if at least one row was parsed.
+ */
+bool parse_generic_v2_rows(const JsonIndex &json, core::TransitRowModel *rows, uint8_t maxRows, uint8_t &rowCount);
+
+/**
+ * Applies a {"type":"patch"} message to the first activeRows rows in place.
+ * The message is either one patch object or {"patches":[...]} of them, each
+ * naming a "row" and any of "etas" (same form as lines[].etas), "eta"
+ * (primary ETA only) and "status". Sets a bit in patchedMask per patched row.
+ * Returns false if any patch is malformed or names a row past activeRows;
+ * rows may then be partially written.
+ */
+bool apply_generic_v2_patch(const JsonIndex &json,
+                            core::TransitRowModel *rows,
+                            uint8_t activeRows,
+                            uint8_t &patchedMask);
+
+/**
+ * Reads the optional countdown fields of a v2 payload: a root "serverTime"
+ * and per-line "arrivals" arrays, both in Unix seconds. Lines with arrivals
+ * get their ETAs recomputed on the device as time passes, so the server
+ * need not publish when only a minute rolls over. serverTimeSec is 0 when
+ * absent. Returns true if any of the first maxRows lines has arrivals.
  */
-bool parse_generic_v2_payload(const String &message, ProviderPayload &out);
+bool parse_generic_v2_arrivals(const JsonIndex &json,
+                               core::RowArrivals *arrivals,
+                               uint8_t maxRows,
+                               uint32_t &serverTimeSec);
 
 }  // namespace parsing
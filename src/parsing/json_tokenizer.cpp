@@ -0,0 +1,342 @@
+#include "parsing/json_tokenizer.h"
+
+#include <limits.h>
+#include <string.h>
+
+namespace parsing {
+
+namespace {
+
+enum class Expect : uint8_t {
+  kValue,
+  kValueOrClose,  // first element of an array
+  kKey,
+  kKeyOrClose,    // first member of an object
+  kColon,
+  kCommaOrClose,
+  kDone,
+};
+
+bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool is_delimiter(char c) {
+  return is_space(c) || c == ',' || c == ']' || c == '}' || c == ':';
+}
+
+int hex_digit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+char lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool raw_equals_ignore_case(const char *raw, size_t len, const char *text) {
+  for (size_t i = 0; i < len; ++i) {
+    if (text[i] == '\0' || lower(raw[i]) != lower(text[i])) {
+      return false;
+    }
+  }
+  return text[len] == '\0';
+}
+
+}  // namespace
+
+JsonIndex::JsonIndex() : data_(nullptr), len_(0), tokens_{}, count_(0) {}
+
+int JsonIndex::add_token(JsonType type, size_t start) {
+  if (count_ >= kMaxTokens) {
+    return kNone;
+  }
+  JsonToken &t = tokens_[count_];
+  t.type = type;
+  t.escaped = false;
+  t.start = static_cast<uint16_t>(start);
+  t.end = static_cast<uint16_t>(start);
+  t.size = 0;
+  t.next = static_cast<uint16_t>(count_ + 1);
+  return count_++;
+}
+
+bool JsonIndex::parse(const uint8_t *data, size_t len) {
+  data_ = reinterpret_cast<const char *>(data);
+  len_ = len;
+  count_ = 0;
+  if (!data || len == 0 || len >= 0xFFFF) {
+    return false;
+  }
+  if (!tokenize()) {
+    count_ = 0;
+    return false;
+  }
+  return true;
+}
+
+// Builds the token table over data_. On false the table is half-built and
+// parse() discards it.
+bool JsonIndex::tokenize() {
+  const size_t len = len_;
+  uint16_t stack[kMaxDepth];
+  uint8_t depth = 0;
+  Expect expect = Expect::kValue;
+
+  auto after_value = [&]() { return depth == 0 ? Expect::kDone : Expect::kCommaOrClose; };
+  auto count_element = [&]() {
+    if (depth > 0 && tokens_[stack[depth - 1]].type == JsonType::kArray) {
+      ++tokens_[stack[depth - 1]].size;
+    }
+  };
+
+  size_t pos = 0;
+  while (pos < len) {
+    const char c = data_[pos];
+    if (is_space(c)) {
+      ++pos;
+      continue;
+    }
+
+    switch (c) {
+      case '{':
+      case '[': {
+        if (expect != Expect::kValue && expect != Expect::kValueOrClose) return false;
+        if (depth >= kMaxDepth) return false;
+        count_element();
+        const int t = add_token(c == '{' ? JsonType::kObject : JsonType::kArray, pos);
+        if (t == kNone) return false;
+        stack[depth++] = static_cast<uint16_t>(t);
+        expect = c == '{' ? Expect::kKeyOrClose : Expect::kValueOrClose;
+        ++pos;
+        break;
+      }
+
+      case '}':
+      case ']': {
+        if (depth == 0) return false;
+        JsonToken &open = tokens_[stack[depth - 1]];
+        const bool isObject = c == '}';
+        if (isObject != (open.type == JsonType::kObject)) return false;
+        if (expect != Expect::kCommaOrClose &&
+            expect != (isObject ? Expect::kKeyOrClose : Expect::kValueOrClose)) {
+          return false;
+        }
+        open.end = static_cast<uint16_t>(pos + 1);
+        open.next = count_;
+        --depth;
+        expect = after_value();
+        ++pos;
+        break;
+      }
+
+      case '"': {
+        const bool isKey = expect == Expect::kKey || expect == Expect::kKeyOrClose;
+        if (!isKey && expect != Expect::kValue && expect != Expect::kValueOrClose) return false;
+        if (isKey) {
+          ++tokens_[stack[depth - 1]].size;
+        } else {
+          count_element();
+        }
+        const int t = add_token(JsonType::kString, pos + 1);
+        if (t == kNone) return false;
+        ++pos;
+        bool escaped = false;
+        while (pos < len && data_[pos] != '"') {
+          if (static_cast<uint8_t>(data_[pos]) < 0x20) return false;
+          if (data_[pos] == '\\') {
+            escaped = true;
+            ++pos;
+            if (pos >= len) return false;
+          }
+          ++pos;
+        }
+        if (pos >= len) return false;
+        tokens_[t].end = static_cast<uint16_t>(pos);
+        tokens_[t].escaped = escaped;
+        expect = isKey ? Expect::kColon : after_value();
+        ++pos;
+        break;
+      }
+
+      case ':':
+        if (expect != Expect::kColon) return false;
+        expect = Expect::kValue;
+        ++pos;
+        break;
+
+      case ',':
+        if (expect != Expect::kCommaOrClose) return false;
+        expect = tokens_[stack[depth - 1]].type == JsonType::kObject ? Expect::kKey : Expect::kValue;
+        ++pos;
+        break;
+
+      default: {
+        if (expect != Expect::kValue && expect != Expect::kValueOrClose) return false;
+        if (c != '-' && (c < '0' || c > '9') && c != 't' && c != 'f' && c != 'n') return false;
+        count_element();
+        const int t = add_token(JsonType::kPrimitive, pos);
+        if (t == kNone) return false;
+        while (pos < len && !is_delimiter(data_[pos])) {
+          if (data_[pos] == '"' || data_[pos] == '{' || data_[pos] == '[') return false;
+          ++pos;
+        }
+        tokens_[t].end = static_cast<uint16_t>(pos);
+        expect = after_value();
+        break;
+      }
+    }
+  }
+
+  return expect == Expect::kDone;
+}
+
+int JsonIndex::find(int object, const char *key) const {
+  if (object < 0 || object >= count_ || tokens_[object].type != JsonType::kObject || !key) {
+    return kNone;
+  }
+  int i = object + 1;
+  for (uint16_t m = 0; m < tokens_[object].size; ++m) {
+    if (equals(i, key)) {
+      return i + 1;
+    }
+    i = tokens_[i + 1].next;
+  }
+  return kNone;
+}
+
+int JsonIndex::find(int object, const char *key, JsonType type) const {
+  const int value = find(object, key);
+  return value != kNone && tokens_[value].type == type ? value : kNone;
+}
+
+int JsonIndex::element(int array, uint16_t index) const {
+  if (array < 0 || array >= count_ || tokens_[array].type != JsonType::kArray || index >= tokens_[array].size) {
+    return kNone;
+  }
+  int i = array + 1;
+  for (uint16_t e = 0; e < index; ++e) {
+    i = tokens_[i].next;
+  }
+  return i;
+}
+
+size_t JsonIndex::copy_string(int index, char *out, size_t outLen) const {
+  if (!out || outLen == 0) {
+    return 0;
+  }
+  out[0] = '\0';
+  if (index < 0 || index >= count_) {
+    return 0;
+  }
+  const JsonToken &t = tokens_[index];
+  if (t.type != JsonType::kString && t.type != JsonType::kPrimitive) {
+    return 0;
+  }
+
+  size_t n = 0;
+  auto put = [&](char ch) {
+    if (n + 1 < outLen) out[n++] = ch;
+  };
+  for (size_t i = t.start; i < t.end; ++i) {
+    char ch = data_[i];
+    if (!t.escaped || ch != '\\' || i + 1 >= t.end) {
+      put(ch);
+      continue;
+    }
+    ch = data_[++i];
+    switch (ch) {
+      case 'b': put('\b'); break;
+      case 'f': put('\f'); break;
+      case 'n': put('\n'); break;
+      case 'r': put('\r'); break;
+      case 't': put('\t'); break;
+      case 'u': {
+        uint32_t cp = 0;
+        uint8_t digits = 0;
+        while (digits < 4 && i + 1 < t.end && hex_digit(data_[i + 1]) >= 0) {
+          cp = (cp << 4) | static_cast<uint32_t>(hex_digit(data_[++i]));
+          ++digits;
+        }
+        if (digits != 4 || (cp >= 0xD800 && cp <= 0xDFFF)) {
+          put('?');
+        } else if (cp < 0x80) {
+          put(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+          put(static_cast<char>(0xC0 | (cp >> 6)));
+          put(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+          put(static_cast<char>(0xE0 | (cp >> 12)));
+          put(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+          put(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        break;
+      }
+      default:  // \" \\ \/
+        put(ch);
+        break;
+    }
+  }
+  out[n] = '\0';
+  return n;
+}
+
+bool JsonIndex::equals(int index, const char *text) const {
+  if (index < 0 || index >= count_ || !text) {
+    return false;
+  }
+  const JsonToken &t = tokens_[index];
+  if (t.type != JsonType::kString && t.type != JsonType::kPrimitive) {
+    return false;
+  }
+  if (!t.escaped) {
+    const size_t len = static_cast<size_t>(t.end - t.start);
+    return strncmp(data_ + t.start, text, len) == 0 && text[len] == '\0';
+  }
+  char buf[64];
+  copy_string(index, buf, sizeof(buf));
+  return strcmp(buf, text) == 0;
+}
+
+int JsonIndex::to_int(int index, int fallbackValue) const {
+  if (index < 0 || index >= count_ || tokens_[index].type != JsonType::kPrimitive) {
+    return fallbackValue;
+  }
+  const JsonToken &t = tokens_[index];
+  size_t i = t.start;
+  const bool neg = data_[i] == '-';
+  if (neg) ++i;
+  int value = 0;
+  bool foundDigit = false;
+  for (; i < t.end && data_[i] >= '0' && data_[i] <= '9'; ++i) {
+    foundDigit = true;
+    const int digit = data_[i] - '0';
+    if (value > (INT_MAX - digit) / 10) return fallbackValue;
+    value = value * 10 + digit;
+  }
+  if (!foundDigit) return fallbackValue;
+  return neg ? -value : value;
+}
+
+bool JsonIndex::to_bool(int index, bool fallbackValue) const {
+  if (index < 0 || index >= count_) {
+    return fallbackValue;
+  }
+  const JsonToken &t = tokens_[index];
+  if (t.type != JsonType::kString && t.type != JsonType::kPrimitive) {
+    return fallbackValue;
+  }
+  size_t start = t.start;
+  size_t end = t.end;
+  while (start < end && is_space(data_[start])) ++start;
+  while (end > start && is_space(data_[end - 1])) --end;
+  const char *raw = data_ + start;
+  const size_t len = end - start;
+  if (raw_equals_ignore_case(raw, len, "true") || raw_equals_ignore_case(raw, len, "1")) return true;
+  if (raw_equals_ignore_case(raw, len, "false") || raw_equals_ignore_case(raw, len, "0")) return false;
+  return fallbackValue;
+}
+
+}  // namespace parsing
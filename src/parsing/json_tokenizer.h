@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace parsing {
+
+enum class JsonType : uint8_t {
+  kObject,
+  kArray,
+  kString,
+  kPrimitive,  // number, true, false or null
+};
+
+struct JsonToken {
+  JsonType type;
+  bool escaped;   // string contains backslash escapes
+  uint16_t start; // first byte; for strings, the byte after the opening quote
+  uint16_t end;   // one past the last byte; for strings, the closing quote
+  uint16_t size;  // object: member count, array: element count
+  uint16_t next;  // index of the first token after this one's subtree
+};
+
+// Flat token index over a JSON buffer, built in one pass with no allocation.
+// The buffer is borrowed, not copied: it must outlive every lookup. Object
+// members are stored as a key token followed by its value subtree, so lookups
+// hop from sibling to sibling through `next` without rescanning text.
+class JsonIndex final {
+ public:
+  static constexpr uint16_t kMaxTokens = 256;
+  static constexpr uint8_t kMaxDepth = 16;
+  static constexpr int kNone = -1;
+
+  JsonIndex();
+
+  // Returns false for malformed JSON, trailing garbage, or an input that
+  // needs more than kMaxTokens tokens or kMaxDepth nesting levels.
+  bool parse(const uint8_t *data, size_t len);
+
+  uint16_t count() const { return count_; }
+  const JsonToken &token(int index) const { return tokens_[index]; }
+  int root() const { return count_ > 0 ? 0 : kNone; }
+
+  // Value token for `key` in `object`, or kNone.
+  int find(int object, const char *key) const;
+  int find(int object, const char *key, JsonType type) const;
+  // Token of element `index` in `array`, or kNone.
+  int element(int array, uint16_t index) const;
+
+  // Unescaped string (or raw primitive) text, always NUL-terminated and
+  // truncated to fit. Returns the number of bytes written, 0 for kNone.
+  size_t copy_string(int index, char *out, size_t outLen) const;
+  bool equals(int index, const char *text) const;
+  // Leading integer of a primitive; fallbackValue if there is none or it
+  // does not fit in an int.
+  int to_int(int index, int fallbackValue) const;
+  // Accepts true/false/1/0, bare or quoted, case-insensitively.
+  bool to_bool(int index, bool fallbackValue) const;
+
+ private:
+  bool tokenize();
+  int add_token(JsonType type, size_t start);
+
+  const char *data_;
+  size_t len_;
+  JsonToken tokens_[kMaxTokens];
+  uint16_t count_;
+};
+
+}  // namespace parsing
@@ -1,11 +1,57 @@
 #include "parsing/provider_parser_router.h"
 
+#include "parsing/binary_payload.h"
 #include "parsing/generic_payload_parser.h"
 
 namespace parsing {
 
-bool parse_transit_payload(const String &message, ProviderPayload &out) {
-  return parse_generic_v2_payload(message, out);
+bool parse_transit_rows(const JsonIndex &json, core::TransitRowModel *rows, uint8_t maxRows, uint8_t &rowCount) {
+  return parse_generic_v2_rows(json, rows, maxRows, rowCount);
+}
+
+bool parse_transit_payload(const uint8_t *payload,
+                           size_t len,
+                           const JsonIndex &json,
+                           core::TransitRowModel *rows,
+                           uint8_t maxRows,
+                           uint8_t &rowCount) {
+  if (is_binary_payload(payload, len)) {
+    BinaryPayloadHeader header{};
+    if (!read_binary_header(payload, len, header)) {
+      rowCount = 0;
+      return false;
+    }
+    return decode_binary_rows(payload, len, header, rows, maxRows, rowCount);
+  }
+  return parse_transit_rows(json, rows, maxRows, rowCount);
+}
+
+bool apply_transit_patch(const uint8_t *payload,
+                         size_t len,
+                         const JsonIndex &json,
+                         core::TransitRowModel *rows,
+                         uint8_t activeRows,
+                         uint8_t &patchedMask) {
+  if (is_binary_patch(payload, len)) {
+    return decode_binary_patch(payload, len, rows, activeRows, patchedMask);
+  }
+  return apply_generic_v2_patch(json, rows, activeRows, patchedMask);
+}
+
+bool parse_transit_arrivals(const uint8_t *payload,
+                            size_t len,
+                            const JsonIndex &json,
+                            core::RowArrivals *arrivals,
+                            uint8_t maxRows,
+                            uint32_t &serverTimeSec) {
+  if (is_binary_payload(payload, len)) {
+    serverTimeSec = 0;
+    for (uint8_t i = 0; arrivals && i < maxRows; ++i) {
+      arrivals[i] = {};
+    }
+    return false;
+  }
+  return parse_generic_v2_arrivals(json, arrivals, maxRows, serverTimeSec);
 }
 
 }  // namespace parsing
@@ -1,10 +1,42 @@
 #pragma once
 
-#include <Arduino.h>
-#include "parsing/provider_payload.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/eta_countdown.h"
+#include "core/models.h"
+#include "parsing/json_tokenizer.h"
 
 namespace parsing {
 
-bool parse_transit_payload(const String &message, ProviderPayload &out);
+bool parse_transit_rows(const JsonIndex &json, core::TransitRowModel *rows, uint8_t maxRows, uint8_t &rowCount);
+
+// Decodes a transit update in any supported format: binary v3 from the raw
+// bytes, otherwise v2 JSON from `json`, which must already index `payload`.
+bool parse_transit_payload(const uint8_t *payload,
+                           size_t len,
+                           const JsonIndex &json,
+                           core::TransitRowModel *rows,
+                           uint8_t maxRows,
+                           uint8_t &rowCount);
+
+// Applies a patch message in either format to rows already on screen: a
+// binary patch from the raw bytes, otherwise a {"type":"patch"} JSON message
+// from `json`. See decode_binary_patch and apply_generic_v2_patch.
+bool apply_transit_patch(const uint8_t *payload,
+                         size_t len,
+                         const JsonIndex &json,
+                         core::TransitRowModel *rows,
+                         uint8_t activeRows,
+                         uint8_t &patchedMask);
+
+// Countdown fields of a transit update (see parse_generic_v2_arrivals).
+// Binary v3 has none yet, so its rows always keep the server's ETAs.
+bool parse_transit_arrivals(const uint8_t *payload,
+                            size_t len,
+                            const JsonIndex &json,
+                            core::RowArrivals *arrivals,
+                            uint8_t maxRows,
+                            uint32_t &serverTimeSec);
 
 }  // namespace parsing
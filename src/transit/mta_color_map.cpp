@@ -3,6 +3,8 @@
 #include <ctype.h>
 #include <string.h>
 
+#include "transit/perfect_hash.h"
+
 namespace transit {
 
 namespace {
@@ -32,7 +34,7 @@ static constexpr RouteColorEntry kRouteColorTable[] = {
     {"S", rgb565(0x80, 0x81, 0x83)},
 };
 
-static constexpr RouteColorEntry kLirrRouteColorTable[] = {
+static constexpr AliasRouteColorEntry kLirrRouteColorTable[] = {
     {"1", rgb565(0x00, 0x98, 0x5F)},   // Babylon Branch
     {"2", rgb565(0xCE, 0x8E, 0x00)},   // Hempstead Branch
     {"3", rgb565(0x00, 0xAF, 0x3F)},   // Oyster Bay Branch
@@ -47,7 +49,7 @@ static constexpr RouteColorEntry kLirrRouteColorTable[] = {
     {"13", rgb565(0xA6, 0x26, 0xAA)},  // Greenport Service
 };
 
-static constexpr RouteColorEntry kMnrRouteColorTable[] = {
+static constexpr AliasRouteColorEntry kMnrRouteColorTable[] = {
     {"1", rgb565(0x00, 0x9B, 0x3A)},  // Hudson
     {"2", rgb565(0x00, 0x39, 0xA6)},  // Harlem
     {"3", rgb565(0xEE, 0x00, 0x34)},  // New Haven
@@ -57,7 +59,7 @@ static constexpr RouteColorEntry kMnrRouteColorTable[] = {
 };
 
 // SEPTA Regional Rail — keyed by GTFS route_short_name
-static constexpr RouteColorEntry kSeptaRailColorTable[] = {
+static constexpr AliasRouteColorEntry kSeptaRailColorTable[] = {
     {"AIR", rgb565(0x45, 0x63, 0x7A)},  // Airport Line
     {"CHE", rgb565(0x45, 0x63, 0x7A)},  // Chestnut Hill East
     {"CHW", rgb565(0x45, 0x63, 0x7A)},  // Chestnut Hill West
@@ -74,7 +76,7 @@ static constexpr RouteColorEntry kSeptaRailColorTable[] = {
 };
 
 // SEPTA trolley lines — keyed by internal GTFS route ID
-static constexpr RouteColorEntry kSeptaTrolleyColorTable[] = {
+static constexpr AliasRouteColorEntry kSeptaTrolleyColorTable[] = {
     {"G1", rgb565(0xFF, 0xD7, 0x00)},  // Route 15
     {"T1", rgb565(0x3B, 0x7B, 0x38)},  // Route 10
     {"T2", rgb565(0x3B, 0x7B, 0x38)},  // Route 34
@@ -139,6 +141,168 @@ static constexpr uint16_t kSeptaNhslPurple = rgb565(0x5F, 0x24, 0x9F);
 static constexpr uint16_t kSeptaMediaSharonHillPink = rgb565(0xDC, 0x2E, 0x6B);
 static constexpr uint16_t kMbtaBusColor = rgb565(0x0F, 0x4C, 0xBA);
 static constexpr uint16_t kMbtaFerryFallbackColor = rgb565(0x0E, 0xA5, 0xE9);
+static constexpr uint16_t kSeptaTrolleyFallbackColor = rgb565(0x3B, 0x7B, 0x38);
+
+// SEPTA bus routes with a rail-line color, keyed by the exact GTFS route ID
+static constexpr AliasRouteColorEntry kSeptaBusColorTable[] = {
+    {"L1|L1 OWL", rgb565(0x00, 0x97, 0xD6)},
+    {"B1|B2|B3|B1 OWL", kSeptaBroadStreetColor},
+    {"M1|M1 BUS", kSeptaNhslPurple},
+    {"T BUS|T5 BUS", kSeptaTrolleyGreen},
+    {"D1 BUS|D2 BUS", kSeptaMediaSharonHillPink},
+};
+
+// Providers whose routes are looked up in the route hash. Exact providers
+// match the route ID byte for byte; the others match its upper-cased
+// alphanumerics, so "Red Line", "red-line" and "REDLINE" are one key.
+enum RouteGroup : uint8_t {
+  kGroupLirr,
+  kGroupMnr,
+  kGroupSeptaRail,
+  kGroupSeptaTrolley,
+  kGroupSeptaBus,
+  kGroupMtaBus,
+  kGroupCtaSubway,
+  kGroupCtaBus,
+  kGroupMbta,
+  kGroupNjtRail,
+  kGroupNjtBus,
+};
+
+enum class RouteKeyMode : uint8_t {
+  kExact,
+  kNormalized,
+};
+
+struct ProviderInfo {
+  const char *providerId;
+  uint8_t group;
+  RouteKeyMode mode;
+  uint16_t missColor;  // color for routes not in the group's tables
+};
+
+static constexpr ProviderInfo kProviders[] = {
+    {"mta-lirr", kGroupLirr, RouteKeyMode::kExact, MtaColorMap::kFallbackColor},
+    {"mta-mnr", kGroupMnr, RouteKeyMode::kExact, MtaColorMap::kFallbackColor},
+    {"septa-rail", kGroupSeptaRail, RouteKeyMode::kExact, kSeptaRailBadgeColor},
+    {"septa-trolley", kGroupSeptaTrolley, RouteKeyMode::kExact, kSeptaTrolleyFallbackColor},
+    {"septa-bus", kGroupSeptaBus, RouteKeyMode::kExact, kSeptaBusColor},
+    {"mta-bus", kGroupMtaBus, RouteKeyMode::kExact, kMtaBusColor},
+    {"cta-subway", kGroupCtaSubway, RouteKeyMode::kNormalized, MtaColorMap::kFallbackColor},
+    {"cta-bus", kGroupCtaBus, RouteKeyMode::kNormalized, kCtaBusFallbackColor},
+    {"mbta", kGroupMbta, RouteKeyMode::kNormalized, MtaColorMap::kFallbackColor},
+    {"mbta-subway", kGroupMbta, RouteKeyMode::kNormalized, MtaColorMap::kFallbackColor},
+    {"mbta-bus", kGroupMbta, RouteKeyMode::kNormalized, MtaColorMap::kFallbackColor},
+    {"mbta-rail", kGroupMbta, RouteKeyMode::kNormalized, MtaColorMap::kFallbackColor},
+    {"njt-rail", kGroupNjtRail, RouteKeyMode::kExact, kNjtRailColor},
+    {"njt-bus", kGroupNjtBus, RouteKeyMode::kExact, kNjtBusColor},
+};
+
+struct RouteTableRef {
+  uint8_t group;
+  const AliasRouteColorEntry *entries;
+  size_t count;
+};
+
+template <size_t N>
+constexpr RouteTableRef route_table(uint8_t group, const AliasRouteColorEntry (&entries)[N]) {
+  return {group, entries, N};
+}
+
+// Every (provider group, route) color the hash is generated from. MBTA's
+// ferry, commuter rail and subway keys never overlap, so they share a group.
+static constexpr RouteTableRef kRouteTables[] = {
+    route_table(kGroupLirr, kLirrRouteColorTable),
+    route_table(kGroupMnr, kMnrRouteColorTable),
+    route_table(kGroupSeptaRail, kSeptaRailColorTable),
+    route_table(kGroupSeptaTrolley, kSeptaTrolleyColorTable),
+    route_table(kGroupSeptaBus, kSeptaBusColorTable),
+    route_table(kGroupCtaSubway, kCtaSubwayColorTable),
+    route_table(kGroupCtaBus, kCtaBusColorTable),
+    route_table(kGroupMbta, kMbtaFerryColorTable),
+    route_table(kGroupMbta, kMbtaCommuterRailColorTable),
+    route_table(kGroupMbta, kMbtaSubwayColorTable),
+};
+
+constexpr size_t count_route_keys() {
+  size_t n = 0;
+  for (const RouteTableRef &table : kRouteTables) {
+    for (size_t i = 0; i < table.count; ++i) {
+      ++n;
+      for (const char *c = table.entries[i].aliases; *c; ++c) {
+        if (*c == '|') ++n;
+      }
+    }
+  }
+  return n;
+}
+
+constexpr size_t kRouteKeyCount = count_route_keys();
+
+struct RouteKeys {
+  HashKey keys[kRouteKeyCount];
+  uint16_t colors[kRouteKeyCount];
+};
+
+// One key per alias, pointing into the alias strings themselves.
+constexpr RouteKeys expand_route_keys() {
+  RouteKeys out{};
+  size_t n = 0;
+  for (const RouteTableRef &table : kRouteTables) {
+    for (size_t i = 0; i < table.count; ++i) {
+      const char *alias = table.entries[i].aliases;
+      while (true) {
+        size_t len = 0;
+        while (alias[len] != '\0' && alias[len] != '|') ++len;
+        out.keys[n] = {alias, static_cast<uint8_t>(len), table.group};
+        out.colors[n] = table.entries[i].color565;
+        ++n;
+        if (alias[len] == '\0') break;
+        alias += len + 1;
+      }
+    }
+  }
+  return out;
+}
+
+constexpr size_t kProviderCount = sizeof(kProviders) / sizeof(kProviders[0]);
+
+struct ProviderKeys {
+  HashKey keys[kProviderCount];
+};
+
+constexpr ProviderKeys expand_provider_keys() {
+  ProviderKeys out{};
+  for (size_t i = 0; i < kProviderCount; ++i) {
+    out.keys[i] = {kProviders[i].providerId, static_cast<uint8_t>(const_strlen(kProviders[i].providerId)), 0};
+  }
+  return out;
+}
+
+static constexpr RouteKeys kRouteKeys = expand_route_keys();
+static constexpr PerfectHash<512, 128> kRouteHash = build_perfect_hash<512, 128>(kRouteKeys.keys);
+static constexpr ProviderKeys kProviderKeys = expand_provider_keys();
+static constexpr PerfectHash<32, 8> kProviderHash = build_perfect_hash<32, 8>(kProviderKeys.keys);
+static_assert(kRouteHash.ok, "route color keys have no perfect hash; check for duplicate aliases");
+static_assert(kProviderHash.ok, "provider ids have no perfect hash; check for duplicates");
+
+// First character of the route family (ignoring separators) to its color.
+struct RouteFamilyColors {
+  uint16_t colors[128];
+};
+
+constexpr RouteFamilyColors build_route_family_colors() {
+  RouteFamilyColors out{};
+  for (uint16_t &color : out.colors) color = MtaColorMap::kFallbackColor;
+  for (size_t i = sizeof(kRouteColorTable) / sizeof(kRouteColorTable[0]); i > 0; --i) {
+    for (const char *c = kRouteColorTable[i - 1].routes; *c; ++c) {
+      out.colors[static_cast<uint8_t>(*c) & 0x7F] = kRouteColorTable[i - 1].color565;
+    }
+  }
+  return out;
+}
+
+static constexpr RouteFamilyColors kRouteFamilyColors = build_route_family_colors();
 
 char normalize_route_char(const char *routeId) {
   if (!routeId) return '\0';
@@ -152,11 +316,7 @@ char normalize_route_char(const char *routeId) {
   return '\0';
 }
 
-void normalize_route_token(const char *routeId, char *out, size_t outLen) {
-  if (!out || outLen == 0) return;
-  out[0] = '\0';
-  if (!routeId) return;
-
+size_t normalize_route_token(const char *routeId, char *out, size_t outLen) {
   size_t j = 0;
   for (size_t i = 0; routeId[i] != '\0' && j + 1 < outLen; ++i) {
     const unsigned char c = static_cast<unsigned char>(routeId[i]);
@@ -164,74 +324,35 @@ void normalize_route_token(const char *routeId, char *out, size_t outLen) {
     out[j++] = static_cast<char>(toupper(c));
   }
   out[j] = '\0';
+  return j;
 }
 
-bool normalized_route_starts_with(const char *routeId, const char *prefix) {
-  char normalized[32];
-  normalize_route_token(routeId, normalized, sizeof(normalized));
-  if (normalized[0] == '\0') return false;
-  const size_t prefixLen = strlen(prefix);
-  return strncmp(normalized, prefix, prefixLen) == 0;
+const ProviderInfo *find_provider(const char *providerId) {
+  const size_t len = strlen(providerId);
+  const int index = kProviderHash.candidate(0, providerId, len);
+  return index >= 0 && key_equals(kProviderKeys.keys[index], 0, providerId, len) ? &kProviders[index] : nullptr;
 }
 
-bool is_mbta_bus_route(const char *routeId) {
-  char normalized[32];
-  normalize_route_token(routeId, normalized, sizeof(normalized));
-  if (normalized[0] == '\0') return false;
+// Routes MBTA serves by bus: numbered routes, Silver Line and crosstown.
+bool is_mbta_bus_route(const char *normalized) {
   if (normalized[0] >= '0' && normalized[0] <= '9') return true;
   return strncmp(normalized, "SL", 2) == 0 || strncmp(normalized, "CT", 2) == 0;
 }
 
-bool token_matches_alias_list(const char *routeId, const char *aliases) {
-  if (!aliases) return false;
-
-  char normalized[32];
-  normalize_route_token(routeId, normalized, sizeof(normalized));
-  if (normalized[0] == '\0') {
-    return false;
-  }
-
-  const char *cursor = aliases;
-  while (*cursor != '\0') {
-    const char *sep = strchr(cursor, '|');
-    const size_t aliasLen = sep ? static_cast<size_t>(sep - cursor) : strlen(cursor);
-    if (aliasLen == strlen(normalized) && strncmp(cursor, normalized, aliasLen) == 0) {
-      return true;
-    }
-    if (!sep) break;
-    cursor = sep + 1;
-  }
-
-  return false;
-}
-
-uint16_t color_from_alias_table(const AliasRouteColorEntry *table,
-                                size_t count,
-                                const char *routeId,
-                                uint16_t fallbackColor) {
-  for (size_t i = 0; i < count; ++i) {
-    if (token_matches_alias_list(routeId, table[i].aliases)) {
-      return table[i].color565;
-    }
-  }
-  return fallbackColor;
+uint16_t mbta_miss_color(const char *normalized) {
+  if (strncmp(normalized, "BOAT", 4) == 0) return kMbtaFerryFallbackColor;
+  if (is_mbta_bus_route(normalized)) return kMbtaBusColor;
+  return MtaColorMap::kFallbackColor;
 }
 
 }  // namespace
 
 uint16_t MtaColorMap::color_for_route(const char *routeId) {
   const char needle = normalize_route_char(routeId);
-  if (needle == '\0') {
+  if (needle == '\0' || static_cast<unsigned char>(needle) >= 0x80) {
     return kFallbackColor;
   }
-
-  for (size_t i = 0; i < (sizeof(kRouteColorTable) / sizeof(kRouteColorTable[0])); ++i) {
-    if (strchr(kRouteColorTable[i].routes, needle) != nullptr) {
-      return kRouteColorTable[i].color565;
-    }
-  }
-
-  return kFallbackColor;
+  return kRouteFamilyColors.colors[static_cast<uint8_t>(needle)];
 }
 
 uint16_t MtaColorMap::color_for_provider_route(const char *providerId, const char *routeId) {
@@ -239,114 +360,26 @@ uint16_t MtaColorMap::color_for_provider_route(const char *providerId, const cha
     return kFallbackColor;
   }
 
-  if (providerId) {
-    if (strcmp(providerId, "mta-lirr") == 0) {
-      for (size_t i = 0; i < (sizeof(kLirrRouteColorTable) / sizeof(kLirrRouteColorTable[0])); ++i) {
-        if (strcmp(kLirrRouteColorTable[i].routes, routeId) == 0) {
-          return kLirrRouteColorTable[i].color565;
-        }
-      }
-      return kFallbackColor;
-    }
-
-    if (strcmp(providerId, "mta-mnr") == 0) {
-      for (size_t i = 0; i < (sizeof(kMnrRouteColorTable) / sizeof(kMnrRouteColorTable[0])); ++i) {
-        if (strcmp(kMnrRouteColorTable[i].routes, routeId) == 0) {
-          return kMnrRouteColorTable[i].color565;
-        }
-      }
-      return kFallbackColor;
-    }
-
-    if (strcmp(providerId, "septa-rail") == 0) {
-      for (size_t i = 0; i < (sizeof(kSeptaRailColorTable) / sizeof(kSeptaRailColorTable[0])); ++i) {
-        if (strcmp(kSeptaRailColorTable[i].routes, routeId) == 0) {
-          return kSeptaRailColorTable[i].color565;
-        }
-      }
-      return kSeptaRailBadgeColor;
-    }
-
-    if (strcmp(providerId, "septa-trolley") == 0) {
-      for (size_t i = 0; i < (sizeof(kSeptaTrolleyColorTable) / sizeof(kSeptaTrolleyColorTable[0])); ++i) {
-        if (strcmp(kSeptaTrolleyColorTable[i].routes, routeId) == 0) {
-          return kSeptaTrolleyColorTable[i].color565;
-        }
-      }
-      return rgb565(0x3B, 0x7B, 0x38);  // SEPTA trolley green fallback
-    }
-
-    if (strcmp(providerId, "septa-bus") == 0) {
-      if (strcmp(routeId, "L1") == 0 || strcmp(routeId, "L1 OWL") == 0) {
-        return rgb565(0x00, 0x97, 0xD6);
-      }
-      if (strcmp(routeId, "B1") == 0 || strcmp(routeId, "B2") == 0 || strcmp(routeId, "B3") == 0 ||
-          strcmp(routeId, "B1 OWL") == 0) {
-        return kSeptaBroadStreetColor;
-      }
-      if (strcmp(routeId, "M1") == 0 || strcmp(routeId, "M1 BUS") == 0) {
-        return kSeptaNhslPurple;
-      }
-      if (strcmp(routeId, "T BUS") == 0 || strcmp(routeId, "T5 BUS") == 0) {
-        return kSeptaTrolleyGreen;
-      }
-      if (strcmp(routeId, "D1 BUS") == 0 || strcmp(routeId, "D2 BUS") == 0) {
-        return kSeptaMediaSharonHillPink;
-      }
-      return kSeptaBusColor;
-    }
-
-    if (strcmp(providerId, "mta-bus") == 0) {
-      return kMtaBusColor;
-    }
-
-    if (strcmp(providerId, "cta-subway") == 0) {
-      return color_from_alias_table(kCtaSubwayColorTable,
-                                    sizeof(kCtaSubwayColorTable) / sizeof(kCtaSubwayColorTable[0]),
-                                    routeId,
-                                    kFallbackColor);
-    }
-
-    if (strcmp(providerId, "cta-bus") == 0) {
-      return color_from_alias_table(kCtaBusColorTable,
-                                    sizeof(kCtaBusColorTable) / sizeof(kCtaBusColorTable[0]),
-                                    routeId,
-                                    kCtaBusFallbackColor);
-    }
-
-    if (strcmp(providerId, "mbta") == 0 || strcmp(providerId, "mbta-subway") == 0 ||
-        strcmp(providerId, "mbta-bus") == 0 || strcmp(providerId, "mbta-rail") == 0) {
-      if (normalized_route_starts_with(routeId, "BOAT")) {
-        return color_from_alias_table(kMbtaFerryColorTable,
-                                      sizeof(kMbtaFerryColorTable) / sizeof(kMbtaFerryColorTable[0]),
-                                      routeId,
-                                      kMbtaFerryFallbackColor);
-      }
-      if (is_mbta_bus_route(routeId)) {
-        return kMbtaBusColor;
-      }
-      if (normalized_route_starts_with(routeId, "CR") || token_matches_alias_list(routeId, "CAPEFLYER")) {
-        return color_from_alias_table(kMbtaCommuterRailColorTable,
-                                      sizeof(kMbtaCommuterRailColorTable) / sizeof(kMbtaCommuterRailColorTable[0]),
-                                      routeId,
-                                      kFallbackColor);
-      }
-      return color_from_alias_table(kMbtaSubwayColorTable,
-                                    sizeof(kMbtaSubwayColorTable) / sizeof(kMbtaSubwayColorTable[0]),
-                                    routeId,
-                                    kFallbackColor);
-    }
-
-    if (strcmp(providerId, "njt-rail") == 0) {
-      return kNjtRailColor;
-    }
+  const ProviderInfo *provider = providerId ? find_provider(providerId) : nullptr;
+  if (!provider) {
+    return color_for_route(routeId);
+  }
 
-    if (strcmp(providerId, "njt-bus") == 0) {
-      return kNjtBusColor;
-    }
+  char normalized[32];
+  const char *key = routeId;
+  size_t len = 0;
+  if (provider->mode == RouteKeyMode::kNormalized) {
+    len = normalize_route_token(routeId, normalized, sizeof(normalized));
+    key = normalized;
+  } else {
+    len = strlen(routeId);
   }
 
-  return color_for_route(routeId);
+  const int index = kRouteHash.candidate(provider->group, key, len);
+  if (index >= 0 && key_equals(kRouteKeys.keys[index], provider->group, key, len)) {
+    return kRouteKeys.colors[index];
+  }
+  return provider->group == kGroupMbta ? mbta_miss_color(normalized) : provider->missColor;
 }
 
 }  // namespace transit
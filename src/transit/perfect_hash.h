@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace transit {
+
+// Compile-time perfect hash tables for fixed string sets. The compiler
+// runs the generator while building the firmware, so lookup tables can never
+// drift from the source tables they are built from.
+//
+// Hash-and-displace: one 32-bit hash per lookup; its high bits pick a bucket
+// whose displacement is XORed into the low bits to give a slot holding at
+// most one key. A lookup is one hash, one table read and one key compare.
+
+// A key is a byte string plus a small tag, so the same string under two tags
+// (e.g. route "1" for two providers) are different keys.
+struct HashKey {
+  const char *text;
+  uint8_t len;
+  uint8_t tag;
+};
+
+constexpr uint32_t hash_key(uint8_t tag, const char *text, size_t len, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  h = (h ^ tag) * 16777619u;
+  for (size_t i = 0; i < len; ++i) {
+    h = (h ^ static_cast<uint8_t>(text[i])) * 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x7FEB352Du;
+  h ^= h >> 15;
+  return h;
+}
+
+constexpr bool key_equals(const HashKey &key, uint8_t tag, const char *text, size_t len) {
+  if (key.tag != tag || key.len != len) return false;
+  for (size_t i = 0; i < len; ++i) {
+    if (key.text[i] != text[i]) return false;
+  }
+  return true;
+}
+
+constexpr size_t const_strlen(const char *s) {
+  size_t n = 0;
+  while (s[n] != '\0') ++n;
+  return n;
+}
+
+template <size_t kSlots, size_t kBuckets>
+struct PerfectHash {
+  static_assert(kSlots > 0 && (kSlots & (kSlots - 1)) == 0 && kSlots <= 0x8000, "slots must be a power of two");
+  static_assert(kBuckets > 0 && (kBuckets & (kBuckets - 1)) == 0 && kBuckets <= 0x10000,
+                "buckets must be a power of two");
+
+  bool ok;
+  uint32_t seed;
+  uint16_t displacement[kBuckets];
+  int16_t slots[kSlots];  // key index, or -1
+
+  // Index of the only key that can equal (tag, text); the caller compares it.
+  constexpr int candidate(uint8_t tag, const char *text, size_t len) const {
+    const uint32_t h = hash_key(tag, text, len, seed);
+    const uint32_t bucket = (h >> 16) & (kBuckets - 1);
+    return slots[(h ^ displacement[bucket]) & (kSlots - 1)];
+  }
+};
+
+// Tries seeds until every bucket finds a displacement that lands all of its
+// keys in free slots. Buckets are placed largest first. ok stays false when
+// no seed below kMaxSeeds works (duplicate keys never do).
+template <size_t kSlots, size_t kBuckets, size_t N>
+constexpr PerfectHash<kSlots, kBuckets> build_perfect_hash(const HashKey (&keys)[N]) {
+  static_assert(N <= kSlots, "more keys than slots");
+  constexpr uint32_t kMaxSeeds = 64;
+  constexpr size_t kSlotMask = kSlots - 1;
+
+  PerfectHash<kSlots, kBuckets> table{};
+  for (uint32_t seed = 0; seed < kMaxSeeds; ++seed) {
+    uint32_t hashes[N] = {};
+    uint16_t bucketSize[kBuckets] = {};
+    uint16_t bucketStart[kBuckets + 1] = {};
+    uint16_t order[N] = {};
+    uint16_t fill[kBuckets] = {};
+    size_t maxBucket = 0;
+
+    for (size_t i = 0; i < N; ++i) {
+      hashes[i] = hash_key(keys[i].tag, keys[i].text, keys[i].len, seed);
+      const size_t b = (hashes[i] >> 16) & (kBuckets - 1);
+      ++bucketSize[b];
+      if (bucketSize[b] > maxBucket) maxBucket = bucketSize[b];
+    }
+    for (size_t b = 0; b < kBuckets; ++b) {
+      bucketStart[b + 1] = static_cast<uint16_t>(bucketStart[b] + bucketSize[b]);
+    }
+    for (size_t i = 0; i < N; ++i) {
+      const size_t b = (hashes[i] >> 16) & (kBuckets - 1);
+      order[bucketStart[b] + fill[b]++] = static_cast<uint16_t>(i);
+    }
+
+    for (size_t s = 0; s < kSlots; ++s) table.slots[s] = -1;
+    bool placedAll = true;
+    for (size_t size = maxBucket; size > 0 && placedAll; --size) {
+      for (size_t b = 0; b < kBuckets && placedAll; ++b) {
+        if (bucketSize[b] != size) continue;
+        bool placed = false;
+        for (size_t d = 0; d < kSlots && !placed; ++d) {
+          placed = true;
+          for (size_t k = bucketStart[b]; k < bucketStart[b + 1] && placed; ++k) {
+            const size_t slot = (hashes[order[k]] ^ d) & kSlotMask;
+            if (table.slots[slot] >= 0) placed = false;
+            for (size_t j = bucketStart[b]; j < k && placed; ++j) {
+              if (((hashes[order[j]] ^ d) & kSlotMask) == slot) placed = false;
+            }
+          }
+          if (placed) {
+            table.displacement[b] = static_cast<uint16_t>(d);
+            for (size_t k = bucketStart[b]; k < bucketStart[b + 1]; ++k) {
+              table.slots[(hashes[order[k]] ^ d) & kSlotMask] = static_cast<int16_t>(order[k]);
+            }
+          }
+        }
+        placedAll = placed;
+      }
+    }
+
+    if (placedAll) {
+      table.ok = true;
+      table.seed = seed;
+      return table;
+    }
+  }
+  return table;
+}
+
+}  // namespace transit
@@ -0,0 +1,185 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core/eta_countdown.h"
+#include "core/wall_clock.h"
+
+// Checks the on-device ETA countdown (core/eta_countdown) and the clock it
+// reads (core/wall_clock) against hand-worked cases: minutes round up, the
+// last minute shows DUE, an arrival stays DUE for kArrivalGraceMs and then
+// drops off, next_countdown_change_ms() lands exactly on each of those
+// boundaries, and an SNTP sync is never overridden by a payload's server
+// time. Prints one line per failed case and exits 1 if there were any.
+//
+//   countdown_check
+
+namespace {
+
+constexpr uint32_t kArrivalSec = 1760700600;
+constexpr uint64_t kArrivalMs = static_cast<uint64_t>(kArrivalSec) * 1000;
+constexpr uint32_t kMinuteMs = 60000;
+constexpr uint32_t kSweepStepMs = 250;
+
+uint32_t gFailures = 0;
+uint32_t gChecks = 0;
+
+void expect(bool ok, const char *what, long long detail) {
+  ++gChecks;
+  if (ok) return;
+  ++gFailures;
+  printf("FAIL  %s (%lld)\n", what, detail);
+}
+
+core::RowArrivals arrivals_of(const uint32_t *epochs, uint8_t count) {
+  core::RowArrivals arrivals{};
+  arrivals.enabled = true;
+  arrivals.count = count;
+  for (uint8_t i = 0; i < count; ++i) arrivals.epochs[i] = epochs[i];
+  return arrivals;
+}
+
+core::TransitRowModel countdown(const core::RowArrivals &arrivals, uint64_t nowEpochMs) {
+  core::TransitRowModel row{};
+  core::apply_countdown(arrivals, nowEpochMs, row);
+  return row;
+}
+
+// Primary ETA with `remainingMs` to go (negative once the arrival is past).
+void expect_eta(int64_t remainingMs, const char *eta) {
+  const core::RowArrivals arrivals = arrivals_of(&kArrivalSec, 1);
+  const core::TransitRowModel row = countdown(arrivals, static_cast<uint64_t>(kArrivalMs - remainingMs));
+  char what[96];
+  snprintf(what, sizeof(what), "eta is \"%s\" with %lld ms left, got \"%s\"", eta,
+           static_cast<long long>(remainingMs), row.eta);
+  expect(strcmp(row.eta, eta) == 0 && row.etaExtra[0] == '\0' && row.displayType == 1, what, remainingMs);
+}
+
+void expect_next_change(int64_t remainingMs, uint32_t changeMs) {
+  const core::RowArrivals arrivals = arrivals_of(&kArrivalSec, 1);
+  const uint32_t got = core::next_countdown_change_ms(&arrivals, 1, static_cast<uint64_t>(kArrivalMs - remainingMs));
+  char what[96];
+  snprintf(what, sizeof(what), "next change %lu ms with %lld ms left", static_cast<unsigned long>(changeMs),
+           static_cast<long long>(remainingMs));
+  expect(got == changeMs, what, got);
+}
+
+void check_rounding() {
+  // A partial minute counts as a whole one.
+  expect_eta(3 * kMinuteMs, "3m");
+  expect_eta(2 * kMinuteMs + 1, "3m");
+  expect_eta(2 * kMinuteMs, "2m");
+  expect_eta(kMinuteMs + 1, "2m");
+  // The last minute, the arrival itself and the grace after it read DUE.
+  expect_eta(kMinuteMs, "DUE");
+  expect_eta(1, "DUE");
+  expect_eta(0, "DUE");
+  expect_eta(-static_cast<int64_t>(core::kArrivalGraceMs) + 1, "DUE");
+  // Then the arrival drops off and an empty row shows dashes.
+  expect_eta(-static_cast<int64_t>(core::kArrivalGraceMs), "--");
+}
+
+void check_following_arrivals() {
+  const uint32_t epochs[] = {kArrivalSec - 120, kArrivalSec, kArrivalSec + 600};
+  const core::RowArrivals arrivals = arrivals_of(epochs, 3);
+
+  core::TransitRowModel row = countdown(arrivals, kArrivalMs - 5 * kMinuteMs);
+  expect(strcmp(row.eta, "3m") == 0, "first arrival is the primary ETA", 0);
+  expect(strcmp(row.etaExtra, "5M 15M") == 0, "later arrivals fill etaExtra", 0);
+  expect(row.displayType == 4, "etaExtra switches the row to stacked", row.displayType);
+
+  // The first arrival has left: the next one is promoted to the primary ETA.
+  row = countdown(arrivals, kArrivalMs - 2 * kMinuteMs + core::kArrivalGraceMs);
+  expect(strcmp(row.eta, "DUE") == 0 && strcmp(row.etaExtra, "11M") == 0, "departed arrival promotes the next", 0);
+  row = countdown(arrivals, kArrivalMs + 11 * kMinuteMs);
+  expect(strcmp(row.eta, "--") == 0 && row.displayType == 1, "every arrival departed", 0);
+}
+
+void check_next_change() {
+  // One ms either side of the 3m -> 2m, 2m -> DUE, arrival and drop-off
+  // boundaries. Past the last one nothing will change again.
+  expect_next_change(2 * kMinuteMs + 1, 1);
+  expect_next_change(2 * kMinuteMs, kMinuteMs);
+  expect_next_change(2 * kMinuteMs - 1, kMinuteMs - 1);
+  expect_next_change(kMinuteMs + 1, 1);
+  expect_next_change(kMinuteMs, kMinuteMs);
+  expect_next_change(kMinuteMs - 1, kMinuteMs - 1);
+  expect_next_change(1, 1);
+  expect_next_change(0, core::kArrivalGraceMs);
+  expect_next_change(-1, core::kArrivalGraceMs - 1);
+  expect_next_change(-static_cast<int64_t>(core::kArrivalGraceMs) + 1, 1);
+  expect_next_change(-static_cast<int64_t>(core::kArrivalGraceMs), 0);
+
+  // The soonest change over all enabled rows wins; disabled rows are skipped.
+  const uint32_t early = kArrivalSec - 5;
+  core::RowArrivals rows[2] = {arrivals_of(&kArrivalSec, 1), arrivals_of(&early, 1)};
+  const uint64_t nowMs = kArrivalMs - 5 * kMinuteMs - 10000;
+  expect(core::next_countdown_change_ms(rows, 2, nowMs) == 5000, "soonest row wins",
+         core::next_countdown_change_ms(rows, 2, nowMs));
+  rows[1].enabled = false;
+  expect(core::next_countdown_change_ms(rows, 2, nowMs) == 10000, "disabled row ignored",
+         core::next_countdown_change_ms(rows, 2, nowMs));
+}
+
+// Sweeps the whole countdown: the text must hold until the reported change
+// time and differ once it is reached, unless the change is the 1 -> 0
+// minute step that DUE hides.
+void check_sweep() {
+  const uint32_t epochs[] = {kArrivalSec, kArrivalSec + 150};
+  const core::RowArrivals arrivals = arrivals_of(epochs, 2);
+  for (uint64_t now = kArrivalMs - 4 * kMinuteMs; now < kArrivalMs + 4 * kMinuteMs; now += kSweepStepMs) {
+    const uint32_t changeMs = core::next_countdown_change_ms(&arrivals, 1, now);
+    if (changeMs == 0) continue;
+    const core::TransitRowModel before = countdown(arrivals, now);
+    const core::TransitRowModel held = countdown(arrivals, now + changeMs - 1);
+    const core::TransitRowModel after = countdown(arrivals, now + changeMs);
+    expect(strcmp(before.eta, held.eta) == 0 && strcmp(before.etaExtra, held.etaExtra) == 0,
+           "countdown changed before next_countdown_change_ms()", static_cast<long long>(now - kArrivalMs));
+    expect(strcmp(held.eta, after.eta) != 0 || strcmp(held.etaExtra, after.etaExtra) != 0 ||
+               strcmp(held.eta, "DUE") == 0,
+           "countdown did not change at next_countdown_change_ms()", static_cast<long long>(now - kArrivalMs));
+  }
+}
+
+void check_wall_clock() {
+  using Source = core::WallClock::Source;
+  core::WallClock clock;
+  expect(!clock.valid(), "clock starts unsynced", 0);
+
+  clock.sync(Source::kServer, 1000000, 500);
+  expect(clock.valid() && clock.source() == Source::kServer, "server time syncs an unsynced clock", 0);
+  expect(clock.epoch_ms(2500) == 1002000, "epoch extrapolates with millis()", static_cast<long long>(clock.epoch_ms(2500)));
+
+  clock.sync(Source::kServer, 5000000, 3000);
+  expect(clock.epoch_ms(3000) == 5000000, "a later server time replaces an earlier one", 0);
+
+  clock.sync(Source::kSntp, 9000000, 4000);
+  expect(clock.source() == Source::kSntp && clock.epoch_ms(4000) == 9000000, "SNTP replaces server time", 0);
+
+  clock.sync(Source::kServer, 1, 5000);
+  expect(clock.source() == Source::kSntp && clock.epoch_ms(5000) == 9001000, "server time after SNTP is ignored",
+         static_cast<long long>(clock.epoch_ms(5000)));
+  clock.sync(Source::kNone, 1, 5000);
+  expect(clock.epoch_ms(5000) == 9001000, "a sync without a source is ignored", 0);
+
+  clock.sync(Source::kSntp, 9500000, 6000);
+  expect(clock.epoch_ms(6000) == 9500000, "SNTP resyncs", 0);
+
+  // millis() wraps after ~49.7 days; the extrapolation carries across it.
+  clock.sync(Source::kSntp, 20000000, 0xFFFFFF00U);
+  expect(clock.epoch_ms(0x100) == 20000512, "epoch carries across a millis() wrap",
+         static_cast<long long>(clock.epoch_ms(0x100)));
+}
+
+}  // namespace
+
+int main() {
+  check_rounding();
+  check_following_arrivals();
+  check_next_change();
+  check_sweep();
+  check_wall_clock();
+  printf("%lu of %lu countdown checks passed\n", static_cast<unsigned long>(gChecks - gFailures),
+         static_cast<unsigned long>(gChecks));
+  return gFailures == 0 ? 0 : 1;
+}
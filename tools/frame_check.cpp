@@ -0,0 +1,420 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/layout_engine.h"
+#include "host_display.h"
+#include "transit/mta_color_map.h"
+
+// Renders a fixed matrix of scenarios through core::LayoutEngine and
+// display::BadgeRenderer and checks each frame against a golden file: the
+// pixels must match exactly, and no draw call count or the number of pixels
+// written may go up. Counts that went down pass with a note to re-bless.
+//
+//   frame_check [--update] [--out <dir>] <golden-dir>
+//
+// --update rewrites every golden file from the current renderer. Mismatching
+// frames are written to --out (default /tmp/frame_check) as expected/actual
+// PPMs. Golden files are text so a change reviews as a diff:
+//
+//   ops fill_rect N draw_pixel N draw_hline N draw_text N draw_bitmap N pixels N
+//   palette <char> <rgb565 hex>     one per color, '.' is black
+//   frame
+//   <height lines of width palette chars>
+
+namespace {
+
+constexpr uint16_t kColorBlack = 0x0000;
+constexpr int kDiffScale = 4;
+constexpr const char *kDefaultOutDir = "/tmp/frame_check";
+constexpr const char kPaletteChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+struct Viewport {
+  uint16_t width;
+  uint16_t height;
+};
+
+constexpr Viewport kViewports[] = {{64, 32}, {128, 32}, {128, 64}, {256, 64}};
+
+struct Scenario {
+  const char *name;
+  void (*build)(core::RenderModel &model);
+};
+
+template <size_t N>
+void copy_cstr(char (&dst)[N], const char *src) {
+  strncpy(dst, src, N - 1);
+  dst[N - 1] = '\0';
+}
+
+void set_row(core::TransitRowModel &row,
+             const char *provider,
+             const char *route,
+             uint8_t shape,
+             const char *destination,
+             const char *eta,
+             const char *etaExtra) {
+  memset(&row, 0, sizeof(row));
+  row.displayType = 1;
+  row.badgeShape = shape;
+  copy_cstr(row.badgeText, route);
+  row.badgeColor = transit::MtaColorMap::color_for_provider_route(provider, route);
+  copy_cstr(row.destination, destination);
+  copy_cstr(row.eta, eta);
+  copy_cstr(row.etaExtra, etaExtra);
+}
+
+void set_transit(core::RenderModel &model, uint8_t rows) {
+  model.uiState = core::UiState::kTransit;
+  model.hasData = true;
+  model.displayType = 1;
+  model.activeRows = rows;
+}
+
+void build_setup(core::RenderModel &model) {
+  model.uiState = core::UiState::kSetupMode;
+  copy_cstr(model.statusLine, "SET UP");
+  copy_cstr(model.statusDetail, "Scan QR and use the app");
+  copy_cstr(model.bleName, "CommuteLive-AB12");
+}
+
+void build_waiting(core::RenderModel &model) {
+  model.uiState = core::UiState::kConnectedWaitingData;
+  copy_cstr(model.statusLine, "ADD A LINE");
+  copy_cstr(model.statusDetail, "Open the app to get started");
+}
+
+void build_one_row(core::RenderModel &model) {
+  set_transit(model, 1);
+  set_row(model.rows[0], "mta-subway", "A", core::kBadgeShapeCircle, "Inwood-207 St", "3m", "");
+}
+
+void build_two_rows(core::RenderModel &model) {
+  set_transit(model, 2);
+  set_row(model.rows[0], "mta-subway", "A", core::kBadgeShapeCircle, "Inwood-207 St", "3m", "");
+  set_row(model.rows[1], "mta-subway", "1", core::kBadgeShapeCircle, "South Ferry", "8m", "");
+  model.rows[1].delayed = true;
+}
+
+void build_stacked_eta(core::RenderModel &model) {
+  set_transit(model, 2);
+  set_row(model.rows[0], "mta-subway", "Q", core::kBadgeShapeCircle, "96 St", "2m", "9m, 16m");
+  set_row(model.rows[1], "mta-subway", "7", core::kBadgeShapeCircle, "Flushing-Main St", "Due", "5m, 11m");
+  model.rows[0].displayType = 4;
+  model.rows[1].displayType = 4;
+}
+
+void build_pill_badges(core::RenderModel &model) {
+  set_transit(model, 2);
+  set_row(model.rows[0], "mta-bus", "Q58", core::kBadgeShapePill, "Ridgewood Term", "Due", "");
+  set_row(model.rows[1], "mta-bus", "M15", core::kBadgeShapePill, "South Ferry", "12m", "");
+}
+
+void build_long_destination(core::RenderModel &model) {
+  set_transit(model, 2);
+  set_row(model.rows[0], "mta-subway", "A", core::kBadgeShapeCircle, "Far Rockaway-Mott Av via Lefferts Blvd",
+          "11m", "");
+  set_row(model.rows[1], "mta-subway", "S", core::kBadgeShapeCircle, "Franklin Av-Fulton St Shuttle", "4m", "");
+  model.rows[0].scrollEnabled = true;
+}
+
+constexpr Scenario kScenarios[] = {
+    {"setup", &build_setup},
+    {"waiting", &build_waiting},
+    {"one-row", &build_one_row},
+    {"two-rows", &build_two_rows},
+    {"stacked-eta", &build_stacked_eta},
+    {"pill-badges", &build_pill_badges},
+    {"long-destination", &build_long_destination},
+};
+
+struct OpField {
+  const char *name;
+  uint64_t HostDrawCounters::*value;
+};
+
+constexpr OpField kOpFields[] = {
+    {"fill_rect", &HostDrawCounters::fillRect},
+    {"draw_pixel", &HostDrawCounters::drawPixel},
+    {"draw_hline", &HostDrawCounters::drawHline},
+    {"draw_text", &HostDrawCounters::drawText},
+    {"draw_bitmap", &HostDrawCounters::drawBitmap},
+    {"pixels", &HostDrawCounters::pixels},
+};
+
+struct Frame {
+  int width = 0;
+  int height = 0;
+  std::vector<uint16_t> pixels;
+  HostDrawCounters counters{};
+};
+
+void render(const Scenario &scenario, const Viewport &viewport, Frame &out) {
+  core::RenderModel model{};
+  scenario.build(model);
+
+  core::LayoutEngine layout;
+  layout.set_viewport(viewport.width, viewport.height);
+  core::DrawList drawList{};
+  layout.build_transit_layout(model, drawList);
+
+  HostDisplayEngine display(viewport.width, viewport.height);
+  display.clear(kColorBlack);
+  render_draw_list(drawList, display);
+
+  out.width = display.width();
+  out.height = display.height();
+  out.pixels = display.pixels();
+  out.counters = display.counters();
+}
+
+std::string golden_path(const std::string &dir, const Scenario &scenario, const Viewport &viewport) {
+  char name[96];
+  snprintf(name, sizeof(name), "%s-%ux%u.txt", scenario.name, viewport.width, viewport.height);
+  return dir + "/" + name;
+}
+
+bool write_golden(const std::string &path, const Frame &frame) {
+  std::vector<uint16_t> palette;
+  std::string rows;
+  rows.reserve(static_cast<size_t>(frame.width + 1) * frame.height);
+  for (int y = 0; y < frame.height; ++y) {
+    for (int x = 0; x < frame.width; ++x) {
+      const uint16_t color = frame.pixels[static_cast<size_t>(y) * frame.width + x];
+      if (color == kColorBlack) {
+        rows.push_back('.');
+        continue;
+      }
+      size_t slot = 0;
+      while (slot < palette.size() && palette[slot] != color) ++slot;
+      if (slot == palette.size()) {
+        if (slot + 1 >= sizeof(kPaletteChars)) {
+          fprintf(stderr, "%s: more than %zu colors\n", path.c_str(), sizeof(kPaletteChars) - 1);
+          return false;
+        }
+        palette.push_back(color);
+      }
+      rows.push_back(kPaletteChars[slot]);
+    }
+    rows.push_back('\n');
+  }
+
+  std::ofstream out(path);
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", path.c_str());
+    return false;
+  }
+  out << "ops";
+  for (const OpField &field : kOpFields) {
+    out << ' ' << field.name << ' ' << frame.counters.*field.value;
+  }
+  out << '\n';
+  char entry[32];
+  for (size_t i = 0; i < palette.size(); ++i) {
+    snprintf(entry, sizeof(entry), "palette %c %04X\n", kPaletteChars[i], palette[i]);
+    out << entry;
+  }
+  out << "frame\n" << rows;
+  return out.good();
+}
+
+bool read_golden(const std::string &path, int width, int height, Frame &out, std::string &error) {
+  std::ifstream in(path);
+  if (!in) {
+    error = "missing golden " + path + " (run make update-golden)";
+    return false;
+  }
+
+  uint16_t paletteColors[128] = {};
+  bool paletteSet[128] = {};
+  paletteSet[static_cast<uint8_t>('.')] = true;
+  std::string line;
+  bool sawOps = false;
+  while (std::getline(in, line) && line != "frame") {
+    std::istringstream fields(line);
+    std::string keyword;
+    fields >> keyword;
+    if (keyword == "ops") {
+      std::string name;
+      uint64_t value = 0;
+      while (fields >> name >> value) {
+        for (const OpField &field : kOpFields) {
+          if (name == field.name) out.counters.*field.value = value;
+        }
+      }
+      sawOps = true;
+    } else if (keyword == "palette") {
+      std::string symbol;
+      std::string hex;
+      fields >> symbol >> hex;
+      const uint8_t slot = symbol.size() == 1 ? static_cast<uint8_t>(symbol[0]) : 0;
+      if (slot == 0 || slot >= 128) {
+        error = path + ": bad palette line";
+        return false;
+      }
+      paletteColors[slot] = static_cast<uint16_t>(strtoul(hex.c_str(), nullptr, 16));
+      paletteSet[slot] = true;
+    }
+  }
+  if (!sawOps) {
+    error = path + ": no ops line";
+    return false;
+  }
+
+  out.width = width;
+  out.height = height;
+  out.pixels.assign(static_cast<size_t>(width) * height, kColorBlack);
+  for (int y = 0; y < height; ++y) {
+    if (!std::getline(in, line) || static_cast<int>(line.size()) != width) {
+      error = path + ": frame is not " + std::to_string(width) + "x" + std::to_string(height);
+      return false;
+    }
+    for (int x = 0; x < width; ++x) {
+      const uint8_t slot = static_cast<uint8_t>(line[static_cast<size_t>(x)]);
+      if (slot >= 128 || !paletteSet[slot]) {
+        error = path + ": unknown palette char";
+        return false;
+      }
+      out.pixels[static_cast<size_t>(y) * width + x] = paletteColors[slot];
+    }
+  }
+  return true;
+}
+
+bool ensure_dir(const char *path) {
+  return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Prints the scenario's verdict; true when it passes.
+bool check(const std::string &label, const Frame &actual, const Frame &expected, const char *outDir) {
+  bool pass = true;
+  size_t diffPixels = 0;
+  int minX = actual.width;
+  int minY = actual.height;
+  int maxX = -1;
+  int maxY = -1;
+  for (int y = 0; y < actual.height; ++y) {
+    for (int x = 0; x < actual.width; ++x) {
+      const size_t i = static_cast<size_t>(y) * actual.width + x;
+      if (actual.pixels[i] == expected.pixels[i]) continue;
+      ++diffPixels;
+      minX = std::min(minX, x);
+      minY = std::min(minY, y);
+      maxX = std::max(maxX, x);
+      maxY = std::max(maxY, y);
+    }
+  }
+  if (diffPixels > 0) {
+    pass = false;
+    std::string expectedPath;
+    std::string actualPath;
+    if (ensure_dir(outDir)) {
+      expectedPath = std::string(outDir) + "/" + label + ".expected.ppm";
+      actualPath = std::string(outDir) + "/" + label + ".actual.ppm";
+      HostDisplayEngine::write_ppm(expectedPath, expected.pixels, expected.width, expected.height, kDiffScale);
+      HostDisplayEngine::write_ppm(actualPath, actual.pixels, actual.width, actual.height, kDiffScale);
+    }
+    printf("FAIL  %-26s %zu pixels differ in (%d,%d)-(%d,%d); see %s\n",
+           label.c_str(),
+           diffPixels,
+           minX,
+           minY,
+           maxX,
+           maxY,
+           actualPath.empty() ? "(no output dir)" : actualPath.c_str());
+  }
+
+  bool improved = false;
+  for (const OpField &field : kOpFields) {
+    const uint64_t now = actual.counters.*field.value;
+    const uint64_t was = expected.counters.*field.value;
+    if (now > was) {
+      pass = false;
+      printf("FAIL  %-26s %s %llu, golden %llu\n",
+             label.c_str(),
+             field.name,
+             static_cast<unsigned long long>(now),
+             static_cast<unsigned long long>(was));
+    } else if (now < was) {
+      improved = true;
+    }
+  }
+
+  if (pass) {
+    printf("ok    %-26s fill_rect %llu draw_pixel %llu draw_hline %llu pixels %llu%s\n",
+           label.c_str(),
+           static_cast<unsigned long long>(actual.counters.fillRect),
+           static_cast<unsigned long long>(actual.counters.drawPixel),
+           static_cast<unsigned long long>(actual.counters.drawHline),
+           static_cast<unsigned long long>(actual.counters.pixels),
+           improved ? "  (fewer ops than golden; run make update-golden)" : "");
+  }
+  return pass;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool update = false;
+  const char *outDir = kDefaultOutDir;
+  const char *goldenDir = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--update") == 0) {
+      update = true;
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (argv[i][0] != '-' && !goldenDir) {
+      goldenDir = argv[i];
+    } else {
+      goldenDir = nullptr;
+      break;
+    }
+  }
+  if (!goldenDir) {
+    fprintf(stderr, "usage: %s [--update] [--out <dir>] <golden-dir>\n", argv[0]);
+    return 2;
+  }
+
+  uint32_t failures = 0;
+  uint32_t total = 0;
+  for (const Scenario &scenario : kScenarios) {
+    for (const Viewport &viewport : kViewports) {
+      ++total;
+      Frame actual;
+      render(scenario, viewport, actual);
+      const std::string path = golden_path(goldenDir, scenario, viewport);
+      char label[64];
+      snprintf(label, sizeof(label), "%s-%ux%u", scenario.name, viewport.width, viewport.height);
+
+      if (update) {
+        if (!write_golden(path, actual)) ++failures;
+        continue;
+      }
+
+      Frame expected;
+      std::string error;
+      if (!read_golden(path, actual.width, actual.height, expected, error)) {
+        printf("FAIL  %-26s %s\n", label, error.c_str());
+        ++failures;
+        continue;
+      }
+      if (!check(label, actual, expected, outDir)) ++failures;
+    }
+  }
+
+  if (update) {
+    printf("%s %u golden frames in %s\n", failures ? "failed to write" : "wrote", total, goldenDir);
+    return failures ? 1 : 0;
+  }
+  printf("%u of %u frames passed\n", total - failures, total);
+  return failures ? 1 : 0;
+}
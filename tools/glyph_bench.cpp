@@ -0,0 +1,211 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "display/glyph_atlas.h"
+
+// Glyphs/second for the Adafruit_GFX text path versus atlas span fills.
+//
+// The "gfx" side reproduces what Adafruit_GFX::print() does per character on
+// the panel canvas: a column/bit walk over the font with one virtual
+// writePixel per covered pixel (every cell pixel when a background is set),
+// and for tiny-plus text the whole string printed twice. The "atlas" side
+// builds a GlyphAtlas from the same font and draws spans through one virtual
+// hline call per span row. Both write into the same RGB565 framebuffer.
+
+namespace {
+
+constexpr int16_t kFbW = 256;
+constexpr int16_t kFbH = 64;
+constexpr uint16_t kFg = 0xFFE0;
+constexpr uint16_t kBg = 0x0000;
+
+// Stand-in fonts with realistic density; glyph shapes do not matter here.
+uint8_t classic_column(char c, uint8_t col) {
+  const uint8_t seed = static_cast<uint8_t>(static_cast<uint8_t>(c) * 37U + col * 11U);
+  return static_cast<uint8_t>((seed ^ (seed >> 3)) & 0x7F);
+}
+
+bool tiny_pixel(char c, uint8_t x, uint8_t y) {
+  const uint8_t seed = static_cast<uint8_t>(static_cast<uint8_t>(c) * 29U + y * 7U + x * 13U);
+  return ((seed ^ (seed >> 2)) & 1U) != 0;
+}
+
+class Target {
+ public:
+  Target() : pixels_(static_cast<size_t>(kFbW) * kFbH, 0) {}
+  virtual ~Target() = default;
+
+  virtual void write_pixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= kFbW || y >= kFbH) {
+      return;
+    }
+    pixels_[static_cast<size_t>(y) * kFbW + x] = color;
+  }
+
+  virtual void write_hline(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    if (y < 0 || y >= kFbH) {
+      return;
+    }
+    int16_t x0 = x < 0 ? 0 : x;
+    int16_t x1 = static_cast<int16_t>(x + w) > kFbW ? kFbW : static_cast<int16_t>(x + w);
+    uint16_t *row = &pixels_[static_cast<size_t>(y) * kFbW];
+    for (int16_t i = x0; i < x1; ++i) {
+      row[i] = color;
+    }
+  }
+
+  uint32_t checksum() const {
+    uint32_t sum = 0;
+    for (uint16_t p : pixels_) {
+      sum = sum * 31U + p;
+    }
+    return sum;
+  }
+
+ private:
+  std::vector<uint16_t> pixels_;
+};
+
+void gfx_classic(Target &t, int16_t x, int16_t y, const char *text, uint8_t size, bool opaque) {
+  for (const char *p = text; *p; ++p, x = static_cast<int16_t>(x + 6 * size)) {
+    for (uint8_t i = 0; i < 5; ++i) {
+      uint8_t line = classic_column(*p, i);
+      for (uint8_t j = 0; j < 8; ++j, line >>= 1) {
+        const bool lit = (line & 1U) != 0;
+        if (!lit && !opaque) {
+          continue;
+        }
+        for (uint8_t sy = 0; sy < size; ++sy) {
+          for (uint8_t sx = 0; sx < size; ++sx) {
+            t.write_pixel(static_cast<int16_t>(x + i * size + sx), static_cast<int16_t>(y + j * size + sy),
+                          lit ? kFg : kBg);
+          }
+        }
+      }
+    }
+    if (opaque) {
+      for (uint8_t j = 0; j < 8 * size; ++j) {
+        for (uint8_t sx = 0; sx < size; ++sx) {
+          t.write_pixel(static_cast<int16_t>(x + 5 * size + sx), static_cast<int16_t>(y + j), kBg);
+        }
+      }
+    }
+  }
+}
+
+void gfx_tiny(Target &t, int16_t x, int16_t y, const char *text) {
+  for (const char *p = text; *p; ++p, x = static_cast<int16_t>(x + 4)) {
+    for (uint8_t yy = 0; yy < 5; ++yy) {
+      for (uint8_t xx = 0; xx < 3; ++xx) {
+        if (tiny_pixel(*p, xx, yy)) {
+          t.write_pixel(static_cast<int16_t>(x + xx), static_cast<int16_t>(y - 5 + yy), kFg);
+        }
+      }
+    }
+  }
+}
+
+void build_atlas(display::GlyphAtlas &atlas) {
+  uint8_t cells[6 * 8];
+  uint8_t tiny[3 * 5];
+  uint8_t bold[4 * 5];
+  for (char c = display::GlyphAtlas::kFirstChar; c <= display::GlyphAtlas::kLastChar; ++c) {
+    for (uint8_t i = 0; i < 6; ++i) {
+      const uint8_t line = i < 5 ? classic_column(c, i) : 0;
+      for (uint8_t j = 0; j < 8; ++j) {
+        cells[j * 6 + i] = (line >> j) & 1U ? display::GlyphAtlas::kCellForeground
+                                           : display::GlyphAtlas::kCellBackground;
+      }
+    }
+    atlas.add_glyph(display::GlyphSet::kClassic, c, cells, 6, 8, 0, 0, 6);
+
+    memset(bold, display::GlyphAtlas::kCellEmpty, sizeof(bold));
+    for (uint8_t yy = 0; yy < 5; ++yy) {
+      for (uint8_t xx = 0; xx < 3; ++xx) {
+        const bool lit = tiny_pixel(c, xx, yy);
+        tiny[yy * 3 + xx] = lit ? display::GlyphAtlas::kCellForeground : display::GlyphAtlas::kCellEmpty;
+        if (lit) {
+          bold[yy * 4 + xx] = display::GlyphAtlas::kCellForeground;
+          bold[yy * 4 + xx + 1] = display::GlyphAtlas::kCellForeground;
+        }
+      }
+    }
+    atlas.add_glyph(display::GlyphSet::kTiny, c, tiny, 3, 5, 0, -5, 4);
+    atlas.add_glyph(display::GlyphSet::kTinyBold, c, bold, 4, 5, 0, -5, 4);
+  }
+}
+
+struct Case {
+  const char *name;
+  display::GlyphSet set;
+  uint8_t size;
+  bool opaque;
+};
+
+const Case kCases[] = {
+    {"classic x1 bg", display::GlyphSet::kClassic, 1, true},
+    {"classic x1", display::GlyphSet::kClassic, 1, false},
+    {"classic x2 bg", display::GlyphSet::kClassic, 2, true},
+    {"tiny", display::GlyphSet::kTiny, 1, false},
+    {"tiny plus", display::GlyphSet::kTinyBold, 1, false},
+};
+
+const char *const kSamples[] = {"12 min", "Jamaica Ctr", "Due", "Coney Island-Stillwell", "A C E", "3m 14m 27m"};
+
+void run_case(const display::GlyphAtlas &atlas, const Case &c) {
+  constexpr int kIterations = 40000;
+  Target gfx;
+  Target spans;
+  uint64_t glyphs = 0;
+
+  const auto gfxStart = std::chrono::steady_clock::now();
+  for (int it = 0; it < kIterations; ++it) {
+    const char *text = kSamples[it % (sizeof(kSamples) / sizeof(kSamples[0]))];
+    const int16_t y = static_cast<int16_t>(c.set == display::GlyphSet::kClassic ? (it & 15) : 8 + (it & 15));
+    if (c.set == display::GlyphSet::kClassic) {
+      gfx_classic(gfx, static_cast<int16_t>(it & 31), y, text, c.size, c.opaque);
+    } else {
+      gfx_tiny(gfx, static_cast<int16_t>(it & 31), y, text);
+      if (c.set == display::GlyphSet::kTinyBold) {
+        gfx_tiny(gfx, static_cast<int16_t>((it & 31) + 1), y, text);
+      }
+    }
+    glyphs += strlen(text);
+  }
+  const auto gfxEnd = std::chrono::steady_clock::now();
+
+  for (int it = 0; it < kIterations; ++it) {
+    const char *text = kSamples[it % (sizeof(kSamples) / sizeof(kSamples[0]))];
+    const int16_t y = static_cast<int16_t>(c.set == display::GlyphSet::kClassic ? (it & 15) : 8 + (it & 15));
+    atlas.draw(c.set, static_cast<int16_t>(it & 31), y, text, c.size, c.opaque,
+               [&spans](int16_t sx, int16_t sy, int16_t w, bool lit) { spans.write_hline(sx, sy, w, lit ? kFg : kBg); });
+  }
+  const auto atlasEnd = std::chrono::steady_clock::now();
+
+  const double gfxSec = std::chrono::duration<double>(gfxEnd - gfxStart).count();
+  const double atlasSec = std::chrono::duration<double>(atlasEnd - gfxEnd).count();
+  printf("%-14s  gfx: %7.2f Mglyph/s  atlas: %7.2f Mglyph/s  speedup %5.2fx  %s\n",
+         c.name,
+         static_cast<double>(glyphs) / gfxSec / 1e6,
+         static_cast<double>(glyphs) / atlasSec / 1e6,
+         gfxSec / atlasSec,
+         gfx.checksum() == spans.checksum() ? "match" : "MISMATCH");
+}
+
+}  // namespace
+
+int main() {
+  static display::GlyphAtlas atlas;
+  build_atlas(atlas);
+  printf("Glyph atlas: %u spans (%u bytes)\n",
+         static_cast<unsigned>(atlas.span_count()),
+         static_cast<unsigned>(atlas.span_count() * sizeof(display::GlyphSpan)));
+  for (const Case &c : kCases) {
+    run_case(atlas, c);
+  }
+  return 0;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/layout_engine.h"
+#include "display/badge_renderer.h"
+#include "display/display_engine.h"
+#include "display/font_tables.h"
+
+// Software display::DisplayEngine for the host tools: draws into an RGB565
+// buffer the way the HUB75 canvas does and counts the calls it receives.
+// Shared by led_preview and frame_check.
+
+struct HostDrawCounters {
+  uint64_t fillRect;
+  uint64_t drawPixel;
+  uint64_t drawHline;
+  uint64_t drawText;
+  uint64_t drawBitmap;
+  uint64_t pixels;  // in-bounds pixel stores, whichever call made them
+};
+
+class HostDisplayEngine final : public display::DisplayEngine {
+ public:
+  static constexpr uint8_t kTextSizeTinyPlus = 255;
+
+  HostDisplayEngine(int width, int height)
+      : width_(width), height_(height), pixels_(static_cast<size_t>(width) * height, 0), counters_{} {}
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const std::vector<uint16_t> &pixels() const { return pixels_; }
+  const HostDrawCounters &counters() const { return counters_; }
+
+  void clear(uint16_t color) {
+    std::fill(pixels_.begin(), pixels_.end(), color);
+    counters_ = HostDrawCounters{};
+  }
+
+  void draw_text(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size, uint16_t bg) override {
+    ++counters_.drawText;
+    draw_text_internal(x, y, text, color, size, false, bg);
+  }
+
+  void draw_text_transparent(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size) override {
+    ++counters_.drawText;
+    draw_text_internal(x, y, text, color, size, true, 0);
+  }
+
+  void fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    ++counters_.fillRect;
+    for (int16_t yy = 0; yy < h; ++yy) {
+      for (int16_t xx = 0; xx < w; ++xx) {
+        put(x + xx, y + yy, color);
+      }
+    }
+  }
+
+  void draw_pixel(int16_t x, int16_t y, uint16_t color) override {
+    ++counters_.drawPixel;
+    put(x, y, color);
+  }
+
+  void draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    ++counters_.drawHline;
+    for (int16_t xx = 0; xx < w; ++xx) {
+      put(x + xx, y, color);
+    }
+  }
+
+  void draw_bitmap(int16_t x, int16_t y, const uint8_t *bits, int16_t w, int16_t h, uint16_t fg, uint16_t bg) override {
+    ++counters_.drawBitmap;
+    if (!bits) {
+      return;
+    }
+    const int16_t stride = static_cast<int16_t>((w + 7) / 8);
+    for (int16_t yy = 0; yy < h; ++yy) {
+      for (int16_t xx = 0; xx < w; ++xx) {
+        const bool set = (bits[yy * stride + (xx >> 3)] & (0x80U >> (xx & 7))) != 0;
+        put(x + xx, y + yy, set ? fg : bg);
+      }
+    }
+  }
+
+  display::TextMetrics measure_text(const char *text, uint8_t size) override {
+    return display::font_measure_text(text, size);
+  }
+
+  bool write_ppm(const std::string &path, int scale) const { return write_ppm(path, pixels_, width_, height_, scale); }
+
+  static bool write_ppm(const std::string &path, const std::vector<uint16_t> &pixels, int width, int height, int scale) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+      return false;
+    }
+
+    out << "P6\n" << width * scale << " " << height * scale << "\n255\n";
+    for (int y = 0; y < height; ++y) {
+      for (int ys = 0; ys < scale; ++ys) {
+        for (int x = 0; x < width; ++x) {
+          const uint16_t color = pixels[static_cast<size_t>(y) * width + x];
+          const uint8_t r = static_cast<uint8_t>(((color >> 11) & 0x1F) * 255 / 31);
+          const uint8_t g = static_cast<uint8_t>(((color >> 5) & 0x3F) * 255 / 63);
+          const uint8_t b = static_cast<uint8_t>((color & 0x1F) * 255 / 31);
+          for (int xs = 0; xs < scale; ++xs) {
+            out.put(static_cast<char>(r));
+            out.put(static_cast<char>(g));
+            out.put(static_cast<char>(b));
+          }
+        }
+      }
+    }
+    return out.good();
+  }
+
+ private:
+  void put(int x, int y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return;
+    }
+    pixels_[static_cast<size_t>(y) * width_ + x] = color;
+    ++counters_.pixels;
+  }
+
+  // Mirrors Adafruit_GFX text output: classic glyphs fill their whole 6x8 cell
+  // when a background is given, TomThumb glyphs hang off the baseline and are
+  // always transparent, tiny-plus is TomThumb drawn again one pixel right.
+  void draw_text_internal(int16_t x,
+                          int16_t y,
+                          const char *text,
+                          uint16_t color,
+                          uint8_t size,
+                          bool transparent,
+                          uint16_t bg) {
+    if (!text) {
+      return;
+    }
+
+    int16_t cursorX = x;
+    for (size_t i = 0; text[i] != '\0'; ++i) {
+      if (display::font_is_tiny(size)) {
+        draw_tiny_char(cursorX, y, text[i], color);
+        if (size == kTextSizeTinyPlus) {
+          draw_tiny_char(static_cast<int16_t>(cursorX + 1), y, text[i], color);
+        }
+      } else {
+        draw_classic_char(cursorX, y, text[i], color, transparent, bg, size);
+      }
+      cursorX = static_cast<int16_t>(cursorX + display::font_advance(text[i], size));
+    }
+  }
+
+  void draw_classic_char(int16_t x, int16_t y, char c, uint16_t color, bool transparent, uint16_t bg, uint8_t scale) {
+    const uint8_t slot = display::font_glyph_slot(c);
+    for (uint8_t row = 0; row < display::kClassicCellH; ++row) {
+      for (uint8_t col = 0; col < display::kClassicCellW; ++col) {
+        const bool on = display::classic_glyph_pixel(slot, col, row);
+        if (!on && transparent) {
+          continue;
+        }
+        const uint16_t pixelColor = on ? color : bg;
+        for (uint8_t yy = 0; yy < scale; ++yy) {
+          for (uint8_t xx = 0; xx < scale; ++xx) {
+            put(x + col * scale + xx, y + row * scale + yy, pixelColor);
+          }
+        }
+      }
+    }
+  }
+
+  void draw_tiny_char(int16_t x, int16_t y, char c, uint16_t color) {
+    const uint8_t slot = display::font_glyph_slot(c);
+    if (slot == display::kNoGlyph) {
+      return;
+    }
+    const display::FontGlyph &glyph = display::kTinyFontGlyphs[slot];
+    for (uint8_t row = 0; row < glyph.height; ++row) {
+      for (uint8_t col = 0; col < glyph.width; ++col) {
+        if (display::tiny_glyph_pixel(slot, col, row)) {
+          put(x + glyph.xOffset + col, y + glyph.yOffset + row, color);
+        }
+      }
+    }
+  }
+
+  int width_;
+  int height_;
+  std::vector<uint16_t> pixels_;
+  HostDrawCounters counters_;
+};
+
+// Replays a DrawList the way DeviceController::execute_draw_command() does.
+inline void render_draw_list(const core::DrawList &drawList, HostDisplayEngine &display) {
+  display::BadgeRenderer badgeRenderer;
+  for (size_t i = 0; i < drawList.count; ++i) {
+    const core::DrawCommand &cmd = drawList.commands[i];
+    switch (cmd.type) {
+      case core::DrawCommandType::kFillRect:
+        display.fill_rect(cmd.x, cmd.y, cmd.w, cmd.h, cmd.color);
+        break;
+      case core::DrawCommandType::kText:
+        display.draw_text(cmd.x, cmd.y, cmd.text, cmd.color, cmd.size, cmd.bg);
+        break;
+      case core::DrawCommandType::kBadge:
+        badgeRenderer.draw_badge(display, cmd.x, cmd.y, cmd.w, cmd.text, cmd.color);
+        break;
+      case core::DrawCommandType::kRectBadge:
+        badgeRenderer.draw_rect_badge(display,
+                                      cmd.x,
+                                      cmd.y,
+                                      cmd.w,
+                                      cmd.h,
+                                      cmd.text,
+                                      cmd.color,
+                                      static_cast<display::RoundedBadgeStyle>(cmd.size));
+        break;
+      case core::DrawCommandType::kMonoBitmap:
+        if (!cmd.bitmap || cmd.w <= 0 || cmd.h <= 0) {
+          break;
+        }
+        for (int16_t y = 0; y < cmd.h; ++y) {
+          for (int16_t x = 0; x < cmd.w; ++x) {
+            const uint8_t pixel =
+                cmd.bitmap[static_cast<size_t>(y) * static_cast<size_t>(cmd.w) + static_cast<size_t>(x)];
+            display.draw_pixel(static_cast<int16_t>(cmd.x + x),
+                               static_cast<int16_t>(cmd.y + y),
+                               pixel ? cmd.color : cmd.bg);
+          }
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
@@ -0,0 +1,329 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <new>
+#include <string>
+
+#include "parsing/json_tokenizer.h"
+#include "parsing/provider_parser_router.h"
+#include "recorded_payloads.h"
+
+// Messages/second and heap allocations per message for MQTT command parsing.
+//
+// The "legacy" side reproduces the String-based path handle_command() used:
+// copy the payload into a NUL-terminated buffer and a String, then pull every
+// field with its own indexOf() scan, slicing each lines[] item and the badge
+// object into fresh substrings first. std::string stands in for Arduino
+// String; its small-string buffer hides most of the allocations String makes,
+// so the legacy allocation count is a lower bound. The "index" side builds one
+// parsing::JsonIndex over the payload bytes and answers the same lookups from
+// it. Both extract the fields the firmware reads and must agree on them.
+
+namespace {
+
+uint64_t gAllocations = 0;
+
+}  // namespace
+
+void *operator new(size_t size) {
+  ++gAllocations;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+
+// --- legacy String-style extraction ---------------------------------------
+
+std::string legacy_string_field(const std::string &json, const char *field) {
+  const std::string key = std::string("\"") + field + "\"";
+  const size_t keyPos = json.find(key);
+  if (keyPos == std::string::npos) return "";
+  const size_t colonPos = json.find(':', keyPos + key.size());
+  if (colonPos == std::string::npos) return "";
+  size_t i = colonPos + 1;
+  while (i < json.size() && (json[i] == ' ' || json[i] == '\t')) i++;
+  if (i >= json.size()) return "";
+  if (json[i] == '"') {
+    const size_t end = json.find('"', i + 1);
+    if (end == std::string::npos) return "";
+    return json.substr(i + 1, end - i - 1);
+  }
+  size_t end = i;
+  while (end < json.size() && (isalnum(static_cast<unsigned char>(json[end])) || json[end] == '_' || json[end] == '-')) {
+    end++;
+  }
+  return end > i ? json.substr(i, end - i) : "";
+}
+
+int legacy_int_field(const std::string &json, const char *field, int fallbackValue) {
+  const std::string key = std::string("\"") + field + "\"";
+  const size_t keyPos = json.find(key);
+  if (keyPos == std::string::npos) return fallbackValue;
+  const size_t colonPos = json.find(':', keyPos + key.size());
+  if (colonPos == std::string::npos) return fallbackValue;
+  size_t i = colonPos + 1;
+  while (i < json.size() && json[i] == ' ') i++;
+  int value = 0;
+  bool found = false;
+  for (; i < json.size() && json[i] >= '0' && json[i] <= '9'; ++i) {
+    found = true;
+    value = value * 10 + (json[i] - '0');
+  }
+  return found ? value : fallbackValue;
+}
+
+bool legacy_bool_field(const std::string &json, const char *field, bool fallbackValue) {
+  const std::string value = legacy_string_field(json, field);
+  if (value == "true" || value == "1") return true;
+  if (value == "false" || value == "0") return false;
+  return fallbackValue;
+}
+
+int legacy_string_array(const std::string &json, const char *field, std::string out[], int maxCount) {
+  const std::string key = std::string("\"") + field + "\"";
+  const size_t keyPos = json.find(key);
+  if (keyPos == std::string::npos) return 0;
+  const size_t open = json.find('[', keyPos);
+  const size_t close = open == std::string::npos ? open : json.find(']', open);
+  if (close == std::string::npos) return 0;
+  int count = 0;
+  size_t pos = open + 1;
+  while (count < maxCount && pos < close) {
+    while (pos < close && (json[pos] == ' ' || json[pos] == ',')) pos++;
+    if (pos >= close || json[pos] != '"') break;
+    const size_t end = json.find('"', pos + 1);
+    if (end == std::string::npos || end > close) break;
+    out[count++] = json.substr(pos + 1, end - pos - 1);
+    pos = end + 1;
+  }
+  return count;
+}
+
+std::string legacy_object_field(const std::string &json, const char *field) {
+  const std::string key = std::string("\"") + field + "\"";
+  const size_t keyPos = json.find(key);
+  if (keyPos == std::string::npos) return "";
+  const size_t start = json.find('{', keyPos);
+  if (start == std::string::npos) return "";
+  int depth = 0;
+  for (size_t i = start; i < json.size(); ++i) {
+    if (json[i] == '{') depth++;
+    if (json[i] == '}' && --depth == 0) return json.substr(start, i - start + 1);
+  }
+  return "";
+}
+
+bool legacy_line_at(const std::string &json, int index, std::string &out) {
+  const size_t keyPos = json.find("\"lines\"");
+  if (keyPos == std::string::npos) return false;
+  const size_t arrStart = json.find('[', keyPos);
+  if (arrStart == std::string::npos) return false;
+  int depth = 0;
+  int itemIndex = -1;
+  size_t itemStart = 0;
+  for (size_t i = arrStart; i < json.size(); ++i) {
+    const char c = json[i];
+    if (c == '[' || c == '{') {
+      if (c == '{' && depth == 1) {
+        itemIndex++;
+        itemStart = i;
+      }
+      depth++;
+    } else if (c == ']' || c == '}') {
+      depth--;
+      if (c == '}' && depth == 1 && itemIndex == index) {
+        out = json.substr(itemStart, i - itemStart + 1);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// --- extracted fields, compared between both paths -------------------------
+
+struct Row {
+  char label[64];
+  char eta[16];
+  char etaExtra[64];
+  char badgeText[5];
+  char badgeColor[12];
+  bool circle;
+  bool delayed;
+  bool scrolling;
+};
+
+struct Fields {
+  int brightness;
+  char type[32];
+  char reason[48];
+  bool clearCredentials;
+  uint8_t rows;
+  Row row[2];
+};
+
+void copy_field(char *dst, size_t len, const std::string &src) {
+  snprintf(dst, len, "%s", src.c_str());
+}
+
+void legacy_parse(const uint8_t *payload, size_t len, Fields &f) {
+  char messageBuf[1451];
+  memcpy(messageBuf, payload, len);
+  messageBuf[len] = '\0';
+  const std::string message(messageBuf);
+
+  memset(&f, 0, sizeof(f));
+  f.brightness = legacy_int_field(message, "brightness", 80);
+  copy_field(f.type, sizeof(f.type), legacy_string_field(message, "type"));
+  copy_field(f.reason, sizeof(f.reason), legacy_string_field(message, "reason"));
+  f.clearCredentials = legacy_bool_field(message, "clearCredentials", false);
+
+  for (int i = 0; i < 2; ++i) {
+    std::string line;
+    if (!legacy_line_at(message, i, line)) break;
+    Row &r = f.row[f.rows++];
+    copy_field(r.label, sizeof(r.label), legacy_string_field(line, "label"));
+    const std::string badge = legacy_object_field(line, "badge");
+    r.circle = legacy_string_field(badge, "shape") == "circle";
+    copy_field(r.badgeColor, sizeof(r.badgeColor), legacy_string_field(badge, "color"));
+    copy_field(r.badgeText, sizeof(r.badgeText), legacy_string_field(badge, "text"));
+    r.delayed = legacy_string_field(line, "status") == "delayed";
+    r.scrolling = legacy_bool_field(line, "scrolling", false);
+    std::string etas[8];
+    const int n = legacy_string_array(line, "etas", etas, 8);
+    copy_field(r.eta, sizeof(r.eta), n > 0 ? etas[0] : "--");
+    std::string extra;
+    for (int e = 1; e < n; ++e) {
+      for (char &c : etas[e]) {
+        if (c == 'm') c = 'M';
+      }
+      if (e > 1) extra += " ";
+      extra += etas[e];
+    }
+    copy_field(r.etaExtra, sizeof(r.etaExtra), extra);
+  }
+}
+
+void index_parse(parsing::JsonIndex &json, const uint8_t *payload, size_t len, Fields &f) {
+  memset(&f, 0, sizeof(f));
+  if (!json.parse(payload, len)) return;
+  const int root = json.root();
+  f.brightness = json.to_int(json.find(root, "brightness"), 80);
+  json.copy_string(json.find(root, "type"), f.type, sizeof(f.type));
+  json.copy_string(json.find(root, "reason"), f.reason, sizeof(f.reason));
+  f.clearCredentials = json.to_bool(json.find(root, "clearCredentials"), false);
+
+  const int lines = json.find(root, "lines", parsing::JsonType::kArray);
+  for (uint16_t i = 0; i < 2; ++i) {
+    const int line = json.element(lines, i);
+    if (line == parsing::JsonIndex::kNone) break;
+    Row &r = f.row[f.rows++];
+    json.copy_string(json.find(line, "label"), r.label, sizeof(r.label));
+    const int badge = json.find(line, "badge", parsing::JsonType::kObject);
+    r.circle = json.equals(json.find(badge, "shape"), "circle");
+    json.copy_string(json.find(badge, "color"), r.badgeColor, sizeof(r.badgeColor));
+    json.copy_string(json.find(badge, "text"), r.badgeText, sizeof(r.badgeText));
+    r.delayed = json.equals(json.find(line, "status"), "delayed");
+    r.scrolling = json.to_bool(json.find(line, "scrolling"), false);
+    const int etas = json.find(line, "etas", parsing::JsonType::kArray);
+    const uint16_t n = etas == parsing::JsonIndex::kNone ? 0 : json.token(etas).size;
+    if (n == 0) {
+      snprintf(r.eta, sizeof(r.eta), "--");
+      continue;
+    }
+    int item = etas + 1;
+    json.copy_string(item, r.eta, sizeof(r.eta));
+    size_t used = 0;
+    for (uint16_t e = 1; e < n && e < 8; ++e) {
+      item = json.token(item).next;
+      char eta[16];
+      json.copy_string(item, eta, sizeof(eta));
+      for (char *c = eta; *c; ++c) {
+        if (*c == 'm') *c = 'M';
+      }
+      used += static_cast<size_t>(
+          snprintf(r.etaExtra + used, sizeof(r.etaExtra) - used, e > 1 ? " %s" : "%s", eta));
+      if (used >= sizeof(r.etaExtra)) break;
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  constexpr int kIterations = 100000;
+  static parsing::JsonIndex json;
+  bool allMatch = true;
+
+  for (const char *text : kRecordedPayloads) {
+    const uint8_t *payload = reinterpret_cast<const uint8_t *>(text);
+    const size_t len = strlen(text);
+    Fields legacy{};
+    Fields indexed{};
+
+    uint64_t allocStart = gAllocations;
+    const auto legacyStart = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIterations; ++it) {
+      legacy_parse(payload, len, legacy);
+    }
+    const auto legacyEnd = std::chrono::steady_clock::now();
+    const double legacyAllocs = static_cast<double>(gAllocations - allocStart) / kIterations;
+
+    allocStart = gAllocations;
+    for (int it = 0; it < kIterations; ++it) {
+      index_parse(json, payload, len, indexed);
+    }
+    const auto indexEnd = std::chrono::steady_clock::now();
+    const double indexAllocs = static_cast<double>(gAllocations - allocStart) / kIterations;
+
+    const bool match = memcmp(&legacy, &indexed, sizeof(Fields)) == 0;
+    allMatch = allMatch && match;
+    const double legacySec = std::chrono::duration<double>(legacyEnd - legacyStart).count();
+    const double indexSec = std::chrono::duration<double>(indexEnd - legacyEnd).count();
+    printf("%4zu B %3u tok  legacy: %6.2f us %5.1f allocs  index: %5.2f us %3.1f allocs  speedup %5.2fx  %s\n",
+           len,
+           static_cast<unsigned>(json.count()),
+           legacySec / kIterations * 1e6,
+           legacyAllocs,
+           indexSec / kIterations * 1e6,
+           indexAllocs,
+           legacySec / indexSec,
+           match ? "match" : "MISMATCH");
+  }
+
+  // The firmware path proper: index, then v2 lines straight into row models.
+  {
+    const uint8_t *payload = reinterpret_cast<const uint8_t *>(kRecordedPayloads[0]);
+    const size_t len = strlen(kRecordedPayloads[0]);
+    core::TransitRowModel rows[core::kMaxVisibleTransitRows];
+    uint8_t rowCount = 0;
+    const uint64_t allocStart = gAllocations;
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIterations; ++it) {
+      json.parse(payload, len);
+      parsing::parse_transit_rows(json, rows, core::kMaxVisibleTransitRows, rowCount);
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("parse_transit_rows: %5.2f us %3.1f allocs  rows=%u row0='%s' eta=%s extra='%s'\n",
+           sec / kIterations * 1e6,
+           static_cast<double>(gAllocations - allocStart) / kIterations,
+           static_cast<unsigned>(rowCount),
+           rows[0].destination,
+           rows[0].eta,
+           rows[0].etaExtra);
+  }
+
+  printf("JsonIndex arena: %u tokens (%u bytes)\n",
+         static_cast<unsigned>(parsing::JsonIndex::kMaxTokens),
+         static_cast<unsigned>(sizeof(parsing::JsonIndex)));
+  return allMatch ? 0 : 1;
+}
@@ -0,0 +1,486 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/publish_queue.h"
+#include "network/mqtt_codec.h"
+#include "network/mqtt_connection.h"
+
+// Drives mqtt::Connection against a stand-in broker on 127.0.0.1. Each
+// scenario runs the broker side in a thread with one scripted behaviour and
+// checks where the state machine ends up, plus the longest single tick(),
+// which must stay in the low milliseconds however the broker misbehaves.
+// The last scenario drains a core::PublishQueue filled while offline.
+
+namespace {
+
+using mqtt::Connection;
+
+enum class BrokerMode {
+  kNormal,         // CONNACK (split across two writes), SUBACK, one command
+  kSilent,         // accepts TCP, never answers
+  kRefuseConnack,  // CONNACK rc=5
+  kRefuseSubscribe,
+  kOversized,      // a command larger than the rx buffer, then a normal one
+  kNoPings,        // stops answering after SUBACK
+};
+
+struct BrokerLog {
+  bool sawConnect = false;
+  bool sawWill = false;
+  std::string clientId;
+  std::string subscribeTopic;
+  std::string birthTopic;
+  std::string birthPayload;
+  bool birthRetained = false;
+  std::string publishTopic;
+  std::string publishPayload;
+  std::vector<std::string> published;  // every topic after the birth message, in order
+  int pingreqs = 0;
+  bool sawPuback = false;
+  bool sawDisconnect = false;
+};
+
+uint32_t now_ms() {
+  using namespace std::chrono;
+  return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+int listen_loopback(uint16_t &port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  const int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+    close(fd);
+    return -1;
+  }
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// A port nothing listens on: bind one, then close it.
+uint16_t closed_port() {
+  uint16_t port = 0;
+  const int fd = listen_loopback(port);
+  close(fd);
+  return port;
+}
+
+std::string read_str(const uint8_t *&p) {
+  const size_t n = static_cast<size_t>((p[0] << 8) | p[1]);
+  std::string s(reinterpret_cast<const char *>(p + 2), n);
+  p += 2 + n;
+  return s;
+}
+
+void send_all(int fd, const uint8_t *data, size_t len) {
+  while (len > 0) {
+    const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n <= 0) return;
+    data += n;
+    len -= static_cast<size_t>(n);
+  }
+}
+
+size_t encode_publish_qos1(const char *topic, uint16_t packetId, const std::string &payload, uint8_t *out) {
+  const size_t topicLen = strlen(topic);
+  const size_t remaining = 2 + topicLen + 2 + payload.size();
+  size_t pos = 0;
+  out[pos++] = (mqtt::kPublish << 4) | 0x02;
+  size_t r = remaining;
+  do {
+    uint8_t digit = r % 128;
+    r /= 128;
+    if (r > 0) digit |= 0x80;
+    out[pos++] = digit;
+  } while (r > 0);
+  out[pos++] = static_cast<uint8_t>(topicLen >> 8);
+  out[pos++] = static_cast<uint8_t>(topicLen);
+  memcpy(out + pos, topic, topicLen);
+  pos += topicLen;
+  out[pos++] = static_cast<uint8_t>(packetId >> 8);
+  out[pos++] = static_cast<uint8_t>(packetId);
+  memcpy(out + pos, payload.data(), payload.size());
+  return pos + payload.size();
+}
+
+void send_command(int fd, uint16_t packetId, const std::string &payload) {
+  static uint8_t packet[4096];
+  send_all(fd, packet, encode_publish_qos1("device/test/commands", packetId, payload, packet));
+}
+
+// Serves one client until it disconnects or runForMs passes.
+void run_broker(int listenFd, BrokerMode mode, uint32_t runForMs, BrokerLog &log) {
+  const uint32_t endAt = now_ms() + runForMs;
+  pollfd pfd{listenFd, POLLIN, 0};
+  if (poll(&pfd, 1, static_cast<int>(runForMs)) <= 0) return;
+  const int fd = accept(listenFd, nullptr, nullptr);
+  if (fd < 0) return;
+
+  static uint8_t rx[8192];
+  size_t rxLen = 0;
+  bool silent = mode == BrokerMode::kSilent;
+  while (static_cast<int32_t>(endAt - now_ms()) > 0) {
+    pollfd cfd{fd, POLLIN, 0};
+    if (poll(&cfd, 1, 5) <= 0) continue;
+    const ssize_t n = recv(fd, rx + rxLen, sizeof(rx) - rxLen, 0);
+    if (n <= 0) break;
+    rxLen += static_cast<size_t>(n);
+
+    size_t consumed = 0;
+    while (true) {
+      mqtt::Packet packet{};
+      size_t packetLen = 0;
+      if (mqtt::next_packet(rx + consumed, rxLen - consumed, packet, packetLen) != mqtt::DecodeStatus::kComplete) {
+        break;
+      }
+      consumed += packetLen;
+      if (silent) {
+        if (packet.type() == mqtt::kPingreq) ++log.pingreqs;
+        continue;
+      }
+
+      const uint8_t *p = packet.body;
+      switch (packet.type()) {
+        case mqtt::kConnect: {
+          log.sawConnect = true;
+          read_str(p);  // "MQTT"
+          p += 1;
+          const uint8_t flags = *p++;
+          p += 2;
+          log.clientId = read_str(p);
+          log.sawWill = (flags & 0x04) != 0;
+          const uint8_t rc = mode == BrokerMode::kRefuseConnack ? 5 : 0;
+          const uint8_t connack[4] = {mqtt::kConnack << 4, 2, 0, rc};
+          // Two writes so the client has to reassemble the packet.
+          send_all(fd, connack, 1);
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          send_all(fd, connack + 1, 3);
+          break;
+        }
+        case mqtt::kSubscribe: {
+          const uint16_t packetId = static_cast<uint16_t>((p[0] << 8) | p[1]);
+          p += 2;
+          log.subscribeTopic = read_str(p);
+          const uint8_t granted = mode == BrokerMode::kRefuseSubscribe ? mqtt::kSubackFailure : 0;
+          const uint8_t suback[5] = {mqtt::kSuback << 4, 3, static_cast<uint8_t>(packetId >> 8),
+                                     static_cast<uint8_t>(packetId), granted};
+          send_all(fd, suback, sizeof(suback));
+          if (mode == BrokerMode::kNoPings) silent = true;
+          break;
+        }
+        case mqtt::kPublish: {
+          const char *topic = nullptr;
+          size_t topicLen = 0;
+          const uint8_t *payload = nullptr;
+          size_t payloadLen = 0;
+          uint16_t packetId = 0;
+          mqtt::parse_publish(packet, topic, topicLen, payload, payloadLen, packetId);
+          if (log.birthTopic.empty()) {
+            log.birthTopic.assign(topic, topicLen);
+            log.birthPayload.assign(reinterpret_cast<const char *>(payload), payloadLen);
+            log.birthRetained = (packet.header & 0x01) != 0;
+            if (mode == BrokerMode::kOversized) send_command(fd, 7, std::string(3000, 'x'));
+            send_command(fd, 8, "{\"cmdType\":\"ping\"}");
+          } else {
+            log.publishTopic.assign(topic, topicLen);
+            log.publishPayload.assign(reinterpret_cast<const char *>(payload), payloadLen);
+            log.published.emplace_back(log.publishTopic);
+          }
+          break;
+        }
+        case mqtt::kPuback:
+          log.sawPuback = true;
+          break;
+        case mqtt::kPingreq: {
+          ++log.pingreqs;
+          const uint8_t pingresp[2] = {mqtt::kPingresp << 4, 0};
+          send_all(fd, pingresp, sizeof(pingresp));
+          break;
+        }
+        case mqtt::kDisconnect:
+          log.sawDisconnect = true;
+          break;
+        default:
+          break;
+      }
+    }
+    memmove(rx, rx + consumed, rxLen - consumed);
+    rxLen -= consumed;
+    if (log.sawDisconnect) break;
+  }
+  close(fd);
+}
+
+struct ClientLog {
+  int messages = 0;
+  std::string lastTopic;
+  std::string lastPayload;
+};
+
+void on_message(const char *topic, const uint8_t *payload, size_t len, void *ctx) {
+  auto *log = static_cast<ClientLog *>(ctx);
+  ++log->messages;
+  log->lastTopic = topic;
+  log->lastPayload.assign(reinterpret_cast<const char *>(payload), len);
+}
+
+Connection::Options client_options(uint16_t port) {
+  Connection::Options options = Connection::default_options();
+  options.host = "127.0.0.1";
+  options.port = port;
+  options.connect.clientId = "harness-device";
+  options.connect.willTopic = "device/test/presence";
+  options.connect.willMessage = "offline";
+  options.connect.willRetain = true;
+  options.subscribeTopic = "device/test/commands";
+  options.birthTopic = "device/test/presence";
+  options.birthPayload = "online";
+  options.birthRetain = true;
+  options.connackTimeoutMs = 300;
+  options.subackTimeoutMs = 300;
+  return options;
+}
+
+// Ticks like the firmware loop until pred() holds or the budget runs out.
+template <typename Pred>
+bool tick_until(Connection &conn, uint32_t budgetMs, Pred pred) {
+  const uint32_t endAt = now_ms() + budgetMs;
+  while (static_cast<int32_t>(endAt - now_ms()) > 0) {
+    conn.tick(now_ms());
+    if (pred()) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return pred();
+}
+
+int failures = 0;
+
+void check(bool ok, const char *scenario, const char *what) {
+  if (!ok) {
+    ++failures;
+    printf("  FAIL %s: %s\n", scenario, what);
+  }
+}
+
+void report(const char *scenario, const Connection &conn, uint32_t elapsedMs) {
+  printf("%-18s state=%-10s error=%-18s detail=%-4d elapsed=%5lums maxTick=%4luus\n",
+         scenario,
+         Connection::state_name(conn.state()),
+         Connection::error_name(conn.error()),
+         conn.error_detail(),
+         static_cast<unsigned long>(elapsedMs),
+         static_cast<unsigned long>(conn.max_tick_us()));
+}
+
+// The longest tick must be far below the 50ms network poll period.
+constexpr uint32_t kMaxTickBudgetUs = 5000;
+
+void scenario_happy_path() {
+  uint16_t port = 0;
+  const int listenFd = listen_loopback(port);
+  BrokerLog broker;
+  std::thread thread(run_broker, listenFd, BrokerMode::kNormal, 2000, std::ref(broker));
+
+  Connection conn;
+  ClientLog client;
+  conn.set_message_callback(&on_message, &client);
+  const uint32_t startedAt = now_ms();
+  conn.start(client_options(port), now_ms());
+  tick_until(conn, 1500, [&] { return client.messages > 0 || conn.idle(); });
+  const uint32_t elapsed = now_ms() - startedAt;
+  const char *state = "{\"status\":\"ok\"}";
+  conn.publish("device/test/state", reinterpret_cast<const uint8_t *>(state), strlen(state), false);
+  tick_until(conn, 100, [] { return false; });
+  conn.disconnect();
+  thread.join();
+  close(listenFd);
+
+  report("happy_path", conn, elapsed);
+  check(broker.sawConnect && broker.sawWill && broker.clientId == "harness-device", "happy_path", "CONNECT with will");
+  check(broker.subscribeTopic == "device/test/commands", "happy_path", "SUBSCRIBE topic");
+  check(broker.birthTopic == "device/test/presence" && broker.birthPayload == "online" && broker.birthRetained,
+        "happy_path", "retained birth message");
+  check(client.messages == 1 && client.lastTopic == "device/test/commands" &&
+            client.lastPayload == "{\"cmdType\":\"ping\"}",
+        "happy_path", "command delivered");
+  check(broker.sawPuback, "happy_path", "QoS 1 command acknowledged");
+  check(broker.publishTopic == "device/test/state" && broker.publishPayload == state, "happy_path", "publish");
+  check(broker.sawDisconnect, "happy_path", "DISCONNECT sent");
+  check(conn.max_tick_us() < kMaxTickBudgetUs, "happy_path", "tick stayed short");
+}
+
+void scenario_failure(const char *name, BrokerMode mode, Connection::Error expected, int expectedDetail) {
+  uint16_t port = 0;
+  const int listenFd = listen_loopback(port);
+  BrokerLog broker;
+  std::thread thread(run_broker, listenFd, mode, 1000, std::ref(broker));
+
+  Connection conn;
+  const uint32_t startedAt = now_ms();
+  conn.start(client_options(port), now_ms());
+  tick_until(conn, 1000, [&] { return conn.idle(); });
+  const uint32_t elapsed = now_ms() - startedAt;
+  thread.join();
+  close(listenFd);
+
+  report(name, conn, elapsed);
+  check(conn.idle() && conn.error() == expected, name, "expected error");
+  check(expectedDetail < 0 || conn.error_detail() == expectedDetail, name, "expected detail");
+  check(conn.max_tick_us() < kMaxTickBudgetUs, name, "tick stayed short");
+}
+
+void scenario_refused_port() {
+  Connection conn;
+  const uint32_t startedAt = now_ms();
+  conn.start(client_options(closed_port()), now_ms());
+  tick_until(conn, 1000, [&] { return conn.idle(); });
+  report("refused_port", conn, now_ms() - startedAt);
+  check(conn.error() == Connection::Error::kConnectFailed && conn.error_detail() == ECONNREFUSED, "refused_port",
+        "ECONNREFUSED surfaced");
+}
+
+void scenario_oversized_command() {
+  uint16_t port = 0;
+  const int listenFd = listen_loopback(port);
+  BrokerLog broker;
+  std::thread thread(run_broker, listenFd, BrokerMode::kOversized, 1500, std::ref(broker));
+
+  Connection conn;
+  ClientLog client;
+  conn.set_message_callback(&on_message, &client);
+  const uint32_t startedAt = now_ms();
+  conn.start(client_options(port), now_ms());
+  tick_until(conn, 1000, [&] { return client.messages > 0 || conn.idle(); });
+  const uint32_t elapsed = now_ms() - startedAt;
+  const bool stayedUp = conn.connected();
+  conn.disconnect();
+  thread.join();
+  close(listenFd);
+
+  report("oversized_command", conn, elapsed);
+  check(stayedUp, "oversized_command", "session survived");
+  check(client.messages == 1 && client.lastPayload == "{\"cmdType\":\"ping\"}", "oversized_command",
+        "only the command that fits is delivered");
+}
+
+void scenario_keepalive() {
+  uint16_t port = 0;
+  const int listenFd = listen_loopback(port);
+  BrokerLog broker;
+  std::thread thread(run_broker, listenFd, BrokerMode::kNoPings, 3000, std::ref(broker));
+
+  Connection conn;
+  Connection::Options options = client_options(port);
+  options.connect.keepAliveSec = 1;
+  const uint32_t startedAt = now_ms();
+  conn.start(options, now_ms());
+  tick_until(conn, 2500, [&] { return conn.idle(); });
+  const uint32_t elapsed = now_ms() - startedAt;
+  thread.join();
+  close(listenFd);
+
+  report("keepalive_timeout", conn, elapsed);
+  check(conn.error() == Connection::Error::kKeepaliveTimeout, "keepalive_timeout", "silent broker dropped");
+  check(broker.pingreqs >= 1, "keepalive_timeout", "PINGREQ sent before giving up");
+}
+
+bool send_to_connection(const core::PublishQueue::Message &message, void *ctx) {
+  static const char *const kTopics[] = {"device/test/presence", "device/test/state", "device/test/event",
+                                        "device/test/logs", "device/test/telemetry"};
+  auto *conn = static_cast<Connection *>(ctx);
+  return conn->publish(kTopics[static_cast<uint8_t>(message.kind)],
+                       reinterpret_cast<const uint8_t *>(message.payload), message.len, message.retained);
+}
+
+void scenario_offline_queue() {
+  using core::PublishKind;
+  static core::PublishQueue queue;
+  const std::string crash = "{\"event_type\":\"crash_reboot\"}";
+  const std::string log(400, 'l');
+  const std::string telemetry(200, 't');
+  queue.push(PublishKind::kLog, crash.data(), crash.size(), false);
+  int logsAccepted = 1;
+  for (int i = 0; i < 20; ++i) {
+    logsAccepted += queue.push(PublishKind::kLog, log.data(), log.size(), false) ? 1 : 0;
+    queue.push(PublishKind::kTelemetry, telemetry.data(), telemetry.size(), false);
+  }
+  for (int i = 0; i < 5; ++i) queue.push(PublishKind::kPresence, "online", 6, true);
+  for (int i = 0; i < 3; ++i) queue.push(PublishKind::kState, "{\"rows\":2}", 10, false);
+  const uint16_t queued = queue.pending();
+
+  uint16_t port = 0;
+  const int listenFd = listen_loopback(port);
+  BrokerLog broker;
+  std::thread thread(run_broker, listenFd, BrokerMode::kNormal, 3000, std::ref(broker));
+
+  Connection conn;
+  conn.start(client_options(port), now_ms());
+  tick_until(conn, 1000, [&] { return conn.connected() || conn.idle(); });
+  int drainTicks = 0;
+  size_t maxTickBytes = 0;
+  tick_until(conn, 1500, [&] {
+    if (!conn.connected()) return true;
+    if (queue.empty()) return true;
+    const size_t sent = queue.drain(&send_to_connection, &conn, 1024);
+    if (sent > maxTickBytes) maxTickBytes = sent;
+    ++drainTicks;
+    return false;
+  });
+  tick_until(conn, 100, [] { return false; });
+  conn.disconnect();
+  thread.join();
+  close(listenFd);
+
+  printf("%-18s queued=%u delivered=%zu ticks=%d maxTickBytes=%zu dropped=%lu coalesced=%lu\n",
+         "offline_queue",
+         static_cast<unsigned>(queued),
+         broker.published.size(),
+         drainTicks,
+         maxTickBytes,
+         static_cast<unsigned long>(queue.dropped()),
+         static_cast<unsigned long>(queue.coalesced()));
+  const std::vector<std::string> &seen = broker.published;
+  check(queue.empty() && seen.size() == queued, "offline_queue", "everything queued was delivered");
+  check(queue.coalesced() == 6, "offline_queue", "presence and state coalesced to one each");
+  check(seen.size() > 3 && seen[0] == "device/test/presence" && seen[1] == "device/test/state" &&
+            seen[2] == "device/test/logs",
+        "offline_queue", "presence, then state, then logs");
+  check(!seen.empty() && seen.back() == "device/test/telemetry", "offline_queue", "telemetry drains last");
+  check(logsAccepted < 21, "offline_queue", "full log ring refuses new logs");
+  check(broker.published.size() > 2 && drainTicks > 1, "offline_queue", "backlog spread over several ticks");
+}
+
+}  // namespace
+
+int main() {
+  scenario_happy_path();
+  scenario_failure("silent_broker", BrokerMode::kSilent, Connection::Error::kConnackTimeout, -1);
+  scenario_refused_port();
+  scenario_failure("connack_refused", BrokerMode::kRefuseConnack, Connection::Error::kConnackRefused, 5);
+  scenario_failure("suback_refused", BrokerMode::kRefuseSubscribe, Connection::Error::kSubscribeRefused,
+                   mqtt::kSubackFailure);
+  scenario_oversized_command();
+  scenario_keepalive();
+  scenario_offline_queue();
+
+  printf("%s (%d failure%s)\n", failures == 0 ? "PASS" : "FAIL", failures, failures == 1 ? "" : "s");
+  return failures == 0 ? 0 : 1;
+}
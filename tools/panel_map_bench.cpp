@@ -0,0 +1,289 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include "core/panel_mapper.h"
+
+// Panel mapping: the arithmetic Linear/SerpentinePanelMapper against the
+// PanelMapTable DisplayEngine builds in begin(). Every config sanitize_display()
+// accepts is mapped point by point (plus a border of out-of-range points) and
+// span by span; any difference fails the run. Timing uses the largest chain.
+//
+// ChainTransform is learned from stand-ins for the VirtualMatrixPanel
+// transform (rotated 180 degrees onto a chain that runs panel row after panel
+// row); every span it places must cover exactly the chain pixels the stand-in
+// sends that span's points to. A quarter-turn transform must be refused. The
+// last timing fills the whole canvas both ways: one virtual transformed
+// drawPixel per pixel, and per-panel spans written straight to the chain.
+
+namespace {
+
+core::DisplayConfig make_config(uint8_t rows, uint8_t cols, uint16_t width, uint16_t height, bool serpentine) {
+  core::DisplayConfig cfg{1, 2, 64, 32, 255, false, true, 0, 0, 0, 0, 0, 0, 4, false};
+  cfg.panelRows = rows;
+  cfg.panelCols = cols;
+  cfg.panelWidth = width;
+  cfg.panelHeight = height;
+  cfg.serpentine = serpentine;
+  return cfg;
+}
+
+const core::IPanelMapper &arithmetic_mapper(const core::DisplayConfig &cfg) {
+  static const core::LinearPanelMapper linear;
+  static const core::SerpentinePanelMapper serpentine;
+  return cfg.serpentine ? static_cast<const core::IPanelMapper &>(serpentine)
+                        : static_cast<const core::IPanelMapper &>(linear);
+}
+
+bool same(const core::PhysicalPoint &a, const core::PhysicalPoint &b) {
+  if (a.valid != b.valid) return false;
+  return !a.valid || (a.panelIndex == b.panelIndex && a.localX == b.localX && a.localY == b.localY);
+}
+
+size_t check_config(const core::DisplayConfig &cfg, const core::PanelMapTable &table, size_t &probes) {
+  const core::IPanelMapper &reference = arithmetic_mapper(cfg);
+  const int16_t width = static_cast<int16_t>(cfg.panelCols * cfg.panelWidth);
+  const int16_t height = static_cast<int16_t>(cfg.panelRows * cfg.panelHeight);
+  size_t mismatches = 0;
+
+  for (int16_t y = -2; y < height + 2; ++y) {
+    for (int16_t x = -2; x < width + 2; ++x) {
+      ++probes;
+      const core::PhysicalPoint want = reference.map(cfg, x, y);
+      const core::PhysicalPoint got = table.map(x, y);
+      if (!same(want, got) && ++mismatches <= 10) {
+        printf("MISMATCH %ux%u of %ux%u serp=%d (%d,%d) want %d/%u/%u/%u got %d/%u/%u/%u\n",
+               cfg.panelCols, cfg.panelRows, cfg.panelWidth, cfg.panelHeight, cfg.serpentine, x, y,
+               want.valid, want.panelIndex, want.localX, want.localY,
+               got.valid, got.panelIndex, got.localX, got.localY);
+      }
+    }
+  }
+
+  // Spans must cover exactly the in-range points, each matching map().
+  core::PhysicalSpan spans[16];
+  for (int16_t y = 0; y < height; y = static_cast<int16_t>(y + 7)) {
+    for (int16_t x = -5; x < width; x = static_cast<int16_t>(x + 13)) {
+      const int16_t w = static_cast<int16_t>(cfg.panelWidth + 9);
+      const uint8_t count = table.map_span(x, y, w, spans, 16);
+      int16_t cursor = x < 0 ? 0 : x;
+      for (uint8_t i = 0; i < count; ++i) {
+        const core::PhysicalPoint start = reference.map(cfg, cursor, y);
+        if (!start.valid || start.panelIndex != spans[i].panelIndex || start.localX != spans[i].localX ||
+            start.localY != spans[i].localY) {
+          ++mismatches;
+        }
+        cursor = static_cast<int16_t>(cursor + spans[i].length);
+      }
+      const int16_t end = x + w > width ? width : static_cast<int16_t>(x + w);
+      if (cursor != end) ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+// Stand-in driver transforms: logical point -> chain buffer point.
+struct ChainModel {
+  int16_t width;
+  int16_t height;
+  uint16_t panelHeight;
+  bool quarterTurn;
+};
+
+bool model_probe(void *ctx, int16_t x, int16_t y, int16_t &chainX, int16_t &chainY) {
+  const ChainModel &model = *static_cast<const ChainModel *>(ctx);
+  if (x < 0 || y < 0 || x >= model.width || y >= model.height) {
+    return false;
+  }
+  int16_t rx = static_cast<int16_t>(model.width - 1 - x);
+  int16_t ry = static_cast<int16_t>(model.height - 1 - y);
+  if (model.quarterTurn) {
+    rx = y;
+    ry = static_cast<int16_t>(model.width - 1 - x);
+  }
+  const int16_t panelRow = static_cast<int16_t>(ry / model.panelHeight);
+  chainX = static_cast<int16_t>(panelRow * model.width + rx);
+  chainY = static_cast<int16_t>(ry % model.panelHeight);
+  return true;
+}
+
+size_t check_chain(const core::DisplayConfig &cfg, const core::PanelMapTable &table, core::ChainTransform &chain) {
+  ChainModel model{static_cast<int16_t>(table.width()), static_cast<int16_t>(table.height()), cfg.panelHeight, false};
+  if (!chain.learn(table, &model_probe, &model)) {
+    printf("CHAIN LEARN FAILED %ux%u of %ux%u serp=%d\n", cfg.panelCols, cfg.panelRows, cfg.panelWidth,
+           cfg.panelHeight, cfg.serpentine);
+    return 1;
+  }
+  size_t mismatches = 0;
+  core::PhysicalSpan spans[16];
+  for (int16_t y = 0; y < model.height; ++y) {
+    for (int16_t x = -3; x < model.width; x = static_cast<int16_t>(x + 29)) {
+      const uint8_t count = table.map_span(x, y, 61, spans, 16);
+      int16_t cursor = x < 0 ? 0 : x;
+      for (uint8_t i = 0; i < count; ++i) {
+        int16_t chainX = 0;
+        int16_t chainY = 0;
+        chain.place(spans[i], chainX, chainY);
+        for (uint16_t j = 0; j < spans[i].length; ++j, ++cursor) {
+          int16_t wantX = 0;
+          int16_t wantY = 0;
+          model_probe(&model, cursor, y, wantX, wantY);
+          if (wantY != chainY || wantX < chainX || wantX >= chainX + spans[i].length) {
+            ++mismatches;
+          }
+        }
+      }
+    }
+  }
+  // Rows become columns under a quarter turn; no span can be placed.
+  model.quarterTurn = true;
+  if (model.width == model.height && chain.learn(table, &model_probe, &model)) {
+    ++mismatches;
+  }
+  return mismatches;
+}
+
+class ChainBuffer {
+ public:
+  ChainBuffer(int16_t width, int16_t height) : width_(width), pixels_(static_cast<size_t>(width) * height, 0) {}
+  virtual ~ChainBuffer() = default;
+
+  virtual void draw_pixel(int16_t x, int16_t y, uint16_t color) {
+    pixels_[static_cast<size_t>(y) * width_ + x] = color;
+  }
+
+  virtual void draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    uint16_t *row = &pixels_[static_cast<size_t>(y) * width_ + x];
+    for (int16_t i = 0; i < w; ++i) {
+      row[i] = color;
+    }
+  }
+
+  uint16_t at(size_t i) const { return pixels_[i]; }
+
+ private:
+  int16_t width_;
+  std::vector<uint16_t> pixels_;
+};
+
+}  // namespace
+
+int main() {
+  static core::PanelMapTable table;
+  size_t configs = 0;
+  size_t probes = 0;
+  size_t mismatches = 0;
+  for (uint8_t rows = 1; rows <= 4; ++rows) {
+    for (uint8_t cols = 1; cols <= 8; ++cols) {
+      for (uint16_t width : {32, 64, 128}) {
+        for (uint16_t height : {16, 32, 64}) {
+          for (bool serpentine : {false, true}) {
+            const core::DisplayConfig cfg = make_config(rows, cols, width, height, serpentine);
+            if (!table.build(cfg)) {
+              printf("BUILD FAILED %ux%u of %ux%u\n", cols, rows, width, height);
+              ++mismatches;
+              continue;
+            }
+            ++configs;
+            mismatches += check_config(cfg, table, probes);
+            if (rows * cols <= core::ChainTransform::kMaxPanels) {
+              static core::ChainTransform chain;
+              mismatches += check_chain(cfg, table, chain);
+            }
+          }
+        }
+      }
+    }
+  }
+  printf("consistency: %zu configs, %zu probes, %zu mismatches\n", configs, probes, mismatches);
+
+  const core::DisplayConfig cfg = make_config(4, 8, 128, 64, true);
+  table.build(cfg);
+  const core::IPanelMapper &reference = arithmetic_mapper(cfg);
+  const core::IPanelMapper &cached = table;
+  const int16_t width = 8 * 128;
+  const int16_t height = 4 * 64;
+  constexpr int kRounds = 20;
+  uint32_t sink = 0;
+
+  const auto arithmeticStart = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRounds; ++r) {
+    for (int16_t y = 0; y < height; ++y) {
+      for (int16_t x = 0; x < width; ++x) sink += reference.map(cfg, x, y).panelIndex;
+    }
+  }
+  const auto tableStart = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRounds; ++r) {
+    for (int16_t y = 0; y < height; ++y) {
+      for (int16_t x = 0; x < width; ++x) sink += cached.map(cfg, x, y).panelIndex;
+    }
+  }
+  const auto spanStart = std::chrono::steady_clock::now();
+  core::PhysicalSpan spans[8];
+  for (int r = 0; r < kRounds; ++r) {
+    for (int16_t y = 0; y < height; ++y) {
+      const uint8_t count = table.map_span(0, y, width, spans, 8);
+      for (uint8_t i = 0; i < count; ++i) {
+        for (uint16_t j = 0; j < spans[i].length; ++j) sink += spans[i].panelIndex;
+      }
+    }
+  }
+  const auto spanEnd = std::chrono::steady_clock::now();
+
+  const double points = static_cast<double>(width) * height * kRounds;
+  const double arithmeticNs = std::chrono::duration<double, std::nano>(tableStart - arithmeticStart).count() / points;
+  const double tableNs = std::chrono::duration<double, std::nano>(spanStart - tableStart).count() / points;
+  const double spanNs = std::chrono::duration<double, std::nano>(spanEnd - spanStart).count() / points;
+  printf("%dx%d  arithmetic %5.2f ns/px   table %5.2f ns/px   span %5.2f ns/px   speedup %5.2fx   (sink %u)\n",
+         width, height, arithmeticNs, tableNs, spanNs, arithmeticNs / tableNs, static_cast<unsigned>(sink & 0xFF));
+
+  // Full-canvas fill of the 8x4 chain of 128x64 panels as 4 rows of 1024.
+  const core::DisplayConfig linearCfg = make_config(4, 8, 128, 64, false);
+  table.build(linearCfg);
+  ChainModel model{width, height, 64, false};
+  static core::ChainTransform chain;
+  chain.learn(table, &model_probe, &model);
+  ChainBuffer pixelBuffer(static_cast<int16_t>(width * 4), 64);
+  ChainBuffer spanBuffer(static_cast<int16_t>(width * 4), 64);
+  ChainBuffer *pixelTarget = &pixelBuffer;
+  ChainBuffer *spanTarget = &spanBuffer;
+
+  const auto pixelStart = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRounds; ++r) {
+    for (int16_t y = 0; y < height; ++y) {
+      for (int16_t x = 0; x < width; ++x) {
+        int16_t chainX = 0;
+        int16_t chainY = 0;
+        if (model_probe(&model, x, y, chainX, chainY)) {
+          pixelTarget->draw_pixel(chainX, chainY, static_cast<uint16_t>(r + 1));
+        }
+      }
+    }
+  }
+  const auto directStart = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRounds; ++r) {
+    for (int16_t y = 0; y < height; ++y) {
+      const uint8_t count = table.map_span(0, y, width, spans, 8);
+      for (uint8_t i = 0; i < count; ++i) {
+        int16_t chainX = 0;
+        int16_t chainY = 0;
+        chain.place(spans[i], chainX, chainY);
+        spanTarget->draw_hline(chainX, chainY, static_cast<int16_t>(spans[i].length), static_cast<uint16_t>(r + 1));
+      }
+    }
+  }
+  const auto directEnd = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+    if (pixelBuffer.at(i) != spanBuffer.at(i)) {
+      ++mismatches;
+      break;
+    }
+  }
+  const double pixelNs = std::chrono::duration<double, std::nano>(directStart - pixelStart).count() / points;
+  const double directNs = std::chrono::duration<double, std::nano>(directEnd - directStart).count() / points;
+  printf("fill   per-pixel %5.2f ns/px   direct spans %5.2f ns/px   speedup %5.1fx\n", pixelNs, directNs,
+         pixelNs / directNs);
+  return mismatches == 0 ? 0 : 1;
+}
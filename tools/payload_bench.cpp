@@ -0,0 +1,250 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "parsing/binary_payload.h"
+#include "parsing/json_tokenizer.h"
+#include "parsing/provider_parser_router.h"
+#include "recorded_payloads.h"
+
+// Wire size and decode time of the recorded v2 JSON transit updates versus
+// the same updates re-encoded as binary v3. The encoder here is the reference
+// for the backend: it maps each v2 field to its v3 form, and both decodes
+// must produce identical row models. The patch section does the same for an
+// ETA-only change sent as a patch instead of a whole update.
+
+namespace {
+
+using parsing::JsonIndex;
+using parsing::JsonType;
+
+uint16_t hex_to_rgb565(const char *hex) {
+  const char *s = hex[0] == '#' ? hex + 1 : hex;
+  if (strlen(s) < 6) return 0x8410;
+  const unsigned long rgb = strtoul(s, nullptr, 16);
+  const uint8_t r = static_cast<uint8_t>(rgb >> 16);
+  const uint8_t g = static_cast<uint8_t>(rgb >> 8);
+  const uint8_t b = static_cast<uint8_t>(rgb);
+  return static_cast<uint16_t>(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+uint8_t eta_code(const char *eta) {
+  char up[16];
+  size_t n = 0;
+  for (; *eta && n + 1 < sizeof(up); ++eta) {
+    if (!isspace(static_cast<unsigned char>(*eta))) up[n++] = static_cast<char>(toupper(static_cast<unsigned char>(*eta)));
+  }
+  up[n] = '\0';
+  if (strcmp(up, "DUE") == 0 || strcmp(up, "NOW") == 0) return parsing::kEtaDue;
+  if (up[0] < '0' || up[0] > '9') return parsing::kEtaNone;
+  const long minutes = strtol(up, nullptr, 10);
+  return static_cast<uint8_t>(minutes > parsing::kEtaMaxMinutes ? parsing::kEtaMaxMinutes : minutes);
+}
+
+class Writer {
+ public:
+  Writer(uint8_t *out, size_t cap) : out_(out), cap_(cap), len_(0) {}
+  void u8(uint8_t v) {
+    if (len_ < cap_) out_[len_] = v;
+    ++len_;
+  }
+  void u16(uint16_t v) {
+    u8(static_cast<uint8_t>(v));
+    u8(static_cast<uint8_t>(v >> 8));
+  }
+  void str(const char *s, size_t maxLen) {
+    size_t n = strlen(s);
+    if (n > maxLen) n = maxLen;
+    u8(static_cast<uint8_t>(n));
+    for (size_t i = 0; i < n; ++i) u8(static_cast<uint8_t>(s[i]));
+  }
+  size_t len() const { return len_; }
+  uint8_t *at(size_t pos) { return out_ + pos; }
+
+ private:
+  uint8_t *out_;
+  size_t cap_;
+  size_t len_;
+};
+
+size_t encode_v3(const JsonIndex &json, uint8_t *out, size_t cap) {
+  Writer w(out, cap);
+  const int root = json.root();
+  const int brightness = json.find(root, "brightness", JsonType::kPrimitive);
+  const int lines = json.find(root, "lines", JsonType::kArray);
+  const uint16_t lineCount = lines == JsonIndex::kNone ? 0 : json.token(lines).size;
+
+  w.u8(parsing::kBinaryPayloadV3);
+  w.u8(brightness != JsonIndex::kNone ? parsing::kBinaryFlagBrightness : 0);
+  if (brightness != JsonIndex::kNone) w.u8(static_cast<uint8_t>(json.to_int(brightness, 0)));
+  w.u8(static_cast<uint8_t>(lineCount));
+
+  char text[64];
+  for (uint16_t i = 0; i < lineCount; ++i) {
+    const int line = json.element(lines, i);
+    const int badge = json.find(line, "badge", JsonType::kObject);
+    const size_t lenPos = w.len();
+    w.u8(0);  // rowLen, patched below
+
+    uint8_t flags = 0;
+    if (json.equals(json.find(badge, "shape"), "circle")) flags |= parsing::kBinaryRowCircleBadge;
+    if (json.to_bool(json.find(line, "scrolling"), false)) flags |= parsing::kBinaryRowScrolling;
+    json.copy_string(json.find(line, "status"), text, sizeof(text));
+    if (strcasecmp(text, "delayed") == 0) flags |= parsing::kBinaryRowDelayed;
+    w.u8(flags);
+
+    json.copy_string(json.find(badge, "color"), text, sizeof(text));
+    w.u16(badge == JsonIndex::kNone ? 0x8410 : hex_to_rgb565(text));
+    json.copy_string(json.find(badge, "text"), text, sizeof(text));
+    w.str(text, 4);
+    json.copy_string(json.find(line, "label"), text, sizeof(text));
+    w.str(text, core::kMaxDestinationLen - 1);
+
+    const int etas = json.find(line, "etas", JsonType::kArray);
+    const uint16_t etaCount = etas == JsonIndex::kNone ? 0 : json.token(etas).size;
+    w.u8(static_cast<uint8_t>(etaCount));
+    for (uint16_t e = 0; e < etaCount; ++e) {
+      json.copy_string(json.element(etas, e), text, sizeof(text));
+      w.u8(eta_code(text));
+    }
+    if (w.len() <= cap) *w.at(lenPos) = static_cast<uint8_t>(w.len() - lenPos - 1);
+  }
+  return w.len();
+}
+
+bool rows_equal(const core::TransitRowModel &a, const core::TransitRowModel &b) {
+  return a.displayType == b.displayType && a.scrollEnabled == b.scrollEnabled && a.delayed == b.delayed &&
+         strcmp(a.destination, b.destination) == 0 && strcmp(a.eta, b.eta) == 0 &&
+         strcmp(a.etaExtra, b.etaExtra) == 0 && a.badgeShape == b.badgeShape && a.badgeColor == b.badgeColor &&
+         strcmp(a.badgeText, b.badgeText) == 0;
+}
+
+}  // namespace
+
+int main() {
+  constexpr int kIterations = 200000;
+  static JsonIndex json;
+  bool allMatch = true;
+  size_t jsonTotal = 0;
+  size_t binaryTotal = 0;
+
+  for (const char *text : kRecordedPayloads) {
+    const uint8_t *payload = reinterpret_cast<const uint8_t *>(text);
+    const size_t len = strlen(text);
+    if (!json.parse(payload, len) || json.find(json.root(), "lines") == JsonIndex::kNone) {
+      continue;  // commands stay JSON
+    }
+
+    uint8_t binary[256];
+    const size_t binaryLen = encode_v3(json, binary, sizeof(binary));
+    if (binaryLen > sizeof(binary)) {
+      printf("%4zu B  encode overflow\n", len);
+      allMatch = false;
+      continue;
+    }
+
+    core::TransitRowModel v2Rows[core::kMaxVisibleTransitRows] = {};
+    core::TransitRowModel v3Rows[core::kMaxVisibleTransitRows] = {};
+    uint8_t v2Count = 0;
+    uint8_t v3Count = 0;
+
+    const auto v2Start = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIterations; ++it) {
+      json.parse(payload, len);
+      parsing::parse_transit_payload(payload, len, json, v2Rows, core::kMaxVisibleTransitRows, v2Count);
+    }
+    const auto v2End = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIterations; ++it) {
+      parsing::parse_transit_payload(binary, binaryLen, json, v3Rows, core::kMaxVisibleTransitRows, v3Count);
+    }
+    const auto v3End = std::chrono::steady_clock::now();
+
+    bool match = v2Count == v3Count && v2Count > 0;
+    for (uint8_t i = 0; match && i < v2Count; ++i) {
+      match = rows_equal(v2Rows[i], v3Rows[i]);
+    }
+    allMatch = allMatch && match;
+    jsonTotal += len;
+    binaryTotal += binaryLen;
+
+    const double v2Sec = std::chrono::duration<double>(v2End - v2Start).count();
+    const double v3Sec = std::chrono::duration<double>(v3End - v2End).count();
+    printf("v2 %4zu B %5.2f us   v3 %3zu B %5.2f us   size %4.1f%%  speedup %5.2fx  %s\n",
+           len,
+           v2Sec / kIterations * 1e6,
+           binaryLen,
+           v3Sec / kIterations * 1e6,
+           100.0 * static_cast<double>(binaryLen) / static_cast<double>(len),
+           v2Sec / v3Sec,
+           match ? "match" : "MISMATCH");
+  }
+
+  if (jsonTotal > 0) {
+    printf("total: v2 %zu B, v3 %zu B (%.1f%% of v2)\n",
+           jsonTotal,
+           binaryTotal,
+           100.0 * static_cast<double>(binaryTotal) / static_cast<double>(jsonTotal));
+  }
+
+  // The first recorded update a minute later, as a full update and as patches.
+  const char *kNextFull =
+      R"({"v":2,"brightness":60,"lines":[{"provider":"mta-subway","line":"A","label":"Far Rockaway-Mott Av","badge":{"shape":"circle","color":"#0039A6","text":"A"},"status":"on_time","scrolling":true,"etas":["2m","10m","18m"]},{"provider":"mta-subway","line":"C","label":"Euclid Av","badge":{"shape":"circle","color":"#0039A6","text":"C"},"status":"delayed","scrolling":false,"etas":["7m","22m"]}]})";
+  const char *kJsonPatch = R"({"type":"patch","row":0,"etas":["2m","10m","18m"]})";
+  const uint8_t kBinaryPatch[] = {parsing::kBinaryPatchV3, 1, 6, 0, 0, 3, 2, 10, 18};
+  const struct {
+    const char *name;
+    const uint8_t *data;
+    size_t len;
+  } patches[] = {
+      {"json", reinterpret_cast<const uint8_t *>(kJsonPatch), strlen(kJsonPatch)},
+      {"binary", kBinaryPatch, sizeof(kBinaryPatch)},
+  };
+
+  core::TransitRowModel base[core::kMaxVisibleTransitRows] = {};
+  core::TransitRowModel expected[core::kMaxVisibleTransitRows] = {};
+  uint8_t baseCount = 0;
+  uint8_t expectedCount = 0;
+  const uint8_t *first = reinterpret_cast<const uint8_t *>(kRecordedPayloads[0]);
+  json.parse(first, strlen(kRecordedPayloads[0]));
+  parsing::parse_transit_rows(json, base, core::kMaxVisibleTransitRows, baseCount);
+
+  const uint8_t *next = reinterpret_cast<const uint8_t *>(kNextFull);
+  const size_t nextLen = strlen(kNextFull);
+  const auto fullStart = std::chrono::steady_clock::now();
+  for (int it = 0; it < kIterations; ++it) {
+    json.parse(next, nextLen);
+    parsing::parse_transit_rows(json, expected, core::kMaxVisibleTransitRows, expectedCount);
+  }
+  const double fullSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - fullStart).count();
+  printf("patch: full v2 %zu B %5.2f us\n", nextLen, fullSec / kIterations * 1e6);
+
+  for (const auto &patch : patches) {
+    core::TransitRowModel rows[core::kMaxVisibleTransitRows];
+    uint8_t mask = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIterations; ++it) {
+      memcpy(rows, base, sizeof(rows));
+      if (!parsing::is_binary_patch(patch.data, patch.len)) json.parse(patch.data, patch.len);
+      parsing::apply_transit_patch(patch.data, patch.len, json, rows, baseCount, mask);
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool match = mask == 0x01 && baseCount == expectedCount;
+    for (uint8_t i = 0; match && i < baseCount; ++i) {
+      match = rows_equal(rows[i], expected[i]);
+    }
+    allMatch = allMatch && match;
+    printf("patch: %-6s %3zu B %5.2f us   size %4.1f%%  speedup %5.2fx  %s\n",
+           patch.name,
+           patch.len,
+           sec / kIterations * 1e6,
+           100.0 * static_cast<double>(patch.len) / static_cast<double>(nextLen),
+           fullSec / sec,
+           match ? "match" : "MISMATCH");
+  }
+  return allMatch ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// MQTT command payloads recorded from the broker, shared by the host benches.
+// Transit updates come first; device ids and colors are left as captured.
+inline const char *const kRecordedPayloads[] = {
+    R"({"v":2,"brightness":60,"lines":[{"provider":"mta-subway","line":"A","label":"Far Rockaway-Mott Av","badge":{"shape":"circle","color":"#0039A6","text":"A"},"status":"on_time","scrolling":true,"etas":["3m","11m","19m"]},{"provider":"mta-subway","line":"C","label":"Euclid Av","badge":{"shape":"circle","color":"#0039A6","text":"C"},"status":"delayed","scrolling":false,"etas":["7m","22m"]}]})",
+    R"({"v":2,"brightness":80,"lines":[{"provider":"mta-bus","line":"Q58","label":"Ridgewood Term","badge":{"shape":"pill","color":"#EE352E","text":"Q58"},"status":"on_time","scrolling":false,"etas":["Due"]}]})",
+    R"({"v":2,"brightness":45,"arrivalsToDisplay":3,"lines":[{"provider":"mbta","line":"Red","label":"Ashmont/Braintree","badge":{"shape":"pill","color":"#DA291C","text":"RL"},"status":"on_time","scrolling":true,"etas":["1m","6m","12m","18m","25m"]},{"provider":"mbta","line":"Orange","label":"Forest Hills","badge":{"shape":"pill","color":"#ED8B00","text":"OL"},"status":"on_time","scrolling":true,"etas":["4m","13m","21m"]}]})",
+    R"({"type":"display_blank","reason":"schedule","brightness":10})",
+    R"({"type":"disconnect_wifi","reason":"unpaired","clearCredentials":true})",
+};
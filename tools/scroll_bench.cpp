@@ -0,0 +1,282 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "core/layout_engine.h"
+#include "display/scroll_strip.h"
+
+// Compares the cost of one scroll step between the old per-character scroll
+// renderer and the pre-rendered strip blit. Display work is counted the way
+// the HUB75 canvas sees it: one engine call per draw_* and one pixel write per
+// covered pixel (Adafruit's drawChar with a background writes the full
+// 6x8 cell per glyph, scaled by size^2).
+
+namespace {
+
+constexpr uint16_t kColorBlack = 0x0000;
+constexpr uint16_t kColorWhite = 0xFFFF;
+constexpr int16_t kScrollEtaSafetyGapPx = 4;
+
+struct DrawCounters {
+  uint64_t calls = 0;
+  uint64_t pixels = 0;
+};
+
+class CountingDisplayEngine final : public display::DisplayEngine {
+ public:
+  void draw_text(int16_t, int16_t, const char *text, uint16_t, uint8_t size, uint16_t) override {
+    const uint32_t scale = size == 0 ? 1U : size;
+    ++counters.calls;
+    counters.pixels += static_cast<uint64_t>(strlen(text)) * 6U * 8U * scale * scale;
+  }
+
+  void draw_text_transparent(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size) override {
+    draw_text(x, y, text, color, size, color);
+  }
+
+  void fill_rect(int16_t, int16_t, int16_t w, int16_t h, uint16_t) override {
+    ++counters.calls;
+    if (w > 0 && h > 0) {
+      counters.pixels += static_cast<uint64_t>(w) * static_cast<uint64_t>(h);
+    }
+  }
+
+  void draw_pixel(int16_t, int16_t, uint16_t) override {
+    ++counters.calls;
+    ++counters.pixels;
+  }
+
+  void draw_hline(int16_t, int16_t, int16_t w, uint16_t) override {
+    ++counters.calls;
+    if (w > 0) {
+      counters.pixels += static_cast<uint64_t>(w);
+    }
+  }
+
+  void draw_bitmap(int16_t, int16_t, const uint8_t *, int16_t w, int16_t h, uint16_t, uint16_t) override {
+    ++counters.calls;
+    if (w > 0 && h > 0) {
+      counters.pixels += static_cast<uint64_t>(w) * static_cast<uint64_t>(h);
+    }
+  }
+
+  display::TextMetrics measure_text(const char *text, uint8_t size) override {
+    display::TextMetrics tm{};
+    tm.width = static_cast<int16_t>(strlen(text) * 6U * size);
+    tm.height = static_cast<int16_t>(8U * size);
+    return tm;
+  }
+
+  DrawCounters counters;
+};
+
+struct Scenario {
+  const char *name;
+  uint16_t width;
+  uint16_t height;
+  uint8_t rows;
+  const char *destination;
+};
+
+const Scenario kScenarios[] = {
+    {"128x32 2-row", 128, 32, 2, "Jamaica Center-Parsons/Archer via 8 Av Local"},
+    {"128x32 1-row", 128, 32, 1, "Coney Island-Stillwell Av via Sea Beach"},
+    {"192x32 2-row", 192, 32, 2, "Far Rockaway-Mott Av / Rockaway Park-Beach 116 St"},
+    {"256x64 2-row", 256, 64, 2, "Harlem-148 St via Lenox Av Express and 7 Av Local"},
+};
+
+// Stand-in glyphs with typical 5x7 pixel density; only run structure matters here.
+uint8_t synthetic_column(char c, uint8_t col) {
+  const uint8_t seed = static_cast<uint8_t>(static_cast<uint8_t>(c) * 37U + col * 11U);
+  return static_cast<uint8_t>((seed ^ (seed >> 3)) & 0x7F);
+}
+
+void rasterize_strip(const char *text, uint8_t size, display::ScrollStrip &strip) {
+  const int16_t charW = static_cast<int16_t>(6 * size);
+  const int16_t spaceW = static_cast<int16_t>(charW - 2);
+  int16_t width = 0;
+  for (const char *p = text; *p; ++p) {
+    width = static_cast<int16_t>(width + (*p == ' ' ? spaceW : charW));
+  }
+  strip.reset(width, static_cast<int16_t>(8 * size));
+
+  int16_t cx = 0;
+  for (const char *p = text; *p; ++p) {
+    if (*p == ' ') {
+      cx = static_cast<int16_t>(cx + spaceW);
+      continue;
+    }
+    for (uint8_t col = 0; col < 5; ++col) {
+      const uint8_t bits = synthetic_column(*p, col);
+      for (uint8_t row = 0; row < 8; ++row) {
+        if ((bits & (1U << row)) == 0) {
+          continue;
+        }
+        for (uint8_t sy = 0; sy < size; ++sy) {
+          for (uint8_t sx = 0; sx < size; ++sx) {
+            strip.set_pixel(static_cast<int16_t>(cx + col * size + sx), static_cast<int16_t>(row * size + sy));
+          }
+        }
+      }
+    }
+    cx = static_cast<int16_t>(cx + charW);
+  }
+}
+
+// The renderer this change replaced: geometry lookup plus one draw_text per
+// visible character and black fills for gaps, every step.
+void legacy_scroll_step(display::DisplayEngine &display,
+                        const core::LayoutEngine &layout,
+                        const core::RenderModel &model,
+                        uint8_t rowIndex,
+                        int16_t offset) {
+  core::TransitRowGeometry geom{};
+  if (!layout.compute_transit_row_geometry(model, rowIndex, geom)) {
+    return;
+  }
+
+  const char *text = model.rows[rowIndex].destination;
+  const int16_t charW = static_cast<int16_t>(6 * geom.destinationFont);
+  const int16_t charH = static_cast<int16_t>(8 * geom.destinationFont);
+  const int16_t spaceW = static_cast<int16_t>(charW > 2 ? charW - 2 : 1);
+  const int16_t clipLeft = geom.destinationX;
+  const int16_t clipWidth = geom.effectiveDestinationWidth > kScrollEtaSafetyGapPx
+      ? static_cast<int16_t>(geom.effectiveDestinationWidth - kScrollEtaSafetyGapPx)
+      : geom.effectiveDestinationWidth;
+  const int16_t clipRight = static_cast<int16_t>(geom.destinationX + clipWidth);
+
+  int16_t cx = static_cast<int16_t>(geom.destinationX + offset);
+  {
+    int16_t scanCx = cx;
+    int16_t firstVisibleX = clipRight;
+    for (const char *p = text; *p && scanCx < clipRight; ++p) {
+      const int16_t adv = (*p == ' ') ? spaceW : charW;
+      if (*p != ' ' && scanCx >= clipLeft) { firstVisibleX = scanCx; break; }
+      scanCx = static_cast<int16_t>(scanCx + adv);
+    }
+    if (firstVisibleX > clipLeft) {
+      display.fill_rect(clipLeft, geom.destinationY, static_cast<int16_t>(firstVisibleX - clipLeft), charH, kColorBlack);
+    }
+  }
+
+  char buf[2] = {0, 0};
+  for (const char *p = text; *p; ++p) {
+    if (*p == ' ') {
+      const int16_t gapX = cx < clipLeft ? clipLeft : cx;
+      const int16_t gapEnd = static_cast<int16_t>(cx + spaceW);
+      if (gapX < clipRight && gapEnd > clipLeft) {
+        const int16_t gapW = static_cast<int16_t>((gapEnd < clipRight ? gapEnd : clipRight) - gapX);
+        if (gapW > 0) display.fill_rect(gapX, geom.destinationY, gapW, charH, kColorBlack);
+      }
+      cx = static_cast<int16_t>(cx + spaceW);
+      continue;
+    }
+    if (cx < clipLeft) { cx = static_cast<int16_t>(cx + charW); continue; }
+    if (cx >= clipRight) break;
+    buf[0] = *p;
+    display.draw_text(cx, geom.destinationY, buf, kColorWhite, geom.destinationFont, kColorBlack);
+    cx = static_cast<int16_t>(cx + charW);
+  }
+
+  if (cx < clipRight) {
+    display.fill_rect(cx < clipLeft ? clipLeft : cx, geom.destinationY,
+                      static_cast<int16_t>(clipRight - (cx < clipLeft ? clipLeft : cx)), charH, kColorBlack);
+  }
+}
+
+core::RenderModel build_model(const Scenario &scenario) {
+  core::RenderModel model{};
+  model.uiState = core::UiState::kTransit;
+  model.hasData = true;
+  model.displayType = 1;
+  model.activeRows = scenario.rows;
+  for (uint8_t i = 0; i < scenario.rows; ++i) {
+    core::TransitRowModel &row = model.rows[i];
+    row.displayType = 1;
+    row.scrollEnabled = true;
+    row.badgeShape = core::kBadgeShapeCircle;
+    row.badgeColor = 0x01B4;
+    strncpy(row.destination, scenario.destination, sizeof(row.destination) - 1);
+    strncpy(row.eta, "12m", sizeof(row.eta) - 1);
+    strncpy(row.badgeText, "A", sizeof(row.badgeText) - 1);
+  }
+  return model;
+}
+
+void run_scenario(const Scenario &scenario) {
+  core::LayoutEngine layout;
+  layout.set_viewport(scenario.width, scenario.height);
+  const core::RenderModel model = build_model(scenario);
+
+  core::TransitRowGeometry geom{};
+  if (!layout.compute_transit_row_geometry(model, 0, geom) || geom.destinationFont == 0) {
+    printf("%-14s  (no scrollable destination)\n", scenario.name);
+    return;
+  }
+
+  display::ScrollStrip strip;
+  rasterize_strip(model.rows[0].destination, geom.destinationFont, strip);
+  const int16_t window = geom.effectiveDestinationWidth > kScrollEtaSafetyGapPx
+      ? static_cast<int16_t>(geom.effectiveDestinationWidth - kScrollEtaSafetyGapPx)
+      : geom.effectiveDestinationWidth;
+  const int16_t overflow = static_cast<int16_t>(strip.width() - window);
+  if (overflow <= 0) {
+    printf("%-14s  (destination fits; nothing to scroll)\n", scenario.name);
+    return;
+  }
+
+  // One full scroll cycle across every row, repeated for stable timings.
+  constexpr int kCycles = 200;
+  CountingDisplayEngine legacy;
+  CountingDisplayEngine blit;
+  uint64_t steps = 0;
+
+  const auto legacyStart = std::chrono::steady_clock::now();
+  for (int cycle = 0; cycle < kCycles; ++cycle) {
+    for (int16_t offset = 0; offset >= -overflow; --offset) {
+      for (uint8_t row = 0; row < scenario.rows; ++row) {
+        legacy_scroll_step(legacy, layout, model, row, offset);
+      }
+    }
+  }
+  const auto legacyEnd = std::chrono::steady_clock::now();
+
+  for (int cycle = 0; cycle < kCycles; ++cycle) {
+    for (int16_t offset = 0; offset >= -overflow; --offset) {
+      for (uint8_t row = 0; row < scenario.rows; ++row) {
+        strip.blit(blit, geom.destinationX, geom.destinationY, window, static_cast<int16_t>(-offset), kColorWhite,
+                   kColorBlack);
+      }
+      ++steps;
+    }
+  }
+  const auto blitEnd = std::chrono::steady_clock::now();
+
+  const double legacyNs =
+      static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(legacyEnd - legacyStart).count());
+  const double blitNs =
+      static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(blitEnd - legacyEnd).count());
+  const double n = static_cast<double>(steps);
+  printf("%-14s  font=%u window=%3dpx  legacy: %6.1f calls %7.1f px %8.0f ns  strip: %6.1f calls %7.1f px %8.0f ns\n",
+         scenario.name,
+         static_cast<unsigned>(geom.destinationFont),
+         static_cast<int>(window),
+         static_cast<double>(legacy.counters.calls) / n,
+         static_cast<double>(legacy.counters.pixels) / n,
+         legacyNs / n,
+         static_cast<double>(blit.counters.calls) / n,
+         static_cast<double>(blit.counters.pixels) / n,
+         blitNs / n);
+}
+
+}  // namespace
+
+int main() {
+  printf("Per scroll step (all scrolling rows), averaged over full scroll cycles\n");
+  for (const Scenario &scenario : kScenarios) {
+    run_scenario(scenario);
+  }
+  return 0;
+}
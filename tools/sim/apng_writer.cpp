@@ -0,0 +1,198 @@
+#include "apng_writer.h"
+
+#include <string.h>
+
+namespace sim {
+
+namespace {
+
+constexpr uint8_t kPngSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr size_t kMaxStoredBlock = 65535;
+constexpr uint16_t kDelayDenominator = 1000;  // fcTL delays in ms
+
+uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc = 0) {
+  static uint32_t table[256];
+  static bool ready = false;
+  if (!ready) {
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) c = (c & 1U) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    ready = true;
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) crc = table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+  return ~crc;
+}
+
+void put_u32(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 24));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_u16(std::vector<uint8_t> &out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+// zlib stream of stored blocks.
+void deflate_stored(const std::vector<uint8_t> &raw, std::vector<uint8_t> &out) {
+  out.push_back(0x78);
+  out.push_back(0x01);
+  size_t offset = 0;
+  do {
+    const size_t len = raw.size() - offset < kMaxStoredBlock ? raw.size() - offset : kMaxStoredBlock;
+    const bool last = offset + len == raw.size();
+    out.push_back(last ? 1 : 0);
+    out.push_back(static_cast<uint8_t>(len));
+    out.push_back(static_cast<uint8_t>(len >> 8));
+    out.push_back(static_cast<uint8_t>(~len));
+    out.push_back(static_cast<uint8_t>(~len >> 8));
+    out.insert(out.end(), raw.begin() + static_cast<long>(offset), raw.begin() + static_cast<long>(offset + len));
+    offset += len;
+  } while (offset < raw.size());
+
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (uint8_t byte : raw) {
+    a = (a + byte) % 65521U;
+    b = (b + a) % 65521U;
+  }
+  put_u32(out, (b << 16) | a);
+}
+
+}  // namespace
+
+ApngWriter::ApngWriter()
+    : file_(nullptr),
+      width_(0),
+      height_(0),
+      scale_(1),
+      actlOffset_(0),
+      frames_(0),
+      sequence_(0),
+      hasPending_(false),
+      pendingAtMs_(0) {}
+
+ApngWriter::~ApngWriter() {
+  if (file_) fclose(file_);
+}
+
+bool ApngWriter::open(const char *path, uint16_t width, uint16_t height, uint8_t scale) {
+  if (file_ || width == 0 || height == 0 || scale == 0) return false;
+  file_ = fopen(path, "wb");
+  if (!file_) return false;
+  width_ = width;
+  height_ = height;
+  scale_ = scale;
+
+  std::vector<uint8_t> ihdr;
+  put_u32(ihdr, static_cast<uint32_t>(width_) * scale_);
+  put_u32(ihdr, static_cast<uint32_t>(height_) * scale_);
+  ihdr.push_back(8);  // bit depth
+  ihdr.push_back(2);  // RGB
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+
+  std::vector<uint8_t> actl;
+  put_u32(actl, 0);  // frame count, patched by close()
+  put_u32(actl, 0);  // loop forever
+
+  if (fwrite(kPngSignature, 1, sizeof(kPngSignature), file_) != sizeof(kPngSignature) ||
+      !write_chunk("IHDR", ihdr)) {
+    return false;
+  }
+  actlOffset_ = ftell(file_);
+  return write_chunk("acTL", actl);
+}
+
+bool ApngWriter::add_frame(const uint16_t *pixels, uint32_t atMs) {
+  if (!file_ || !pixels) return false;
+  if (hasPending_ && !write_pending(atMs - pendingAtMs_)) return false;
+
+  const size_t outWidth = static_cast<size_t>(width_) * scale_;
+  pendingRows_.clear();
+  pendingRows_.reserve((outWidth * 3 + 1) * height_ * scale_);
+  for (uint16_t y = 0; y < height_; ++y) {
+    const size_t rowStart = pendingRows_.size();
+    pendingRows_.push_back(0);  // filter: none
+    for (uint16_t x = 0; x < width_; ++x) {
+      const uint16_t color = pixels[static_cast<size_t>(y) * width_ + x];
+      const uint8_t r = static_cast<uint8_t>(((color >> 11) & 0x1F) * 255 / 31);
+      const uint8_t g = static_cast<uint8_t>(((color >> 5) & 0x3F) * 255 / 63);
+      const uint8_t b = static_cast<uint8_t>((color & 0x1F) * 255 / 31);
+      for (uint8_t xs = 0; xs < scale_; ++xs) {
+        pendingRows_.push_back(r);
+        pendingRows_.push_back(g);
+        pendingRows_.push_back(b);
+      }
+    }
+    for (uint8_t ys = 1; ys < scale_; ++ys) {
+      pendingRows_.insert(pendingRows_.end(), pendingRows_.begin() + static_cast<long>(rowStart),
+                          pendingRows_.begin() + static_cast<long>(rowStart + outWidth * 3 + 1));
+    }
+  }
+  hasPending_ = true;
+  pendingAtMs_ = atMs;
+  return true;
+}
+
+bool ApngWriter::close(uint32_t lastDurationMs) {
+  if (!file_) return false;
+  bool ok = !hasPending_ || write_pending(lastDurationMs);
+  ok = ok && write_chunk("IEND", {});
+
+  // acTL goes before the first IDAT, so its frame count is patched in place.
+  std::vector<uint8_t> actl;
+  put_u32(actl, frames_);
+  put_u32(actl, 0);
+  ok = ok && fseek(file_, actlOffset_, SEEK_SET) == 0 && write_chunk("acTL", actl);
+  ok = fclose(file_) == 0 && ok;
+  file_ = nullptr;
+  return ok;
+}
+
+bool ApngWriter::write_chunk(const char *type, const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> chunk;
+  chunk.reserve(data.size() + 12);
+  put_u32(chunk, static_cast<uint32_t>(data.size()));
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  put_u32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+  return fwrite(chunk.data(), 1, chunk.size(), file_) == chunk.size();
+}
+
+bool ApngWriter::write_pending(uint32_t durationMs) {
+  std::vector<uint8_t> fctl;
+  put_u32(fctl, sequence_++);
+  put_u32(fctl, static_cast<uint32_t>(width_) * scale_);
+  put_u32(fctl, static_cast<uint32_t>(height_) * scale_);
+  put_u32(fctl, 0);  // x offset
+  put_u32(fctl, 0);  // y offset
+  put_u16(fctl, static_cast<uint16_t>(durationMs > 0xFFFF ? 0xFFFF : durationMs));
+  put_u16(fctl, kDelayDenominator);
+  fctl.push_back(0);  // dispose: none
+  fctl.push_back(0);  // blend: source
+  if (!write_chunk("fcTL", fctl)) return false;
+
+  std::vector<uint8_t> data;
+  if (frames_ == 0) {
+    deflate_stored(pendingRows_, data);
+    if (!write_chunk("IDAT", data)) return false;
+  } else {
+    put_u32(data, sequence_++);
+    std::vector<uint8_t> compressed;
+    deflate_stored(pendingRows_, compressed);
+    data.insert(data.end(), compressed.begin(), compressed.end());
+    if (!write_chunk("fdAT", data)) return false;
+  }
+  ++frames_;
+  hasPending_ = false;
+  return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+// Animated PNG from RGB565 frames, for viewing a capture in a browser. The
+// image data is stored uncompressed (deflate "stored" blocks) so the writer
+// needs no zlib; keep captures to the window of interest.
+namespace sim {
+
+class ApngWriter final {
+ public:
+  ApngWriter();
+  ~ApngWriter();
+
+  bool open(const char *path, uint16_t width, uint16_t height, uint8_t scale);
+  // Frames are written one behind, once the next one fixes their duration.
+  bool add_frame(const uint16_t *pixels, uint32_t atMs);
+  // Writes the last frame with durationMs and patches the frame count.
+  bool close(uint32_t lastDurationMs);
+
+  uint32_t frames() const { return frames_ + (hasPending_ ? 1 : 0); }
+
+ private:
+  bool write_chunk(const char *type, const std::vector<uint8_t> &data);
+  bool write_pending(uint32_t durationMs);
+
+  FILE *file_;
+  uint16_t width_;
+  uint16_t height_;
+  uint8_t scale_;
+  long actlOffset_;
+  uint32_t frames_;
+  uint32_t sequence_;
+  bool hasPending_;
+  uint32_t pendingAtMs_;
+  std::vector<uint8_t> pendingRows_;  // filtered scanlines of the frame waiting for its duration
+};
+
+}  // namespace sim
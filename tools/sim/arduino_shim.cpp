@@ -0,0 +1,355 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <Update.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <stdarg.h>
+#include <sys/time.h>
+
+#include <map>
+#include <vector>
+
+#include "sim_runtime.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+UpdateClass Update;
+
+namespace {
+
+constexpr uint32_t kSimFreeHeap = 180000;
+constexpr uint32_t kSimMaxAllocHeap = 110000;
+constexpr int8_t kSimRssi = -58;
+
+// Fixed seed so "random" jitter is the same on every run.
+uint32_t gRandomState = 0x2545F491U;
+
+uint32_t next_random() {
+  gRandomState ^= gRandomState << 13;
+  gRandomState ^= gRandomState >> 17;
+  gRandomState ^= gRandomState << 5;
+  return gRandomState;
+}
+
+using PrefsNamespace = std::map<std::string, std::vector<uint8_t>>;
+
+std::map<std::string, PrefsNamespace> &prefs_store() {
+  static std::map<std::string, PrefsNamespace> store;
+  return store;
+}
+
+// The firmware runs on one simulated task; this is its handle and the
+// notification count xTaskNotifyGive() leaves for its next wait.
+int gTaskHandle = 0;
+uint32_t gPendingNotifications = 0;
+
+}  // namespace
+
+unsigned long millis() {
+  return sim::now_ms();
+}
+
+unsigned long micros() {
+  return static_cast<unsigned long>(sim::now_us());
+}
+
+void delay(unsigned long ms) {
+  sim::advance_ms(static_cast<uint32_t>(ms));
+}
+
+void randomSeed(unsigned long seed) {
+  gRandomState = seed != 0 ? static_cast<uint32_t>(seed) : 0x2545F491U;
+}
+
+long random(long maxExclusive) {
+  return maxExclusive > 0 ? static_cast<long>(next_random() % static_cast<uint32_t>(maxExclusive)) : 0;
+}
+
+long random(long minInclusive, long maxExclusive) {
+  return maxExclusive > minInclusive ? minInclusive + random(maxExclusive - minInclusive) : minInclusive;
+}
+
+uint32_t esp_random() {
+  return next_random();
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2,
+                const char *server3) {
+  (void)gmtOffsetSec;
+  (void)daylightOffsetSec;
+  (void)server1;
+  (void)server2;
+  (void)server3;
+}
+
+namespace sim {
+
+// Parenthesised so the redirecting macro in the sys/time.h shim leaves the
+// definition alone.
+int(gettimeofday)(struct timeval *tv, void *tz) {
+  (void)tz;
+  const uint64_t epochMs = sntp_epoch_ms();
+  tv->tv_sec = static_cast<time_t>(epochMs / 1000U);
+  tv->tv_usec = static_cast<suseconds_t>((epochMs % 1000U) * 1000U);
+  return 0;
+}
+
+}  // namespace sim
+
+void String::trim() {
+  const size_t first = s_.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    s_.clear();
+    return;
+  }
+  s_ = s_.substr(first, s_.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+  (void)baud;
+}
+
+size_t HardwareSerial::printf(const char *fmt, ...) {
+  char line[1024];
+  va_list args;
+  va_start(args, fmt);
+  const int written = vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  if (written <= 0) return 0;
+  sim::serial_write(line);
+  if (sim::serial_echo()) fputs(line, stderr);
+  return static_cast<size_t>(written);
+}
+
+size_t HardwareSerial::print(const char *text) {
+  return sim::serial_echo() ? static_cast<size_t>(fputs(text, stderr)) : 0;
+}
+
+size_t HardwareSerial::println(const char *text) {
+  if (!sim::serial_echo()) return 0;
+  return static_cast<size_t>(fprintf(stderr, "%s\n", text));
+}
+
+void HardwareSerial::flush() {
+  if (sim::serial_echo()) fflush(stderr);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return kSimFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return kSimMaxAllocHeap;
+}
+
+uint64_t EspClass::getEfuseMac() {
+  return 0x0000A1B2C3D4E5F6ULL;
+}
+
+const char *EspClass::getSdkVersion() {
+  return "sim";
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+  return 240;
+}
+
+void EspClass::restart() {
+  sim::request_restart();
+}
+
+wl_status_t WiFiClass::status() {
+  if (!sim::station_started()) return WL_IDLE_STATUS;
+  return sim::wifi_up() ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+int8_t WiFiClass::RSSI() {
+  return status() == WL_CONNECTED ? kSimRssi : 0;
+}
+
+String WiFiClass::SSID() {
+  return String(status() == WL_CONNECTED ? "sim-ap" : "");
+}
+
+IPAddress WiFiClass::localIP() {
+  return status() == WL_CONNECTED ? IPAddress(192, 168, 4, 20) : IPAddress();
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  return status() == WL_CONNECTED ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", octets_[0], octets_[1], octets_[2], octets_[3]);
+  return String(text);
+}
+
+bool Preferences::begin(const char *ns, bool readOnly) {
+  ns_ = ns ? ns : "";
+  open_ = true;
+  readOnly_ = readOnly;
+  return true;
+}
+
+void Preferences::end() {
+  open_ = false;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!open_ || readOnly_) return false;
+  return prefs_store()[ns_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+  return open_ && prefs_store()[ns_].count(key) > 0;
+}
+
+size_t Preferences::put_raw(const char *key, const void *value, size_t len) {
+  if (!open_ || readOnly_) return 0;
+  const uint8_t *bytes = static_cast<const uint8_t *>(value);
+  prefs_store()[ns_][key].assign(bytes, bytes + len);
+  return len;
+}
+
+bool Preferences::get_raw(const char *key, void *out, size_t len) {
+  if (!open_) return false;
+  const PrefsNamespace &ns = prefs_store()[ns_];
+  const auto it = ns.find(key);
+  if (it == ns.end() || it->second.size() != len) return false;
+  memcpy(out, it->second.data(), len);
+  return true;
+}
+
+bool Preferences::getBool(const char *key, bool fallback) {
+  uint8_t value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value != 0 : fallback;
+}
+
+char Preferences::getChar(const char *key, char fallback) {
+  char value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value : fallback;
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t fallback) {
+  uint8_t value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value : fallback;
+}
+
+uint16_t Preferences::getUShort(const char *key, uint16_t fallback) {
+  uint16_t value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value : fallback;
+}
+
+int32_t Preferences::getInt(const char *key, int32_t fallback) {
+  int32_t value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value : fallback;
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t fallback) {
+  uint32_t value = 0;
+  return get_raw(key, &value, sizeof(value)) ? value : fallback;
+}
+
+String Preferences::getString(const char *key, const String &fallback) {
+  if (!open_) return fallback;
+  const PrefsNamespace &ns = prefs_store()[ns_];
+  const auto it = ns.find(key);
+  if (it == ns.end()) return fallback;
+  return String(std::string(it->second.begin(), it->second.end()));
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!open_) return 0;
+  const PrefsNamespace &ns = prefs_store()[ns_];
+  const auto it = ns.find(key);
+  return it == ns.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char *key, void *out, size_t maxLen) {
+  const size_t len = getBytesLength(key);
+  if (len == 0 || len > maxLen) return 0;
+  memcpy(out, prefs_store()[ns_][key].data(), len);
+  return len;
+}
+
+size_t Preferences::putBool(const char *key, bool value) {
+  const uint8_t raw = value ? 1 : 0;
+  return put_raw(key, &raw, sizeof(raw));
+}
+
+size_t Preferences::putChar(const char *key, char value) {
+  return put_raw(key, &value, sizeof(value));
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+  return put_raw(key, &value, sizeof(value));
+}
+
+size_t Preferences::putUShort(const char *key, uint16_t value) {
+  return put_raw(key, &value, sizeof(value));
+}
+
+size_t Preferences::putInt(const char *key, int32_t value) {
+  return put_raw(key, &value, sizeof(value));
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+  return put_raw(key, &value, sizeof(value));
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+  return put_raw(key, value ? value : "", value ? strlen(value) : 0);
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  return put_raw(key, value, len);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, uint32_t stackBytes, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *outHandle, BaseType_t core) {
+  (void)entry;
+  (void)name;
+  (void)stackBytes;
+  (void)arg;
+  (void)priority;
+  (void)core;
+  if (outHandle) *outHandle = nullptr;
+  return pdFAIL;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return &gTaskHandle;
+}
+
+TickType_t xTaskGetTickCount() {
+  return sim::now_ms();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  sim::advance_ms(ticks);
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period) {
+  const TickType_t wakeAt = *previousWake + period;
+  const TickType_t now = sim::now_ms();
+  if (static_cast<int32_t>(wakeAt - now) > 0) sim::advance_ms(wakeAt - now);
+  *previousWake = wakeAt;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  if (gPendingNotifications == 0) {
+    sim::advance_ms(ticksToWait);
+    return 0;
+  }
+  const uint32_t taken = gPendingNotifications;
+  gPendingNotifications = clearOnExit ? 0 : taken - 1;
+  return taken;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  if (task == &gTaskHandle) {
+    ++gPendingNotifications;
+  }
+}
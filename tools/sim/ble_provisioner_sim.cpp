@@ -0,0 +1,51 @@
+// BLE provisioning has no radio in the simulator: the provisioner advertises
+// nothing and never receives credentials, so the device runs on the bootstrap
+// WiFi credentials device_sim passes in.
+
+#include "ble/ble_provisioner.h"
+
+#include "core/logging.h"
+
+namespace ble {
+
+BleProvisioner *BleProvisioner::sInstance_ = nullptr;
+
+void BleProvisioner::begin(const char *bleName, const char *deviceId) {
+  sInstance_ = this;
+  initialized_ = true;
+  advertising_ = true;
+  DCTRL_LOGI("BLE", "Sim advertising name=%s deviceId=%s",
+             core::logging::safe_str(bleName),
+             core::logging::safe_str(deviceId));
+}
+
+void BleProvisioner::stop() { advertising_ = false; }
+
+void BleProvisioner::notify_status(const char *statusJson) { (void)statusJson; }
+
+void BleProvisioner::notify_scan_results(const char *json) { (void)json; }
+
+void BleProvisioner::set_credentials_callback(OnCredentials cb, void *ctx) {
+  credCb_ = cb;
+  credCbCtx_ = ctx;
+}
+
+void BleProvisioner::set_scan_callback(OnScanRequest cb, void *ctx) {
+  scanCb_ = cb;
+  scanCbCtx_ = ctx;
+}
+
+bool BleProvisioner::credentials_pending() { return credPending_; }
+
+BleCredentials BleProvisioner::take_credentials() {
+  BleCredentials out = pendingCreds_;
+  credPending_ = false;
+  return out;
+}
+
+void BleProvisioner::handle_write(const uint8_t *data, size_t len) {
+  (void)data;
+  (void)len;
+}
+
+}  // namespace ble
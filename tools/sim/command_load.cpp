@@ -0,0 +1,376 @@
+// Offers recorded MQTT commands to the firmware's DeviceController in the
+// simulator and reports what the command path costs: host time per
+// handle_command(), heap allocations made while handling, the renders the
+// commands turned into and the commands that never reached the firmware.
+//
+// Without --rate the trace replays on its own timeline, link events included.
+// With --rate the commands alone are re-timed to arrive evenly at N per
+// second from the moment the MQTT session is up; --repeat offers the trace's
+// commands N times over. Arrivals queue at the simulated broker (bounded by
+// --queue) and the device takes in one socket read per network poll, so a
+// rate the loop cannot keep up with shows as delivery lag and then drops.
+//
+//   command_load [--rate N] [--repeat N] [--queue N] [--cols N] [--rows N]
+//                [--tail-ms N] [--verbose] <trace>
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <vector>
+
+#include "core/config_store.h"
+#include "core/device_controller.h"
+#include "core/display_engine.h"
+#include "core/layout_engine.h"
+#include "core/logging.h"
+#include "core/mqtt_client.h"
+#include "core/network_manager.h"
+#include "core/profiler.h"
+#include "sim_device.h"
+#include "sim_runtime.h"
+#include "trace.h"
+
+namespace {
+
+// mosquitto's default max_queued_messages per client.
+constexpr size_t kDefaultQueueLimit = 1000;
+constexpr uint32_t kDefaultTailMs = 1000;
+// How long rate mode waits for the first MQTT session before giving up.
+constexpr uint32_t kConnectTimeoutMs = 60000;
+
+// Every operator new in the process lands here; the delivery hooks diff the
+// totals around each command.
+uint64_t gAllocCount = 0;
+uint64_t gAllocBytes = 0;
+
+struct Options {
+  double rate = 0;  // commands per second; 0 replays the trace timeline
+  uint32_t repeat = 1;
+  size_t queueLimit = kDefaultQueueLimit;
+  uint8_t panelCols = 2;
+  uint8_t panelRows = 1;
+  uint32_t tailMs = kDefaultTailMs;
+  bool verbose = false;
+  const char *tracePath = nullptr;
+};
+
+struct Arrival {
+  uint64_t atUs;
+  const sim::TraceEvent *event;
+};
+
+struct Delivery {
+  uint32_t handleNs;
+  uint32_t lagUs;  // broker arrival to handoff
+  uint32_t allocs;
+  uint32_t allocBytes;
+};
+
+struct LoadState {
+  std::chrono::steady_clock::time_point startedAt;
+  uint64_t allocCountAtStart = 0;
+  uint64_t allocBytesAtStart = 0;
+  std::vector<Delivery> deliveries;
+};
+
+bool parse_options(int argc, char **argv, Options &opts) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--rate") == 0 && hasValue) {
+      opts.rate = strtod(argv[++i], nullptr);
+      if (opts.rate <= 0) return false;
+    } else if (strcmp(arg, "--repeat") == 0 && hasValue) {
+      opts.repeat = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--queue") == 0 && hasValue) {
+      opts.queueLimit = static_cast<size_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--cols") == 0 && hasValue) {
+      opts.panelCols = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--rows") == 0 && hasValue) {
+      opts.panelRows = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--tail-ms") == 0 && hasValue) {
+      opts.tailMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--verbose") == 0) {
+      opts.verbose = true;
+    } else if (arg[0] != '-' && !opts.tracePath) {
+      opts.tracePath = arg;
+    } else {
+      return false;
+    }
+  }
+  return opts.tracePath != nullptr && opts.repeat > 0 && opts.panelCols > 0 && opts.panelRows > 0;
+}
+
+// Trace timeline from startUs, once per repeat; each pass starts 1 ms after
+// the previous one's last event.
+void schedule_replay(const std::vector<sim::TraceEvent> &events,
+                     uint32_t repeat,
+                     uint64_t startUs,
+                     std::vector<Arrival> &out) {
+  const uint64_t passUs = (events.back().atMs + 1ULL) * 1000U;
+  for (uint32_t pass = 0; pass < repeat; ++pass) {
+    for (const sim::TraceEvent &event : events) {
+      out.push_back({startUs + pass * passUs + event.atMs * 1000ULL, &event});
+    }
+  }
+}
+
+// Commands only, evenly spaced at rate per second.
+void schedule_rate(const std::vector<sim::TraceEvent> &events,
+                   uint32_t repeat,
+                   double rate,
+                   uint64_t startUs,
+                   std::vector<Arrival> &out) {
+  uint64_t index = 0;
+  for (uint32_t pass = 0; pass < repeat; ++pass) {
+    for (const sim::TraceEvent &event : events) {
+      if (event.kind != sim::TraceEventKind::kCommand) continue;
+      out.push_back({startUs + static_cast<uint64_t>(index * 1e6 / rate), &event});
+      ++index;
+    }
+  }
+}
+
+void before_delivery(const sim::Command &command, void *ctx) {
+  (void)command;
+  LoadState &state = *static_cast<LoadState *>(ctx);
+  state.allocCountAtStart = gAllocCount;
+  state.allocBytesAtStart = gAllocBytes;
+  state.startedAt = std::chrono::steady_clock::now();
+}
+
+void after_delivery(const sim::Command &command, void *ctx) {
+  LoadState &state = *static_cast<LoadState *>(ctx);
+  const auto elapsed = std::chrono::steady_clock::now() - state.startedAt;
+  Delivery delivery{};
+  delivery.handleNs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  delivery.lagUs = static_cast<uint32_t>(sim::now_us() - command.queuedAtUs);
+  delivery.allocs = static_cast<uint32_t>(gAllocCount - state.allocCountAtStart);
+  delivery.allocBytes = static_cast<uint32_t>(gAllocBytes - state.allocBytesAtStart);
+  state.deliveries.push_back(delivery);
+}
+
+template <typename T>
+T percentile(const std::vector<T> &sorted, double pct) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * pct / 100.0))];
+}
+
+template <typename T>
+void print_percentiles(const char *label, std::vector<T> values, double scale) {
+  std::sort(values.begin(), values.end());
+  printf("%-14s p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+         label,
+         percentile(values, 50) / scale,
+         percentile(values, 90) / scale,
+         percentile(values, 99) / scale,
+         percentile(values, 99.9) / scale,
+         values.empty() ? 0.0 : values.back() / scale);
+}
+
+uint32_t profiled_count(core::ProfileSection section) {
+  return core::profiler::stats(section).count;
+}
+
+}  // namespace
+
+void *operator new(size_t size) {
+  ++gAllocCount;
+  gAllocBytes += size;
+  if (void *p = malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (!parse_options(argc, argv, opts)) {
+    fprintf(stderr,
+            "usage: %s [--rate N] [--repeat N] [--queue N] [--cols N] [--rows N] [--tail-ms N] [--verbose] <trace>\n",
+            argv[0]);
+    return 2;
+  }
+
+  std::vector<sim::TraceEvent> events;
+  char err[128];
+  if (!sim::load_trace(opts.tracePath, events, err, sizeof(err))) {
+    fprintf(stderr, "%s: %s\n", opts.tracePath, err);
+    return 1;
+  }
+  if (events.empty()) {
+    fprintf(stderr, "%s: no events\n", opts.tracePath);
+    return 1;
+  }
+
+  LoadState state;
+  sim::set_serial_echo(opts.verbose);
+  sim::set_command_queue_limit(opts.queueLimit);
+  sim::set_delivery_hooks(&before_delivery, &after_delivery, &state);
+
+  Serial.begin(115200);
+  delay(200);
+  randomSeed(esp_random());
+
+  const core::DeviceRuntimeConfig cfg = sim::bootstrap_config(opts.panelCols, opts.panelRows, false);
+  core::MqttTopics topics{};
+  core::MqttClient::build_default_topics(cfg.deviceId, topics);
+
+  core::ConfigStore configStore;
+  core::NetworkManager networkManager;
+  core::MqttClient mqttClient;
+  core::DisplayEngine displayEngine;
+  core::LayoutEngine layoutEngine;
+  core::DeviceController controller(
+      core::DeviceController::Dependencies{&configStore, &networkManager, &mqttClient, &displayEngine, &layoutEngine});
+
+  configStore.set_bootstrap_config(cfg);
+  const bool started = controller.begin();
+  core::logging::flush();
+  if (!started) {
+    fprintf(stderr, "controller init failed\n");
+    return 1;
+  }
+
+  std::vector<Arrival> schedule;
+  if (opts.rate > 0) {
+    while (!mqttClient.connected() && millis() < kConnectTimeoutMs && !sim::restart_requested()) {
+      controller.tick(millis());
+      core::logging::flush();
+      controller.wait_for_next_deadline();
+    }
+    if (!mqttClient.connected()) {
+      fprintf(stderr, "no MQTT session after %lu ms\n", static_cast<unsigned long>(millis()));
+      return 1;
+    }
+    schedule_rate(events, opts.repeat, opts.rate, sim::now_us(), schedule);
+  } else {
+    schedule_replay(events, opts.repeat, 0, schedule);
+  }
+  if (schedule.empty()) {
+    fprintf(stderr, "%s: no commands\n", opts.tracePath);
+    return 1;
+  }
+
+  // Renders before the first arrival are boot screens, not load.
+  const core::ProfileSection kRenderSections[] = {core::ProfileSection::kRenderFull,
+                                                  core::ProfileSection::kRenderMinimal,
+                                                  core::ProfileSection::kRenderEta,
+                                                  core::ProfileSection::kRenderScroll};
+  uint32_t rendersAtStart[4] = {};
+  bool loadStarted = false;
+
+  uint32_t offered = 0;
+  uint64_t offeredBytes = 0;
+  size_t maxQueued = 0;
+  size_t next = 0;
+  const uint64_t firstArrivalUs = schedule.front().atUs;
+  const uint64_t lastArrivalUs = schedule.back().atUs;
+  const uint64_t endUs = lastArrivalUs + opts.tailMs * 1000ULL;
+  while (!sim::restart_requested()) {
+    const uint64_t nowUs = sim::now_us();
+    if (!loadStarted && nowUs >= firstArrivalUs) {
+      for (size_t i = 0; i < 4; ++i) rendersAtStart[i] = profiled_count(kRenderSections[i]);
+      loadStarted = true;
+    }
+    for (; next < schedule.size() && schedule[next].atUs <= nowUs; ++next) {
+      const sim::TraceEvent &event = *schedule[next].event;
+      if (event.kind != sim::TraceEventKind::kCommand) {
+        sim::apply_event(event, topics.command);
+        continue;
+      }
+      ++offered;
+      offeredBytes += event.payload.size();
+      // Stamped with the scheduled arrival: the device only looks between
+      // sleeps, and that wait is part of the lag being measured.
+      sim::push_command({event.topic.empty() ? topics.command : event.topic, event.payload, schedule[next].atUs});
+    }
+    maxQueued = std::max(maxQueued, sim::pending_commands());
+    if (next == schedule.size() && nowUs >= endUs && (sim::pending_commands() == 0 || !mqttClient.connected())) {
+      break;
+    }
+
+    controller.tick(millis());
+    core::logging::flush();
+    controller.wait_for_next_deadline();
+  }
+
+  const std::vector<Delivery> &deliveries = state.deliveries;
+  std::vector<uint32_t> handleNs;
+  std::vector<uint32_t> lagUs;
+  uint64_t totalHandleNs = 0;
+  uint64_t allocs = 0;
+  uint64_t allocBytes = 0;
+  uint32_t allocatingCommands = 0;
+  for (const Delivery &delivery : deliveries) {
+    handleNs.push_back(delivery.handleNs);
+    lagUs.push_back(delivery.lagUs);
+    totalHandleNs += delivery.handleNs;
+    allocs += delivery.allocs;
+    allocBytes += delivery.allocBytes;
+    allocatingCommands += delivery.allocs > 0 ? 1 : 0;
+  }
+  uint32_t renders[4];
+  uint32_t totalRenders = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    renders[i] = profiled_count(kRenderSections[i]) - rendersAtStart[i];
+    totalRenders += renders[i];
+  }
+
+  const double spanSec = (lastArrivalUs - firstArrivalUs) / 1e6;
+  const double elapsedSec = (sim::now_us() - firstArrivalUs) / 1e6;
+  const size_t count = deliveries.size();
+  printf("trace          %s (%zu events, repeat %lu)\n",
+         opts.tracePath,
+         events.size(),
+         static_cast<unsigned long>(opts.repeat));
+  if (opts.rate > 0) {
+    printf("offered        %lu cmds, %llu bytes at %.1f/s over %.3f s\n",
+           static_cast<unsigned long>(offered),
+           static_cast<unsigned long long>(offeredBytes),
+           opts.rate,
+           spanSec);
+  } else {
+    printf("offered        %lu cmds, %llu bytes on the trace timeline over %.3f s\n",
+           static_cast<unsigned long>(offered),
+           static_cast<unsigned long long>(offeredBytes),
+           spanSec);
+  }
+  printf("delivered      %zu (%.2f/s)  dropped %lu (queue %lu)  oversize %lu  undelivered %zu  max queued %zu\n",
+         count,
+         elapsedSec > 0 ? count / elapsedSec : 0.0,
+         static_cast<unsigned long>(sim::dropped_commands()),
+         static_cast<unsigned long>(opts.queueLimit),
+         static_cast<unsigned long>(sim::oversize_discards()),
+         sim::pending_commands(),
+         maxQueued);
+  print_percentiles("handle us", handleNs, 1000.0);
+  print_percentiles("lag ms", lagUs, 1000.0);
+  printf("handle total   %.3f ms host (%.2f%% of the offered span)\n",
+         totalHandleNs / 1e6,
+         spanSec > 0 ? totalHandleNs / 1e7 / spanSec : 0.0);
+  printf("heap           %llu allocs, %llu bytes in %lu of %zu commands (%.1f bytes/cmd)\n",
+         static_cast<unsigned long long>(allocs),
+         static_cast<unsigned long long>(allocBytes),
+         static_cast<unsigned long>(allocatingCommands),
+         count,
+         count > 0 ? static_cast<double>(allocBytes) / count : 0.0);
+  printf("renders        full %lu  minimal %lu  eta %lu  scroll %lu  (%.2f non-scroll per cmd)\n",
+         static_cast<unsigned long>(renders[0]),
+         static_cast<unsigned long>(renders[1]),
+         static_cast<unsigned long>(renders[2]),
+         static_cast<unsigned long>(renders[3]),
+         count > 0 ? static_cast<double>(totalRenders - renders[3]) / count : 0.0);
+  printf("publish queue  dropped %lu\n", static_cast<unsigned long>(mqttClient.publish_queue().dropped()));
+  return 0;
+}
@@ -0,0 +1,245 @@
+// Runs the firmware's DeviceController on the host against a recorded MQTT
+// trace. Time is virtual: the controller's waits advance the clock instead of
+// sleeping, so an hour of traffic replays in seconds and every run of the same
+// trace makes the same decisions. Host time is only measured around tick().
+//
+// --capture and --apng record every frame presented between --from-ms and
+// --until-ms (see frame_capture.h); --until-ms also ends the run there. The
+// files are written from inside present(), so host tick times are not
+// meaningful while capturing.
+//
+//   device_sim [--cols N] [--rows N] [--double-buffered] [--tail-ms N] [--verbose]
+//              [--capture <dir>] [--apng <path>] [--apng-scale N] [--from-ms N] [--until-ms N] <trace>
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/config_store.h"
+#include "core/device_controller.h"
+#include "core/display_engine.h"
+#include "core/layout_engine.h"
+#include "core/logging.h"
+#include "core/mqtt_client.h"
+#include "core/network_manager.h"
+#include "core/profiler.h"
+#include "frame_capture.h"
+#include "sim_device.h"
+#include "sim_display.h"
+#include "sim_runtime.h"
+#include "trace.h"
+
+namespace {
+
+constexpr uint32_t kDefaultTailMs = 5000;
+constexpr size_t kProfileSummaryLen = 1024;
+
+struct Options {
+  uint8_t panelCols = 2;
+  uint8_t panelRows = 1;
+  bool doubleBuffered = false;
+  uint32_t tailMs = kDefaultTailMs;
+  bool verbose = false;
+  const char *tracePath = nullptr;
+  sim::CaptureOptions capture;
+};
+
+struct PublishTotals {
+  uint32_t count = 0;
+  uint64_t bytes = 0;
+};
+
+// Keyed by the last topic segment (state, presence, event, ...).
+std::map<std::string, PublishTotals> gPublishes;
+
+void on_publish(const char *topic, const uint8_t *payload, size_t len, bool retained, void *ctx) {
+  (void)payload;
+  (void)retained;
+  (void)ctx;
+  const char *slash = strrchr(topic, '/');
+  PublishTotals &totals = gPublishes[slash ? slash + 1 : topic];
+  ++totals.count;
+  totals.bytes += len;
+}
+
+bool parse_options(int argc, char **argv, Options &opts) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--cols") == 0 && hasValue) {
+      opts.panelCols = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--rows") == 0 && hasValue) {
+      opts.panelRows = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--tail-ms") == 0 && hasValue) {
+      opts.tailMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--capture") == 0 && hasValue) {
+      opts.capture.dir = argv[++i];
+    } else if (strcmp(arg, "--apng") == 0 && hasValue) {
+      opts.capture.apngPath = argv[++i];
+    } else if (strcmp(arg, "--apng-scale") == 0 && hasValue) {
+      opts.capture.apngScale = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--from-ms") == 0 && hasValue) {
+      opts.capture.fromMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--until-ms") == 0 && hasValue) {
+      opts.capture.untilMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--double-buffered") == 0) {
+      opts.doubleBuffered = true;
+    } else if (strcmp(arg, "--verbose") == 0) {
+      opts.verbose = true;
+    } else if (arg[0] != '-' && !opts.tracePath) {
+      opts.tracePath = arg;
+    } else {
+      return false;
+    }
+  }
+  return opts.tracePath != nullptr && opts.panelCols > 0 && opts.panelRows > 0 && opts.capture.apngScale > 0;
+}
+
+uint32_t percentile(const std::vector<uint32_t> &sorted, uint32_t pct) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, sorted.size() * pct / 100)];
+}
+
+uint32_t profiled_count(core::ProfileSection section) {
+  return core::profiler::stats(section).count;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (!parse_options(argc, argv, opts)) {
+    fprintf(stderr,
+            "usage: %s [--cols N] [--rows N] [--double-buffered] [--tail-ms N] [--verbose]\n"
+            "       [--capture <dir>] [--apng <path>] [--apng-scale N] [--from-ms N] [--until-ms N] <trace>\n",
+            argv[0]);
+    return 2;
+  }
+
+  std::vector<sim::TraceEvent> events;
+  char err[128];
+  if (!sim::load_trace(opts.tracePath, events, err, sizeof(err))) {
+    fprintf(stderr, "%s: %s\n", opts.tracePath, err);
+    return 1;
+  }
+
+  sim::set_serial_echo(opts.verbose);
+  sim::set_publish_sink(&on_publish, nullptr);
+
+  Serial.begin(115200);
+  delay(200);
+  randomSeed(esp_random());
+
+  const core::DeviceRuntimeConfig cfg = sim::bootstrap_config(opts.panelCols, opts.panelRows, opts.doubleBuffered);
+  core::MqttTopics topics{};
+  core::MqttClient::build_default_topics(cfg.deviceId, topics);
+
+  core::ConfigStore configStore;
+  core::NetworkManager networkManager;
+  core::MqttClient mqttClient;
+  core::DisplayEngine displayEngine;
+  core::LayoutEngine layoutEngine;
+  core::DeviceController controller(
+      core::DeviceController::Dependencies{&configStore, &networkManager, &mqttClient, &displayEngine, &layoutEngine});
+
+  const bool capturing = opts.capture.dir || opts.capture.apngPath;
+  sim::FrameCapture capture;
+  if (capturing && !capture.begin(opts.capture, displayEngine)) {
+    fprintf(stderr, "cannot write capture to %s\n", opts.capture.dir);
+    return 1;
+  }
+
+  configStore.set_bootstrap_config(cfg);
+  const bool started = controller.begin();
+  core::logging::flush();
+  if (!started) {
+    fprintf(stderr, "controller init failed\n");
+    return 1;
+  }
+
+  const uint32_t lastEventMs = events.empty() ? static_cast<uint32_t>(millis()) : events.back().atMs;
+  const uint32_t endMs = std::min(lastEventMs + opts.tailMs, opts.capture.untilMs);
+  std::vector<uint32_t> tickNs;
+  uint32_t commands = 0;
+  size_t next = 0;
+  while (!sim::restart_requested()) {
+    const uint32_t nowMs = millis();
+    for (; next < events.size() && events[next].atMs <= nowMs; ++next) {
+      commands += events[next].kind == sim::TraceEventKind::kCommand ? 1 : 0;
+      sim::apply_event(events[next], topics.command);
+    }
+    if ((next == events.size() || nowMs >= opts.capture.untilMs) && nowMs >= endMs) break;
+
+    const auto startedAt = std::chrono::steady_clock::now();
+    controller.tick(nowMs);
+    const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+    tickNs.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+
+    // Draining the log ring is the idle task's job on the device; keep it out
+    // of the measured tick.
+    core::logging::flush();
+    controller.wait_for_next_deadline();
+  }
+
+  const bool captured = capturing && capture.finish(millis());
+  if (capturing && !captured) {
+    fprintf(stderr, "capture output incomplete\n");
+  }
+
+  uint64_t totalNs = 0;
+  for (uint32_t ns : tickNs) totalNs += ns;
+  std::vector<uint32_t> sorted(tickNs);
+  std::sort(sorted.begin(), sorted.end());
+  const double virtualSec = millis() / 1000.0;
+  const sim::DisplayCounters &display = sim::display_counters();
+
+  printf("trace          %s (%zu events, %lu commands, %zu undelivered)\n",
+         opts.tracePath,
+         events.size(),
+         static_cast<unsigned long>(commands),
+         sim::pending_commands());
+  printf("virtual time   %.3f s%s\n", virtualSec, sim::restart_requested() ? " (stopped by restart)" : "");
+  printf("loop ticks     %zu (%.1f per virtual s)\n", tickNs.size(), virtualSec > 0 ? tickNs.size() / virtualSec : 0.0);
+  printf("tick host us   avg %.2f  p50 %.2f  p99 %.2f  max %.2f\n",
+         tickNs.empty() ? 0.0 : totalNs / 1000.0 / tickNs.size(),
+         percentile(sorted, 50) / 1000.0,
+         percentile(sorted, 99) / 1000.0,
+         sorted.empty() ? 0.0 : sorted.back() / 1000.0);
+  printf("renders        full %lu  minimal %lu  eta %lu  scroll %lu\n",
+         static_cast<unsigned long>(profiled_count(core::ProfileSection::kRenderFull)),
+         static_cast<unsigned long>(profiled_count(core::ProfileSection::kRenderMinimal)),
+         static_cast<unsigned long>(profiled_count(core::ProfileSection::kRenderEta)),
+         static_cast<unsigned long>(profiled_count(core::ProfileSection::kRenderScroll)));
+  printf("pixels         writes %llu  changed %llu  presents %lu\n",
+         static_cast<unsigned long long>(display.pixelWrites),
+         static_cast<unsigned long long>(display.pixelChanges),
+         static_cast<unsigned long>(display.presents));
+  for (const auto &entry : gPublishes) {
+    printf("publish        %-10s %5lu msgs %8llu bytes\n",
+           entry.first.c_str(),
+           static_cast<unsigned long>(entry.second.count),
+           static_cast<unsigned long long>(entry.second.bytes));
+  }
+
+  if (capturing) {
+    printf("captured       %lu frames:", static_cast<unsigned long>(capture.frames()));
+    for (uint8_t mode = 0; mode < sim::FrameCapture::kModeCount; ++mode) {
+      printf(" %s %lu", sim::FrameCapture::mode_name(mode), static_cast<unsigned long>(capture.mode_frames(mode)));
+    }
+    printf("  unchanged %lu\n", static_cast<unsigned long>(capture.unchanged_frames()));
+  }
+
+  char summary[kProfileSummaryLen];
+  if (core::profiler::format_summary(summary, sizeof(summary)) > 0) {
+    printf("profile        %s\n", summary);
+  }
+  return capturing && !captured ? 1 : 0;
+}
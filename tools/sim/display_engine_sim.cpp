@@ -0,0 +1,452 @@
+// Software DisplayEngine for the host simulator. Draw calls land in an RGB565
+// framebuffer instead of a HUB75 DMA buffer; dirty tracking, the dark-row
+// skip for black fills and FrameStats follow core/display_engine.cpp so the
+// controller sees the same costs it would on the panel.
+
+#include "core/display_engine.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "core/logging.h"
+#include "display/font_tables.h"
+#include "sim_display.h"
+
+namespace sim {
+
+namespace {
+
+std::vector<uint16_t> gCanvas;
+std::vector<uint16_t> gPresented;
+uint16_t gWidth = 0;
+uint16_t gHeight = 0;
+DisplayCounters gCounters{};
+PresentHook gPresentHook = nullptr;
+void *gPresentCtx = nullptr;
+
+void put_pixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= static_cast<int16_t>(gWidth) || y >= static_cast<int16_t>(gHeight)) {
+    return;
+  }
+  uint16_t &px = gCanvas[static_cast<size_t>(y) * gWidth + static_cast<size_t>(x)];
+  ++gCounters.pixelWrites;
+  if (px != color) {
+    ++gCounters.pixelChanges;
+    px = color;
+  }
+}
+
+void put_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t row = y; row < y + h; ++row) {
+    for (int16_t col = x; col < x + w; ++col) {
+      put_pixel(col, row, color);
+    }
+  }
+}
+
+}  // namespace
+
+const DisplayCounters &display_counters() { return gCounters; }
+
+void set_present_hook(PresentHook hook, void *ctx) {
+  gPresentHook = hook;
+  gPresentCtx = ctx;
+}
+
+const uint16_t *presented_pixels() { return gPresented.empty() ? nullptr : gPresented.data(); }
+
+uint16_t display_width() { return gWidth; }
+
+uint16_t display_height() { return gHeight; }
+
+}  // namespace sim
+
+namespace core {
+
+namespace {
+
+constexpr uint8_t kTextSizeTiny = 0;
+constexpr uint8_t kTextSizeTinyPlus = 255;
+
+void text_box(int16_t x, int16_t y, const char *text, uint8_t size, int16_t &bx, int16_t &by, int16_t &bw,
+              int16_t &bh) {
+  const int16_t len = static_cast<int16_t>(strlen(text));
+  if (size == kTextSizeTiny || size == kTextSizeTinyPlus) {
+    bx = x;
+    by = static_cast<int16_t>(y - 6);
+    bw = static_cast<int16_t>(len * 4 + 2);
+    bh = 8;
+    return;
+  }
+  bx = x;
+  by = y;
+  bw = static_cast<int16_t>(len * 6 * size);
+  bh = static_cast<int16_t>(8 * size);
+}
+
+// Adafruit_GFX text output: classic glyphs fill their 6x8 cell when opaque,
+// TomThumb glyphs hang off the baseline and are always transparent.
+void draw_glyph_run(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size, bool opaque, uint16_t bg) {
+  int16_t cursorX = x;
+  for (const char *p = text; *p; ++p) {
+    const uint8_t slot = display::font_glyph_slot(*p);
+    if (display::font_is_tiny(size)) {
+      if (slot != display::kNoGlyph) {
+        const display::FontGlyph &g = display::kTinyFontGlyphs[slot];
+        const uint8_t passes = size == kTextSizeTinyPlus ? 2 : 1;
+        for (uint8_t pass = 0; pass < passes; ++pass) {
+          for (uint8_t row = 0; row < g.height; ++row) {
+            for (uint8_t col = 0; col < g.width; ++col) {
+              if (display::tiny_glyph_pixel(slot, col, row)) {
+                sim::put_pixel(static_cast<int16_t>(cursorX + pass + g.xOffset + col),
+                               static_cast<int16_t>(y + g.yOffset + row),
+                               color);
+              }
+            }
+          }
+        }
+      }
+    } else {
+      for (uint8_t row = 0; row < display::kClassicCellH; ++row) {
+        for (uint8_t col = 0; col < display::kClassicCellW; ++col) {
+          const bool on = display::classic_glyph_pixel(slot, col, row);
+          if (on || opaque) {
+            sim::put_rect(static_cast<int16_t>(cursorX + col * size),
+                          static_cast<int16_t>(y + row * size),
+                          size,
+                          size,
+                          on ? color : bg);
+          }
+        }
+      }
+    }
+    cursorX = static_cast<int16_t>(cursorX + display::font_advance(*p, size));
+  }
+}
+
+}  // namespace
+
+DisplayEngine::DisplayEngine()
+    : config_{1, 2, 64, 32, 255, false, true, 0, 0, 0, 0, 0, 0, 4, false},
+      geometry_{128, 32},
+      ready_(false),
+      matrix_(nullptr),
+      virtualMatrix_(nullptr),
+      canvas_(nullptr),
+      shadow_(nullptr),
+      dirty_(),
+      previousDirty_(),
+      litRows_(),
+      stats_{},
+      glyphAtlas_(),
+      classicFontVerified_(true),
+      tinyFontVerified_(true),
+      linearMapper_(),
+      serpentineMapper_(),
+      panelMap_(),
+      mapper_(&linearMapper_),
+      chain_() {}
+
+DisplayEngine::~DisplayEngine() { end(); }
+
+bool DisplayEngine::begin(const DisplayConfig &config) {
+  end();
+
+  DisplayGeometry geom{};
+  if (!compute_geometry(config, geom)) {
+    DCTRL_LOGE("DISPLAY", "Invalid geometry config rows=%u cols=%u panel=%ux%u",
+               static_cast<unsigned>(config.panelRows),
+               static_cast<unsigned>(config.panelCols),
+               static_cast<unsigned>(config.panelWidth),
+               static_cast<unsigned>(config.panelHeight));
+    return false;
+  }
+
+  config_ = config;
+  geometry_ = geom;
+  if (panelMap_.build(config_)) {
+    mapper_ = &panelMap_;
+  } else {
+    mapper_ = config_.serpentine ? static_cast<const IPanelMapper *>(&serpentineMapper_)
+                                 : static_cast<const IPanelMapper *>(&linearMapper_);
+  }
+
+  sim::gWidth = geometry_.totalWidth;
+  sim::gHeight = geometry_.totalHeight;
+  sim::gCanvas.assign(static_cast<size_t>(sim::gWidth) * sim::gHeight, 0);
+  sim::gPresented.clear();
+
+  dirty_.set_bounds(static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight));
+  previousDirty_.set_bounds(static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight));
+  // The simulated shadow canvas never fails to allocate, so partial presents
+  // are always available.
+  litRows_.set_all(false);
+  stats_ = {};
+
+  ready_ = true;
+  DCTRL_LOGI("DISPLAY", "Sim panel ready total=%ux%u panels=%ux%u",
+             geometry_.totalWidth,
+             geometry_.totalHeight,
+             config_.panelCols,
+             config_.panelRows);
+  return true;
+}
+
+void DisplayEngine::end() { ready_ = false; }
+
+bool DisplayEngine::is_ready() const { return ready_; }
+
+const DisplayConfig &DisplayEngine::config() const { return config_; }
+
+const DisplayGeometry &DisplayEngine::geometry() const { return geometry_; }
+
+const IPanelMapper &DisplayEngine::panel_mapper() const { return *mapper_; }
+
+void DisplayEngine::set_brightness(uint8_t brightness) { config_.brightness = brightness; }
+
+void DisplayEngine::set_offsets(int8_t xOffset, int8_t yOffset) {
+  config_.xOffset = xOffset;
+  config_.yOffset = yOffset;
+}
+
+bool DisplayEngine::begin_frame() { return ready_; }
+
+void DisplayEngine::clear(uint16_t color) {
+  if (!ready_) {
+    return;
+  }
+  ++sim::gCounters.clears;
+  sim::put_rect(0, 0, static_cast<int16_t>(geometry_.totalWidth), static_cast<int16_t>(geometry_.totalHeight), color);
+  dirty_.add_all();
+  litRows_.set_all(color != 0);
+}
+
+LogicalPoint DisplayEngine::with_offset(int16_t x, int16_t y) const {
+  return {static_cast<int16_t>(x + config_.xOffset), static_cast<int16_t>(y + config_.yOffset)};
+}
+
+void DisplayEngine::mark_drawn(int16_t x, int16_t y, int16_t w, int16_t h, bool lit) {
+  dirty_.add(x, y, w, h);
+  if (lit) {
+    litRows_.set_range(y, h, true);
+  }
+}
+
+void DisplayEngine::draw_text(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size, uint16_t bg) {
+  if (!ready_ || !text) {
+    return;
+  }
+  ++sim::gCounters.drawTexts;
+  const LogicalPoint p = with_offset(x, y);
+  int16_t bx = 0;
+  int16_t by = 0;
+  int16_t bw = 0;
+  int16_t bh = 0;
+  text_box(p.x, p.y, text, size, bx, by, bw, bh);
+  mark_drawn(bx, by, bw, bh, color != 0 || bg != 0);
+  draw_glyph_run(p.x, p.y, text, color, size, true, bg);
+}
+
+void DisplayEngine::draw_text_transparent(int16_t x, int16_t y, const char *text, uint16_t color, uint8_t size) {
+  if (!ready_ || !text) {
+    return;
+  }
+  ++sim::gCounters.drawTexts;
+  const LogicalPoint p = with_offset(x, y);
+  int16_t bx = 0;
+  int16_t by = 0;
+  int16_t bw = 0;
+  int16_t bh = 0;
+  text_box(p.x, p.y, text, size, bx, by, bw, bh);
+  mark_drawn(bx, by, bw, bh, color != 0);
+  draw_glyph_run(p.x, p.y, text, color, size, false, 0);
+}
+
+void DisplayEngine::build_glyph_atlas() {}
+
+bool DisplayEngine::draw_atlas_text(int16_t, int16_t, const char *, uint16_t, uint8_t, bool, uint16_t) {
+  return false;
+}
+
+void DisplayEngine::draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!ready_ || w <= 0 || h <= 0) {
+    return;
+  }
+  ++sim::gCounters.drawRects;
+  const LogicalPoint p = with_offset(x, y);
+  sim::put_rect(p.x, p.y, w, 1, color);
+  sim::put_rect(p.x, static_cast<int16_t>(p.y + h - 1), w, 1, color);
+  sim::put_rect(p.x, p.y, 1, h, color);
+  sim::put_rect(static_cast<int16_t>(p.x + w - 1), p.y, 1, h, color);
+  mark_drawn(p.x, p.y, w, h, color != 0);
+}
+
+void DisplayEngine::fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!ready_ || w <= 0 || h <= 0) {
+    return;
+  }
+  ++sim::gCounters.fillRects;
+  const LogicalPoint p = with_offset(x, y);
+  if (color != 0) {
+    sim::put_rect(p.x, p.y, w, h, color);
+    mark_drawn(p.x, p.y, w, h, true);
+    return;
+  }
+
+  const int16_t height = static_cast<int16_t>(geometry_.totalHeight);
+  const int16_t rowEnd = static_cast<int16_t>(p.y + h) < height ? static_cast<int16_t>(p.y + h) : height;
+  int16_t runStart = -1;
+  for (int16_t row = p.y < 0 ? 0 : p.y; row <= rowEnd; ++row) {
+    if (row < rowEnd && litRows_.test(row)) {
+      if (runStart < 0) {
+        runStart = row;
+      }
+      continue;
+    }
+    if (runStart >= 0) {
+      sim::put_rect(p.x, runStart, w, static_cast<int16_t>(row - runStart), 0);
+      dirty_.add(p.x, runStart, w, static_cast<int16_t>(row - runStart));
+      runStart = -1;
+    }
+    if (row < rowEnd) {
+      ++stats_.skippedRows;
+    }
+  }
+
+  if (p.x <= 0 && p.x + w >= static_cast<int16_t>(geometry_.totalWidth)) {
+    litRows_.set_range(p.y, h, false);
+  }
+}
+
+void DisplayEngine::draw_pixel(int16_t x, int16_t y, uint16_t color) {
+  if (!ready_) {
+    return;
+  }
+  ++sim::gCounters.drawPixels;
+  const LogicalPoint p = with_offset(x, y);
+  sim::put_pixel(p.x, p.y, color);
+  mark_drawn(p.x, p.y, 1, 1, color != 0);
+}
+
+void DisplayEngine::draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (!ready_ || w <= 0) {
+    return;
+  }
+  ++sim::gCounters.drawHlines;
+  const LogicalPoint p = with_offset(x, y);
+  sim::put_rect(p.x, p.y, w, 1, color);
+  mark_drawn(p.x, p.y, w, 1, color != 0);
+}
+
+void DisplayEngine::draw_bitmap(int16_t x,
+                                int16_t y,
+                                const uint8_t *bits,
+                                int16_t w,
+                                int16_t h,
+                                uint16_t fg,
+                                uint16_t bg) {
+  if (!ready_ || !bits || w <= 0 || h <= 0) {
+    return;
+  }
+  ++sim::gCounters.drawBitmaps;
+  const LogicalPoint p = with_offset(x, y);
+  const int16_t stride = static_cast<int16_t>((w + 7) / 8);
+  for (int16_t row = 0; row < h; ++row) {
+    for (int16_t col = 0; col < w; ++col) {
+      const bool on = (bits[row * stride + col / 8] & (0x80U >> (col & 7))) != 0;
+      sim::put_pixel(static_cast<int16_t>(p.x + col), static_cast<int16_t>(p.y + row), on ? fg : bg);
+    }
+  }
+  mark_drawn(p.x, p.y, w, h, fg != 0 || bg != 0);
+}
+
+display::TextMetrics DisplayEngine::measure_text(const char *text, uint8_t size) {
+  if (!ready_ || !text) {
+    return display::TextMetrics{};
+  }
+  return display::font_measure_text(text, size);
+}
+
+bool DisplayEngine::render_scroll_strip(const char *text,
+                                        uint8_t size,
+                                        int16_t charAdvance,
+                                        int16_t spaceAdvance,
+                                        display::ScrollStrip &out) {
+  out.invalidate();
+  if (!text || size == kTextSizeTiny || size == kTextSizeTinyPlus || charAdvance <= 0 || spaceAdvance <= 0) {
+    return false;
+  }
+
+  int32_t width = 0;
+  for (const char *p = text; *p; ++p) {
+    width += (*p == ' ') ? spaceAdvance : charAdvance;
+  }
+  if (width > display::ScrollStrip::kMaxWidthPx ||
+      !out.reset(static_cast<int16_t>(width), static_cast<int16_t>(8 * size))) {
+    return false;
+  }
+
+  int16_t cx = 0;
+  for (const char *p = text; *p; ++p) {
+    if (*p == ' ') {
+      cx = static_cast<int16_t>(cx + spaceAdvance);
+      continue;
+    }
+    const uint8_t slot = display::font_glyph_slot(*p);
+    for (uint8_t row = 0; row < display::kClassicCellH; ++row) {
+      for (uint8_t col = 0; col < display::kClassicCellW; ++col) {
+        if (!display::classic_glyph_pixel(slot, col, row)) {
+          continue;
+        }
+        for (uint8_t yy = 0; yy < size; ++yy) {
+          for (uint8_t xx = 0; xx < size; ++xx) {
+            out.set_pixel(static_cast<int16_t>(cx + col * size + xx), static_cast<int16_t>(row * size + yy));
+          }
+        }
+      }
+    }
+    cx = static_cast<int16_t>(cx + charAdvance);
+  }
+  return true;
+}
+
+bool DisplayEngine::present() {
+  if (!ready_) {
+    return false;
+  }
+
+  const uint32_t dirtyArea = dirty_.area();
+  ++stats_.frames;
+  stats_.dirtyPixels += dirtyArea;
+  stats_.lastDirtyPixels = dirtyArea;
+
+  if (config_.doubleBuffered) {
+    display::DirtyRegion pending = dirty_;
+    pending.add_region(previousDirty_);
+    stats_.copiedPixels += pending.area();
+    previousDirty_ = dirty_;
+  }
+  dirty_.clear();
+
+  sim::gPresented = sim::gCanvas;
+  ++sim::gCounters.presents;
+  if (sim::gPresentHook) {
+    sim::gPresentHook(sim::gPresentCtx);
+  }
+  return true;
+}
+
+bool DisplayEngine::partial_present() const { return true; }
+
+const FrameStats &DisplayEngine::frame_stats() const { return stats_; }
+
+void DisplayEngine::reset_frame_stats() { stats_ = {}; }
+
+void DisplayEngine::copy_to_matrix(const display::DirtyRect &) {}
+
+uint16_t DisplayEngine::color565(uint8_t r, uint8_t g, uint8_t b) const {
+  return static_cast<uint16_t>(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+}  // namespace core
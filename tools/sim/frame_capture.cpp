@@ -0,0 +1,192 @@
+#include "frame_capture.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "core/profiler.h"
+#include "sim_runtime.h"
+
+namespace sim {
+
+namespace {
+
+// Indexed like the mode column; other (no render section) comes last.
+constexpr core::ProfileSection kRenderSections[] = {
+    core::ProfileSection::kRenderFull,
+    core::ProfileSection::kRenderMinimal,
+    core::ProfileSection::kRenderEta,
+    core::ProfileSection::kRenderScroll,
+};
+constexpr uint8_t kModeOther = 4;
+
+bool write_ppm(const std::string &path, const uint16_t *pixels, uint16_t width, uint16_t height) {
+  FILE *out = fopen(path.c_str(), "wb");
+  if (!out) return false;
+  fprintf(out, "P6\n%u %u\n255\n", width, height);
+  for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+    const uint16_t color = pixels[i];
+    const uint8_t rgb[3] = {
+        static_cast<uint8_t>(((color >> 11) & 0x1F) * 255 / 31),
+        static_cast<uint8_t>(((color >> 5) & 0x3F) * 255 / 63),
+        static_cast<uint8_t>((color & 0x1F) * 255 / 31),
+    };
+    fwrite(rgb, 1, sizeof(rgb), out);
+  }
+  return fclose(out) == 0;
+}
+
+DisplayCounters counters_since(const DisplayCounters &now, const DisplayCounters &then) {
+  DisplayCounters delta{};
+  delta.pixelWrites = now.pixelWrites - then.pixelWrites;
+  delta.pixelChanges = now.pixelChanges - then.pixelChanges;
+  delta.presents = now.presents - then.presents;
+  delta.clears = now.clears - then.clears;
+  delta.fillRects = now.fillRects - then.fillRects;
+  delta.drawPixels = now.drawPixels - then.drawPixels;
+  delta.drawHlines = now.drawHlines - then.drawHlines;
+  delta.drawTexts = now.drawTexts - then.drawTexts;
+  delta.drawBitmaps = now.drawBitmaps - then.drawBitmaps;
+  delta.drawRects = now.drawRects - then.drawRects;
+  return delta;
+}
+
+}  // namespace
+
+FrameCapture::FrameCapture()
+    : options_(),
+      engine_(nullptr),
+      csv_(nullptr),
+      apng_(),
+      apngOpen_(false),
+      ok_(true),
+      lastCounters_{},
+      lastRenderCounts_{},
+      hasPending_(false),
+      pending_{},
+      frames_(0),
+      unchangedFrames_(0),
+      modeFrames_{} {}
+
+FrameCapture::~FrameCapture() {
+  set_present_hook(nullptr, nullptr);
+  if (csv_) fclose(csv_);
+}
+
+bool FrameCapture::begin(const CaptureOptions &options, const core::DisplayEngine &engine) {
+  options_ = options;
+  engine_ = &engine;
+  if (options_.dir) {
+    if (mkdir(options_.dir, 0755) != 0 && errno != EEXIST) return false;
+    csv_ = fopen((std::string(options_.dir) + "/frames.csv").c_str(), "w");
+    if (!csv_) return false;
+    fprintf(csv_,
+            "frame,at_ms,duration_ms,mode,clear,fill_rect,draw_pixel,draw_hline,draw_text,draw_bitmap,draw_rect,"
+            "pixel_writes,pixel_changes,dirty_px\n");
+  }
+  lastCounters_ = display_counters();
+  for (size_t i = 0; i < 4; ++i) lastRenderCounts_[i] = core::profiler::stats(kRenderSections[i]).count;
+  set_present_hook(&FrameCapture::on_present, this);
+  return true;
+}
+
+bool FrameCapture::finish(uint32_t endMs) {
+  set_present_hook(nullptr, nullptr);
+  if (hasPending_) {
+    write_record(pending_, endMs - pending_.atMs, take_mode());
+    hasPending_ = false;
+  }
+  if (apngOpen_) {
+    ok_ = apng_.close(endMs - pending_.atMs) && ok_;
+    apngOpen_ = false;
+  }
+  if (csv_) {
+    ok_ = fclose(csv_) == 0 && ok_;
+    csv_ = nullptr;
+  }
+  return ok_;
+}
+
+const char *FrameCapture::mode_name(uint8_t mode) {
+  static const char *const kNames[kModeCount] = {"full", "minimal", "eta", "scroll", "other"};
+  return mode < kModeCount ? kNames[mode] : "?";
+}
+
+void FrameCapture::on_present(void *ctx) { static_cast<FrameCapture *>(ctx)->capture(); }
+
+// The render section that called present() only records its count when it
+// returns, so a frame's mode is known at the next present (or at finish()).
+void FrameCapture::capture() {
+  const uint32_t nowMs = now_ms();
+  if (hasPending_) {
+    write_record(pending_, nowMs - pending_.atMs, take_mode());
+    hasPending_ = false;
+  } else {
+    take_mode();
+  }
+
+  const DisplayCounters counters = display_counters();
+  const DisplayCounters calls = counters_since(counters, lastCounters_);
+  lastCounters_ = counters;
+  if (nowMs < options_.fromMs || nowMs >= options_.untilMs) return;
+
+  pending_.index = frames_ + 1;
+  pending_.atMs = nowMs;
+  pending_.calls = calls;
+  pending_.dirtyPixels = engine_->frame_stats().lastDirtyPixels;
+  hasPending_ = true;
+
+  const uint16_t *pixels = presented_pixels();
+  if (options_.dir) {
+    char name[32];
+    snprintf(name, sizeof(name), "/frame-%06lu.ppm", static_cast<unsigned long>(pending_.index));
+    ok_ = write_ppm(std::string(options_.dir) + name, pixels, display_width(), display_height()) && ok_;
+  }
+  if (options_.apngPath) {
+    if (!apngOpen_) {
+      apngOpen_ = apng_.open(options_.apngPath, display_width(), display_height(), options_.apngScale);
+      ok_ = apngOpen_ && ok_;
+    }
+    // A repaint that changed nothing only lengthens the previous frame.
+    if (apngOpen_ && (calls.pixelChanges > 0 || apng_.frames() == 0)) {
+      ok_ = apng_.add_frame(pixels, nowMs) && ok_;
+    }
+  }
+}
+
+uint8_t FrameCapture::take_mode() {
+  uint8_t mode = kModeOther;
+  for (uint8_t i = 0; i < 4; ++i) {
+    const uint32_t count = core::profiler::stats(kRenderSections[i]).count;
+    // Full wins: a minimal repaint that falls back to a full one presents from
+    // inside render_full().
+    if (count != lastRenderCounts_[i] && mode == kModeOther) mode = i;
+    lastRenderCounts_[i] = count;
+  }
+  return mode;
+}
+
+void FrameCapture::write_record(const Record &record, uint32_t durationMs, uint8_t mode) {
+  ++frames_;
+  ++modeFrames_[mode];
+  if (record.calls.pixelChanges == 0) ++unchangedFrames_;
+  if (!csv_) return;
+  fprintf(csv_,
+          "%lu,%lu,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%llu,%llu,%lu\n",
+          static_cast<unsigned long>(record.index),
+          static_cast<unsigned long>(record.atMs),
+          static_cast<unsigned long>(durationMs),
+          mode_name(mode),
+          static_cast<unsigned long>(record.calls.clears),
+          static_cast<unsigned long>(record.calls.fillRects),
+          static_cast<unsigned long>(record.calls.drawPixels),
+          static_cast<unsigned long>(record.calls.drawHlines),
+          static_cast<unsigned long>(record.calls.drawTexts),
+          static_cast<unsigned long>(record.calls.drawBitmaps),
+          static_cast<unsigned long>(record.calls.drawRects),
+          static_cast<unsigned long long>(record.calls.pixelWrites),
+          static_cast<unsigned long long>(record.calls.pixelChanges),
+          static_cast<unsigned long>(record.dirtyPixels));
+}
+
+}  // namespace sim
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "apng_writer.h"
+#include "core/display_engine.h"
+#include "sim_display.h"
+
+// Records every frame the simulated panel presents inside a time window: one
+// CSV row per frame with the render path that produced it and the engine
+// calls it took, plus the frames themselves as a PPM sequence and/or an
+// animated PNG timed on the virtual clock.
+//
+// frames.csv columns:
+//   frame,at_ms,duration_ms,mode,clear,fill_rect,draw_pixel,draw_hline,
+//   draw_text,draw_bitmap,draw_rect,pixel_writes,pixel_changes,dirty_px
+//
+// mode is full, minimal, eta or scroll (the profiler section that presented)
+// or other. A frame with pixel_changes 0 repainted nothing visible.
+namespace sim {
+
+struct CaptureOptions {
+  const char *dir = nullptr;       // PPM sequence and frames.csv
+  const char *apngPath = nullptr;
+  uint8_t apngScale = 2;
+  uint32_t fromMs = 0;
+  uint32_t untilMs = UINT32_MAX;
+};
+
+class FrameCapture final {
+ public:
+  FrameCapture();
+  ~FrameCapture();
+
+  // Installs the present hook; engine is read for per-frame dirty area.
+  bool begin(const CaptureOptions &options, const core::DisplayEngine &engine);
+  // Closes the last frame at endMs and the output files.
+  bool finish(uint32_t endMs);
+
+  uint32_t frames() const { return frames_; }
+  uint32_t unchanged_frames() const { return unchangedFrames_; }
+  uint32_t mode_frames(uint8_t mode) const { return modeFrames_[mode]; }
+  static const char *mode_name(uint8_t mode);
+  static constexpr uint8_t kModeCount = 5;
+
+ private:
+  struct Record {
+    uint32_t index;
+    uint32_t atMs;
+    DisplayCounters calls;
+    uint32_t dirtyPixels;
+  };
+
+  static void on_present(void *ctx);
+  void capture();
+  uint8_t take_mode();
+  void write_record(const Record &record, uint32_t durationMs, uint8_t mode);
+
+  CaptureOptions options_;
+  const core::DisplayEngine *engine_;
+  FILE *csv_;
+  ApngWriter apng_;
+  bool apngOpen_;
+  bool ok_;
+  DisplayCounters lastCounters_;
+  uint32_t lastRenderCounts_[4];
+  bool hasPending_;
+  Record pending_;
+  uint32_t frames_;
+  uint32_t unchangedFrames_;
+  uint32_t modeFrames_[kModeCount];
+};
+
+}  // namespace sim
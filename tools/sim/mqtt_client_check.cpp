@@ -0,0 +1,109 @@
+// Runs core::MqttClient with the real mqtt::Connection against brokers that
+// fail every connect attempt inside the tick that starts it (a refused
+// loopback port, a host that does not resolve) and checks the client backs
+// off between attempts instead of retrying on every loop wake. Time is the
+// simulator's virtual clock; the sockets are real.
+//
+//   mqtt_client_check
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "core/logging.h"
+#include "core/mqtt_client.h"
+#include "sim_runtime.h"
+
+namespace {
+
+constexpr uint32_t kLoopWakeMs = 50;       // the controller's network poll period
+constexpr uint32_t kRunMs = 30000;
+constexpr uint32_t kMinFirstRetryMs = 1000;
+constexpr uint32_t kMaxAttempts = 8;       // 1 s doubling with jitter fits 5 or 6 in 30 s
+
+struct Attempts {
+  std::vector<uint32_t> startedAtMs;
+  uint32_t failures = 0;
+};
+
+void on_serial(const char *text, void *ctx) {
+  Attempts &attempts = *static_cast<Attempts *>(ctx);
+  if (strstr(text, "Attempting broker connect")) attempts.startedAtMs.push_back(millis());
+  if (strstr(text, "Broker connect failed")) ++attempts.failures;
+}
+
+// A port nothing listens on: bind one, then close it.
+uint16_t closed_port() {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
+bool check(bool ok, const char *scenario, const char *what) {
+  if (!ok) printf("FAIL  %-18s %s\n", scenario, what);
+  return ok;
+}
+
+bool run_scenario(const char *name, const char *host, uint16_t port) {
+  core::MqttConfig config{};
+  strncpy(config.host, host, sizeof(config.host) - 1);
+  config.port = port;
+  strncpy(config.clientId, "mqtt-client-check", sizeof(config.clientId) - 1);
+  core::MqttTopics topics{};
+  core::MqttClient::build_default_topics("mqtt-client-check", topics);
+
+  Attempts attempts;
+  sim::set_serial_sink(&on_serial, &attempts);
+  core::MqttClient client;
+  client.begin(config, topics);
+  const uint32_t startedAtMs = millis();
+  while (millis() - startedAtMs < kRunMs) {
+    client.tick(millis());
+    core::logging::flush();
+    sim::advance_ms(kLoopWakeMs);
+  }
+  client.disconnect(false);
+  core::logging::flush();
+  sim::set_serial_sink(nullptr, nullptr);
+
+  const std::vector<uint32_t> &at = attempts.startedAtMs;
+  bool ok = check(at.size() >= 3, name, "fewer than 3 connect attempts");
+  ok = check(at.size() <= kMaxAttempts, name, "retried without backing off") && ok;
+  ok = check(attempts.failures == at.size(), name, "a failed attempt was not logged") && ok;
+  for (size_t i = 1; ok && i < at.size(); ++i) {
+    const uint32_t gapMs = at[i] - at[i - 1];
+    ok = check(gapMs >= kMinFirstRetryMs, name, "retried sooner than the first backoff step") && ok;
+    ok = check(i < 2 || gapMs > at[i - 1] - at[i - 2], name, "retry spacing did not grow") && ok;
+  }
+
+  printf("%-4s  %-18s %zu attempts in %lu ms, gaps", ok ? "ok" : "FAIL", name, at.size(),
+         static_cast<unsigned long>(kRunMs));
+  for (size_t i = 1; i < at.size() && i <= kMaxAttempts; ++i) {
+    printf(" %lu", static_cast<unsigned long>(at[i] - at[i - 1]));
+  }
+  printf(at.size() > kMaxAttempts + 1 ? " ...\n" : "\n");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  sim::set_station_started(true);
+  sim::set_wifi_up(true);
+
+  bool ok = run_scenario("refused_port", "127.0.0.1", closed_port());
+  ok = run_scenario("unresolvable_host", "broker.invalid", 1883) && ok;
+  return ok ? 0 : 1;
+}
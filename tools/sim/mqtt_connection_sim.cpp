@@ -0,0 +1,200 @@
+// mqtt::Connection for the host simulator. Instead of a socket it talks to the
+// simulated broker in sim_runtime: an attempt resolves kHandshakeMs after
+// start(), connecting if the trace has the broker up; inbound commands are
+// handed to the message callback, no more per tick than one socket read of
+// kRxBufferLen bytes would carry, and publishes go straight to the publish
+// sink. The real MqttClient above it keeps its retry, queueing and logging.
+
+#include "network/mqtt_connection.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "sim_runtime.h"
+
+namespace mqtt {
+
+namespace {
+
+// TCP connect through SUBACK on a LAN broker. Never zero: a real attempt
+// always spans ticks, and MqttClient relies on seeing the in-flight phase.
+constexpr uint32_t kHandshakeMs = 20;
+
+bool has_text(const char *text) { return text && text[0] != '\0'; }
+
+// Size of the QoS 0 PUBLISH carrying a command, as it sits in rx_.
+size_t publish_wire_len(const sim::Command &command) {
+  const size_t remaining = 2 + command.topic.size() + command.payload.size();
+  size_t lengthBytes = 1;
+  for (size_t rest = remaining >> 7; rest > 0; rest >>= 7) ++lengthBytes;
+  return 1 + lengthBytes + remaining;
+}
+
+void publish_text(const char *topic, const char *payload, bool retained) {
+  if (!has_text(topic)) return;
+  const char *safePayload = payload ? payload : "";
+  sim::publish(topic, reinterpret_cast<const uint8_t *>(safePayload), strlen(safePayload), retained);
+}
+
+}  // namespace
+
+Connection::Connection()
+    : options_(default_options()),
+      state_(State::kIdle),
+      error_(Error::kNone),
+      errorDetail_(0),
+      socket_(-1),
+      phaseStartedAtMs_(0),
+      lastTxAtMs_(0),
+      lastRxAtMs_(0),
+      lastTickAtMs_(0),
+      pingOutstanding_(false),
+      nextPacketId_(1),
+      subscribePacketId_(0),
+      generation_(0),
+      maxTickUs_(0),
+      discardRemaining_(0),
+      dns_{},
+      messageCallback_(nullptr),
+      messageCtx_(nullptr),
+      rxLen_(0),
+      txLen_(0) {}
+
+Connection::~Connection() {}
+
+Connection::Options Connection::default_options() {
+  Options options{};
+  options.connect.keepAliveSec = 60;
+  options.dnsTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.connectTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.connackTimeoutMs = kDefaultPhaseTimeoutMs;
+  options.subackTimeoutMs = kDefaultPhaseTimeoutMs;
+  return options;
+}
+
+bool Connection::start(const Options &options, uint32_t nowMs) {
+  if (state_ != State::kIdle || !has_text(options.host) || options.port == 0) {
+    return false;
+  }
+  options_ = options;
+  error_ = Error::kNone;
+  errorDetail_ = 0;
+  enter(State::kConnecting, nowMs);
+  return true;
+}
+
+void Connection::tick(uint32_t nowMs) {
+  lastTickAtMs_ = nowMs;
+  switch (state_) {
+    case State::kIdle:
+      return;
+    case State::kResolving:
+    case State::kConnecting:
+    case State::kAwaitConnack:
+    case State::kAwaitSuback:
+      if (nowMs - phaseStartedAtMs_ < kHandshakeMs) {
+        return;
+      }
+      if (!sim::mqtt_up()) {
+        fail(Error::kConnectFailed, ECONNREFUSED);
+        return;
+      }
+      enter(State::kConnected, nowMs);
+      publish_text(options_.birthTopic, options_.birthPayload, options_.birthRetain);
+      return;
+    case State::kConnected:
+      break;
+  }
+
+  if (!sim::mqtt_up()) {
+    // The broker publishes the will once it notices the session is gone.
+    publish_text(options_.connect.willTopic, options_.connect.willMessage, options_.connect.willRetain);
+    fail(Error::kConnectionLost, 0);
+    return;
+  }
+
+  const uint32_t generation = generation_;
+  size_t budget = kRxBufferLen;
+  sim::Command command;
+  while (messageCallback_) {
+    const sim::Command *next = sim::peek_command();
+    if (!next) break;
+    const size_t wireLen = publish_wire_len(*next);
+    if (wireLen > kRxBufferLen) {
+      sim::pop_command(command);
+      sim::count_oversize_discard();
+      continue;
+    }
+    if (wireLen > budget) break;
+    budget -= wireLen;
+    sim::pop_command(command);
+    lastRxAtMs_ = nowMs;
+    sim::begin_delivery(command);
+    messageCallback_(command.topic.c_str(), command.payload.data(), command.payload.size(), messageCtx_);
+    sim::end_delivery(command);
+    if (generation != generation_) break;
+  }
+}
+
+void Connection::disconnect() { drop(); }
+
+void Connection::drop() {
+  state_ = State::kIdle;
+  ++generation_;
+}
+
+bool Connection::publish(const char *topic, const uint8_t *payload, size_t len, bool retained) {
+  if (state_ != State::kConnected) return false;
+  lastTxAtMs_ = lastTickAtMs_;
+  sim::publish(topic, payload, len, retained);
+  return true;
+}
+
+void Connection::set_message_callback(MessageCallback callback, void *ctx) {
+  messageCallback_ = callback;
+  messageCtx_ = ctx;
+}
+
+const char *Connection::state_name(State state) {
+  switch (state) {
+    case State::kIdle:
+      return "idle";
+    case State::kResolving:
+      return "resolving";
+    case State::kConnecting:
+      return "connecting";
+    case State::kAwaitConnack:
+      return "await_connack";
+    case State::kAwaitSuback:
+      return "await_suback";
+    case State::kConnected:
+      return "connected";
+  }
+  return "unknown";
+}
+
+const char *Connection::error_name(Error error) {
+  switch (error) {
+    case Error::kNone:
+      return "none";
+    case Error::kConnectFailed:
+      return "connect_failed";
+    case Error::kConnectionLost:
+      return "connection_lost";
+    default:
+      return "unknown";
+  }
+}
+
+void Connection::enter(State state, uint32_t nowMs) {
+  state_ = state;
+  phaseStartedAtMs_ = nowMs;
+}
+
+void Connection::fail(Error error, int detail) {
+  drop();
+  error_ = error;
+  errorDetail_ = detail;
+}
+
+}  // namespace mqtt
@@ -0,0 +1,227 @@
+// Replays a trace through the simulated device and checks that scrolling
+// never draws over an ETA. After every ETA-only render, the scroll frames
+// that follow (up to the next full or minimal render) must leave alone every
+// pixel at or right of the leftmost column that ETA render changed, within
+// the rows it changed. Exits 1 on the first violation.
+//
+//   scroll_check [--cols N] [--rows N] <trace>
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "core/config_store.h"
+#include "core/device_controller.h"
+#include "core/display_engine.h"
+#include "core/layout_engine.h"
+#include "core/logging.h"
+#include "core/mqtt_client.h"
+#include "core/network_manager.h"
+#include "core/profiler.h"
+#include "sim_device.h"
+#include "sim_display.h"
+#include "sim_runtime.h"
+#include "trace.h"
+
+namespace {
+
+constexpr uint32_t kTailMs = 5000;
+constexpr uint32_t kMinGuardedScrollFrames = 10;
+
+enum class Mode : uint8_t { kFull, kMinimal, kEta, kScroll, kOther };
+
+constexpr core::ProfileSection kRenderSections[] = {
+    core::ProfileSection::kRenderFull,
+    core::ProfileSection::kRenderMinimal,
+    core::ProfileSection::kRenderEta,
+    core::ProfileSection::kRenderScroll,
+};
+
+struct Box {
+  bool empty = true;
+  uint16_t x0 = 0;
+  uint16_t y0 = 0;
+  uint16_t y1 = 0;
+};
+
+class EtaGuard final {
+ public:
+  EtaGuard() { take_mode(); }
+
+  static void on_present(void *ctx) { static_cast<EtaGuard *>(ctx)->present(); }
+
+  // Judges the last frame, whose render section has returned by now.
+  void finish() {
+    if (hasLast_) judge(take_mode());
+  }
+
+  bool failed() const { return failed_; }
+  uint32_t eta_renders() const { return etaRenders_; }
+  uint32_t guarded_scroll_frames() const { return guardedScrollFrames_; }
+
+ private:
+  // The render section's count moves once its scope closes, after present()
+  // returns, so a frame is judged at the next present.
+  void present() {
+    const size_t len = static_cast<size_t>(sim::display_width()) * sim::display_height();
+    if (hasLast_) {
+      judge(take_mode());
+      before_ = last_;
+    }
+    last_.assign(sim::presented_pixels(), sim::presented_pixels() + len);
+    lastAtMs_ = millis();
+    hasLast_ = true;
+  }
+
+  Mode take_mode() {
+    Mode mode = Mode::kOther;
+    for (size_t i = 0; i < 4; ++i) {
+      const uint32_t count = core::profiler::stats(kRenderSections[i]).count;
+      if (count != renderCounts_[i] && mode == Mode::kOther) mode = static_cast<Mode>(i);
+      renderCounts_[i] = count;
+    }
+    return mode;
+  }
+
+  // Changed pixels of the last frame against the one before it.
+  Box changed_box() const {
+    Box box;
+    if (before_.size() != last_.size()) return box;
+    const uint16_t width = sim::display_width();
+    for (size_t i = 0; i < last_.size(); ++i) {
+      if (last_[i] == before_[i]) continue;
+      const uint16_t x = static_cast<uint16_t>(i % width);
+      const uint16_t y = static_cast<uint16_t>(i / width);
+      if (box.empty) {
+        box = {false, x, y, y};
+      } else {
+        box.x0 = x < box.x0 ? x : box.x0;
+        box.y1 = y;
+      }
+    }
+    return box;
+  }
+
+  void judge(Mode mode) {
+    if (mode == Mode::kEta) {
+      const Box box = changed_box();
+      ++etaRenders_;
+      if (!box.empty) guard_ = box;
+      return;
+    }
+    if (mode != Mode::kScroll) {
+      guard_.empty = true;
+      return;
+    }
+    if (guard_.empty || failed_) return;
+    ++guardedScrollFrames_;
+    const uint16_t width = sim::display_width();
+    for (uint16_t y = guard_.y0; y <= guard_.y1; ++y) {
+      for (uint16_t x = guard_.x0; x < width; ++x) {
+        const size_t i = static_cast<size_t>(y) * width + x;
+        if (last_[i] != before_[i]) {
+          printf("FAIL  scroll frame at %lu ms drew (%u, %u), inside the ETA at x >= %u, rows %u-%u\n",
+                 static_cast<unsigned long>(lastAtMs_), x, y, guard_.x0, guard_.y0, guard_.y1);
+          failed_ = true;
+          return;
+        }
+      }
+    }
+  }
+
+  std::vector<uint16_t> before_;
+  std::vector<uint16_t> last_;
+  bool hasLast_ = false;
+  uint32_t lastAtMs_ = 0;
+  uint32_t renderCounts_[4] = {};
+  Box guard_;
+  bool failed_ = false;
+  uint32_t etaRenders_ = 0;
+  uint32_t guardedScrollFrames_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint8_t panelCols = 2;
+  uint8_t panelRows = 1;
+  const char *tracePath = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--cols") == 0 && i + 1 < argc) {
+      panelCols = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+      panelRows = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (argv[i][0] != '-' && !tracePath) {
+      tracePath = argv[i];
+    } else {
+      tracePath = nullptr;
+      break;
+    }
+  }
+  if (!tracePath || panelCols == 0 || panelRows == 0) {
+    fprintf(stderr, "usage: %s [--cols N] [--rows N] <trace>\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<sim::TraceEvent> events;
+  char err[128];
+  if (!sim::load_trace(tracePath, events, err, sizeof(err))) {
+    fprintf(stderr, "%s: %s\n", tracePath, err);
+    return 1;
+  }
+
+  Serial.begin(115200);
+  const core::DeviceRuntimeConfig cfg = sim::bootstrap_config(panelCols, panelRows, false);
+  core::MqttTopics topics{};
+  core::MqttClient::build_default_topics(cfg.deviceId, topics);
+
+  core::ConfigStore configStore;
+  core::NetworkManager networkManager;
+  core::MqttClient mqttClient;
+  core::DisplayEngine displayEngine;
+  core::LayoutEngine layoutEngine;
+  core::DeviceController controller(
+      core::DeviceController::Dependencies{&configStore, &networkManager, &mqttClient, &displayEngine, &layoutEngine});
+
+  EtaGuard guard;
+  sim::set_present_hook(&EtaGuard::on_present, &guard);
+
+  configStore.set_bootstrap_config(cfg);
+  const bool started = controller.begin();
+  core::logging::flush();
+  if (!started) {
+    fprintf(stderr, "controller init failed\n");
+    return 1;
+  }
+
+  const uint32_t endMs = (events.empty() ? static_cast<uint32_t>(millis()) : events.back().atMs) + kTailMs;
+  size_t next = 0;
+  while (!sim::restart_requested() && !guard.failed()) {
+    const uint32_t nowMs = millis();
+    for (; next < events.size() && events[next].atMs <= nowMs; ++next) {
+      sim::apply_event(events[next], topics.command);
+    }
+    if (next == events.size() && nowMs >= endMs) break;
+    controller.tick(nowMs);
+    core::logging::flush();
+    controller.wait_for_next_deadline();
+  }
+  guard.finish();
+  sim::set_present_hook(nullptr, nullptr);
+
+  if (guard.failed()) return 1;
+  if (guard.guarded_scroll_frames() < kMinGuardedScrollFrames) {
+    printf("FAIL  %s: only %lu scroll frames followed an ETA render; the trace does not exercise the check\n",
+           tracePath,
+           static_cast<unsigned long>(guard.guarded_scroll_frames()));
+    return 1;
+  }
+  printf("%s: %lu ETA renders, %lu scroll frames after them kept clear of the ETA\n",
+         tracePath,
+         static_cast<unsigned long>(guard.eta_renders()),
+         static_cast<unsigned long>(guard.guarded_scroll_frames()));
+  return 0;
+}
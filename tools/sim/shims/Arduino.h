@@ -0,0 +1,72 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino-ESP32 core the firmware uses.
+// Time comes from the simulator's virtual clock (see sim_runtime.h); ARDUINO
+// stays undefined so shared code keeps taking its host paths.
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void randomSeed(unsigned long seed);
+long random(long maxExclusive);
+long random(long minInclusive, long maxExclusive);
+
+// UTC-only SNTP start; the simulator decides whether it ever answers.
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+
+class String {
+ public:
+  String(const char *text = "") : s_(text ? text : "") {}
+  String(const std::string &text) : s_(text) {}
+
+  const char *c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool startsWith(const char *prefix) const { return s_.compare(0, strlen(prefix), prefix) == 0; }
+  void trim();
+
+  bool operator==(const char *other) const { return s_ == other; }
+  bool operator!=(const char *other) const { return s_ != other; }
+  String &operator+=(const char *other) {
+    s_ += other;
+    return *this;
+  }
+
+ private:
+  std::string s_;
+};
+
+class HardwareSerial {
+ public:
+  void begin(unsigned long baud);
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char *text);
+  size_t println(const char *text = "");
+  void flush();
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac();
+  const char *getSdkVersion();
+  uint32_t getCpuFreqMHz();
+  // Records the request; the simulator stops the run after the current tick.
+  void restart();
+};
+
+extern EspClass ESP;
@@ -0,0 +1,4 @@
+#pragma once
+
+// The simulated DisplayEngine draws into memory and never touches a panel.
+class MatrixPanel_I2S_DMA;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+// NVS stand-in: values live in process memory for the length of a run, keyed
+// by namespace and key, so the controller's caches and counters round-trip.
+class Preferences {
+ public:
+  bool begin(const char *ns, bool readOnly = false);
+  void end();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  bool getBool(const char *key, bool fallback = false);
+  char getChar(const char *key, char fallback = 0);
+  uint8_t getUChar(const char *key, uint8_t fallback = 0);
+  uint16_t getUShort(const char *key, uint16_t fallback = 0);
+  int32_t getInt(const char *key, int32_t fallback = 0);
+  uint32_t getUInt(const char *key, uint32_t fallback = 0);
+  String getString(const char *key, const String &fallback = String());
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *out, size_t maxLen);
+
+  size_t putBool(const char *key, bool value);
+  size_t putChar(const char *key, char value);
+  size_t putUChar(const char *key, uint8_t value);
+  size_t putUShort(const char *key, uint16_t value);
+  size_t putInt(const char *key, int32_t value);
+  size_t putUInt(const char *key, uint32_t value);
+  size_t putString(const char *key, const char *value);
+  size_t putBytes(const char *key, const void *value, size_t len);
+
+ private:
+  size_t put_raw(const char *key, const void *value, size_t len);
+  bool get_raw(const char *key, void *out, size_t len);
+
+  std::string ns_;
+  bool open_ = false;
+  bool readOnly_ = false;
+};
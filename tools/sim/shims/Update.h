@@ -0,0 +1,31 @@
+#pragma once
+
+#include <WiFiClient.h>
+
+constexpr size_t UPDATE_SIZE_UNKNOWN = 0xFFFFFFFF;
+
+// Refuses every update, so OTA commands fail cleanly in the simulator.
+class UpdateClass {
+ public:
+  bool begin(size_t size) {
+    (void)size;
+    return false;
+  }
+  size_t write(uint8_t *data, size_t len) {
+    (void)data;
+    (void)len;
+    return 0;
+  }
+  size_t writeStream(WiFiClient &stream) {
+    (void)stream;
+    return 0;
+  }
+  bool end(bool evenIfRemaining = false) {
+    (void)evenIfRemaining;
+    return false;
+  }
+  bool hasError() { return true; }
+  const char *errorString() { return "simulated"; }
+};
+
+extern UpdateClass Update;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+
+enum HTTPMethod {
+  HTTP_ANY,
+  HTTP_GET,
+  HTTP_POST,
+};
+
+// Routes are accepted and never called; there are no HTTP clients.
+class WebServer {
+ public:
+  using Handler = void (*)();
+
+  explicit WebServer(int port) { (void)port; }
+  void begin() {}
+  void handleClient() {}
+  void on(const char *uri, HTTPMethod method, Handler handler) {
+    (void)uri;
+    (void)method;
+    (void)handler;
+  }
+  void send(int code, const char *contentType, const char *content) {
+    (void)code;
+    (void)contentType;
+    (void)content;
+  }
+  bool hasArg(const char *name) {
+    (void)name;
+    return false;
+  }
+  String arg(const char *name) {
+    (void)name;
+    return String();
+  }
+};
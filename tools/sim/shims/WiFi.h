@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+// The disconnect reasons the controller distinguishes (esp_wifi_types.h).
+typedef enum {
+  WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+  WIFI_REASON_AKMP_INVALID = 20,
+  WIFI_REASON_802_1X_AUTH_FAILED = 23,
+  WIFI_REASON_TIMEOUT = 65,
+  WIFI_REASON_BAD_CIPHER_OR_AKM = 66,
+  WIFI_REASON_BEACON_TIMEOUT = 200,
+  WIFI_REASON_NO_AP_FOUND = 201,
+  WIFI_REASON_AUTH_FAIL = 202,
+  WIFI_REASON_ASSOC_FAIL = 203,
+  WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+  WIFI_REASON_CONNECTION_FAIL = 205,
+} wifi_err_reason_t;
+
+class IPAddress {
+ public:
+  IPAddress() : octets_{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets_{a, b, c, d} {}
+  String toString() const;
+
+ private:
+  uint8_t octets_[4];
+};
+
+// Reports the simulated link: WL_CONNECTED while the trace has WiFi up and
+// the station has been started.
+class WiFiClass {
+ public:
+  wl_status_t status();
+  int8_t RSSI();
+  String SSID();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+};
+
+extern WiFiClass WiFi;
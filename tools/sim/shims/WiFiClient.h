@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Never connected; the simulator has no HTTP peers.
+class WiFiClient {
+ public:
+  void setTimeout(uint32_t timeoutMs) { (void)timeoutMs; }
+  int readBytes(uint8_t *buffer, size_t len) {
+    (void)buffer;
+    (void)len;
+    return 0;
+  }
+  String readStringUntil(char terminator) {
+    (void)terminator;
+    return String();
+  }
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+// Task creation always fails, so the controller renders from its own loop and
+// the log ring is drained by the simulator. Delays and notification waits
+// advance the virtual clock instead of blocking.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, uint32_t stackBytes, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *outHandle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+void xTaskNotifyGive(TaskHandle_t task);
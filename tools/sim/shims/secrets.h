@@ -0,0 +1,7 @@
+#pragma once
+
+// Simulator builds never reach a broker; these only satisfy the includes.
+#define COMMUTELIVE_MQTT_HOST "sim.invalid"
+#define COMMUTELIVE_MQTT_PORT 1883
+#define COMMUTELIVE_MQTT_USER ""
+#define COMMUTELIVE_MQTT_PASS ""
@@ -0,0 +1,11 @@
+#pragma once
+
+#include_next <sys/time.h>
+
+// The firmware reads SNTP time with gettimeofday(); route it to the virtual
+// wall clock so runs do not depend on the host's clock.
+namespace sim {
+int gettimeofday(struct timeval *tv, void *tz);
+}
+
+#define gettimeofday(tv, tz) ::sim::gettimeofday(tv, tz)
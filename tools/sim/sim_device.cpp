@@ -0,0 +1,76 @@
+#include "sim_device.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "network/wifi_manager.h"
+#include "secrets.h"
+#include "sim_runtime.h"
+
+namespace sim {
+
+namespace {
+
+template <size_t N>
+void copy_str(char (&dst)[N], const char *src) {
+  strncpy(dst, src ? src : "", N - 1);
+  dst[N - 1] = '\0';
+}
+
+}  // namespace
+
+core::DeviceRuntimeConfig bootstrap_config(uint8_t panelCols, uint8_t panelRows, bool doubleBuffered) {
+  core::DeviceRuntimeConfig cfg{};
+  cfg.schemaVersion = 2;
+  const uint64_t chipid = ESP.getEfuseMac();
+  snprintf(cfg.deviceId, sizeof(cfg.deviceId), "esp32-%04X%08X", static_cast<uint16_t>(chipid >> 32),
+           static_cast<uint32_t>(chipid));
+
+  cfg.display.panelRows = panelRows;
+  cfg.display.panelCols = panelCols;
+  cfg.display.panelWidth = 64;
+  cfg.display.panelHeight = 32;
+  cfg.display.brightness = 32;
+  cfg.display.doubleBuffered = doubleBuffered;
+  cfg.display.latchBlanking = 4;
+
+  copy_str(cfg.network.ssid, "sim-ap");
+  copy_str(cfg.network.password, "sim-password");
+  char apSsid[64];
+  wifi_manager::build_ap_ssid(apSsid, sizeof(apSsid));
+  copy_str(cfg.network.apSsid, apSsid);
+  copy_str(cfg.network.apPassword, wifi_manager::generate_or_load_ap_password().c_str());
+
+  copy_str(cfg.mqtt.host, COMMUTELIVE_MQTT_HOST);
+  cfg.mqtt.port = static_cast<uint16_t>(COMMUTELIVE_MQTT_PORT);
+  copy_str(cfg.mqtt.username, COMMUTELIVE_MQTT_USER);
+  copy_str(cfg.mqtt.password, COMMUTELIVE_MQTT_PASS);
+  copy_str(cfg.mqtt.clientId, cfg.deviceId);
+  return cfg;
+}
+
+bool apply_event(const TraceEvent &event, const char *commandTopic) {
+  switch (event.kind) {
+    case TraceEventKind::kCommand:
+      return push_command({event.topic.empty() ? commandTopic : event.topic, event.payload, now_us()});
+    case TraceEventKind::kWifiDown:
+      set_wifi_up(false);
+      break;
+    case TraceEventKind::kWifiUp:
+      set_wifi_up(true);
+      break;
+    case TraceEventKind::kMqttDown:
+      set_mqtt_up(false);
+      break;
+    case TraceEventKind::kMqttUp:
+      set_mqtt_up(true);
+      break;
+    case TraceEventKind::kSntp:
+      set_sntp_epoch_ms(event.value);
+      break;
+  }
+  return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "core/config_store.h"
+#include "trace.h"
+
+// Setup shared by the tools that run DeviceController in the simulator.
+namespace sim {
+
+// Same bootstrap configuration as setup() in main.cpp, plus WiFi credentials
+// so the device joins the simulated access point instead of waiting for BLE.
+core::DeviceRuntimeConfig bootstrap_config(uint8_t panelCols, uint8_t panelRows, bool doubleBuffered);
+
+// Applies a trace event to the simulated world. Commands without a topic go
+// to commandTopic; false means the broker queue dropped the command.
+bool apply_event(const TraceEvent &event, const char *commandTopic);
+
+}  // namespace sim
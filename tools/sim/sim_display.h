@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// What the simulated DisplayEngine put on the panel. There is one engine per
+// simulated device, so the framebuffer is process-wide.
+namespace sim {
+
+struct DisplayCounters {
+  uint64_t pixelWrites;   // in-bounds pixel stores issued by draw calls
+  uint64_t pixelChanges;  // stores that changed the stored color
+  uint32_t presents;
+  // Engine calls that drew; ones rejected before begin() or for an empty
+  // size are left out.
+  uint32_t clears;
+  uint32_t fillRects;
+  uint32_t drawPixels;
+  uint32_t drawHlines;
+  uint32_t drawTexts;
+  uint32_t drawBitmaps;
+  uint32_t drawRects;
+};
+
+const DisplayCounters &display_counters();
+
+// Called at the end of every present(), with the new frame in
+// presented_pixels().
+using PresentHook = void (*)(void *ctx);
+void set_present_hook(PresentHook hook, void *ctx);
+
+// Last presented frame, row-major RGB565; null before the first present().
+const uint16_t *presented_pixels();
+uint16_t display_width();
+uint16_t display_height();
+
+}  // namespace sim
@@ -0,0 +1,174 @@
+#include "sim_runtime.h"
+
+#include <deque>
+#include <utility>
+
+namespace sim {
+
+namespace {
+
+struct World {
+  uint64_t nowUs = 0;
+  bool wifiUp = true;
+  bool stationStarted = false;
+  bool mqttUp = true;
+  uint64_t sntpEpochMs = 0;
+  uint32_t sntpSetAtMs = 0;
+  std::deque<Command> inbox;
+  size_t inboxLimit = 0;
+  uint32_t droppedCommands = 0;
+  uint32_t oversizeDiscards = 0;
+  DeliveryHook beforeDelivery = nullptr;
+  DeliveryHook afterDelivery = nullptr;
+  void *deliveryCtx = nullptr;
+  PublishSink sink = nullptr;
+  void *sinkCtx = nullptr;
+  bool restartRequested = false;
+  bool serialEcho = false;
+  SerialSink serialSink = nullptr;
+  void *serialSinkCtx = nullptr;
+};
+
+World &world() {
+  static World w;
+  return w;
+}
+
+}  // namespace
+
+uint32_t now_ms() {
+  return static_cast<uint32_t>(world().nowUs / 1000U);
+}
+
+uint64_t now_us() {
+  return world().nowUs;
+}
+
+void advance_ms(uint32_t ms) {
+  world().nowUs += static_cast<uint64_t>(ms) * 1000U;
+}
+
+bool wifi_up() {
+  return world().wifiUp;
+}
+
+void set_wifi_up(bool up) {
+  world().wifiUp = up;
+}
+
+bool station_started() {
+  return world().stationStarted;
+}
+
+void set_station_started(bool started) {
+  world().stationStarted = started;
+}
+
+bool mqtt_up() {
+  return world().mqttUp;
+}
+
+void set_mqtt_up(bool up) {
+  world().mqttUp = up;
+}
+
+void set_sntp_epoch_ms(uint64_t epochMs) {
+  world().sntpEpochMs = epochMs;
+  world().sntpSetAtMs = now_ms();
+}
+
+uint64_t sntp_epoch_ms() {
+  if (world().sntpEpochMs == 0) return 0;
+  return world().sntpEpochMs + (now_ms() - world().sntpSetAtMs);
+}
+
+bool push_command(Command command) {
+  World &w = world();
+  if (w.inboxLimit > 0 && w.inbox.size() >= w.inboxLimit) {
+    ++w.droppedCommands;
+    return false;
+  }
+  w.inbox.push_back(std::move(command));
+  return true;
+}
+
+const Command *peek_command() {
+  return world().inbox.empty() ? nullptr : &world().inbox.front();
+}
+
+bool pop_command(Command &out) {
+  if (world().inbox.empty()) return false;
+  out = std::move(world().inbox.front());
+  world().inbox.pop_front();
+  return true;
+}
+
+size_t pending_commands() {
+  return world().inbox.size();
+}
+
+void set_command_queue_limit(size_t limit) {
+  world().inboxLimit = limit;
+}
+
+uint32_t dropped_commands() {
+  return world().droppedCommands;
+}
+
+void count_oversize_discard() {
+  ++world().oversizeDiscards;
+}
+
+uint32_t oversize_discards() {
+  return world().oversizeDiscards;
+}
+
+void set_delivery_hooks(DeliveryHook before, DeliveryHook after, void *ctx) {
+  world().beforeDelivery = before;
+  world().afterDelivery = after;
+  world().deliveryCtx = ctx;
+}
+
+void begin_delivery(const Command &command) {
+  if (world().beforeDelivery) world().beforeDelivery(command, world().deliveryCtx);
+}
+
+void end_delivery(const Command &command) {
+  if (world().afterDelivery) world().afterDelivery(command, world().deliveryCtx);
+}
+
+void set_publish_sink(PublishSink sink, void *ctx) {
+  world().sink = sink;
+  world().sinkCtx = ctx;
+}
+
+void publish(const char *topic, const uint8_t *payload, size_t len, bool retained) {
+  if (world().sink) world().sink(topic, payload, len, retained, world().sinkCtx);
+}
+
+void request_restart() {
+  world().restartRequested = true;
+}
+
+bool restart_requested() {
+  return world().restartRequested;
+}
+
+void set_serial_echo(bool echo) {
+  world().serialEcho = echo;
+}
+
+bool serial_echo() {
+  return world().serialEcho;
+}
+
+void set_serial_sink(SerialSink sink, void *ctx) {
+  world().serialSink = sink;
+  world().serialSinkCtx = ctx;
+}
+
+void serial_write(const char *text) {
+  if (world().serialSink) world().serialSink(text, world().serialSinkCtx);
+}
+
+}  // namespace sim
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// The world the simulated firmware runs in: one virtual clock, the state of
+// its WiFi and MQTT links, the commands waiting at the broker and a sink for
+// everything the device publishes. Shims and the sim replacements of
+// hardware-facing classes read and write this; device_sim drives it.
+namespace sim {
+
+// Virtual time since boot. millis()/micros() read it; delay(), vTaskDelay()
+// and the scheduler's notification waits advance it.
+uint32_t now_ms();
+uint64_t now_us();
+void advance_ms(uint32_t ms);
+
+// The access point. WiFi.status() reports connected only while it is up and
+// the firmware has started the station (begin_station/connect_station) since
+// the last reset_station_state().
+bool wifi_up();
+void set_wifi_up(bool up);
+bool station_started();
+void set_station_started(bool started);
+bool mqtt_up();
+void set_mqtt_up(bool up);
+
+// Unix time SNTP reports from now on; 0 (the default) means it never answers.
+void set_sntp_epoch_ms(uint64_t epochMs);
+uint64_t sntp_epoch_ms();
+
+struct Command {
+  std::string topic;
+  std::vector<uint8_t> payload;
+  uint64_t queuedAtUs;  // when it reached the broker
+};
+
+// Commands are queued at the broker and delivered by the simulated
+// mqtt::Connection while a session is up, as many per tick as fit in one
+// socket read. With a limit set, a push onto a full queue is dropped like a
+// broker drops messages for a subscriber that is not keeping up.
+bool push_command(Command command);
+const Command *peek_command();
+bool pop_command(Command &out);
+size_t pending_commands();
+void set_command_queue_limit(size_t limit);  // 0 (the default) means unbounded
+uint32_t dropped_commands();
+// Commands too large for the device's receive buffer, which the connection
+// skips without handing them to the firmware.
+void count_oversize_discard();
+uint32_t oversize_discards();
+
+// Called around each command handed to the firmware's message callback, so a
+// driver can time and account for the work done on it.
+using DeliveryHook = void (*)(const Command &command, void *ctx);
+void set_delivery_hooks(DeliveryHook before, DeliveryHook after, void *ctx);
+void begin_delivery(const Command &command);
+void end_delivery(const Command &command);
+
+// Everything the broker receives from the device, including the birth and
+// will messages on the presence topic.
+using PublishSink = void (*)(const char *topic, const uint8_t *payload, size_t len, bool retained, void *ctx);
+void set_publish_sink(PublishSink sink, void *ctx);
+void publish(const char *topic, const uint8_t *payload, size_t len, bool retained);
+
+void request_restart();
+bool restart_requested();
+
+// Serial output is dropped unless echoing is on.
+void set_serial_echo(bool echo);
+bool serial_echo();
+
+// Sees every Serial.printf() line, echoed or not.
+using SerialSink = void (*)(const char *text, void *ctx);
+void set_serial_sink(SerialSink sink, void *ctx);
+void serial_write(const char *text);
+
+}  // namespace sim
@@ -0,0 +1,140 @@
+#include "trace.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+
+namespace sim {
+
+namespace {
+
+struct Directive {
+  const char *name;
+  TraceEventKind kind;
+};
+
+constexpr Directive kDirectives[] = {
+    {"!wifi_down", TraceEventKind::kWifiDown},
+    {"!wifi_up", TraceEventKind::kWifiUp},
+    {"!mqtt_down", TraceEventKind::kMqttDown},
+    {"!mqtt_up", TraceEventKind::kMqttUp},
+    {"!sntp", TraceEventKind::kSntp},
+};
+
+int hex_nibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool decode_hex(const char *text, std::vector<uint8_t> &out) {
+  out.clear();
+  for (const char *p = text; *p; p += 2) {
+    const int hi = hex_nibble(p[0]);
+    const int lo = p[1] ? hex_nibble(p[1]) : -1;
+    if (hi < 0 || lo < 0) return false;
+    out.push_back(static_cast<uint8_t>((hi << 4) | lo));
+  }
+  return !out.empty();
+}
+
+bool parse_event(const char *text, uint32_t previousMs, TraceEvent &event, const char *&reason) {
+  char *end = nullptr;
+  const unsigned long long atMs = strtoull(text, &end, 10);
+  if (end == text || !isspace(static_cast<unsigned char>(*end))) {
+    reason = "expected '<ms> <payload>'";
+    return false;
+  }
+  if (atMs > UINT32_MAX || atMs < previousMs) {
+    reason = "time out of order";
+    return false;
+  }
+  event = TraceEvent{};
+  event.atMs = static_cast<uint32_t>(atMs);
+
+  const char *rest = end;
+  while (isspace(static_cast<unsigned char>(*rest))) ++rest;
+  if (*rest == '\0') {
+    reason = "missing payload";
+    return false;
+  }
+
+  if (*rest == '!') {
+    for (const Directive &directive : kDirectives) {
+      const size_t nameLen = strlen(directive.name);
+      if (strncmp(rest, directive.name, nameLen) != 0 ||
+          (rest[nameLen] != '\0' && !isspace(static_cast<unsigned char>(rest[nameLen])))) {
+        continue;
+      }
+      event.kind = directive.kind;
+      if (directive.kind != TraceEventKind::kSntp) return true;
+      event.value = strtoull(rest + nameLen, &end, 10);
+      if (event.value == 0) {
+        reason = "!sntp needs an epoch in ms";
+        return false;
+      }
+      return true;
+    }
+    reason = "unknown directive";
+    return false;
+  }
+
+  event.kind = TraceEventKind::kCommand;
+  if (*rest == '@') {
+    const char *topicEnd = rest + 1;
+    while (*topicEnd && !isspace(static_cast<unsigned char>(*topicEnd))) ++topicEnd;
+    event.topic.assign(rest + 1, topicEnd);
+    rest = topicEnd;
+    while (isspace(static_cast<unsigned char>(*rest))) ++rest;
+    if (event.topic.empty() || *rest == '\0') {
+      reason = "expected '@<topic> <payload>'";
+      return false;
+    }
+  }
+  if (strncmp(rest, "hex:", 4) == 0) {
+    if (!decode_hex(rest + 4, event.payload)) {
+      reason = "bad hex payload";
+      return false;
+    }
+    return true;
+  }
+  event.payload.assign(rest, rest + strlen(rest));
+  return true;
+}
+
+}  // namespace
+
+bool load_trace(const char *path, std::vector<TraceEvent> &out, char *err, size_t errLen) {
+  out.clear();
+  std::ifstream in(path);
+  if (!in) {
+    snprintf(err, errLen, "cannot open %s", path);
+    return false;
+  }
+
+  std::string line;
+  uint32_t lineNo = 0;
+  uint32_t previousMs = 0;
+  while (std::getline(in, line)) {
+    ++lineNo;
+    while (!line.empty() && isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+    const size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') continue;
+
+    TraceEvent event;
+    const char *reason = nullptr;
+    if (!parse_event(line.c_str() + first, previousMs, event, reason)) {
+      snprintf(err, errLen, "line %lu: %s", static_cast<unsigned long>(lineNo), reason);
+      return false;
+    }
+    previousMs = event.atMs;
+    out.push_back(std::move(event));
+  }
+  return true;
+}
+
+}  // namespace sim
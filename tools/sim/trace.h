@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Recorded broker traffic and link events, one per line:
+//
+//   <ms> [@<topic>] <payload> command delivered on <topic>, by default the
+//                             device's command topic; the payload is the rest
+//                             of the line, or hex:<bytes> for binary payloads
+//   <ms> !wifi_down | !wifi_up | !mqtt_down | !mqtt_up
+//   <ms> !sntp <epochMs>      SNTP starts answering with this Unix time
+//
+// Times are milliseconds since boot and must not go backwards. Blank lines
+// and lines starting with '#' are skipped.
+namespace sim {
+
+enum class TraceEventKind : uint8_t {
+  kCommand,
+  kWifiDown,
+  kWifiUp,
+  kMqttDown,
+  kMqttUp,
+  kSntp,
+};
+
+struct TraceEvent {
+  uint32_t atMs;
+  TraceEventKind kind;
+  std::string topic;             // kCommand; empty for the command topic
+  std::vector<uint8_t> payload;  // kCommand only
+  uint64_t value;                // kSntp epoch
+};
+
+// False with a "line N: reason" message in err on the first bad line.
+bool load_trace(const char *path, std::vector<TraceEvent> &out, char *err, size_t errLen);
+
+}  // namespace sim
@@ -0,0 +1,121 @@
+// Station control for the host simulator. Credentials persist through the
+// Preferences shim like they do in NVS; association follows the access point
+// state the trace drives (see sim_runtime.h).
+
+#include "network/wifi_manager.h"
+
+#include <Preferences.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <string.h>
+
+#include "core/logging.h"
+#include "sim_runtime.h"
+
+namespace wifi_manager {
+
+namespace {
+
+// How long the blocking connect waits on the device before giving up.
+constexpr uint32_t kBlockingConnectTimeoutMs = 7500;
+
+Preferences prefs;
+
+}  // namespace
+
+void save_credentials(const String &ssid, const String &password, const String &user) {
+  prefs.begin("wifi", false);
+  prefs.putString("ssid", ssid.c_str());
+  prefs.putString("pass", password.c_str());
+  prefs.putString("user", user.c_str());
+  prefs.end();
+}
+
+bool load_credentials(String &ssid, String &password, String &user) {
+  prefs.begin("wifi", true);
+  ssid = prefs.getString("ssid", "");
+  password = prefs.getString("pass", "");
+  user = prefs.getString("user", "");
+  prefs.end();
+  return ssid.length() > 0;
+}
+
+void clear_credentials() {
+  prefs.begin("wifi", false);
+  prefs.remove("ssid");
+  prefs.remove("pass");
+  prefs.remove("user");
+  prefs.end();
+}
+
+void reset_station_state(bool erasePersistentConfig) {
+  (void)erasePersistentConfig;
+  sim::set_station_started(false);
+  delay(200);
+}
+
+bool connect_station(const char *ssid, const char *password, const char *username) {
+  begin_station(ssid, password, username);
+  if (sim::wifi_up()) {
+    return true;
+  }
+  delay(kBlockingConnectTimeoutMs);
+  return false;
+}
+
+bool connect_station_for_provisioning(const char *ssid,
+                                      const char *password,
+                                      const char *username,
+                                      int *finalStatusOut,
+                                      ProvisioningProgressCallback progressCb,
+                                      void *progressCtx) {
+  (void)progressCb;
+  (void)progressCtx;
+  const bool connected = connect_station(ssid, password, username);
+  if (finalStatusOut) {
+    *finalStatusOut = WiFi.status();
+  }
+  return connected;
+}
+
+void begin_station(const char *ssid, const char *password, const char *username) {
+  DCTRL_LOGI("WIFI", "begin_station ssid=%s passwordLen=%u enterprise=%s",
+             core::logging::safe_str(ssid),
+             static_cast<unsigned>(password ? strlen(password) : 0),
+             core::logging::bool_str(username && strlen(username) > 0));
+  sim::set_station_started(true);
+}
+
+void build_ap_ssid(char *out, size_t outLen) {
+  const uint64_t chipid = ESP.getEfuseMac();
+  snprintf(out, outLen, "CommuteLive-%04X", static_cast<uint16_t>(chipid));
+}
+
+String generate_or_load_ap_password() {
+  return String("SIMPASS2");
+}
+
+bool handle_connect_request(WebServer &server, String &connectedSsid, String &connectedPassword, String &connectedUser) {
+  (void)server;
+  (void)connectedSsid;
+  (void)connectedPassword;
+  (void)connectedUser;
+  return false;
+}
+
+int scan_and_emit(void (*emitChunk)(const char *json, void *ctx), void *ctx) {
+  (void)emitChunk;
+  (void)ctx;
+  return 0;
+}
+
+int last_disconnect_reason() {
+  return 0;
+}
+
+const char *disconnect_reason_name(int reason) {
+  (void)reason;
+  return "NONE";
+}
+
+}  // namespace wifi_manager